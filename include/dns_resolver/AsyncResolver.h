@@ -0,0 +1,168 @@
+/*
+ * ----------------------------------------
+ * Arquivo: AsyncResolver.h
+ * Propósito: Resolução iterativa não bloqueante (epoll) com muitas consultas por thread
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include "dns_resolver/ResolverEngine.h"
+#include "dns_resolver/ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dns_resolver {
+
+// Resultado de uma resolução assíncrona
+struct AsyncResult {
+    std::string domain;
+    uint16_t qtype = 0;
+    bool ok = false;
+    DNSMessage response;     // Válido se ok
+    std::string error;       // Motivo da falha se !ok
+};
+
+// Motor de resolução orientado a eventos
+// Uma única thread (epoll) conduz todas as resoluções como máquinas de
+// estado: cada passo iterativo envia a query por UDP não bloqueante e volta
+// ao loop; respostas, RTOs (retry no próximo servidor do conjunto NS) e o
+// prazo de cada passo são eventos. Mesmo algoritmo de ResolverEngine
+// (zone cut em cache, InfraCache, CNAME, NS sem glue como sub-resolução),
+// sem DNSSEC e só em UDP: respostas truncadas vão a um pool pequeno que faz
+// a consulta TCP bloqueante e devolve o resultado ao loop.
+// No máximo max_in_flight resoluções ativas (cada uma usa até
+// retry_servers sockets); as demais esperam na fila.
+// Com coalesce_inflight, pedidos iguais (nome + tipo) a uma resolução ativa
+// esperam por ela, sem ocupar vaga nem enviar queries; o mesmo vale para o
+// endereço de um NS sem glue pedido por várias delegações.
+class AsyncResolver {
+public:
+    using Callback = std::function<void(AsyncResult&)>;
+
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT = 256;
+
+    // Lança std::invalid_argument se !supports(config)
+    explicit AsyncResolver(
+        const ResolverConfig& config,
+        size_t max_in_flight = DEFAULT_MAX_IN_FLIGHT
+    );
+
+    // Resoluções ainda pendentes terminam com erro "Resolver stopped"
+    ~AsyncResolver();
+
+    // Não permite cópia
+    AsyncResolver(const AsyncResolver&) = delete;
+    AsyncResolver& operator=(const AsyncResolver&) = delete;
+
+    // Thread-safe; callback roda na thread do loop e não deve bloquear
+    void resolve(const std::string& domain, uint16_t qtype, Callback callback);
+
+    // Thread-safe; falha vira std::runtime_error no future
+    std::future<DNSMessage> resolve(const std::string& domain, uint16_t qtype);
+
+    // Resoluções submetidas e ainda não concluídas
+    size_t pending() const { return pending_.load(); }
+
+    // Pedidos (e sub-resoluções de NS) atendidos por uma resolução já ativa
+    uint64_t coalesced() const { return coalesced_.load(); }
+
+    // Configurações atendidas: UDP, sem DNSSEC (a cadeia DS/DNSKEY é síncrona)
+    static bool supports(const ResolverConfig& config);
+
+private:
+    struct Resolution;
+    using Clock = std::chrono::steady_clock;
+
+    struct Submission {
+        std::string domain;
+        uint16_t qtype;
+        Callback callback;
+    };
+
+    struct Timer {
+        Clock::time_point when;
+        uint64_t id;
+        uint64_t generation;
+        bool operator>(const Timer& other) const { return when > other.when; }
+    };
+
+    static const int MAX_DEPTH = 5;          // Sub-resoluções de NS aninhadas
+    static const int MAX_CNAME_DEPTH = 10;
+    static const int MAX_EVENTS = 64;
+
+    // Thread do loop
+    void loop();
+    void drainSubmissions();
+    void admitWaiting();
+    void fireTimers();
+    void onReadable(int fd);
+
+    // Coalescência (thread do loop)
+    bool join(Submission& submission);
+    Resolution& create(const std::string& domain, uint16_t qtype);
+    bool waitsFor(uint64_t waiter, uint64_t id);
+
+    // Máquina de estados (sempre na thread do loop)
+    void start(Resolution& r);
+    void startLookup(Resolution& r);
+    void beginStep(Resolution& r, const std::string& primary, const std::vector<std::string>& pool);
+    void sendNext(Resolution& r);
+    void onTimer(Resolution& r);
+    void onResponse(Resolution& r, const DNSMessage& response);
+    void followCNAME(Resolution& r, const DNSMessage& response);
+    void resolveNextNameserver(Resolution& r);
+    void stepFailed(Resolution& r, const std::string& error);
+    void complete(Resolution& r, bool ok, const DNSMessage& response, const std::string& error);
+
+    void armTimer(Resolution& r, Clock::time_point when);
+    void closeSockets(Resolution& r);
+    Resolution* find(uint64_t id);
+
+    // Executa fn na thread do loop (usado pelo pool de TCP)
+    void post(std::function<void()> fn);
+    void wake();
+
+    ResolverConfig config_;
+    ResolverEngine engine_;       // Helpers de parsing, seleção e delegações (const)
+    size_t max_in_flight_;
+
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> stop_{false};
+    std::atomic<size_t> pending_{0};
+    std::atomic<uint64_t> coalesced_{0};
+
+    // Entrada de outras threads
+    std::mutex submit_mutex_;
+    std::deque<Submission> submitted_;
+    std::deque<std::function<void()>> posted_;
+
+    // Estado do loop (só a thread do loop acessa)
+    std::deque<Submission> waiting_;
+    std::unordered_map<uint64_t, std::unique_ptr<Resolution>> active_;
+    std::unordered_map<std::string, uint64_t> by_key_;   // Pergunta → resolução ativa
+    std::unordered_map<int, uint64_t> socket_owner_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+    uint64_t next_id_ = 1;
+    size_t top_level_active_ = 0;
+
+    std::unique_ptr<ThreadPool> tcp_pool_;
+    std::thread loop_thread_;
+};
+
+} // namespace dns_resolver
@@ -11,17 +11,40 @@
 #pragma once
 
 #include "dns_resolver/types.h"
+#include "dns_resolver/CacheProtocol.h"
+#include "dns_resolver/SharedCache.h"
 #include <string>
+#include <string_view>
 #include <memory>
+#include <vector>
 
 namespace dns_resolver {
 
+// Item de armazenamento em lote (storeMany)
+struct CacheStoreItem {
+    std::string qname;
+    uint16_t qtype = 0;
+    bool negative = false;
+    DNSMessage response;   // Positiva: resposta completa
+    uint8_t rcode = 0;     // Negativa: 3 (NXDOMAIN) ou 0 (NODATA)
+    uint32_t ttl = 0;      // Negativa: TTL do SOA
+};
+
 // Cliente IPC para comunicação com cache daemon
 // Responsável por consultar o daemon de cache antes da resolução
 // Implementa fallback elegante se cache estiver offline
+// Usa uma conexão persistente por thread (compartilhada entre instâncias)
+// com frames binários casados por request_id (CacheProtocol)
+// Se o daemon publica o cache em memória compartilhada, HITs são lidos
+// direto do segmento (SharedCache) sem passar pelo socket
 class CacheClient {
 public:
-    explicit CacheClient(const std::string& socket_path = "/tmp/dns_cache.sock");
+    // shm_name: segmento publicado pelo daemon (--shm-slots); vazio (padrão)
+    // desativa, como no daemon
+    explicit CacheClient(
+        const std::string& socket_path = "/tmp/dns_cache.sock",
+        const std::string& shm_name = ""
+    );
     
     // Consulta o cache para um domínio
     std::unique_ptr<DNSMessage> query(
@@ -30,6 +53,24 @@ public:
         uint16_t qclass = DNSClass::IN
     );
     
+    // Consulta aceitando entrada expirada dentro da janela stale do daemon
+    // (RFC 8767); usada quando a resolução falha ou estoura o orçamento
+    // de latência. Respostas stale vêm com TTL 30 e o daemon as renova
+    std::unique_ptr<DNSMessage> queryStale(
+        const std::string& qname,
+        uint16_t qtype,
+        uint16_t qclass = DNSClass::IN
+    );
+    
+    // Consulta várias chaves num único round trip (MQUERY)
+    // Resultado na ordem de questions; nullptr para MISS ou daemon offline
+    std::vector<std::unique_ptr<DNSMessage>> queryMany(
+        const std::vector<DNSQuestion>& questions
+    );
+    
+    // Armazena várias respostas (positivas e negativas) num único round trip (MSTORE)
+    bool storeMany(const std::vector<CacheStoreItem>& items);
+    
     // Armazena resposta no cache
     bool store(
         const DNSMessage& response,
@@ -50,29 +91,58 @@ public:
     
     // Habilita/desabilita trace logs
     void setTraceEnabled(bool enabled);
+    
+    // Serializa resposta em wire format para o cache (sem OPT)
+    static std::string serializeForCache(const DNSMessage& msg);
+    
+    // TTL de armazenamento: menor TTL dos answers (300s se não houver)
+    static uint32_t cacheTTL(const DNSMessage& msg);
 
 private:
     std::string socket_path_;
+    std::string shm_name_;
     mutable bool daemon_available_ = true;  // Assume disponível até falha
     bool trace_enabled_ = false;
     
-    // Conecta ao daemon via Unix socket
-    bool connectToCache(int& sockfd, int timeout_ms = 1000);
+    // QUERY / QUERY_STALE: envia a consulta e interpreta HIT, NEGATIVE ou MISS
+    std::unique_ptr<DNSMessage> lookup(
+        CacheOpcode opcode,
+        const std::string& qname,
+        uint16_t qtype,
+        uint16_t qclass
+    );
+    
+    // Consulta o espelho em memória compartilhada (nullptr se ausente,
+    // expirado ou nos últimos SHARED_BYPASS_PERCENT% do TTL)
+    std::unique_ptr<DNSMessage> lookupShared(
+        const std::string& qname,
+        uint16_t qtype,
+        uint16_t qclass
+    );
+    
+    // Parte final do TTL servida pelo daemon (contagem de HITs / prefetch)
+    static constexpr uint32_t SHARED_BYPASS_PERCENT = 10;
     
-    // Envia comando ao daemon
-    bool sendCommand(int sockfd, const std::string& command);
+    // Itens por frame MQUERY / MSTORE (os frames de um lote seguem em pipeline)
+    static constexpr size_t MAX_BATCH_ITEMS = 256;
+    static constexpr size_t MAX_BATCH_BYTES = 1024 * 1024;
     
-    // Recebe resposta do daemon
-    std::string receiveResponse(int sockfd);
+    // Conecta ao daemon via Unix socket
+    bool connectToCache(int& sockfd, int timeout_ms = 1000) const;
+    
+    // Envia frames em pipeline pela conexão da thread e coleta as
+    // respostas na mesma ordem (casadas por request_id)
+    bool transact(
+        std::vector<std::string>& frames,
+        std::vector<CacheReply>& replies
+    );
     
-    // Parseia resposta HIT do daemon
-    std::unique_ptr<DNSMessage> parseHitResponse(const std::string& response);
+    // Envia um único frame e retorna sua resposta
+    bool transact(std::string frame, CacheReply& reply);
     
-    // Serializa DNSMessage para formato IPC
-    std::string serializeForCache(const DNSMessage& msg) const;
+    // Parseia resposta HIT do daemon (wire format) com DNSParser
+    std::unique_ptr<DNSMessage> parseHitResponse(std::string_view wire);
     
-    // Deserializa DNSMessage do formato IPC
-    DNSMessage deserializeFromCache(const std::string& data) const;
     
     // Log de trace (se enabled)
     void traceLog(const std::string& message) const;
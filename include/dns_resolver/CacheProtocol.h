@@ -0,0 +1,137 @@
+/*
+ * ----------------------------------------
+ * Arquivo: CacheProtocol.h
+ * Propósito: Protocolo binário versionado do IPC entre CacheClient e cache daemon
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+namespace dns_resolver {
+
+// Opcodes do protocolo (requisições < 0x80 <= respostas)
+enum class CacheOpcode : uint8_t {
+    // Requisições de dados
+    QUERY = 0x01,            // str qname, u16 qtype, u16 qclass
+    STORE = 0x02,            // str qname, u16 qtype, u16 qclass, u32 ttl, blob data
+    STORE_NEGATIVE = 0x03,   // str qname, u16 qtype, u16 qclass, u32 ttl, u8 rcode
+    QUERY_STALE = 0x04,      // str qname, u16 qtype, u16 qclass (aceita entrada expirada)
+    MQUERY = 0x05,           // u32 n, n × (str qname, u16 qtype, u16 qclass)
+    MSTORE = 0x06,           // u32 n, n × (u8 STORE|STORE_NEGATIVE, campos do opcode)
+
+    // Requisições administrativas
+    FLUSH = 0x10,            // (vazio)
+    SET_POSITIVE = 0x11,     // u32 entradas
+    SET_NEGATIVE = 0x12,     // u32 entradas
+    PURGE = 0x13,            // u8 CacheTarget
+    LIST = 0x14,             // u8 CacheTarget
+    STATUS = 0x15,           // (vazio)
+    SET_MEMORY = 0x16,       // u64 bytes
+
+    // Respostas
+    OK = 0x80,               // blob mensagem
+    HIT = 0x81,              // blob data
+    NEGATIVE = 0x82,         // u8 rcode
+    MISS = 0x83,             // (vazio)
+    MRESULT = 0x84,          // u32 n, n × (u8 HIT|NEGATIVE|MISS, campos do opcode)
+    ERROR = 0xFF             // blob mensagem
+};
+
+// Alvo de PURGE / LIST
+enum class CacheTarget : uint8_t {
+    POSITIVE = 0,
+    NEGATIVE = 1,
+    ALL = 2
+};
+
+// Cabeçalho fixo de 12 bytes (big-endian):
+// [u16 magic][u8 versão][u8 opcode][u32 request_id][u32 tamanho do payload]
+// Várias requisições podem estar em andamento na mesma conexão; as
+// respostas carregam o request_id da requisição correspondente.
+struct CacheFrameHeader {
+    uint8_t version = 0;
+    CacheOpcode opcode = CacheOpcode::ERROR;
+    uint32_t request_id = 0;
+    uint32_t length = 0;
+};
+
+// Resposta recebida pelo cliente (opcode + payload)
+struct CacheReply {
+    CacheOpcode opcode = CacheOpcode::ERROR;
+    std::string payload;
+};
+
+class CacheProtocol {
+public:
+    static constexpr uint16_t MAGIC = 0xDCAC;
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr uint32_t MAX_PAYLOAD_SIZE = 16 * 1024 * 1024;
+
+    // Extrai o próximo frame completo a partir de offset
+    // payload aponta para dentro de buffer (sem cópia)
+    // Retorna false se o frame ainda está incompleto; avança offset se extraído
+    // Lança std::runtime_error se magic, versão ou tamanho forem inválidos
+    static bool extractFrame(
+        std::string_view buffer,
+        size_t& offset,
+        CacheFrameHeader& header,
+        std::string_view& payload
+    );
+
+    // Grava request_id num frame já montado
+    static void setRequestId(std::string& frame, uint32_t request_id);
+};
+
+// Monta um frame: cabeçalho + campos de tamanho prefixado
+// Strings curtas (nomes) usam prefixo u16; blobs usam prefixo u32
+class CacheMessageWriter {
+public:
+    explicit CacheMessageWriter(CacheOpcode opcode, uint32_t request_id = 0);
+
+    CacheMessageWriter& putU8(uint8_t value);
+    CacheMessageWriter& putU16(uint16_t value);
+    CacheMessageWriter& putU32(uint32_t value);
+    CacheMessageWriter& putU64(uint64_t value);
+    CacheMessageWriter& putString(std::string_view value);
+    CacheMessageWriter& putBlob(std::string_view value);
+
+    // Finaliza o cabeçalho (tamanho) e devolve o frame
+    std::string finish();
+
+private:
+    std::string frame_;
+};
+
+// Lê campos de um payload sem copiar (views sobre o buffer original)
+// Lança std::runtime_error se o payload estiver truncado
+class CacheMessageReader {
+public:
+    explicit CacheMessageReader(std::string_view payload);
+
+    uint8_t getU8();
+    uint16_t getU16();
+    uint32_t getU32();
+    uint64_t getU64();
+    std::string_view getString();
+    std::string_view getBlob();
+
+    bool atEnd() const { return pos_ == payload_.size(); }
+
+private:
+    void require(size_t bytes) const;
+
+    std::string_view payload_;
+    size_t pos_ = 0;
+};
+
+} // namespace dns_resolver
@@ -26,10 +26,21 @@ public:
     
     // Parse de uma mensagem DNS do formato binário
     static DNSMessage parse(const std::vector<uint8_t>& buffer);
+    
+    // Codifica o RDATA de um registro em wire format, sem compressão de nomes
+    // Tipos com nomes (NS, CNAME, PTR, MX, SOA, RRSIG) são recodificados a
+    // partir dos campos parsed; registros montados sem RDATA bruto (A, AAAA,
+    // TXT, DNSKEY, DS) são codificados dos campos; os demais usam rdata
+    static std::vector<uint8_t> encodeRData(const DNSResourceRecord& rr);
 
 private:
     // Funções de serialização
     static std::vector<uint8_t> encodeDomainName(const std::string& domain);
+    static std::vector<uint8_t> encodeName(const std::string& name);
+    static void serializeResourceRecord(
+        const DNSResourceRecord& rr,
+        std::vector<uint8_t>& buffer
+    );
     static uint16_t encodeFlags(const DNSHeader& header);
     
     // Funções de parsing
@@ -12,21 +12,26 @@
 
 #include "dns_resolver/types.h"
 #include "dns_resolver/TrustAnchorStore.h"
+#include "dns_resolver/ValidatedKeyCache.h"
 #include <string>
 #include <vector>
 #include <map>
 
 namespace dns_resolver {
 
+class ThreadPool;
+
 // Validador de Cadeia de Confiança DNSSEC
 // Responsável por validar que DNSKEYs correspondem aos DS records
 // da zona pai, estabelecendo uma cadeia de confiança desde o
 // Trust Anchor até a zona alvo
 class DNSSECValidator {
 public:
+    // key_cache: elos DS → DNSKEY já validados (opcional; não é possuído)
     explicit DNSSECValidator(
         const TrustAnchorStore& trust_anchors,
-        bool trace_enabled = false
+        bool trace_enabled = false,
+        ValidatedKeyCache* key_cache = nullptr
     );
     
     // Validar que DNSKEY corresponde a DS
@@ -44,10 +49,16 @@ public:
     );
     
     // Validar cadeia completa de confiança
+    // dnskey_rrsigs: RRSIGs do RRset DNSKEY de cada zona; o conjunto só é
+    // confiável se assinado por uma chave que confere com o DS do pai
+    // authenticated_keys (opcional): recebe os conjuntos DNSKEY autenticados
+    // da cadeia, as únicas chaves a passar para validateRRsets
     ValidationResult validateChain(
         const std::string& target_zone,
         const std::map<std::string, std::vector<DNSKEYRecord>>& dnskeys,
-        const std::map<std::string, std::vector<DSRecord>>& ds_records
+        const std::map<std::string, std::vector<DSRecord>>& ds_records,
+        const std::map<std::string, std::vector<RRSIGRecord>>& dnskey_rrsigs,
+        std::map<std::string, std::vector<DNSKEYRecord>>* authenticated_keys = nullptr
     );
     
     // Obter zona pai de uma zona
@@ -71,9 +82,37 @@ public:
         const std::string& zone
     );
     
+    // Verificar as assinaturas dos RRsets de uma resposta (RFC 4035 §5.3)
+    // Agrupa answers e authority em RRsets e confere cada RRSIG com as
+    // chaves de zone_keys (conjuntos autenticados por validateChain), usando
+    // só zonas da cadeia de target_zone (a própria e as ancestrais). Cada
+    // RRset da answer precisa de uma assinatura válida; na authority, RRsets
+    // sem RRSIG (NS de delegação, glue) são ignorados.
+    // pool: verificações independentes em paralelo (nullptr = sequencial)
+    // Secure: tudo verificado; Bogus: algum RRset com chaves e sem
+    // assinatura válida, ou RRset da answer na zona mais profunda da cadeia
+    // sem RRSIG utilizável; Indeterminate: RRset da answer fora dessa zona
+    // (ex: alvo de CNAME em outra zona) sem RRSIG ou sem chave conhecida
+    ValidationResult validateRRsets(
+        const DNSMessage& response,
+        const std::string& target_zone,
+        const std::map<std::string, std::vector<DNSKEYRecord>>& zone_keys,
+        ThreadPool* pool = nullptr
+    );
+    
 private:
     const TrustAnchorStore& trust_anchors_;
     bool trace_enabled_;
+    ValidatedKeyCache* key_cache_;
+    
+    // Algum DNSKEY da zona confere com algum DS e assina o RRset DNSKEY
+    // (RFC 4035 §5.2)? (consulta/alimenta key_cache_)
+    bool validateZoneKeys(
+        const std::string& zone,
+        const std::vector<DNSKEYRecord>& dnskeys,
+        const std::vector<DSRecord>& ds_records,
+        const std::vector<RRSIGRecord>& rrsigs
+    );
     
     // Encode domain name no formato wire
     std::vector<uint8_t> encodeDomainName(const std::string& domain) const;
@@ -84,7 +123,9 @@ private:
         const std::string& zone
     );
     
-    // Canonicaliza RRset conforme RFC 4034 §6.2
+    // Canonicaliza RRset conforme RFC 4034 §6.2 e §6.3: owner e nomes do
+    // RDATA em minúsculas, sem compressão, RRs ordenados e sem duplicatas;
+    // owner curinga ("*.zona") se o RRSIG tiver menos labels que o nome
     std::vector<uint8_t> canonicalizeRRset(
         const std::vector<DNSResourceRecord>& rrset,
         const RRSIGRecord& rrsig
@@ -97,8 +138,10 @@ private:
     );
     
     // Verifica assinatura RSA/SHA-256 (algorithm 8)
+    // key_tag indexa a chave convertida no PKeyCache do processo
     bool verifyRSASignature(
         const std::vector<uint8_t>& public_key,
+        uint16_t key_tag,
         const std::vector<uint8_t>& data,
         const std::vector<uint8_t>& signature
     );
@@ -106,6 +149,7 @@ private:
     // Verifica assinatura ECDSA P-256/SHA-256 (algorithm 13)
     bool verifyECDSASignature(
         const std::vector<uint8_t>& public_key,
+        uint16_t key_tag,
         const std::vector<uint8_t>& data,
         const std::vector<uint8_t>& signature
     );
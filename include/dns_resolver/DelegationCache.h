@@ -0,0 +1,109 @@
+/*
+ * ----------------------------------------
+ * Arquivo: DelegationCache.h
+ * Propósito: Cache de infraestrutura (zone cuts, conjuntos NS e endereços de glue)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dns_resolver {
+
+// Delegação conhecida para um zone cut
+struct Delegation {
+    std::string zone;                               // Zone cut normalizado (ex: "com")
+    std::vector<std::string> nameservers;           // Conjunto NS da delegação
+    std::map<std::string, std::string> addresses;   // NS → IP (glue ou resolvido)
+    time_t expires_at = 0;
+};
+
+// Cache de delegações compartilhado pelo processo (thread-safe)
+// As referências (NS + glue) aprendidas em performIterativeLookup ficam
+// guardadas por zone cut com o TTL do conjunto NS; a resolução seguinte
+// começa no zone cut mais profundo conhecido em vez de um root server.
+// Endereços de nameservers (glue ou resolvidos sem glue) ficam também num
+// mapa por nome do NS, reaproveitado por todas as zonas que os usam.
+class DelegationCache {
+public:
+    static constexpr size_t DEFAULT_MAX_ZONES = 10000;
+    static constexpr uint32_t MAX_TTL = 86400;   // Teto para TTLs de NS e glue
+
+    explicit DelegationCache(size_t max_zones = DEFAULT_MAX_ZONES);
+
+    // Instância única do processo (resolvers em lote e prefetch a compartilham)
+    static DelegationCache& instance();
+
+    // Armazena a delegação de zone recebida de um servidor de server_zone
+    // (substitui a anterior)
+    // Proteção contra envenenamento: só aceita zone estritamente abaixo de
+    // server_zone, e só o glue de NS dentro de zone (glue fora da zona
+    // delegada é descartado e não substitui endereços já conhecidos)
+    // glue: endereços vindos na seção ADDITIONAL, só dos NS do conjunto
+    void store(
+        const std::string& server_zone,
+        const std::string& zone,
+        const std::vector<std::string>& nameservers,
+        const std::map<std::string, std::string>& glue,
+        uint32_t ttl,
+        time_t now = std::time(nullptr)
+    );
+
+    // Armazena o endereço resolvido de um nameserver
+    void storeAddress(
+        const std::string& ns_name,
+        const std::string& address,
+        uint32_t ttl,
+        time_t now = std::time(nullptr)
+    );
+
+    // Zone cut mais profundo, ancestral de qname (ou o próprio), ainda válido
+    // out.addresses inclui endereços resolvidos dos NS sem glue
+    bool findDeepest(
+        const std::string& qname,
+        Delegation& out,
+        time_t now = std::time(nullptr)
+    ) const;
+
+    // Endereço conhecido de um nameserver, de glue ou resolvido
+    // (vazio se ausente ou expirado)
+    std::string findAddress(
+        const std::string& ns_name,
+        time_t now = std::time(nullptr)
+    ) const;
+
+    // Remove a delegação de zone (ex: servidores do cache não responderam)
+    void invalidate(const std::string& zone);
+
+    void clear();
+    size_t size() const;
+
+private:
+    struct Address {
+        std::string ip;
+        time_t expires_at = 0;
+    };
+
+    // Com o limite atingido: descarta expiradas e, se preciso, a que vence antes
+    // (chamado com mutex_)
+    template <typename Map>
+    void makeRoom(Map& map, time_t now);
+
+    size_t max_zones_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Delegation> zones_;
+    std::unordered_map<std::string, Address> addresses_;
+};
+
+} // namespace dns_resolver
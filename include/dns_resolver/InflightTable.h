@@ -0,0 +1,69 @@
+/*
+ * ----------------------------------------
+ * Arquivo: InflightTable.h
+ * Propósito: Coalescência de resoluções idênticas em andamento (single-flight)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include "dns_resolver/types.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dns_resolver {
+
+// Tabela de resoluções em andamento compartilhada pelo processo (thread-safe)
+// A primeira chamada para uma key executa a resolução (líder); chamadas
+// concorrentes com a mesma key esperam e recebem o mesmo resultado ou a
+// mesma exceção, sem repetir a caminhada iterativa.
+// Uma thread que já lidera outra resolução (ex: NS sem glue dentro de uma
+// resolução) espera no máximo NESTED_WAIT_MS e então resolve sozinha:
+// dependências circulares entre threads não viram deadlock.
+class InflightTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int NESTED_WAIT_MS = 3000;
+
+    // Instância única do processo
+    static InflightTable& instance();
+
+    // Executa resolve() ou, se a mesma key já está em curso, espera o
+    // resultado dela. Retorna true se esta chamada executou resolve()
+    // (quem deve armazenar o resultado no cache)
+    // deadline: espera no máximo até ali (lança "Latency budget exceeded")
+    // e nunca lidera - o orçamento de um chamador não pode falhar os demais
+    bool run(
+        const std::string& key,
+        const std::function<DNSMessage()>& resolve,
+        DNSMessage& out,
+        const Clock::time_point* deadline = nullptr
+    );
+
+    // Chave de uma pergunta: nome normalizado + tipo + variante do resolver
+    // (resultados com e sem DNSSEC, ou por transporte, não se misturam)
+    static std::string makeKey(const std::string& qname, uint16_t qtype, const std::string& variant);
+
+    // Resoluções em curso
+    size_t size() const;
+
+    // Chamadas atendidas pelo resultado de outra
+    uint64_t coalesced() const { return coalesced_.load(); }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_future<DNSMessage>> inflight_;
+    std::atomic<uint64_t> coalesced_{0};
+};
+
+} // namespace dns_resolver
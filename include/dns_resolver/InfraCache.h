@@ -0,0 +1,97 @@
+/*
+ * ----------------------------------------
+ * Arquivo: InfraCache.h
+ * Propósito: Tabela de infraestrutura: RTT suavizado e timeouts por servidor
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dns_resolver {
+
+// Estatísticas de um servidor (por IP)
+struct ServerStats {
+    uint32_t srtt_ms = 0;        // RTT suavizado (média móvel, peso 1/8)
+    uint32_t rttvar_ms = 0;      // Variação do RTT (média móvel, peso 1/4)
+    uint32_t samples = 0;        // Respostas medidas
+    uint32_t timeouts = 0;       // Falhas consecutivas (zera na próxima resposta)
+    time_t updated_at = 0;
+};
+
+// Tabela de RTT por servidor compartilhada pelo processo (thread-safe)
+// Alimentada por cada queryServer: respostas atualizam o SRTT, falhas
+// dobram a estimativa (backoff). A seleção prefere o menor RTT efetivo e,
+// em EXPLORE_PERCENT% das escolhas, sorteia um candidato para reavaliar
+// servidores que ficaram para trás. Servidores desconhecidos entram com
+// UNKNOWN_RTT_MS (são experimentados antes dos comprovadamente lentos) e
+// estatísticas com mais de STATS_TTL segundos voltam a ser desconhecidas.
+class InfraCache {
+public:
+    static constexpr uint32_t UNKNOWN_RTT_MS = 100;
+    static constexpr uint32_t TIMEOUT_RTT_MS = 1000;    // Piso da estimativa após falha
+    static constexpr uint32_t MAX_RTT_MS = 120000;
+    static constexpr uint32_t EXPLORE_PERCENT = 5;
+    static constexpr uint32_t UNKNOWN_RTO_MS = 400;     // Espera por servidor nunca medido
+    static constexpr uint32_t MIN_RTO_MS = 50;
+    static constexpr uint32_t MAX_RTO_MS = 3000;
+    static constexpr time_t STATS_TTL = 900;
+    static constexpr size_t DEFAULT_MAX_SERVERS = 10000;
+
+    explicit InfraCache(size_t max_servers = DEFAULT_MAX_SERVERS);
+
+    // Instância única do processo
+    static InfraCache& instance();
+
+    // Resposta recebida de server em rtt_ms
+    void recordRtt(const std::string& server, uint32_t rtt_ms, time_t now = std::time(nullptr));
+
+    // Timeout ou erro de rede ao consultar server
+    void recordTimeout(const std::string& server, time_t now = std::time(nullptr));
+
+    // RTT efetivo usado na seleção (UNKNOWN_RTT_MS se sem dados recentes)
+    uint32_t effectiveRtt(const std::string& server, time_t now = std::time(nullptr)) const;
+
+    // Quanto esperar a resposta de server antes de tentar outro servidor
+    // SRTT + 4 × RTTVAR (RFC 6298), entre MIN_RTO_MS e MAX_RTO_MS
+    uint32_t retryTimeoutMs(const std::string& server, time_t now = std::time(nullptr)) const;
+    
+    // Índice do servidor escolhido em servers
+    // Lança std::invalid_argument se servers estiver vazio
+    size_t select(const std::vector<std::string>& servers, time_t now = std::time(nullptr));
+
+    // Estatísticas de server (false se nunca consultado)
+    bool stats(const std::string& server, ServerStats& out) const;
+
+    // Liga/desliga a exploração aleatória (testes determinísticos)
+    void setExplorePercent(uint32_t percent);
+
+    void clear();
+    size_t size() const;
+
+private:
+    // Sem o lock
+    uint32_t effectiveRttLocked(const std::string& server, time_t now) const;
+
+    // Abre espaço para um servidor novo (chamado com mutex_)
+    void makeRoom(time_t now);
+
+    size_t max_servers_;
+    uint32_t explore_percent_ = EXPLORE_PERCENT;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, ServerStats> servers_;
+    std::mt19937 rng_;   // Semeado uma vez (não a cada escolha)
+};
+
+} // namespace dns_resolver
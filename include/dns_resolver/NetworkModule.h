@@ -28,6 +28,27 @@ public:
         int timeout_seconds = 5
     );
     
+    // Resultado de queryUDPStaggered
+    struct StaggeredResult {
+        bool answered = false;
+        size_t server_index = 0;         // Servidor que respondeu
+        size_t sent = 0;                 // Servidores que chegaram a receber a query
+        uint32_t rtt_ms = 0;             // Desde o envio para quem respondeu
+        std::vector<uint8_t> response;
+    };
+    
+    // Envia a mesma query via UDP a servers, um de cada vez: servers[i+1]
+    // recebe a query se nenhuma resposta chegou retry_after_ms[i] depois do
+    // envio a servers[i]. Fica a primeira resposta válida (ID igual ao da
+    // query), de qualquer servidor já consultado, dentro de timeout_ms.
+    // Sem resposta no prazo: answered = false (não lança)
+    static StaggeredResult queryUDPStaggered(
+        const std::vector<std::string>& servers,
+        const std::vector<uint8_t>& query,
+        const std::vector<int>& retry_after_ms,
+        int timeout_ms
+    );
+    
     // Envia uma query DNS via TCP (para respostas >512 bytes)
     static std::vector<uint8_t> queryTCP(
         const std::string& server,
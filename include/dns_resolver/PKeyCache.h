@@ -0,0 +1,96 @@
+/*
+ * ----------------------------------------
+ * Arquivo: PKeyCache.h
+ * Propósito: Cache de chaves públicas DNSKEY já convertidas para EVP_PKEY (OpenSSL)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Declaração antecipada (evita incluir OpenSSL nos headers públicos)
+typedef struct evp_pkey_st EVP_PKEY;
+
+namespace dns_resolver {
+
+// Chaves DNSKEY já convertidas, compartilhadas pelo processo (thread-safe)
+// Converter uma DNSKEY em EVP_PKEY (BIGNUMs, EC_KEY/RSA) custa mais que a
+// própria verificação; as chaves da raiz e dos TLDs assinam quase todas as
+// respostas. Indexado por (algoritmo, key tag, bytes da chave pública): a
+// key tag não é única, então a chave inteira é comparada.
+// Handles são std::shared_ptr: uma chave descartada pelo LRU continua
+// válida para quem ainda a está usando.
+class PKeyCache {
+public:
+    using Handle = std::shared_ptr<EVP_PKEY>;
+
+    static constexpr size_t DEFAULT_MAX_KEYS = 1024;
+
+    explicit PKeyCache(size_t max_keys = DEFAULT_MAX_KEYS);
+
+    // Instância única do processo
+    static PKeyCache& instance();
+
+    // Chave já convertida (nullptr se ausente); renova a posição no LRU
+    Handle find(uint8_t algorithm, uint16_t key_tag, const std::vector<uint8_t>& public_key);
+
+    // Guarda pkey (assume a posse; nullptr é ignorado) e devolve o handle
+    // Se outra thread guardou a mesma chave antes, pkey é liberada e o
+    // handle existente é devolvido
+    Handle insert(
+        uint8_t algorithm,
+        uint16_t key_tag,
+        const std::vector<uint8_t>& public_key,
+        EVP_PKEY* pkey
+    );
+
+    void clear();
+    size_t size() const;
+
+    // Verificações que reaproveitaram / precisaram converter a chave
+    uint64_t hits() const { return hits_.load(); }
+    uint64_t misses() const { return misses_.load(); }
+
+private:
+    struct Key {
+        uint8_t algorithm = 0;
+        uint16_t key_tag = 0;
+        std::vector<uint8_t> public_key;
+
+        bool operator==(const Key& other) const {
+            return algorithm == other.algorithm && key_tag == other.key_tag &&
+                   public_key == other.public_key;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        Handle pkey;
+    };
+
+    using LruList = std::list<Entry>;
+
+    size_t max_keys_;
+    mutable std::mutex mutex_;
+    LruList lru_;    // Mais recente na frente
+    std::unordered_map<Key, LruList::iterator, KeyHash> index_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace dns_resolver
@@ -0,0 +1,149 @@
+/*
+ * ----------------------------------------
+ * Arquivo: ResolverContext.h
+ * Propósito: Estado de resolução compartilhado entre ResolverEngines (trust anchors, DNSKEY/DS)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include "dns_resolver/types.h"
+#include "dns_resolver/TrustAnchorStore.h"
+#include "dns_resolver/ThreadPool.h"
+#include "dns_resolver/ValidatedKeyCache.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dns_resolver {
+
+// Contexto compartilhado por vários ResolverEngine (thread-safe)
+// Carrega os trust anchors uma vez e guarda os conjuntos DNSKEY/DS já
+// consultados por zona, com o TTL dos registros: num lote com DNSSEC, o
+// DNSKEY de "com" é buscado uma vez, não uma por domínio.
+// Delegações e RTTs já são do processo (DelegationCache, InfraCache); o
+// contexto cobre o que antes morria com cada engine.
+// Cada engine continua leve e de uso por uma thread por vez: o contexto é
+// passado por std::shared_ptr e pode ser usado por muitas threads.
+// As consultas DNSKEY/DS rodam num pool do contexto, em paralelo com a
+// caminhada de referências de cada engine; os elos DS → DNSKEY já
+// validados ficam no ValidatedKeyCache do contexto e as assinaturas da
+// resposta são verificadas em outro pool.
+class ResolverContext {
+public:
+    static constexpr size_t DEFAULT_MAX_ZONES = 10000;
+    static constexpr uint32_t MAX_TTL = 86400;       // Teto para TTLs de DNSKEY/DS
+    static constexpr uint32_t NEGATIVE_TTL = 300;    // Zona sem DS/DNSKEY (não assinada)
+    static constexpr size_t FETCH_THREADS = 8;       // Consultas DNSKEY/DS simultâneas
+    static constexpr size_t VERIFY_THREADS = 4;      // Verificações RRSIG simultâneas
+
+    // Carrega trust_anchor_file (vazio = KSK root padrão)
+    explicit ResolverContext(
+        const std::string& trust_anchor_file = "",
+        bool quiet = true,
+        size_t max_zones = DEFAULT_MAX_ZONES
+    );
+
+    // Não permite cópia (engines guardam ponteiros para o contexto)
+    ResolverContext(const ResolverContext&) = delete;
+    ResolverContext& operator=(const ResolverContext&) = delete;
+
+    const TrustAnchorStore& trustAnchors() const { return trust_anchors_; }
+    const std::string& trustAnchorFile() const { return trust_anchor_file_; }
+
+    // Conjunto DNSKEY da zona e os RRSIGs que o cobrem, se consultado e
+    // ainda válido (um conjunto vazio válido indica zona sem DNSKEY)
+    bool findDNSKEY(
+        const std::string& zone,
+        std::vector<DNSKEYRecord>& out,
+        std::vector<RRSIGRecord>& rrsigs,
+        time_t now = std::time(nullptr)
+    ) const;
+
+    // Conjunto DS da zona (vindo do pai), se consultado e ainda válido
+    bool findDS(
+        const std::string& zone,
+        std::vector<DSRecord>& out,
+        time_t now = std::time(nullptr)
+    ) const;
+
+    // ttl: menor TTL do RRset (ignorado se vazio: NEGATIVE_TTL)
+    // ResolverEngine só guarda conjuntos autenticados pela cadeia (nunca
+    // vazios: NODATA sem negação verificada não prova zona não assinada)
+    // rrsigs: assinaturas do RRset DNSKEY (verificadas na validação da cadeia)
+    void storeDNSKEY(
+        const std::string& zone,
+        const std::vector<DNSKEYRecord>& keys,
+        const std::vector<RRSIGRecord>& rrsigs,
+        uint32_t ttl,
+        time_t now = std::time(nullptr)
+    );
+
+    void storeDS(
+        const std::string& zone,
+        const std::vector<DSRecord>& records,
+        uint32_t ttl,
+        time_t now = std::time(nullptr)
+    );
+
+    // Elos da cadeia já validados (passado ao DNSSECValidator)
+    ValidatedKeyCache& validatedKeys() { return validated_keys_; }
+
+    // Pool das consultas DNSKEY/DS (criado no primeiro uso)
+    ThreadPool& fetchPool();
+    
+    // Pool das verificações RRSIG (criado no primeiro uso; só CPU, separado
+    // das consultas para não esperar atrás de timeouts de rede)
+    ThreadPool& verifyPool();
+
+    // Esvazia DNSKEY/DS e elos validados
+    void clear();
+
+    // Conjuntos guardados (DNSKEY + DS)
+    size_t size() const;
+
+private:
+    template <typename Record>
+    struct Entry {
+        std::vector<Record> records;
+        std::vector<RRSIGRecord> rrsigs;    // Só DNSKEY
+        time_t expires_at = 0;
+    };
+
+    template <typename Record>
+    using ZoneMap = std::unordered_map<std::string, Entry<Record>>;
+
+    template <typename Record>
+    bool find(const ZoneMap<Record>& map, const std::string& zone,
+              std::vector<Record>& out, std::vector<RRSIGRecord>* rrsigs, time_t now) const;
+
+    template <typename Record>
+    void store(ZoneMap<Record>& map, const std::string& zone,
+               const std::vector<Record>& records, const std::vector<RRSIGRecord>& rrsigs,
+               uint32_t ttl, time_t now);
+
+    std::string trust_anchor_file_;
+    TrustAnchorStore trust_anchors_;
+    size_t max_zones_;
+
+    mutable std::mutex mutex_;
+    ZoneMap<DNSKEYRecord> dnskeys_;
+    ZoneMap<DSRecord> ds_;
+    ValidatedKeyCache validated_keys_;
+
+    // Últimos membros: são destruídos (e esperam suas tarefas) antes dos mapas
+    std::once_flag verify_pool_once_;
+    std::unique_ptr<ThreadPool> verify_pool_;
+    std::once_flag fetch_pool_once_;
+    std::unique_ptr<ThreadPool> fetch_pool_;
+};
+
+} // namespace dns_resolver
@@ -16,10 +16,17 @@
 #include "dns_resolver/TrustAnchorStore.h"
 #include "dns_resolver/DNSSECValidator.h"
 #include "dns_resolver/CacheClient.h"
+#include "dns_resolver/DelegationCache.h"
+#include "dns_resolver/InfraCache.h"
+#include "dns_resolver/InflightTable.h"
+#include "dns_resolver/ResolverContext.h"
 #include <string>
 #include <vector>
 #include <map>
 #include <set>
+#include <chrono>
+#include <future>
+#include <memory>
 
 namespace dns_resolver {
 
@@ -43,6 +50,14 @@ struct ResolverConfig {
     bool dnssec_enabled = false;            // Ativar validação DNSSEC
     bool quiet_mode = false;                // Modo quiet
     bool fanout_enabled = false;            // Fan-out paralelo
+    bool use_cache = true;                  // Consultar/armazenar no cache daemon
+    bool serve_stale = true;                // Responder com entrada expirada se a resolução falhar (RFC 8767)
+    int stale_budget_ms = 1800;             // Orçamento de latência com resposta stale disponível (0 = sem limite)
+    bool use_delegation_cache = true;       // Começar no zone cut mais profundo conhecido (DelegationCache)
+    bool use_infra_cache = true;            // Escolher servidores pelo RTT suavizado (InfraCache)
+    int retry_servers = 3;                  // Servidores do conjunto NS tentados por passo (1 = sem retry)
+    bool coalesce_inflight = true;          // Esperar resolução idêntica já em curso (InflightTable)
+    std::string cache_shm_name;             // Segmento do daemon (--shm-slots) lido direto; vazio = só socket
     
     ResolverConfig() {
         // Root servers padrão
@@ -61,11 +76,33 @@ struct ResolverConfig {
 // root servers até servidores autoritativos
 class ResolverEngine {
 public:
+    // Cria um contexto próprio (carrega os trust anchors)
     explicit ResolverEngine(const ResolverConfig& config);
     
+    // Usa um contexto compartilhado (lotes, daemon): construção barata e
+    // DNSKEY/DS reaproveitados entre engines. Lança std::invalid_argument se
+    // o contexto for nulo ou de outro arquivo de trust anchor
+    ResolverEngine(const ResolverConfig& config, std::shared_ptr<ResolverContext> context);
+    
+    // Espera consultas DNSKEY/DS ainda em curso
+    ~ResolverEngine();
+    
+    // Não permite cópia (consultas em background referenciam o engine)
+    ResolverEngine(const ResolverEngine&) = delete;
+    ResolverEngine& operator=(const ResolverEngine&) = delete;
+    
     // Resolve um domínio começando dos root servers
     DNSMessage resolve(const std::string& domain, uint16_t qtype);
     
+    // Monta o item de cache para um resultado de resolve(): resposta
+    // positiva, NXDOMAIN ou NODATA (TTL do SOA). false se não cacheável
+    bool makeCacheItem(
+        const std::string& domain,
+        uint16_t qtype,
+        const DNSMessage& result,
+        CacheStoreItem& item
+    ) const;
+    
     // Métodos para respostas negativas
     bool isNXDOMAIN(const DNSMessage& response) const;
     bool isNODATA(const DNSMessage& response, uint16_t qtype) const;
@@ -75,14 +112,59 @@ public:
     bool isTruncated(const DNSMessage& response) const;
     
 private:
+    // O motor assíncrono reutiliza os helpers const (parsing, seleção, delegações)
+    friend class AsyncResolver;
+    
+    // Resolução completa sem cache: root → zone cut → resposta (+ validação DNSSEC)
+    DNSMessage resolveUncached(const std::string& domain, uint16_t qtype);
+    
+    // Variante da key na InflightTable (DNSSEC, transporte)
+    std::string inflightVariant() const;
+    
     // Algoritmo de resolução iterativa (coração do resolver)
+    // server_pool: conjunto de servidores equivalentes a initial_server, usados
+    // como alternativas se ele não responder (vazio e initial_server root =
+    // os root servers)
+    // server_zone: zona servida por initial_server (raiz ou zone cut em cache)
     DNSMessage performIterativeLookup(
         const std::string& domain,
         uint16_t qtype,
         const std::string& initial_server,
-        int depth = 0
+        int depth = 0,
+        const std::vector<std::string>& server_pool = {},
+        const std::string& server_zone = "."
     );
     
+    // Resolução iterativa a partir do zone cut mais profundo em cache; se os
+    // servidores do cache falharem, descarta a delegação e recomeça na raiz
+    DNSMessage lookupFromDeepestCut(
+        const std::string& domain,
+        uint16_t qtype,
+        const std::string& root_server,
+        int depth
+    );
+    
+    // Servidor inicial a partir do DelegationCache (vazio = usar root)
+    // Com DNSSEC começa sempre na raiz: a cadeia precisa de DS/DNSKEY de
+    // todos os ancestrais
+    // pool recebe os endereços de todos os NS conhecidos da delegação
+    std::string cachedStartServer(
+        const std::string& domain,
+        std::string& zone,
+        std::vector<std::string>& pool
+    ) const;
+    
+    // Guarda a delegação recebida se ela cobre o nome consultado e está
+    // abaixo de server_zone (zona do servidor que respondeu)
+    void rememberDelegation(
+        const DNSMessage& response,
+        const std::string& domain,
+        const std::string& server_zone,
+        const std::string& zone,
+        const std::vector<std::string>& nameservers,
+        const std::map<std::string, std::string>& glue_records
+    ) const;
+    
     // Verifica se uma resposta é uma delegação
     bool isDelegation(const DNSMessage& response) const;
     
@@ -95,6 +177,10 @@ private:
     // Resolve um nameserver sem glue record
     std::string resolveNameserver(const std::string& ns_name, int depth);
     
+    // Índice do servidor a consultar: menor RTT suavizado (InfraCache) ou,
+    // com use_infra_cache desligado, um sorteio uniforme
+    size_t selectByRtt(const std::vector<std::string>& servers) const;
+    
     // Seleciona próximo servidor da lista de nameservers
     std::string selectNextServer(
         const std::vector<std::string>& nameservers,
@@ -108,6 +194,9 @@ private:
     // Gera um transaction ID aleatório
     uint16_t generateTransactionID() const;
     
+    // Monta e serializa a query iterativa (RD=0, EDNS0/DO se DNSSEC ativo)
+    std::vector<uint8_t> buildQuery(const std::string& domain, uint16_t qtype) const;
+    
     // Envia uma query DNS e retorna a resposta
     DNSMessage queryServer(
         const std::string& server,
@@ -115,6 +204,24 @@ private:
         uint16_t qtype
     );
     
+    // Servidores de um passo: primary e, em ordem de RTT, até retry_servers - 1
+    // alternativas de pool
+    std::vector<std::string> retryOrder(
+        const std::string& primary,
+        const std::vector<std::string>& pool
+    ) const;
+    
+    // Envia a query a servers[0] e, se ele não responder dentro do seu RTO
+    // (InfraCache), ao próximo, sem cancelar os anteriores; fica a primeira
+    // resposta. Em TCP/DoT o próximo só é tentado após falha do anterior.
+    // answered_by recebe o servidor que respondeu
+    DNSMessage queryWithRetry(
+        const std::vector<std::string>& servers,
+        const std::string& domain,
+        uint16_t qtype,
+        std::string& answered_by
+    );
+    
     // Métodos para CNAME
     DNSMessage followCNAME(
         const DNSMessage& initial_response,
@@ -127,12 +234,44 @@ private:
     std::string extractCNAME(const DNSMessage& response) const;
     bool hasTargetType(const DNSMessage& response, uint16_t qtype) const;
     
-    // Coleta DNSKEY para uma zona
+    // Coleta DNSKEY para uma zona: do contexto ou, se ausente, consulta
+    // disparada no pool do contexto (não bloqueia a caminhada)
     void collectDNSKEY(const std::string& zone, const std::string& server);
     
-    // Coleta DS para uma zona
+    // Coleta DS para uma zona (mesmo esquema)
     void collectDS(const std::string& zone, const std::string& server);
     
+    // RRset DNSKEY de uma zona e as assinaturas que o cobrem
+    struct DNSKEYSet {
+        std::vector<DNSKEYRecord> keys;
+        std::vector<RRSIGRecord> rrsigs;
+        uint32_t ttl = 0;
+    };
+    
+    struct DSSet {
+        std::vector<DSRecord> records;
+        uint32_t ttl = 0;
+    };
+    
+    // Consultas em background (só NOERROR); o contexto não é alterado
+    DNSKEYSet fetchDNSKEY(const std::string& zone, const std::string& server);
+    DSSet fetchDS(const std::string& zone, const std::string& server);
+    
+    // Guarda no contexto os conjuntos consultados nesta resolução cujas
+    // zonas validateChain autenticou (DNSKEY forjado ou vazio não fica)
+    void rememberAuthenticated(
+        const std::map<std::string, std::vector<DNSKEYRecord>>& authenticated_keys
+    );
+    
+    // Espera as consultas pendentes e junta os conjuntos em collected_*
+    void joinDNSSECFetches();
+    
+    // Lança se o orçamento de latência (serve-stale) já se esgotou
+    void checkDeadline() const;
+    
+    // Timeout de rede limitado pelo que resta do orçamento de latência
+    int boundedTimeout(int timeout_seconds) const;
+    
     // Consulta múltiplos servidores em paralelo (fan-out)
     DNSMessage queryServersFanout(
         const std::vector<std::string>& servers,
@@ -149,15 +288,28 @@ private:
     // Cache de servidores consultados (proteção contra loops)
     std::set<std::string> queried_servers_;
     
-    // Trust anchors para validação DNSSEC
-    TrustAnchorStore trust_anchors_;
+    // Trust anchors e DNSKEY/DS já consultados (compartilháveis entre engines)
+    std::shared_ptr<ResolverContext> context_;
     
     // Validador e coleta de registros DNSSEC
     std::map<std::string, std::vector<DNSKEYRecord>> collected_dnskeys_;
+    std::map<std::string, std::vector<RRSIGRecord>> collected_dnskey_rrsigs_;
     std::map<std::string, std::vector<DSRecord>> collected_ds_;
     
+    // Conjuntos consultados (não vindos do contexto) nesta resolução → TTL
+    std::map<std::string, uint32_t> fetched_dnskey_ttls_;
+    std::map<std::string, uint32_t> fetched_ds_ttls_;
+    
+    // Consultas DNSKEY/DS em curso (zona → resultado futuro)
+    std::vector<std::pair<std::string, std::future<DNSKEYSet>>> pending_dnskeys_;
+    std::vector<std::pair<std::string, std::future<DSSet>>> pending_ds_;
+    
     // Cliente de cache (IPC)
     CacheClient cache_client_;
+    
+    // Prazo da resolução em curso (só quando há resposta stale de reserva)
+    bool has_deadline_ = false;
+    std::chrono::steady_clock::time_point deadline_;
 };
 
 } // namespace dns_resolver
@@ -0,0 +1,162 @@
+/*
+ * ----------------------------------------
+ * Arquivo: SharedCache.h
+ * Propósito: Espelho do cache em memória compartilhada POSIX (leitura sem IPC)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dns_resolver {
+
+// Nome da chave do cache: minúsculas, sem trailing dot
+// (nomes DNS não diferenciam maiúsculas)
+inline std::string normalizeCacheName(std::string_view name) {
+    std::string normalized;
+    normalized.reserve(name.size());
+    for (char c : name) {
+        normalized.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+    }
+    if (normalized.size() > 1 && normalized.back() == '.') {
+        normalized.pop_back();
+    }
+    return normalized;
+}
+
+// FNV-1a 64 bits sobre (qname normalizado, qtype, qclass)
+// Mesmo hash no daemon (CacheKey) e nos leitores da memória compartilhada
+inline uint64_t cacheKeyHash(std::string_view normalized, uint16_t qtype, uint16_t qclass) {
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](uint8_t byte) {
+        h ^= byte;
+        h *= 1099511628211ULL;
+    };
+    for (char c : normalized) {
+        mix(static_cast<uint8_t>(c));
+    }
+    mix(static_cast<uint8_t>(qtype >> 8));
+    mix(static_cast<uint8_t>(qtype & 0xFF));
+    mix(static_cast<uint8_t>(qclass >> 8));
+    mix(static_cast<uint8_t>(qclass & 0xFF));
+    return h;
+}
+
+// Entrada lida da memória compartilhada
+struct SharedCacheHit {
+    bool negative = false;
+    uint8_t rcode = 0;
+    time_t timestamp = 0;
+    uint32_t ttl = 0;
+    std::string wire;   // Resposta em wire format (vazia se negativa), TTLs originais
+};
+
+// HITs atendidos pelos leitores num slot desde a última amostragem
+struct SharedCacheHits {
+    std::string qname;
+    uint16_t qtype = 0;
+    uint16_t qclass = 0;
+    bool negative = false;
+    uint32_t hits = 0;
+};
+
+// Tabela hash de tamanho fixo num segmento POSIX (shm_open + mmap)
+// O daemon publica cópias das entradas (único escritor); os resolvers
+// mapeiam o segmento somente leitura e consultam sem syscall.
+// Cada slot tem um seqlock: o escritor torna a sequência ímpar durante a
+// escrita; o leitor copia o slot e descarta a cópia se a sequência mudou.
+// É um espelho com perdas: colisões além da janela de sondagem substituem
+// a entrada que expira primeiro e respostas grandes não são publicadas —
+// nesses casos o cliente cai no IPC normal.
+// Um segundo segmento (nome + "_hits", gravável pelos leitores) tem um
+// contador de HITs por slot: o daemon o amostra para contar popularidade
+// (prefetch, admissão) das consultas que não chegam a ele. Só contadores
+// ficam graváveis; as respostas continuam somente leitura.
+class SharedCache {
+public:
+    static constexpr const char* DEFAULT_NAME = "/dns_cache_shm";
+    static constexpr size_t WIRE_CAPACITY = 1232;   // Payload EDNS recomendado
+    static constexpr size_t MAX_NAME = 255;
+    static constexpr size_t PROBE_WINDOW = 4;       // Slots examinados por chave
+
+    // Cria (ou recria) o segmento com slots arredondados para potência de 2 (daemon)
+    // Lança std::runtime_error se o segmento não puder ser criado
+    static std::unique_ptr<SharedCache> create(const std::string& name, size_t slots);
+
+    // Mapeia segmento existente somente leitura; nullptr se ausente ou inválido
+    static std::unique_ptr<SharedCache> attach(const std::string& name);
+
+    // Criador: marca o segmento como inativo e o remove (shm_unlink)
+    ~SharedCache();
+
+    SharedCache(const SharedCache&) = delete;
+    SharedCache& operator=(const SharedCache&) = delete;
+
+    // Publica entrada positiva (wire) ou negativa (rcode); respostas maiores
+    // que WIRE_CAPACITY removem a versão anterior da chave. Só no criador.
+    void publish(std::string_view qname, uint16_t qtype, uint16_t qclass,
+                 bool negative, uint8_t rcode, std::string_view wire,
+                 time_t timestamp, uint32_t ttl);
+
+    // Remove a entrada da chave (se do tipo indicado). Só no criador.
+    void unpublish(std::string_view qname, uint16_t qtype, uint16_t qclass, bool negative);
+
+    // Remove entradas positivas e/ou negativas. Só no criador.
+    void clear(bool positive, bool negative);
+
+    // Busca entrada não expirada em now; false se ausente ou em escrita
+    // Um HIT incrementa o contador do slot (se o segmento de HITs foi mapeado)
+    bool lookup(std::string_view qname, uint16_t qtype, uint16_t qclass,
+                time_t now, SharedCacheHit& out) const;
+
+    // Lê e zera os contadores de HITs, devolvendo as chaves com HITs. Só no criador.
+    std::vector<SharedCacheHits> drainHits();
+
+    // false depois que o daemon encerrou (leitores devem remapear)
+    bool isActive() const;
+
+    size_t slotCount() const { return slot_count_; }
+
+private:
+    struct Header;
+    struct Slot;
+
+    SharedCache(void* base, size_t size, const std::string& name, bool owner);
+
+    Slot& slotAt(size_t index) const;
+    size_t indexOf(const Slot& slot) const;
+
+    // Slot com a chave na janela de sondagem (nullptr se ausente; chamado com write_mutex_)
+    Slot* findSlot(const std::string& name, uint64_t hash, uint16_t qtype, uint16_t qclass) const;
+
+    // Mapeia o segmento de contadores (criador: cria; leitor: opcional)
+    void mapHits(bool create);
+
+    // Escreve um slot sob o seqlock (chamado com write_mutex_)
+    void writeSlot(Slot& slot, uint64_t hash, std::string_view qname, uint16_t qtype,
+                   uint16_t qclass, bool negative, uint8_t rcode, std::string_view wire,
+                   time_t timestamp, uint32_t ttl);
+    void eraseSlot(Slot& slot);
+
+    void* base_;
+    size_t size_;
+    std::atomic<uint32_t>* hits_ = nullptr;   // Um contador por slot
+    size_t hits_size_ = 0;
+    size_t slot_count_;
+    std::string name_;
+    bool owner_;
+    std::mutex write_mutex_;   // Workers do daemon publicam concorrentemente
+};
+
+} // namespace dns_resolver
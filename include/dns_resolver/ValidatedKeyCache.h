@@ -0,0 +1,84 @@
+/*
+ * ----------------------------------------
+ * Arquivo: ValidatedKeyCache.h
+ * Propósito: Cache dos elos DS → DNSKEY já validados por zona
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include "dns_resolver/types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dns_resolver {
+
+// Resultado da validação de um elo da cadeia para uma zona: o conjunto
+// DNSKEY apresentado confere (key tag, algoritmo, digest) com algum DS do
+// pai (ou trust anchor, na raiz)?
+// O resultado só é reaproveitado para exatamente os mesmos conjuntos DS e
+// DNSKEY: uma troca de chave (rollover) ou DS novo refaz a validação. Como o
+// elo é função só desses registros (cuja validade o ResolverContext já
+// controla pelo TTL), a expiração aqui apenas limita a memória. O
+// DNSSECValidator só guarda elos confiáveis (a assinatura do RRset DNSKEY
+// não entra na chave: uma falha por RRSIG forjado não pode ser reaproveitada).
+// Thread-safe; compartilhado pelo ResolverContext.
+class ValidatedKeyCache {
+public:
+    static constexpr size_t DEFAULT_MAX_ZONES = 10000;
+    static constexpr uint32_t DEFAULT_TTL = 3600;
+    static constexpr uint32_t MAX_TTL = 86400;
+
+    explicit ValidatedKeyCache(size_t max_zones = DEFAULT_MAX_ZONES);
+
+    // true se a zona tem resultado válido para estes conjuntos (trusted = resultado)
+    bool lookup(
+        const std::string& zone,
+        const std::vector<DNSKEYRecord>& dnskeys,
+        const std::vector<DSRecord>& ds,
+        bool& trusted,
+        time_t now = std::time(nullptr)
+    );
+
+    // Guarda o resultado da validação do elo (substitui o anterior da zona)
+    void store(
+        const std::string& zone,
+        const std::vector<DNSKEYRecord>& dnskeys,
+        const std::vector<DSRecord>& ds,
+        bool trusted,
+        uint32_t ttl = DEFAULT_TTL,
+        time_t now = std::time(nullptr)
+    );
+
+    void clear();
+    size_t size() const;
+
+    // Consultas atendidas sem digest / que precisaram validar
+    uint64_t hits() const { return hits_.load(); }
+    uint64_t misses() const { return misses_.load(); }
+
+private:
+    struct Entry {
+        std::vector<DNSKEYRecord> dnskeys;
+        std::vector<DSRecord> ds;
+        bool trusted = false;
+        time_t expires_at = 0;
+    };
+
+    size_t max_zones_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> zones_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+};
+
+} // namespace dns_resolver
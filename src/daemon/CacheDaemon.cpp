@@ -9,9 +9,18 @@
  */
 
 #include "CacheDaemon.h"
+#include "CacheSnapshot.h"
+#include "dns_resolver/CacheClient.h"
+#include "dns_resolver/ResolverEngine.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -21,13 +30,34 @@ namespace dns_cache {
 const char* CacheDaemon::SOCKET_PATH = "/tmp/dns_cache.sock";
 
 CacheDaemon::CacheDaemon() {
-    // Construtor vazio - inicialização lazy
+    // Sockets e threads são criados em run(); aqui só orçamento, janela stale
+    // e admissão padrão
+    setMemoryLimit(config_.memory_limit);
+    setStaleWindow(config_.stale_window);
+    positive_cache_.setAdmission(config_.admission);
 }
 
 CacheDaemon::~CacheDaemon() {
     stop();
 }
 
+void CacheDaemon::setConfig(const DaemonConfig& config) {
+    config_ = config;
+    if (config_.listen_backlog <= 0) {
+        config_.listen_backlog = SOMAXCONN;
+    }
+    if (config_.max_connections == 0) {
+        config_.max_connections = 1;
+    }
+    if (config_.worker_threads == 0) {
+        config_.worker_threads = 1;
+    }
+    setMemoryLimit(config_.memory_limit);
+    setStaleWindow(config_.stale_window);
+    // Só o positivo: entradas negativas são pequenas e não disputam memória
+    positive_cache_.setAdmission(config_.admission);
+}
+
 void CacheDaemon::run() {
     running_ = true;
     
@@ -38,43 +68,191 @@ void CacheDaemon::run() {
         return;
     }
     
+    // Criar epoll e eventfd de notificação dos workers
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Failed to create event loop" << std::endl;
+        stop();
+        unlink(SOCKET_PATH);
+        return;
+    }
+    
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = server_socket_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_socket_, &ev);
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    accepting_ = true;
+    
+    workers_ = std::make_unique<dns_resolver::ThreadPool>(config_.worker_threads);
+    // Também renova entradas servidas stale (mesmo com prefetch_window = 0)
+    if (config_.prefetch_threads > 0) {
+        prefetch_pool_ = std::make_unique<dns_resolver::ThreadPool>(config_.prefetch_threads);
+        resolver_context_ = std::make_shared<dns_resolver::ResolverContext>();
+    }
+    
+    // Espelho em memória compartilhada (opcional; falha não impede o daemon)
+    if (config_.shm_slots > 0) {
+        try {
+            shared_ = dns_resolver::SharedCache::create(dns_resolver::SharedCache::DEFAULT_NAME,
+                                                        config_.shm_slots);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    // Entrada removida (LRU, expiração, capacidade) sai também do espelho
+    // (stop() descarta o espelho com as tabelas ainda vivas: conferir)
+    if (shared_) {
+        positive_cache_.setEvictionListener([this](const CacheKey& key) {
+            if (shared_) {
+                shared_->unpublish(key.qname, key.qtype, key.qclass, false);
+            }
+        });
+        negative_cache_.setEvictionListener([this](const CacheKey& key) {
+            if (shared_) {
+                shared_->unpublish(key.qname, key.qtype, key.qclass, true);
+            }
+        });
+    }
+    
+    // Reinício a quente: carregar o snapshot antes de aceitar consultas
+    loadSnapshot();
+    
     std::cout << "Cache daemon started" << std::endl;
     std::cout << "Socket: " << SOCKET_PATH << std::endl;
-    std::cout << "Positive cache: 0/" << max_positive_entries_ << std::endl;
-    std::cout << "Negative cache: 0/" << max_negative_entries_ << std::endl;
+    std::cout << "Workers: " << config_.worker_threads
+              << ", backlog: " << config_.listen_backlog
+              << ", max connections: " << config_.max_connections << std::endl;
+    std::cout << "Positive cache: " << positive_cache_.size() << "/"
+              << positive_cache_.maxEntries() << std::endl;
+    std::cout << "Negative cache: " << negative_cache_.size() << "/"
+              << negative_cache_.maxEntries() << std::endl;
+    
+    // Expiração fora do caminho das requisições
+    housekeeping_thread_ = std::thread(&CacheDaemon::housekeepingLoop, this);
     
-    // Loop principal do daemon
+    // Loop de eventos principal
+    struct epoll_event events[MAX_EVENTS];
     while (running_) {
-        // Aceitar conexão de cliente
-        int client_socket = accept(server_socket_, nullptr, nullptr);
-        if (client_socket < 0) {
-            if (running_) {
-                std::cerr << "Accept failed" << std::endl;
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, EVENT_TIMEOUT_MS);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
             }
-            continue;
+            std::cerr << "epoll_wait failed" << std::endl;
+            break;
         }
         
-        // Processar comando do cliente
-        handleClient(client_socket);
-        close(client_socket);
-        
-        // Limpeza periódica de entradas expiradas
-        cleanupExpiredEntries();
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+            
+            if (fd == server_socket_) {
+                acceptConnections();
+            } else if (fd == wake_fd_) {
+                uint64_t value;
+                while (read(wake_fd_, &value, sizeof(value)) > 0) {}
+                drainCompletions();
+            } else {
+                if (flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readFromClient(fd);
+                }
+                if ((flags & EPOLLOUT) && connections_.count(fd)) {
+                    writeToClient(fd);
+                }
+            }
+        }
     }
     
-    // Cleanup final
-    close(server_socket_);
+    // Cleanup final (workers e prefetch parados antes do snapshot)
+    stop();
+    saveSnapshot();
     unlink(SOCKET_PATH);
 }
 
-void CacheDaemon::stop() {
+void CacheDaemon::requestStop() {
+    // Seguro em handler de sinal: store atômico + write no eventfd
     running_ = false;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void CacheDaemon::stop() {
+    {
+        std::lock_guard<std::mutex> lock(housekeeping_mutex_);
+        running_ = false;
+    }
+    housekeeping_cv_.notify_all();
+    
+    if (housekeeping_thread_.joinable() &&
+        housekeeping_thread_.get_id() != std::this_thread::get_id()) {
+        housekeeping_thread_.join();
+    }
+    
+    // Aguardar comandos em execução antes de fechar as conexões
+    workers_.reset();
+    
+    // Prefetches enfileirados retornam logo (running_ = false)
+    prefetch_pool_.reset();
+    
+    // Sem escritores: marcar o segmento inativo e removê-lo
+    shared_.reset();
+    
+    for (auto& entry : connections_) {
+        close(entry.first);
+    }
+    connections_.clear();
+    completions_.clear();
+    
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
     if (server_socket_ >= 0) {
         close(server_socket_);
         server_socket_ = -1;
     }
 }
 
+void CacheDaemon::housekeepingLoop() {
+    std::unique_lock<std::mutex> lock(housekeeping_mutex_);
+    auto last_snapshot = std::chrono::steady_clock::now();
+    
+    while (running_) {
+        housekeeping_cv_.wait_for(lock, std::chrono::milliseconds(HOUSEKEEPING_INTERVAL_MS),
+                                  [this] { return !running_; });
+        if (!running_) {
+            break;
+        }
+        
+        // Drenar em lotes limitados, liberando os shards entre lotes
+        lock.unlock();
+        while (running_ && cleanupExpiredEntries()) {
+            std::this_thread::yield();
+        }
+        sampleSharedHits();
+        
+        // Snapshot periódico (o final é gravado ao encerrar)
+        auto now = std::chrono::steady_clock::now();
+        if (running_ && config_.snapshot_interval > 0 &&
+            now - last_snapshot >= std::chrono::seconds(config_.snapshot_interval)) {
+            saveSnapshot();
+            last_snapshot = now;
+        }
+        lock.lock();
+    }
+}
+
 int CacheDaemon::createSocket() {
     // Remover socket antigo se existir
     unlink(SOCKET_PATH);
@@ -97,8 +275,9 @@ int CacheDaemon::createSocket() {
         return -1;
     }
     
-    // Colocar socket em modo listen
-    if (listen(sock, 5) < 0) {
+    // Colocar socket em modo listen (não bloqueante para o epoll)
+    if (listen(sock, config_.listen_backlog) < 0 ||
+        fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) < 0) {
         close(sock);
         unlink(SOCKET_PATH);
         return -1;
@@ -107,489 +286,769 @@ int CacheDaemon::createSocket() {
     return sock;
 }
 
-void CacheDaemon::handleClient(int client_socket) {
-    // Ler comando do cliente (buffer simples)
-    char buffer[4096];
-    ssize_t n = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
+// ========== LOOP DE EVENTOS ==========
+
+void CacheDaemon::acceptConnections() {
+    while (connections_.size() < config_.max_connections) {
+        int client = accept4(server_socket_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && running_) {
+                std::cerr << "Accept failed" << std::endl;
+            }
+            break;
+        }
+        
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = client;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client, &ev) < 0) {
+            close(client);
+            continue;
+        }
+        
+        Connection& conn = connections_[client];
+        conn = Connection();
+        conn.id = next_connection_id_++;
+    }
     
-    if (n <= 0) {
+    updateListenInterest();
+}
+
+void CacheDaemon::readFromClient(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
         return;
     }
+    Connection& conn = it->second;
     
-    buffer[n] = '\0';
-    std::string command(buffer);
+    // Ler tudo o que está disponível
+    char buffer[16384];
+    while (true) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            conn.inbuf.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            conn.peer_closed = true;
+        }
+        break;
+    }
     
-    // Processar comando e gerar resposta
-    std::string response = processCommand(command);
+    // Despachar cada frame completo; respostas podem voltar fora de ordem
+    size_t offset = 0;
+    try {
+        dns_resolver::CacheFrameHeader header;
+        std::string_view payload;
+        while (true) {
+            size_t start = offset;
+            if (!dns_resolver::CacheProtocol::extractFrame(conn.inbuf, offset, header, payload)) {
+                break;
+            }
+            
+            // Caso comum (um frame no buffer): mover o buffer para o worker
+            std::string frame;
+            if (start == 0 && offset == conn.inbuf.size()) {
+                frame = std::move(conn.inbuf);
+                conn.inbuf.clear();
+                offset = 0;
+            } else {
+                frame.assign(conn.inbuf, start, offset - start);
+            }
+            
+            conn.pending++;
+            uint64_t id = conn.id;
+            workers_->enqueue([this, fd, id, frame = std::move(frame)]() {
+                dns_resolver::CacheFrameHeader request;
+                std::string_view body;
+                size_t pos = 0;
+                dns_resolver::CacheProtocol::extractFrame(frame, pos, request, body);
+                std::string response = processCommand(request, body);
+                {
+                    std::lock_guard<std::mutex> lock(completion_mutex_);
+                    completions_.push_back({fd, id, std::move(response)});
+                }
+                uint64_t one = 1;
+                ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+                (void)ignored;
+            });
+            
+            if (conn.inbuf.empty()) {
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        // Frame inválido: conexão fora de sincronia, encerrar
+        std::cerr << "Protocol error: " << e.what() << std::endl;
+        conn.peer_closed = true;
+        conn.inbuf.clear();
+        offset = 0;
+    }
+    conn.inbuf.erase(0, offset);
+    
+    if (conn.peer_closed && conn.pending > 0) {
+        // Deixar de observar o socket encerrado (evita HUP repetido);
+        // as respostas restantes são descartadas ou enviadas na conclusão
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
     
-    // Enviar resposta ao cliente
-    send(client_socket, response.c_str(), response.size(), 0);
+    maybeFinishConnection(fd);
 }
 
-std::string CacheDaemon::processCommand(const std::string& command) {
-    // Parsear comando (formato: COMMAND|arg1|arg2 ou COMMAND arg1)
-    size_t delimiter_pos = command.find('|');
-    std::string cmd;
-    std::istringstream iss(command);
-    
-    if (delimiter_pos != std::string::npos) {
-        // Formato com | (ex: QUERY|domain|type)
-        cmd = command.substr(0, delimiter_pos);
-    } else {
-        // Formato com espaço (ex: SET_POSITIVE 100)
-        iss >> cmd;
+void CacheDaemon::drainCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex_);
+        ready.swap(completions_);
     }
     
-    // QUERY - consultar cache 
-    if (cmd == "QUERY") {
-        // Parsear: QUERY|qname|qtype|qclass
-        size_t pos = 0;
-        std::vector<std::string> parts;
-        std::string temp = command;
-        
-        while ((pos = temp.find('|')) != std::string::npos) {
-            parts.push_back(temp.substr(0, pos));
-            temp = temp.substr(pos + 1);
-        }
-        parts.push_back(temp);  // Último campo
-        
-        if (parts.size() < 4) {
-            return "ERROR|Invalid QUERY format\n";
+    // Agrupar frames por conexão antes de escrever
+    std::vector<int> touched;
+    for (Completion& done : ready) {
+        auto it = connections_.find(done.fd);
+        if (it == connections_.end() || it->second.id != done.id) {
+            continue;  // Conexão já encerrada
         }
         
-        dns_resolver::DNSQuestion question;
-        question.qname = parts[1];
-        question.qtype = std::stoi(parts[2]);
-        question.qclass = std::stoi(parts[3]);
-        
-        // Buscar no cache com lock thread-safe
-        std::lock_guard<std::mutex> lock(cache_mutex_);
-        
-        // Verificar cache positivo primeiro
-        auto pos_it = positive_cache_.find(question);
-        if (pos_it != positive_cache_.end() && !pos_it->second.isExpired()) {
-            // HIT positivo - serializar e retornar
-            std::string serialized = serializeMessage(pos_it->second.response);
-            return "HIT|" + serialized + "\n";
+        Connection& conn = it->second;
+        conn.pending--;
+        if (conn.outbuf.empty()) {
+            conn.outbuf = std::move(done.response);
+        } else {
+            conn.outbuf.append(done.response);
         }
-        
-        // Verificar cache negativo
-        auto neg_it = negative_cache_.find(question);
-        if (neg_it != negative_cache_.end() && !neg_it->second.isExpired()) {
-            // HIT negativo - retornar RCODE
-            uint8_t rcode = neg_it->second.response.header.rcode;
-            return "NEGATIVE|" + std::to_string(static_cast<int>(rcode)) + "\n";
+        touched.push_back(done.fd);
+    }
+    
+    for (int fd : touched) {
+        if (connections_.count(fd)) {
+            writeToClient(fd);
         }
-        
-        // MISS em ambos os caches
-        return "MISS\n";
     }
+}
+
+void CacheDaemon::writeToClient(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    Connection& conn = it->second;
     
-    // STORE - armazenar resposta positiva 
-    if (cmd == "STORE") {
-        // Parsear: STORE|qname|qtype|qclass|ttl|serialized_data
-        // Parsear apenas os primeiros 5 campos, o resto é serialized_data
-        std::vector<std::string> parts;
-        size_t pos = 0;
-        std::string temp = command;
-        
-        // Extrair primeiros 5 campos (STORE, qname, qtype, qclass, ttl)
-        for (int i = 0; i < 5; i++) {
-            pos = temp.find('|');
-            if (pos == std::string::npos) {
-                return "ERROR|Invalid STORE format\n";
+    while (conn.written < conn.outbuf.size()) {
+        ssize_t n = send(fd, conn.outbuf.data() + conn.written,
+                         conn.outbuf.size() - conn.written, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.written += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Socket já fora do epoll: cliente encerrou sem ler respostas
+            if (conn.peer_closed) {
+                closeConnection(fd);
+                return;
             }
-            parts.push_back(temp.substr(0, pos));
-            temp = temp.substr(pos + 1);
+            
+            // Cliente lento: aguardar EPOLLOUT sem bloquear os demais
+            if (!conn.want_write) {
+                struct epoll_event ev;
+                std::memset(&ev, 0, sizeof(ev));
+                ev.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT;
+                ev.data.fd = fd;
+                epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+                conn.want_write = true;
+            }
+            return;
         }
         
-        // O resto é serialized_data (pode conter |)
-        std::string serialized_data = temp;
-        
-        dns_resolver::DNSQuestion question;
-        question.qname = parts[1];
-        question.qtype = std::stoi(parts[2]);
-        question.qclass = std::stoi(parts[3]);
-        
-        uint32_t ttl = std::stoi(parts[4]);
-        
-        // Deserializar resposta DNS
-        dns_resolver::DNSMessage response = deserializeMessage(serialized_data);
-        
-        // Criar entrada de cache
-        CacheEntry entry(response, ttl);
-        
-        // Adicionar ao cache positivo (com política LRU)
-        addToCachePositive(question, entry);
-        
-        return "OK|Stored\n";
+        // Erro de escrita: cliente foi embora
+        closeConnection(fd);
+        return;
+    }
+    
+    conn.outbuf.clear();
+    conn.written = 0;
+    
+    if (conn.want_write) {
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+        conn.want_write = false;
+    }
+    
+    maybeFinishConnection(fd);
+}
+
+void CacheDaemon::maybeFinishConnection(int fd) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    const Connection& conn = it->second;
+    if (conn.peer_closed && conn.pending == 0 && conn.written >= conn.outbuf.size()) {
+        closeConnection(fd);
+    }
+}
+
+void CacheDaemon::closeConnection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+    updateListenInterest();
+}
+
+void CacheDaemon::updateListenInterest() {
+    bool should_accept = connections_.size() < config_.max_connections;
+    if (should_accept == accepting_) {
+        return;
     }
     
-    // STORE_NEGATIVE - armazenar resposta negativa 
-    if (cmd == "STORE_NEGATIVE") {
-        // Parsear: STORE_NEGATIVE|qname|qtype|qclass|ttl|rcode
-        std::vector<std::string> parts;
-        size_t pos = 0;
-        std::string temp = command;
+    // No limite, novas conexões aguardam no backlog do kernel
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = should_accept ? static_cast<uint32_t>(EPOLLIN) : 0u;
+    ev.data.fd = server_socket_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, server_socket_, &ev);
+    accepting_ = should_accept;
+}
+
+std::string CacheDaemon::processCommand(
+    const dns_resolver::CacheFrameHeader& header,
+    std::string_view payload
+) {
+    using dns_resolver::CacheOpcode;
+    using dns_resolver::CacheTarget;
+    using dns_resolver::CacheMessageReader;
+    using dns_resolver::CacheMessageWriter;
+    using dns_resolver::CacheProtocol;
+    
+    uint32_t request_id = header.request_id;
+    auto reply = [request_id](CacheOpcode opcode, std::string_view message) {
+        return CacheMessageWriter(opcode, request_id).putBlob(message).finish();
+    };
+    
+    try {
+        CacheMessageReader reader(payload);
         
-        for (int i = 0; i < 6; i++) {
-            pos = temp.find('|');
-            if (pos == std::string::npos && i < 5) {
-                return "ERROR|Invalid STORE_NEGATIVE format\n";
+        switch (header.opcode) {
+        // QUERY - consultar cache
+        case CacheOpcode::QUERY: {
+            std::string_view qname = reader.getString();
+            uint16_t qtype = reader.getU16();
+            uint16_t qclass = reader.getU16();
+            
+            // Chave normalizada (hash calculado uma vez; lock apenas do shard)
+            CacheKey key(qname, qtype, qclass);
+            CacheEntry entry;
+            
+            // Verificar cache positivo primeiro (HIT promove na lista LRU)
+            if (positive_cache_.lookup(key, entry)) {
+                prepareHit(key, entry, std::time(nullptr));
+                return reply(CacheOpcode::HIT, entry.wire);
             }
-            if (pos != std::string::npos) {
-                parts.push_back(temp.substr(0, pos));
-                temp = temp.substr(pos + 1);
-            } else {
-                parts.push_back(temp);
+            
+            // Verificar cache negativo
+            if (negative_cache_.lookup(key, entry)) {
+                return CacheMessageWriter(CacheOpcode::NEGATIVE, request_id)
+                    .putU8(entry.rcode)
+                    .finish();
             }
+            
+            // MISS em ambos os caches
+            return CacheMessageWriter(CacheOpcode::MISS, request_id).finish();
         }
         
-        if (parts.size() < 6) {
-            return "ERROR|Invalid STORE_NEGATIVE format\n";
+        // QUERY_STALE - resolução falhou ou estourou o orçamento de latência:
+        // aceitar entrada expirada dentro da janela stale (RFC 8767)
+        case CacheOpcode::QUERY_STALE: {
+            std::string_view qname = reader.getString();
+            uint16_t qtype = reader.getU16();
+            uint16_t qclass = reader.getU16();
+            
+            CacheKey key(qname, qtype, qclass);
+            CacheEntry entry;
+            
+            if (positive_cache_.lookupStale(key, entry)) {
+                // Renovar em background; quem pediu usa a resposta antiga agora
+                if (entry.isExpired()) {
+                    bool dnssec = (static_cast<uint8_t>(entry.wire[3]) & 0x20) != 0;
+                    schedulePrefetch(key, dnssec);
+                    entry.rewriteTTLs(STALE_ANSWER_TTL);
+                    stale_served_++;
+                } else {
+                    entry.ageTTLs(std::time(nullptr));
+                }
+                return reply(CacheOpcode::HIT, entry.wire);
+            }
+            
+            if (negative_cache_.lookupStale(key, entry)) {
+                if (entry.isExpired()) {
+                    stale_served_++;
+                }
+                return CacheMessageWriter(CacheOpcode::NEGATIVE, request_id)
+                    .putU8(entry.rcode)
+                    .finish();
+            }
+            
+            return CacheMessageWriter(CacheOpcode::MISS, request_id).finish();
         }
         
-        dns_resolver::DNSQuestion question;
-        question.qname = parts[1];
-        question.qtype = std::stoi(parts[2]);
-        question.qclass = std::stoi(parts[3]);
-        
-        uint32_t ttl = std::stoi(parts[4]);
-        uint8_t rcode = std::stoi(parts[5]);
-        
-        // Criar DNSMessage mínimo com RCODE
-        dns_resolver::DNSMessage negative_response;
-        negative_response.header.qr = true;
-        negative_response.header.rcode = rcode;
-        negative_response.header.ancount = 0;
-        
-        // Criar entrada de cache negativo
-        CacheEntry entry(negative_response, ttl);
-        
-        // Adicionar ao cache negativo (com política LRU)
-        {
-            std::lock_guard<std::mutex> lock(cache_mutex_);
+        // MQUERY - consultar várias chaves num round trip
+        // Um lock por shard envolvido; negativo só para as que faltaram no positivo
+        case CacheOpcode::MQUERY: {
+            uint32_t count = reader.getU32();
+            std::vector<CacheKey> keys;
+            keys.reserve(std::min<size_t>(count, payload.size() / 5));
+            for (uint32_t i = 0; i < count; i++) {
+                std::string_view qname = reader.getString();
+                uint16_t qtype = reader.getU16();
+                uint16_t qclass = reader.getU16();
+                keys.emplace_back(qname, qtype, qclass);
+            }
             
-            // Limpar entradas expiradas primeiro
-            for (auto it = negative_cache_.begin(); it != negative_cache_.end(); ) {
-                if (it->second.isExpired()) {
-                    it = negative_cache_.erase(it);
+            // Resposta não pode passar do limite do frame: por item, status (1),
+            // tamanho do blob (4) ou rcode (1); HITs que não cabem ficam MISS
+            // sem contar HIT nem promover
+            size_t overhead = CacheProtocol::HEADER_SIZE + 4 + keys.size() * 5;
+            size_t wire_budget = overhead < CacheProtocol::MAX_PAYLOAD_SIZE
+                ? CacheProtocol::MAX_PAYLOAD_SIZE - overhead : 0;
+            std::vector<CacheEntry> positive;
+            std::vector<bool> positive_found;
+            positive_cache_.lookupMany(keys, positive, positive_found, wire_budget);
+            
+            std::vector<CacheKey> missed;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (!positive_found[i]) {
+                    missed.push_back(keys[i]);
+                }
+            }
+            std::vector<CacheEntry> negative;
+            std::vector<bool> negative_found;
+            negative_cache_.lookupMany(missed, negative, negative_found);
+            
+            time_t now = std::time(nullptr);
+            CacheMessageWriter writer(CacheOpcode::MRESULT, request_id);
+            writer.putU32(count);
+            size_t next_missed = 0;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (positive_found[i]) {
+                    prepareHit(keys[i], positive[i], now);
+                    writer.putU8(static_cast<uint8_t>(CacheOpcode::HIT)).putBlob(positive[i].wire);
+                } else if (negative_found[next_missed++]) {
+                    writer.putU8(static_cast<uint8_t>(CacheOpcode::NEGATIVE))
+                          .putU8(negative[next_missed - 1].rcode);
                 } else {
-                    ++it;
+                    writer.putU8(static_cast<uint8_t>(CacheOpcode::MISS));
                 }
             }
+            return writer.finish();
+        }
+        
+        // MSTORE - armazenar várias respostas (positivas e negativas) num round trip
+        case CacheOpcode::MSTORE: {
+            uint32_t count = reader.getU32();
+            std::vector<std::pair<CacheKey, CacheEntry>> positive;
+            std::vector<std::pair<CacheKey, CacheEntry>> negative;
             
-            // Aplicar política LRU se cache cheio
-            if (negative_cache_.size() >= max_negative_entries_) {
-                auto oldest = negative_cache_.begin();
-                for (auto it = negative_cache_.begin(); it != negative_cache_.end(); ++it) {
-                    if (it->second.timestamp < oldest->second.timestamp) {
-                        oldest = it;
+            // Validar o frame inteiro antes de inserir (erro não deixa lote pela metade)
+            for (uint32_t i = 0; i < count; i++) {
+                auto kind = static_cast<CacheOpcode>(reader.getU8());
+                std::string_view qname = reader.getString();
+                uint16_t qtype = reader.getU16();
+                uint16_t qclass = reader.getU16();
+                uint32_t ttl = reader.getU32();
+                
+                if (kind == CacheOpcode::STORE) {
+                    std::string_view data = reader.getBlob();
+                    if (data.size() < 12) {
+                        return reply(CacheOpcode::ERROR, "Invalid DNS response\n");
                     }
+                    uint8_t rcode = static_cast<uint8_t>(data[3]) & 0x0F;
+                    positive.emplace_back(CacheKey(qname, qtype, qclass),
+                                          CacheEntry(std::string(data), rcode, ttl));
+                } else if (kind == CacheOpcode::STORE_NEGATIVE) {
+                    uint8_t rcode = reader.getU8();
+                    negative.emplace_back(CacheKey(qname, qtype, qclass),
+                                          CacheEntry(std::string(), rcode, ttl));
+                } else {
+                    return reply(CacheOpcode::ERROR, "Invalid batch item\n");
                 }
-                negative_cache_.erase(oldest);
             }
             
-            // Adicionar nova entrada
-            negative_cache_[question] = entry;
+            // Só o que a admissão aceitou vai para o espelho compartilhado
+            std::vector<bool> positive_admitted = positive_cache_.insertMany(positive);
+            std::vector<bool> negative_admitted = negative_cache_.insertMany(negative);
+            for (size_t i = 0; i < positive.size(); i++) {
+                if (positive_admitted[i]) {
+                    publishShared(positive[i].first, positive[i].second, false);
+                }
+            }
+            for (size_t i = 0; i < negative.size(); i++) {
+                if (negative_admitted[i]) {
+                    publishShared(negative[i].first, negative[i].second, true);
+                }
+            }
+            
+            return reply(CacheOpcode::OK, "Stored " + std::to_string(count) + " entries");
         }
         
-        return "OK|Stored negative\n";
-    }
-    
-    // FLUSH - limpar todo o cache
-    if (cmd == "FLUSH") {
-        size_t removed = flushAll();
-        return "OK|Flushed " + std::to_string(removed) + " entries\n";
-    }
-    
-    // SET_POSITIVE - configurar tamanho do cache positivo
-    if (cmd == "SET_POSITIVE") {
-        size_t size;
-        iss >> size;
-        setMaxPositiveEntries(size);
-        return "OK|Positive cache size set to " + std::to_string(size) + "\n";
-    }
-    
-    // SET_NEGATIVE - configurar tamanho do cache negativo
-    if (cmd == "SET_NEGATIVE") {
-        size_t size;
-        iss >> size;
-        setMaxNegativeEntries(size);
-        return "OK|Negative cache size set to " + std::to_string(size) + "\n";
-    }
-    
-    // PURGE - limpar cache específico
-    if (cmd == "PURGE") {
-        std::string type;
-        iss >> type;
+        // STORE - armazenar resposta positiva
+        case CacheOpcode::STORE: {
+            std::string_view qname = reader.getString();
+            uint16_t qtype = reader.getU16();
+            uint16_t qclass = reader.getU16();
+            uint32_t ttl = reader.getU32();
+            std::string_view data = reader.getBlob();
+            
+            // Resposta em wire format: precisa ao menos do header DNS
+            if (data.size() < 12) {
+                return reply(CacheOpcode::ERROR, "Invalid DNS response\n");
+            }
+            
+            // Armazenar bytes sem reinterpretar (RCODE nos 4 bits baixos do byte 3)
+            // Offsets dos TTLs indexados aqui; lança se a mensagem estiver malformada
+            uint8_t rcode = static_cast<uint8_t>(data[3]) & 0x0F;
+            CacheKey key(qname, qtype, qclass);
+            CacheEntry entry(std::string(data), rcode, ttl);
+            if (positive_cache_.insert(key, entry)) {
+                publishShared(key, entry, false);
+            }
+            
+            return reply(CacheOpcode::OK, "Stored");
+        }
         
-        if (type == "positive") {
-            size_t removed = purgePositiveCache();
-            return "OK|Purged " + std::to_string(removed) + " positive entries\n";
-        } else if (type == "negative") {
-            size_t removed = purgeNegativeCache();
-            return "OK|Purged " + std::to_string(removed) + " negative entries\n";
-        } else if (type == "all") {
+        // STORE_NEGATIVE - armazenar resposta negativa
+        case CacheOpcode::STORE_NEGATIVE: {
+            std::string_view qname = reader.getString();
+            uint16_t qtype = reader.getU16();
+            uint16_t qclass = reader.getU16();
+            uint32_t ttl = reader.getU32();
+            uint8_t rcode = reader.getU8();
+            
+            // Adicionar ao cache negativo (com política LRU; só o RCODE)
+            CacheKey key(qname, qtype, qclass);
+            CacheEntry entry(std::string(), rcode, ttl);
+            if (negative_cache_.insert(key, entry)) {
+                publishShared(key, entry, true);
+            }
+            
+            return reply(CacheOpcode::OK, "Stored negative");
+        }
+        
+        // FLUSH - limpar todo o cache
+        case CacheOpcode::FLUSH: {
             size_t removed = flushAll();
-            return "OK|Purged " + std::to_string(removed) + " total entries\n";
+            return reply(CacheOpcode::OK, "Flushed " + std::to_string(removed) + " entries\n");
         }
         
-        return "ERROR|Invalid purge type\n";
-    }
-    
-    // LIST - listar entradas do cache
-    if (cmd == "LIST") {
-        std::string type;
-        iss >> type;
+        // SET_POSITIVE - configurar tamanho do cache positivo
+        case CacheOpcode::SET_POSITIVE: {
+            size_t size = reader.getU32();
+            setMaxPositiveEntries(size);
+            return reply(CacheOpcode::OK,
+                         "Positive cache size set to " + std::to_string(size) + "\n");
+        }
+        
+        // SET_NEGATIVE - configurar tamanho do cache negativo
+        case CacheOpcode::SET_NEGATIVE: {
+            size_t size = reader.getU32();
+            setMaxNegativeEntries(size);
+            return reply(CacheOpcode::OK,
+                         "Negative cache size set to " + std::to_string(size) + "\n");
+        }
         
-        std::lock_guard<std::mutex> lock(cache_mutex_);
+        // SET_MEMORY - configurar orçamento de memória
+        case CacheOpcode::SET_MEMORY: {
+            uint64_t bytes = reader.getU64();
+            setMemoryLimit(static_cast<size_t>(bytes));
+            return reply(CacheOpcode::OK,
+                         "Memory limit set to " + std::to_string(bytes) + " bytes\n");
+        }
         
-        if (type == "positive") {
-            std::ostringstream oss;
-            oss << "OK|Positive cache: " << positive_cache_.size() 
-                << "/" << max_positive_entries_ << " entries\n";
-            return oss.str();
-        } else if (type == "negative") {
+        // PURGE - limpar cache específico
+        case CacheOpcode::PURGE: {
+            switch (static_cast<CacheTarget>(reader.getU8())) {
+            case CacheTarget::POSITIVE:
+                return reply(CacheOpcode::OK, "Purged " + std::to_string(purgePositiveCache()) +
+                             " positive entries\n");
+            case CacheTarget::NEGATIVE:
+                return reply(CacheOpcode::OK, "Purged " + std::to_string(purgeNegativeCache()) +
+                             " negative entries\n");
+            case CacheTarget::ALL:
+                return reply(CacheOpcode::OK, "Purged " + std::to_string(flushAll()) +
+                             " total entries\n");
+            }
+            return reply(CacheOpcode::ERROR, "Invalid purge type\n");
+        }
+        
+        // LIST - listar entradas do cache
+        case CacheOpcode::LIST: {
             std::ostringstream oss;
-            oss << "OK|Negative cache: " << negative_cache_.size() 
-                << "/" << max_negative_entries_ << " entries\n";
-            return oss.str();
-        } else if (type == "all") {
+            switch (static_cast<CacheTarget>(reader.getU8())) {
+            case CacheTarget::POSITIVE:
+                oss << "Positive cache: " << positive_cache_.size()
+                    << "/" << positive_cache_.maxEntries() << " entries, "
+                    << positive_cache_.bytes() << " bytes\n";
+                return reply(CacheOpcode::OK, oss.str());
+            case CacheTarget::NEGATIVE:
+                oss << "Negative cache: " << negative_cache_.size()
+                    << "/" << negative_cache_.maxEntries() << " entries, "
+                    << negative_cache_.bytes() << " bytes\n";
+                return reply(CacheOpcode::OK, oss.str());
+            case CacheTarget::ALL:
+                oss << "Total: " << (positive_cache_.size() + negative_cache_.size())
+                    << " entries ("
+                    << positive_cache_.size() << " positive, "
+                    << negative_cache_.size() << " negative)\n";
+                return reply(CacheOpcode::OK, oss.str());
+            }
+            return reply(CacheOpcode::ERROR, "Invalid list type\n");
+        }
+        
+        // STATUS - informações do daemon
+        case CacheOpcode::STATUS: {
             std::ostringstream oss;
-            oss << "OK|Total: " << (positive_cache_.size() + negative_cache_.size())
-                << " entries ("
-                << positive_cache_.size() << " positive, "
-                << negative_cache_.size() << " negative)\n";
-            return oss.str();
+            oss << "Cache Daemon Status\n";
+            oss << "Positive: " << positive_cache_.size() << "/" << positive_cache_.maxEntries()
+                << " (" << positive_cache_.bytes() << "/" << positive_cache_.maxBytes() << " bytes)\n";
+            oss << "Negative: " << negative_cache_.size() << "/" << negative_cache_.maxEntries()
+                << " (" << negative_cache_.bytes() << "/" << negative_cache_.maxBytes() << " bytes)\n";
+            oss << "Memory: " << (positive_cache_.bytes() + negative_cache_.bytes()) << "/"
+                << (positive_cache_.maxBytes() + negative_cache_.maxBytes()) << " bytes\n";
+            {
+                std::lock_guard<std::mutex> lock(prefetch_mutex_);
+                oss << "Prefetch: " << prefetch_count_.load() << " refreshed, "
+                    << prefetch_inflight_.size() << " in flight\n";
+            }
+            if (shared_) {
+                oss << "Shared memory: " << dns_resolver::SharedCache::DEFAULT_NAME << ", "
+                    << shared_->slotCount() << " slots, " << shared_hits_.load() << " hits\n";
+            }
+            oss << "Stale: window " << positive_cache_.staleWindow() << "s, "
+                << stale_served_.load() << " served\n";
+            if (positive_cache_.admissionEnabled()) {
+                uint64_t candidates = positive_cache_.admissionCandidates();
+                uint64_t rejects = positive_cache_.admissionRejects();
+                oss << "Admission: TinyLFU, " << rejects << "/" << candidates
+                    << " rejected (" << (candidates ? rejects * 100 / candidates : 0) << "%)\n";
+            } else {
+                oss << "Admission: off\n";
+            }
+            return reply(CacheOpcode::OK, oss.str());
         }
         
-        return "ERROR|Invalid list type\n";
-    }
-    
-    // STATUS - informações do daemon
-    if (cmd == "STATUS") {
-        std::lock_guard<std::mutex> lock(cache_mutex_);
-        std::ostringstream oss;
-        oss << "OK|Cache Daemon Status\n";
-        oss << "Positive: " << positive_cache_.size() << "/" << max_positive_entries_ << "\n";
-        oss << "Negative: " << negative_cache_.size() << "/" << max_negative_entries_ << "\n";
-        return oss.str();
+        default:
+            break;
+        }
+    } catch (const std::exception& e) {
+        return reply(CacheOpcode::ERROR, std::string("Invalid request: ") + e.what() + "\n");
     }
     
-    return "ERROR|Unknown command\n";
+    return reply(CacheOpcode::ERROR, "Unknown command\n");
 }
 
 void CacheDaemon::setMaxPositiveEntries(size_t size) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    max_positive_entries_ = size;
+    positive_cache_.setMaxEntries(size);
 }
 
 void CacheDaemon::setMaxNegativeEntries(size_t size) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    max_negative_entries_ = size;
+    negative_cache_.setMaxEntries(size);
+}
+
+void CacheDaemon::setMemoryLimit(size_t bytes) {
+    size_t negative = bytes / 8;
+    positive_cache_.setMaxBytes(bytes - negative);
+    negative_cache_.setMaxBytes(negative);
+}
+
+void CacheDaemon::setStaleWindow(uint32_t seconds) {
+    positive_cache_.setStaleWindow(seconds);
+    negative_cache_.setStaleWindow(seconds);
+}
+
+void CacheDaemon::saveSnapshot() {
+    if (config_.snapshot_path.empty()) {
+        return;
+    }
+    
+    try {
+        size_t saved = CacheSnapshot::save(config_.snapshot_path, positive_cache_, negative_cache_);
+        std::cout << "Snapshot saved: " << saved << " entries" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Snapshot save failed: " << e.what() << std::endl;
+    }
+}
+
+void CacheDaemon::loadSnapshot() {
+    if (config_.snapshot_path.empty()) {
+        return;
+    }
+    
+    // Snapshot corrompido: mantém o que foi carregado até o erro
+    try {
+        size_t loaded = CacheSnapshot::load(config_.snapshot_path, positive_cache_, negative_cache_);
+        std::cout << "Snapshot loaded: " << loaded << " entries" << std::endl;
+        
+        if (shared_) {
+            positive_cache_.forEach([this](const CacheKey& key, const CacheEntry& entry) {
+                publishShared(key, entry, false);
+            });
+            negative_cache_.forEach([this](const CacheKey& key, const CacheEntry& entry) {
+                publishShared(key, entry, true);
+            });
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Snapshot load failed: " << e.what() << std::endl;
+    }
+}
+
+void CacheDaemon::publishShared(const CacheKey& key, const CacheEntry& entry, bool negative) {
+    if (shared_) {
+        shared_->publish(key.qname, key.qtype, key.qclass, negative, entry.rcode,
+                         entry.wire, entry.timestamp, entry.ttl);
+    }
 }
 
 size_t CacheDaemon::purgePositiveCache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    size_t count = positive_cache_.size();
-    positive_cache_.clear();
-    return count;
+    if (shared_) {
+        shared_->clear(true, false);
+    }
+    return positive_cache_.clear();
 }
 
 size_t CacheDaemon::purgeNegativeCache() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    size_t count = negative_cache_.size();
-    negative_cache_.clear();
-    return count;
+    if (shared_) {
+        shared_->clear(false, true);
+    }
+    return negative_cache_.clear();
 }
 
 size_t CacheDaemon::flushAll() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
-    size_t count = positive_cache_.size() + negative_cache_.size();
-    positive_cache_.clear();
-    negative_cache_.clear();
-    return count;
+    if (shared_) {
+        shared_->clear(true, true);
+    }
+    return positive_cache_.clear() + negative_cache_.clear();
 }
 
 size_t CacheDaemon::getPositiveCacheSize() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
     return positive_cache_.size();
 }
 
 size_t CacheDaemon::getNegativeCacheSize() const {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
     return negative_cache_.size();
 }
 
-void CacheDaemon::cleanupExpiredEntries() {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+bool CacheDaemon::cleanupExpiredEntries() {
+    // Custo limitado por passo: só itens vencidos no topo de cada heap
+    positive_cache_.expireDue(EXPIRY_BUDGET_PER_SHARD);
+    negative_cache_.expireDue(EXPIRY_BUDGET_PER_SHARD);
     
-    // Limpar cache positivo expirado
-    for (auto it = positive_cache_.begin(); it != positive_cache_.end(); ) {
-        if (it->second.isExpired()) {
-            it = positive_cache_.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    
-    // Limpar cache negativo expirado
-    for (auto it = negative_cache_.begin(); it != negative_cache_.end(); ) {
-        if (it->second.isExpired()) {
-            it = negative_cache_.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    return positive_cache_.hasDue() || negative_cache_.hasDue();
 }
 
-// ==========  ARMAZENAMENTO E SERIALIZAÇÃO ==========
+// ========== PREFETCH ==========
 
-void CacheDaemon::addToCachePositive(
-    const dns_resolver::DNSQuestion& question,
-    const CacheEntry& entry
-) {
-    std::lock_guard<std::mutex> lock(cache_mutex_);
+void CacheDaemon::prepareHit(const CacheKey& key, CacheEntry& entry, time_t now) {
+    checkPrefetch(key, entry, now);
     
-    // Limpar entradas expiradas primeiro
-    for (auto it = positive_cache_.begin(); it != positive_cache_.end(); ) {
-        if (it->second.isExpired()) {
-            it = positive_cache_.erase(it);
-        } else {
-            ++it;
-        }
+    // entry é cópia: TTLs reescritos com o tempo restante
+    entry.ageTTLs(now);
+}
+
+void CacheDaemon::checkPrefetch(const CacheKey& key, const CacheEntry& entry, time_t now) {
+    // Entrada popular perto de expirar: renovar em background
+    if (entry.needsPrefetch(now, config_.prefetch_min_hits, config_.prefetch_window)) {
+        // Respostas validadas (AD=1) são renovadas com DNSSEC
+        bool dnssec = (static_cast<uint8_t>(entry.wire[3]) & 0x20) != 0;
+        schedulePrefetch(key, dnssec);
+    }
+}
+
+void CacheDaemon::sampleSharedHits() {
+    if (!shared_) {
+        return;
     }
     
-    // Verificar tamanho e aplicar política LRU
-    if (positive_cache_.size() >= max_positive_entries_) {
-        // Encontrar entrada mais antiga (menor timestamp)
-        auto oldest = positive_cache_.begin();
-        for (auto it = positive_cache_.begin(); it != positive_cache_.end(); ++it) {
-            if (it->second.timestamp < oldest->second.timestamp) {
-                oldest = it;
-            }
+    // HITs servidos pela memória compartilhada contam como consultas ao
+    // daemon: popularidade (prefetch), frequência (admissão) e recência
+    time_t now = std::time(nullptr);
+    for (const auto& sample : shared_->drainHits()) {
+        CacheKey key(sample.qname, sample.qtype, sample.qclass);
+        CacheEntry entry;
+        CacheTable& table = sample.negative ? negative_cache_ : positive_cache_;
+        if (table.recordHits(key, sample.hits, entry) && !sample.negative) {
+            checkPrefetch(key, entry, now);
         }
-        positive_cache_.erase(oldest);
+        shared_hits_ += sample.hits;
     }
-    
-    // Adicionar nova entrada
-    positive_cache_[question] = entry;
 }
 
-std::string CacheDaemon::serializeMessage(const dns_resolver::DNSMessage& msg) const {
-    std::ostringstream oss;
-    
-    // Serializar header básico
-    oss << "rcode:" << static_cast<int>(msg.header.rcode) << ";";
-    
-    // Serializar answers (formato: name|type|ttl|rdata##name|type|ttl|rdata)
-    oss << "answers:";
+void CacheDaemon::schedulePrefetch(const CacheKey& key, bool dnssec) {
+    // O resolver embutido só consulta a classe IN
+    if (!prefetch_pool_ || key.qclass != dns_resolver::DNSClass::IN) {
+        return;
+    }
     
-    bool first = true;
-    for (const auto& rr : msg.answers) {
-        // Serializar apenas tipos suportados (pular DNSSEC por enquanto)
-        if (rr.type == dns_resolver::DNSType::RRSIG || 
-            rr.type == dns_resolver::DNSType::DNSKEY || 
-            rr.type == dns_resolver::DNSType::DS ||
-            rr.type == dns_resolver::DNSType::OPT) {
-            continue;  // Pular registros DNSSEC
-        }
-        
-        if (!first) {
-            oss << "##";
-        }
-        first = false;
-        
-        oss << rr.name << "|" << rr.type << "|" << rr.ttl << "|";
-        
-        // Serializar RDATA baseado no tipo
-        if (rr.type == dns_resolver::DNSType::A && !rr.rdata_a.empty()) {
-            oss << rr.rdata_a;
-        } else if (rr.type == dns_resolver::DNSType::NS && !rr.rdata_ns.empty()) {
-            oss << rr.rdata_ns;
-        } else if (rr.type == dns_resolver::DNSType::CNAME && !rr.rdata_cname.empty()) {
-            oss << rr.rdata_cname;
-        } else if (rr.type == dns_resolver::DNSType::AAAA && !rr.rdata_aaaa.empty()) {
-            oss << rr.rdata_aaaa;
-        } else {
-            oss << "";
+    std::string id = key.qname + "|" + std::to_string(key.qtype);
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        if (prefetch_inflight_.size() >= PREFETCH_MAX_INFLIGHT ||
+            !prefetch_inflight_.insert(id).second) {
+            return;
         }
     }
     
-    return oss.str();
+    try {
+        prefetch_pool_->enqueue([this, key, dnssec, id] {
+            refreshEntry(key, dnssec);
+            std::lock_guard<std::mutex> lock(prefetch_mutex_);
+            prefetch_inflight_.erase(id);
+        });
+    } catch (const std::exception&) {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        prefetch_inflight_.erase(id);
+    }
 }
 
-dns_resolver::DNSMessage CacheDaemon::deserializeMessage(const std::string& data) const {
-    dns_resolver::DNSMessage msg;
-    
-    // Remover newline se existir
-    std::string clean_data = data;
-    if (!clean_data.empty() && clean_data.back() == '\n') {
-        clean_data.pop_back();
+void CacheDaemon::refreshEntry(const CacheKey& key, bool dnssec) {
+    if (!running_) {
+        return;
     }
     
-    // Parsear campos separados por ;
-    std::istringstream iss(clean_data);
-    std::string field;
-    
-    while (std::getline(iss, field, ';')) {
-        size_t colon_pos = field.find(':');
-        if (colon_pos == std::string::npos) continue;
+    try {
+        dns_resolver::ResolverConfig config;
+        config.use_cache = false;  // Não consultar o próprio daemon
+        config.dnssec_enabled = dnssec;
+        config.quiet_mode = true;
         
-        std::string key = field.substr(0, colon_pos);
-        std::string value = field.substr(colon_pos + 1);
+        dns_resolver::ResolverEngine engine(config, resolver_context_);
+        dns_resolver::DNSMessage result = engine.resolve(key.qname, key.qtype);
         
-        if (key == "rcode") {
-            msg.header.rcode = std::stoi(value);
-            msg.header.qr = true;
-        } else if (key == "answers") {
-            // Parsear answers (formato: name|type|ttl|rdata##name|type|ttl|rdata)
-            std::istringstream ans_stream(value);
-            std::string rr_str;
-            
-            while (std::getline(ans_stream, rr_str, '#')) {
-                if (rr_str.empty() || rr_str == "#") continue;
-                
-                // Parsear RR individual (name|type|ttl|rdata)
-                std::istringstream rr_stream(rr_str);
-                std::string rr_field;
-                std::vector<std::string> rr_parts;
-                
-                while (std::getline(rr_stream, rr_field, '|')) {
-                    rr_parts.push_back(rr_field);
-                }
-                
-                if (rr_parts.size() >= 4) {
-                    dns_resolver::DNSResourceRecord rr;
-                    rr.name = rr_parts[0];
-                    rr.type = std::stoi(rr_parts[1]);
-                    rr.ttl = std::stoi(rr_parts[2]);
-                    rr.rr_class = dns_resolver::DNSClass::IN;
-                    
-                    // Deserializar RDATA baseado no tipo
-                    if (rr.type == dns_resolver::DNSType::A) {
-                        rr.rdata_a = rr_parts[3];
-                    } else if (rr.type == dns_resolver::DNSType::NS) {
-                        rr.rdata_ns = rr_parts[3];
-                    } else if (rr.type == dns_resolver::DNSType::CNAME) {
-                        rr.rdata_cname = rr_parts[3];
-                    } else if (rr.type == dns_resolver::DNSType::AAAA) {
-                        rr.rdata_aaaa = rr_parts[3];
-                    }
-                    
-                    msg.answers.push_back(rr);
-                }
-            }
+        // Só respostas positivas substituem a entrada; as demais expiram normalmente
+        if (result.header.rcode != 0 || result.answers.empty()) {
+            return;
+        }
+        
+        CacheEntry entry(
+            dns_resolver::CacheClient::serializeForCache(result),
+            result.header.rcode,
+            dns_resolver::CacheClient::cacheTTL(result)
+        );
+        if (positive_cache_.insert(key, entry)) {
+            publishShared(key, entry, false);
         }
+        prefetch_count_++;
+    } catch (const std::exception& e) {
+        std::cerr << "Prefetch failed for " << key.qname << ": " << e.what() << std::endl;
     }
-    
-    // Atualizar contadores do header
-    msg.header.ancount = msg.answers.size();
-    msg.header.qdcount = 1;  // Sempre 1 question
-    
-    return msg;
 }
 
 } // namespace dns_cache
-
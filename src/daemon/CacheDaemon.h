@@ -11,42 +11,48 @@
 #pragma once
 
 #include "dns_resolver/types.h"
-#include <map>
+#include "dns_resolver/ThreadPool.h"
+#include "dns_resolver/CacheProtocol.h"
+#include "dns_resolver/SharedCache.h"
+#include "dns_resolver/ResolverContext.h"
+#include "CacheTable.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <ctime>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace dns_cache {
 
-// Entrada de cache com timestamp e TTL
-struct CacheEntry {
-    dns_resolver::DNSMessage response;
-    time_t timestamp;
-    uint32_t ttl;
-    
-    CacheEntry() : timestamp(0), ttl(0) {}
-    
-    CacheEntry(const dns_resolver::DNSMessage& resp, uint32_t t)
-        : response(resp), timestamp(std::time(nullptr)), ttl(t) {}
-    
-    // Verifica se entrada expirou
-    bool isExpired() const {
-        return (std::time(nullptr) - timestamp) > static_cast<time_t>(ttl);
-    }
-    
-    // Retorna tempo restante de vida em segundos
-    uint32_t getRemainingTTL() const {
-        time_t elapsed = std::time(nullptr) - timestamp;
-        if (elapsed >= static_cast<time_t>(ttl)) {
-            return 0;
-        }
-        return ttl - static_cast<uint32_t>(elapsed);
-    }
+// Configuração de concorrência do daemon
+struct DaemonConfig {
+    int listen_backlog = 256;        // Backlog do listen()
+    size_t max_connections = 1024;   // Conexões simultâneas (excedentes aguardam no backlog)
+    size_t worker_threads = 4;       // Workers que executam comandos
+    size_t memory_limit = 64 * 1024 * 1024;  // Orçamento de memória das entradas (bytes)
+    uint32_t prefetch_min_hits = 5;  // HITs para uma entrada ser considerada popular
+    uint32_t prefetch_window = 10;   // Renovar nos últimos N% do TTL (0 desativa)
+    size_t prefetch_threads = 2;     // Resoluções de prefetch/renovação simultâneas
+    // Segundos que uma entrada expirada fica servível (0 desativa); 1 dia,
+    // dentro dos 1-3 dias da RFC 8767. O estoque stale não tem orçamento
+    // próprio: usa só a sobra de memory_limit e sai antes das entradas vivas
+    uint32_t stale_window = 86400;
+    std::string snapshot_path = "/tmp/dns_cache.d/dns_cache.snapshot";  // Snapshot (diretório privado; vazio desativa)
+    uint32_t snapshot_interval = 300;  // Segundos entre snapshots periódicos (0 = só ao encerrar)
+    size_t shm_slots = 0;            // Slots do espelho em memória compartilhada (0 desativa)
+    bool admission = true;           // Filtro de admissão TinyLFU no cache positivo
 };
 
 // Daemon de cache DNS distribuído
 // Roda em background e gerencia cache de respostas DNS
 // Comunicação via Unix Domain Socket (/tmp/dns_cache.sock)
+// Loop de eventos epoll multiplexa as conexões; comandos rodam no pool de workers
+// Conexões são persistentes e aceitam vários frames em andamento (ver CacheProtocol)
 class CacheDaemon {
 public:
     CacheDaemon();
@@ -58,12 +64,23 @@ public:
     // Para o daemon gracefully
     void stop();
     
+    // Pede o fim do loop principal (seguro em handler de sinal); run()
+    // encerra, grava o snapshot e retorna
+    void requestStop();
+    
+    // Configura backlog, limite de conexões e workers (antes de run())
+    void setConfig(const DaemonConfig& config);
+    
     // Configura tamanho máximo do cache positivo
     void setMaxPositiveEntries(size_t size);
     
     // Configura tamanho máximo do cache negativo
     void setMaxNegativeEntries(size_t size);
     
+    // Configura orçamento de memória (bytes), dividido entre os caches:
+    // 1/8 para o negativo (entradas só com RCODE) e o restante para o positivo
+    void setMemoryLimit(size_t bytes);
+    
     // Limpa cache positivo
     size_t purgePositiveCache();
     
@@ -83,44 +100,130 @@ private:
     // Cria Unix Domain Socket
     int createSocket();
     
-    // Processa conexão de cliente
-    void handleClient(int client_socket);
+    // Estado de uma conexão de cliente no loop de eventos
+    struct Connection {
+        uint64_t id = 0;
+        std::string inbuf;
+        std::string outbuf;
+        size_t written = 0;
+        size_t pending = 0;        // Comandos em execução nos workers
+        bool peer_closed = false;
+        bool want_write = false;   // EPOLLOUT registrado
+    };
+    
+    // Resposta (frame completo) produzida por um worker, devolvida ao loop de eventos
+    struct Completion {
+        int fd;
+        uint64_t id;
+        std::string response;
+    };
+    
+    // Aceita conexões pendentes (respeitando o limite)
+    void acceptConnections();
+    
+    // Lê dados disponíveis e despacha cada frame completo ao pool
+    void readFromClient(int fd);
+    
+    // Envia respostas enfileiradas na conexão
+    void writeToClient(int fd);
+    
+    // Fecha a conexão se o cliente encerrou e nada mais está pendente
+    void maybeFinishConnection(int fd);
+    
+    // Aplica respostas concluídas pelos workers
+    void drainCompletions();
+    
+    // Fecha conexão e reativa accept se estava no limite
+    void closeConnection(int fd);
+    
+    // Ajusta eventos do socket de escuta conforme o limite de conexões
+    void updateListenInterest();
+    
+    // Processa requisição e devolve o frame de resposta
+    std::string processCommand(
+        const dns_resolver::CacheFrameHeader& header,
+        std::string_view payload
+    );
     
-    // Processa comando recebido
-    std::string processCommand(const std::string& command);
+    // HIT positivo: agenda prefetch se a entrada for popular e estiver perto
+    // de expirar; reescreve os TTLs da cópia com o tempo restante
+    void prepareHit(const CacheKey& key, CacheEntry& entry, time_t now);
     
-    // Remove entradas expiradas
-    void cleanupExpiredEntries();
+    // Agenda a renovação se a entrada for popular e estiver perto de expirar
+    void checkPrefetch(const CacheKey& key, const CacheEntry& entry, time_t now);
     
-    // Adiciona entrada ao cache positivo com política LRU
-    void addToCachePositive(
-        const dns_resolver::DNSQuestion& question,
-        const CacheEntry& entry
-    );
+    // Conta nas tabelas os HITs atendidos pela memória compartilhada
+    void sampleSharedHits();
+    
+    // Remove um lote de entradas expiradas (retorna true se ainda há vencidas)
+    bool cleanupExpiredEntries();
+    
+    // Thread de manutenção: drena os heaps de expiração incrementalmente
+    void housekeepingLoop();
+    
+    // Agenda renovação em background de uma entrada popular ou servida stale (sem duplicatas)
+    void schedulePrefetch(const CacheKey& key, bool dnssec);
+    
+    // Resolve a chave sem passar pelo cache e substitui a entrada positiva
+    void refreshEntry(const CacheKey& key, bool dnssec);
     
-    // Serializa DNSMessage para IPC
-    std::string serializeMessage(const dns_resolver::DNSMessage& msg) const;
+    // Aplica a janela stale aos dois caches
+    void setStaleWindow(uint32_t seconds);
     
-    // Deserializa DNSMessage do IPC
-    dns_resolver::DNSMessage deserializeMessage(const std::string& data) const;
+    // Publica a entrada no espelho em memória compartilhada (se ativo)
+    void publishShared(const CacheKey& key, const CacheEntry& entry, bool negative);
     
-    // Armazenamento
-    std::map<dns_resolver::DNSQuestion, CacheEntry> positive_cache_;
-    std::map<dns_resolver::DNSQuestion, CacheEntry> negative_cache_;
+    // Grava / carrega o snapshot dos caches (erros só são registrados)
+    void saveSnapshot();
+    void loadSnapshot();
     
-    // Thread-safety
-    mutable std::mutex cache_mutex_;
+    // Limite de entradas padrão (a capacidade efetiva vem do orçamento de memória)
+    static constexpr size_t DEFAULT_MAX_ENTRIES = 100000;
     
-    // Configuração
-    size_t max_positive_entries_ = 50;
-    size_t max_negative_entries_ = 50;
+    // Armazenamento (shards com lock próprio; LRU O(1) por shard)
+    CacheTable positive_cache_{DEFAULT_MAX_ENTRIES};
+    CacheTable negative_cache_{DEFAULT_MAX_ENTRIES};
     
     // Estado do daemon
-    bool running_ = false;
+    std::atomic<bool> running_{false};
     int server_socket_ = -1;
+    DaemonConfig config_;
+    
+    // Loop de eventos
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;                       // eventfd sinalizado pelos workers
+    std::unordered_map<int, Connection> connections_;
+    uint64_t next_connection_id_ = 1;
+    bool accepting_ = true;
+    std::unique_ptr<dns_resolver::ThreadPool> workers_;
+    std::mutex completion_mutex_;
+    std::vector<Completion> completions_;
+    
+    // Prefetch de entradas populares (resolver iterativo embutido)
+    std::unique_ptr<dns_resolver::ThreadPool> prefetch_pool_;
+    std::shared_ptr<dns_resolver::ResolverContext> resolver_context_;   // Trust anchors e DNSKEY/DS das renovações
+    std::mutex prefetch_mutex_;
+    std::unordered_set<std::string> prefetch_inflight_;
+    std::atomic<uint64_t> prefetch_count_{0};
+    std::atomic<uint64_t> stale_served_{0};
+    
+    // Espelho somente leitura para os resolvers (escrito só pelo daemon)
+    std::unique_ptr<dns_resolver::SharedCache> shared_;
+    std::atomic<uint64_t> shared_hits_{0};   // HITs amostrados do espelho
+    
+    // Manutenção em background
+    std::thread housekeeping_thread_;
+    std::mutex housekeeping_mutex_;
+    std::condition_variable housekeeping_cv_;
     
     // Constantes
     static const char* SOCKET_PATH;
+    static constexpr int HOUSEKEEPING_INTERVAL_MS = 1000;
+    static constexpr size_t EXPIRY_BUDGET_PER_SHARD = 256;
+    static constexpr int MAX_EVENTS = 64;
+    static constexpr int EVENT_TIMEOUT_MS = 1000;
+    static constexpr size_t PREFETCH_MAX_INFLIGHT = 64;
+    static constexpr uint32_t STALE_ANSWER_TTL = 30;  // TTL das respostas stale (RFC 8767)
 };
 
 } // namespace dns_cache
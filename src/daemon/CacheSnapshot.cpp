@@ -0,0 +1,239 @@
+/*
+ * ----------------------------------------
+ * Arquivo: CacheSnapshot.cpp
+ * Propósito: Gravação e carga (mmap) do snapshot das tabelas de cache
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "CacheSnapshot.h"
+#include "dns_resolver/CacheProtocol.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+
+using dns_resolver::CacheFrameHeader;
+using dns_resolver::CacheMessageReader;
+using dns_resolver::CacheMessageWriter;
+using dns_resolver::CacheOpcode;
+using dns_resolver::CacheProtocol;
+
+namespace dns_cache {
+
+// ========== GRAVAÇÃO ==========
+
+namespace {
+
+constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+bool writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t n = write(fd, data.data() + offset, data.size() - offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Grava as entradas de uma tabela como frames (opcode indica a tabela),
+// acumulados em buffer e escritos em blocos
+size_t writeTable(int fd, std::string& buffer, bool& ok, CacheTable& table, CacheOpcode opcode) {
+    size_t written = 0;
+    table.forEach([&](const CacheKey& key, const CacheEntry& entry) {
+        buffer += CacheMessageWriter(opcode)
+            .putString(key.qname)
+            .putU16(key.qtype)
+            .putU16(key.qclass)
+            .putU64(static_cast<uint64_t>(entry.timestamp + static_cast<time_t>(entry.ttl)))
+            .putU32(entry.ttl)
+            .putU32(entry.hits)
+            .putU8(entry.rcode)
+            .putBlob(entry.wire)
+            .finish();
+        if (buffer.size() >= WRITE_BUFFER_SIZE) {
+            ok = ok && writeAll(fd, buffer);
+            buffer.clear();
+        }
+        written++;
+    });
+    return written;
+}
+
+std::string parentDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        return ".";
+    }
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+// Diretório do snapshot: criado privado (0700) se não existir; um existente
+// não pode ser gravável por outros usuários, exceto com sticky bit (/var/tmp),
+// onde ninguém mais renomeia ou apaga os arquivos do daemon
+void checkDirectory(const std::string& dir) {
+    if (mkdir(dir.c_str(), 0700) < 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create snapshot directory: " + dir);
+    }
+    struct stat st;
+    if (lstat(dir.c_str(), &st) < 0 || !S_ISDIR(st.st_mode)) {
+        throw std::runtime_error("Invalid snapshot directory: " + dir);
+    }
+    if ((st.st_mode & (S_IWGRP | S_IWOTH)) != 0 && (st.st_mode & S_ISVTX) == 0) {
+        throw std::runtime_error("Snapshot directory is writable by others: " + dir);
+    }
+}
+
+} // namespace
+
+size_t CacheSnapshot::save(const std::string& path, CacheTable& positive, CacheTable& negative) {
+    std::string dir = parentDirectory(path);
+    checkDirectory(dir);
+
+    // Temporário exclusivo (mkstemp: O_CREAT | O_EXCL, 0600) no mesmo
+    // diretório e rename: um snapshot antigo nunca fica pela metade e um
+    // link simbólico plantado no caminho não é seguido
+    std::string tmp_path = path + ".XXXXXX";
+    int fd = mkstemp(&tmp_path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create snapshot file: " + tmp_path);
+    }
+
+    std::string buffer(SIGNATURE);
+    buffer.reserve(WRITE_BUFFER_SIZE * 2);
+    bool ok = true;
+    size_t written = writeTable(fd, buffer, ok, positive, CacheOpcode::STORE);
+    written += writeTable(fd, buffer, ok, negative, CacheOpcode::STORE_NEGATIVE);
+    ok = ok && writeAll(fd, buffer);
+
+    // Dados no disco antes do rename: uma queda não deixa o snapshot vazio
+    ok = ok && fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+    if (!ok) {
+        unlink(tmp_path.c_str());
+        throw std::runtime_error("Failed to write snapshot file: " + tmp_path);
+    }
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        unlink(tmp_path.c_str());
+        throw std::runtime_error("Failed to replace snapshot file: " + path);
+    }
+
+    // Persistir a entrada de diretório do rename
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return written;
+}
+
+// ========== CARGA ==========
+
+namespace {
+
+size_t loadEntries(std::string_view data, CacheTable& positive, CacheTable& negative) {
+    if (data.substr(0, CacheSnapshot::SIGNATURE.size()) != CacheSnapshot::SIGNATURE) {
+        throw std::runtime_error("Invalid snapshot signature");
+    }
+
+    time_t now = std::time(nullptr);
+    size_t offset = CacheSnapshot::SIGNATURE.size();
+    size_t loaded = 0;
+    CacheFrameHeader header;
+    std::string_view payload;
+
+    while (CacheProtocol::extractFrame(data, offset, header, payload)) {
+        CacheTable* table;
+        if (header.opcode == CacheOpcode::STORE) {
+            table = &positive;
+        } else if (header.opcode == CacheOpcode::STORE_NEGATIVE) {
+            table = &negative;
+        } else {
+            throw std::runtime_error("Invalid record in snapshot");
+        }
+
+        CacheMessageReader reader(payload);
+        std::string_view qname = reader.getString();
+        uint16_t qtype = reader.getU16();
+        uint16_t qclass = reader.getU16();
+        time_t expires_at = static_cast<time_t>(reader.getU64());
+        uint32_t ttl = reader.getU32();
+        uint32_t hits = reader.getU32();
+        uint8_t rcode = reader.getU8();
+        std::string_view wire = reader.getBlob();
+
+        // Vencida enquanto o daemon estava parado (além da janela stale)
+        if (now > expires_at + static_cast<time_t>(table->staleWindow())) {
+            continue;
+        }
+
+        // Expiração absoluta: timestamp reconstruído a partir do TTL original
+        CacheEntry entry(std::string(wire), rcode, ttl);
+        entry.timestamp = expires_at - static_cast<time_t>(ttl);
+        entry.hits = hits;
+        table->insert(CacheKey(qname, qtype, qclass), entry);
+        loaded++;
+    }
+
+    if (offset != data.size()) {
+        throw std::runtime_error("Truncated snapshot");
+    }
+    return loaded;
+}
+
+} // namespace
+
+size_t CacheSnapshot::load(const std::string& path, CacheTable& positive, CacheTable& negative) {
+    // O_NOFOLLOW: link simbólico no caminho é recusado (ELOOP)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        throw std::runtime_error("Cannot open snapshot file: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) ||
+        st.st_size < static_cast<off_t>(SIGNATURE.size())) {
+        close(fd);
+        throw std::runtime_error("Invalid snapshot file: " + path);
+    }
+
+    // Entradas carregadas são servidas a todos os clientes: só um arquivo
+    // do próprio daemon, que nenhum outro usuário pode ter alterado
+    if (st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        close(fd);
+        throw std::runtime_error("Snapshot file not owned by the daemon or writable by others: " + path);
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Cannot map snapshot file: " + path);
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    // Frames lidos direto do mapeamento (sem copiar o arquivo)
+    try {
+        size_t loaded = loadEntries(std::string_view(static_cast<const char*>(map), size),
+                                    positive, negative);
+        munmap(map, size);
+        return loaded;
+    } catch (...) {
+        munmap(map, size);
+        throw;
+    }
+}
+
+} // namespace dns_cache
@@ -0,0 +1,45 @@
+/*
+ * ----------------------------------------
+ * Arquivo: CacheSnapshot.h
+ * Propósito: Snapshot binário das tabelas de cache para reinício a quente do daemon
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include "CacheTable.h"
+#include <string>
+#include <string_view>
+
+namespace dns_cache {
+
+// Snapshot das tabelas positiva e negativa em arquivo
+// Formato: assinatura de 8 bytes seguida de um frame do CacheProtocol por
+// entrada (STORE / STORE_NEGATIVE), com payload:
+//   str qname, u16 qtype, u16 qclass, u64 expira_em (epoch absoluto),
+//   u32 ttl, u32 hits, u8 rcode, blob wire
+// Entradas são gravadas da menos para a mais recente de cada shard, de
+// modo que a carga reproduz a ordem LRU.
+class CacheSnapshot {
+public:
+    static constexpr std::string_view SIGNATURE{"DCSNAP1\n", 8};
+
+    // Grava as duas tabelas em path (temporário exclusivo + fsync + rename
+    // atômico); o diretório é criado com 0700 se não existir
+    // Retorna o número de entradas gravadas
+    // Lança std::runtime_error se o arquivo não puder ser escrito ou se o
+    // diretório for gravável por outros usuários (sem sticky bit)
+    static size_t save(const std::string& path, CacheTable& positive, CacheTable& negative);
+
+    // Carrega o snapshot via mmap, descartando entradas vencidas (além da
+    // janela stale de cada tabela); retorna o número de entradas carregadas
+    // Arquivo inexistente carrega 0 entradas
+    // Lança std::runtime_error se o arquivo estiver corrompido ou truncado,
+    // for link simbólico, de outro dono ou gravável por grupo/outros
+    static size_t load(const std::string& path, CacheTable& positive, CacheTable& negative);
+};
+
+} // namespace dns_cache
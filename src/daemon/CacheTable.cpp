@@ -0,0 +1,1000 @@
+/*
+ * ----------------------------------------
+ * Arquivo: CacheTable.cpp
+ * Propósito: Implementação da tabela de cache particionada com LRU O(1)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "CacheTable.h"
+#include "dns_resolver/SharedCache.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace dns_cache {
+
+// ========== TTL NO WIRE FORMAT ==========
+
+namespace {
+
+uint16_t wireU16(std::string_view wire, size_t pos) {
+    return static_cast<uint16_t>((static_cast<uint8_t>(wire[pos]) << 8) |
+                                 static_cast<uint8_t>(wire[pos + 1]));
+}
+
+// Avança pos sobre um nome (labels ou ponteiro de compressão)
+void skipName(std::string_view wire, size_t& pos) {
+    while (true) {
+        if (pos >= wire.size()) {
+            throw std::runtime_error("Truncated name in cached response");
+        }
+        uint8_t len = static_cast<uint8_t>(wire[pos]);
+        if (len == 0) {
+            pos += 1;
+            return;
+        }
+        if ((len & 0xC0) == 0xC0) {
+            pos += 2;
+            return;
+        }
+        if ((len & 0xC0) != 0) {
+            throw std::runtime_error("Invalid label in cached response");
+        }
+        pos += 1 + len;
+    }
+}
+
+void writeU32(std::string& wire, size_t pos, uint32_t value) {
+    wire[pos] = static_cast<char>((value >> 24) & 0xFF);
+    wire[pos + 1] = static_cast<char>((value >> 16) & 0xFF);
+    wire[pos + 2] = static_cast<char>((value >> 8) & 0xFF);
+    wire[pos + 3] = static_cast<char>(value & 0xFF);
+}
+
+uint32_t readU32(const std::string& wire, size_t pos) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(wire[pos])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(wire[pos + 1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(wire[pos + 2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(wire[pos + 3]));
+}
+
+constexpr uint16_t TYPE_OPT = 41;
+
+} // namespace
+
+std::vector<uint32_t> findTTLOffsets(std::string_view wire) {
+    if (wire.size() < 12) {
+        throw std::runtime_error("Cached response shorter than DNS header");
+    }
+
+    uint16_t qdcount = wireU16(wire, 4);
+    size_t rrcount = static_cast<size_t>(wireU16(wire, 6)) + wireU16(wire, 8) + wireU16(wire, 10);
+    size_t pos = 12;
+
+    for (uint16_t i = 0; i < qdcount; i++) {
+        skipName(wire, pos);
+        pos += 4;  // QTYPE + QCLASS
+    }
+
+    std::vector<uint32_t> offsets;
+    offsets.reserve(rrcount);
+    for (size_t i = 0; i < rrcount; i++) {
+        skipName(wire, pos);
+        // TYPE(2) CLASS(2) TTL(4) RDLENGTH(2)
+        if (pos + 10 > wire.size()) {
+            throw std::runtime_error("Truncated record in cached response");
+        }
+        uint16_t type = wireU16(wire, pos);
+        uint16_t rdlength = wireU16(wire, pos + 8);
+        if (type != TYPE_OPT) {
+            offsets.push_back(static_cast<uint32_t>(pos + 4));
+        }
+        pos += 10 + rdlength;
+    }
+
+    if (pos > wire.size()) {
+        throw std::runtime_error("Truncated RDATA in cached response");
+    }
+    return offsets;
+}
+
+void CacheEntry::ageTTLs(time_t now) {
+    time_t elapsed = now - timestamp;
+    if (elapsed <= 0) {
+        return;
+    }
+
+    for (uint32_t offset : ttl_offsets) {
+        uint32_t original = readU32(wire, offset);
+        uint32_t remaining = (static_cast<time_t>(original) > elapsed)
+            ? original - static_cast<uint32_t>(elapsed) : 0;
+        writeU32(wire, offset, remaining);
+    }
+}
+
+void CacheEntry::rewriteTTLs(uint32_t value) {
+    for (uint32_t offset : ttl_offsets) {
+        writeU32(wire, offset, value);
+    }
+}
+
+// ========== CHAVE ==========
+
+// Mesma normalização e hash dos leitores da memória compartilhada (SharedCache)
+CacheKey::CacheKey(std::string_view name, uint16_t type, uint16_t cls)
+    : qname(dns_resolver::normalizeCacheName(name)), qtype(type), qclass(cls),
+      hash(dns_resolver::cacheKeyHash(qname, type, cls)) {}
+
+// ========== SHARD ==========
+
+namespace {
+
+// Bytes alocados fora do objeto (strings curtas ficam no buffer interno)
+size_t heapBytes(const std::string& s) {
+    static const size_t inline_capacity = std::string().capacity();
+    return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+}
+
+} // namespace
+
+size_t CacheShard::entryBytes(const CacheKey& key, const CacheEntry& entry) {
+    return sizeof(Node) + sizeof(ExpiryItem) +
+           heapBytes(key.qname) + heapBytes(entry.wire) +
+           entry.ttl_offsets.capacity() * sizeof(uint32_t);
+}
+
+CacheShard::CacheShard(size_t max_entries)
+    : max_entries_(max_entries) {
+    rehash(16);
+}
+
+int64_t CacheShard::findSlot(const CacheKey& key) const {
+    size_t mask = slots_.size() - 1;
+    size_t i = static_cast<size_t>(key.hash) & mask;
+
+    for (size_t probes = 0; probes < slots_.size(); probes++) {
+        int32_t s = slots_[i];
+        if (s == EMPTY) {
+            return -1;
+        }
+        if (s >= 0 && nodes_[s].key == key) {
+            return static_cast<int64_t>(i);
+        }
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+const CacheEntry* CacheShard::lookup(const CacheKey& key, uint32_t hits) {
+    int64_t slot = findSlot(key);
+    if (slot < 0) {
+        return nullptr;
+    }
+
+    int32_t idx = slots_[slot];
+
+    // Expirada: remover agora se já passou da janela stale (evita varredura
+    // completa); dentro da janela, é MISS mas fica para lookupStale
+    if (nodes_[idx].entry.isExpired()) {
+        if (nodes_[idx].entry.isPastStaleWindow(std::time(nullptr), stale_window_)) {
+            erase(idx);
+        }
+        return nullptr;
+    }
+
+    // HIT: contar (popularidade para prefetch) e promover para mais recente
+    uint32_t& count = nodes_[idx].entry.hits;
+    count = (hits > UINT32_MAX - count) ? UINT32_MAX : count + hits;
+    if (idx != head_) {
+        unlink(idx);
+        pushFront(idx);
+    }
+
+    return &nodes_[idx].entry;
+}
+
+const CacheEntry* CacheShard::lookupStale(const CacheKey& key) {
+    int64_t slot = findSlot(key);
+    if (slot < 0) {
+        return nullptr;
+    }
+
+    int32_t idx = slots_[slot];
+    if (nodes_[idx].entry.isPastStaleWindow(std::time(nullptr), stale_window_)) {
+        erase(idx);
+        return nullptr;
+    }
+    return &nodes_[idx].entry;
+}
+
+void CacheShard::insert(const CacheKey& key, const CacheEntry& entry) {
+    if (max_entries_ == 0) {
+        return;
+    }
+
+    // Substituição de entrada existente
+    int64_t slot = findSlot(key);
+    if (slot >= 0) {
+        int32_t idx = slots_[slot];
+        uint32_t hits = nodes_[idx].entry.hits;
+        nodes_[idx].entry = entry;
+        nodes_[idx].entry.hits = hits;
+        nodes_[idx].entry.wire.shrink_to_fit();  // Não reter a capacidade do buffer anterior
+        bytes_ -= nodes_[idx].bytes;
+        nodes_[idx].bytes = entryBytes(nodes_[idx].key, nodes_[idx].entry);
+        bytes_ += nodes_[idx].bytes;
+        scheduleExpiry(idx);
+        if (idx != head_) {
+            unlink(idx);
+            pushFront(idx);
+        }
+        return;
+    }
+
+    // Abrir espaço se cheio: estoque stale primeiro, depois LRU
+    while (count_ >= max_entries_ && evictOldest()) {
+    }
+
+    // Manter fator de carga (incluindo tombstones) abaixo de 70%
+    if ((count_ + tombstones_ + 1) * 10 > slots_.size() * 7) {
+        size_t capacity = 16;
+        while (capacity * 7 < (count_ + 1) * 20) {
+            capacity <<= 1;
+        }
+        rehash(capacity);
+    }
+
+    // Alocar nó (reutilizando livres)
+    int32_t idx;
+    if (!free_.empty()) {
+        idx = free_.back();
+        free_.pop_back();
+    } else {
+        idx = static_cast<int32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[idx].key = key;
+    nodes_[idx].entry = entry;
+    nodes_[idx].bytes = entryBytes(nodes_[idx].key, nodes_[idx].entry);
+    bytes_ += nodes_[idx].bytes;
+
+    // Primeiro slot vazio ou tombstone da sequência de sondagem
+    size_t mask = slots_.size() - 1;
+    size_t i = static_cast<size_t>(key.hash) & mask;
+    while (slots_[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    if (slots_[i] == TOMBSTONE) {
+        tombstones_--;
+    }
+    slots_[i] = idx;
+    count_++;
+
+    pushFront(idx);
+    scheduleExpiry(idx);
+}
+
+size_t CacheShard::removeExpired() {
+    return expireDue(std::time(nullptr), SIZE_MAX);
+}
+
+size_t CacheShard::expireDue(time_t now, size_t budget) {
+    size_t removed = 0;
+
+    // Entrada sai quando now > timestamp + ttl + janela stale
+    // (ver CacheEntry::isPastStaleWindow)
+    while (budget > 0 && !expiry_heap_.empty() && expiry_heap_.front().expires_at < now) {
+        std::pop_heap(expiry_heap_.begin(), expiry_heap_.end(), ExpiresLater());
+        ExpiryItem item = expiry_heap_.back();
+        expiry_heap_.pop_back();
+        budget--;
+
+        // Item obsoleto: nó substituído, removido ou reutilizado
+        if (nodes_[item.idx].generation != item.generation) {
+            continue;
+        }
+        erase(item.idx);
+        removed++;
+    }
+    return removed;
+}
+
+bool CacheShard::hasDue(time_t now) const {
+    return !expiry_heap_.empty() && expiry_heap_.front().expires_at < now;
+}
+
+size_t CacheShard::clear() {
+    size_t count = count_;
+    nodes_.clear();
+    free_.clear();
+    expiry_heap_.clear();
+    count_ = 0;
+    bytes_ = 0;
+    head_ = NIL;
+    tail_ = NIL;
+    rehash(16);
+    return count;
+}
+
+void CacheShard::setMaxEntries(size_t max_entries) {
+    max_entries_ = max_entries;
+    while (count_ > max_entries_ && evictOldest()) {
+    }
+}
+
+int32_t CacheShard::staleVictim(time_t now) {
+    // Descartar itens obsoletos do topo até achar um nó vivo
+    while (!expiry_heap_.empty() &&
+           nodes_[expiry_heap_.front().idx].generation != expiry_heap_.front().generation) {
+        std::pop_heap(expiry_heap_.begin(), expiry_heap_.end(), ExpiresLater());
+        expiry_heap_.pop_back();
+    }
+    if (expiry_heap_.empty()) {
+        return NIL;
+    }
+
+    // A janela stale é a mesma para todo o shard: o topo do heap é também
+    // a entrada cujo TTL venceu primeiro
+    int32_t idx = expiry_heap_.front().idx;
+    return nodes_[idx].entry.isPastStaleWindow(now, 0) ? idx : NIL;
+}
+
+bool CacheShard::evictStale(time_t now) {
+    int32_t idx = staleVictim(now);
+    if (idx == NIL) {
+        return false;
+    }
+    erase(idx);
+    return true;
+}
+
+bool CacheShard::evictOldest() {
+    if (evictStale(std::time(nullptr))) {
+        return true;
+    }
+    if (tail_ == NIL) {
+        return false;
+    }
+    erase(tail_);
+    return true;
+}
+
+const CacheKey* CacheShard::victimKey(time_t now, bool& stale) {
+    int32_t idx = staleVictim(now);
+    stale = idx != NIL;
+    if (!stale) {
+        idx = tail_;
+    }
+    return idx == NIL ? nullptr : &nodes_[idx].key;
+}
+
+void CacheShard::setStaleWindow(uint32_t seconds) {
+    stale_window_ = seconds;
+    // Reagendar os nós vivos com o novo prazo
+    compactExpiryHeap();
+}
+
+void CacheShard::rehash(size_t new_capacity) {
+    std::vector<int32_t> old = std::move(slots_);
+    slots_.assign(new_capacity, EMPTY);
+    tombstones_ = 0;
+
+    size_t mask = new_capacity - 1;
+    for (int32_t idx : old) {
+        if (idx < 0) {
+            continue;
+        }
+        size_t i = static_cast<size_t>(nodes_[idx].key.hash) & mask;
+        while (slots_[i] != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        slots_[i] = idx;
+    }
+}
+
+// ========== LISTA DE RECÊNCIA ==========
+
+void CacheShard::unlink(int32_t idx) {
+    Node& node = nodes_[idx];
+
+    if (node.prev != NIL) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        head_ = node.next;
+    }
+
+    if (node.next != NIL) {
+        nodes_[node.next].prev = node.prev;
+    } else {
+        tail_ = node.prev;
+    }
+
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+void CacheShard::pushFront(int32_t idx) {
+    Node& node = nodes_[idx];
+    node.prev = NIL;
+    node.next = head_;
+    if (head_ != NIL) {
+        nodes_[head_].prev = idx;
+    }
+    head_ = idx;
+    if (tail_ == NIL) {
+        tail_ = idx;
+    }
+}
+
+void CacheShard::erase(int32_t idx) {
+    if (on_erase_) {
+        on_erase_(nodes_[idx].key);
+    }
+
+    int64_t slot = findSlot(nodes_[idx].key);
+    if (slot >= 0) {
+        slots_[slot] = TOMBSTONE;
+        tombstones_++;
+    }
+
+    unlink(idx);
+
+    // Liberar memória do nó e devolvê-lo ao pool
+    nodes_[idx].key = CacheKey();
+    nodes_[idx].entry = CacheEntry();
+    nodes_[idx].key.qname.shrink_to_fit();
+    nodes_[idx].entry.wire.shrink_to_fit();
+    nodes_[idx].generation++;
+    bytes_ -= nodes_[idx].bytes;
+    nodes_[idx].bytes = 0;
+    free_.push_back(idx);
+    count_--;
+}
+
+// ========== HEAP DE EXPIRAÇÃO ==========
+
+void CacheShard::scheduleExpiry(int32_t idx) {
+    Node& node = nodes_[idx];
+    node.generation++;
+
+    expiry_heap_.push_back({expiresAt(node), idx, node.generation});
+    std::push_heap(expiry_heap_.begin(), expiry_heap_.end(), ExpiresLater());
+
+    // Substituições e evicções deixam itens obsoletos; limitar o crescimento
+    if (expiry_heap_.size() > 2 * count_ + 64) {
+        compactExpiryHeap();
+    }
+}
+
+void CacheShard::compactExpiryHeap() {
+    expiry_heap_.clear();
+    for (int32_t idx = head_; idx != NIL; idx = nodes_[idx].next) {
+        const Node& node = nodes_[idx];
+        expiry_heap_.push_back({expiresAt(node), idx, node.generation});
+    }
+    std::make_heap(expiry_heap_.begin(), expiry_heap_.end(), ExpiresLater());
+}
+
+// ========== SKETCH DE FREQUÊNCIA (TINYLFU) ==========
+
+namespace {
+
+// Sementes por linha do sketch: índices independentes a partir do mesmo hash
+constexpr uint64_t SKETCH_SEEDS[] = {
+    0xC3A5C85C97CB3127ULL, 0xB492B66FBE98F273ULL,
+    0x9AE16A3B2F90404FULL, 0xCBF29CE484222325ULL
+};
+
+// Finalizador do splitmix64: espalha os bits do hash FNV da chave
+uint64_t mixHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+} // namespace
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+    resize(capacity);
+}
+
+void FrequencySketch::resize(size_t capacity) {
+    width_ = 16;
+    while (width_ < capacity && width_ < MAX_WIDTH) {
+        width_ <<= 1;
+    }
+    counters_.assign(width_ * DEPTH / 16, 0);
+    doorkeeper_.assign(width_ * 8 / 64, 0);
+    additions_ = 0;
+    sample_size_ = width_ * SAMPLE_FACTOR;
+}
+
+size_t FrequencySketch::counterIndex(uint64_t hash, int row) const {
+    return static_cast<size_t>(row) * width_ +
+           static_cast<size_t>(mixHash(hash + SKETCH_SEEDS[row]) & (width_ - 1));
+}
+
+uint32_t FrequencySketch::counterAt(size_t index) const {
+    return static_cast<uint32_t>((counters_[index / 16] >> ((index % 16) * 4)) & 0xF);
+}
+
+bool FrequencySketch::doorkeeperContains(uint64_t hash) const {
+    uint64_t h = mixHash(hash);
+    size_t bits = doorkeeper_.size() * 64;
+    size_t a = static_cast<size_t>(h) % bits;
+    size_t b = static_cast<size_t>(h >> 32) % bits;
+    return ((doorkeeper_[a / 64] >> (a % 64)) & 1) && ((doorkeeper_[b / 64] >> (b % 64)) & 1);
+}
+
+void FrequencySketch::doorkeeperAdd(uint64_t hash) {
+    uint64_t h = mixHash(hash);
+    size_t bits = doorkeeper_.size() * 64;
+    size_t a = static_cast<size_t>(h) % bits;
+    size_t b = static_cast<size_t>(h >> 32) % bits;
+    doorkeeper_[a / 64] |= 1ULL << (a % 64);
+    doorkeeper_[b / 64] |= 1ULL << (b % 64);
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+    if (!doorkeeperContains(hash)) {
+        doorkeeperAdd(hash);
+    } else {
+        // Atualização conservadora: só sobem os contadores no mínimo
+        size_t index[DEPTH];
+        uint32_t min_count = 15;
+        for (int row = 0; row < DEPTH; row++) {
+            index[row] = counterIndex(hash, row);
+            min_count = std::min(min_count, counterAt(index[row]));
+        }
+        if (min_count < 15) {
+            for (int row = 0; row < DEPTH; row++) {
+                if (counterAt(index[row]) == min_count) {
+                    counters_[index[row] / 16] += 1ULL << ((index[row] % 16) * 4);
+                }
+            }
+        }
+    }
+
+    if (++additions_ >= sample_size_) {
+        age();
+    }
+}
+
+uint32_t FrequencySketch::estimate(uint64_t hash) const {
+    uint32_t min_count = 15;
+    for (int row = 0; row < DEPTH; row++) {
+        min_count = std::min(min_count, counterAt(counterIndex(hash, row)));
+    }
+    return min_count + (doorkeeperContains(hash) ? 1 : 0);
+}
+
+void FrequencySketch::age() {
+    for (uint64_t& word : counters_) {
+        word = (word >> 1) & 0x7777777777777777ULL;
+    }
+    std::fill(doorkeeper_.begin(), doorkeeper_.end(), 0);
+    additions_ /= 2;
+}
+
+// ========== TABELA PARTICIONADA ==========
+
+CacheTable::CacheTable(size_t max_entries, size_t num_shards)
+    : max_entries_(max_entries) {
+    if (num_shards == 0) {
+        num_shards = 1;
+    }
+    // Cada shard aceita até a capacidade total; o limite global é
+    // aplicado pela tabela (evita shards com capacidade 0)
+    for (size_t i = 0; i < num_shards; i++) {
+        shards_.push_back(std::make_unique<Shard>(max_entries));
+    }
+}
+
+size_t CacheTable::shardIndex(const CacheKey& key) const {
+    // Bits altos escolhem o shard; bits baixos, o slot dentro dele
+    return (key.hash >> 40) % shards_.size();
+}
+
+CacheTable::Shard& CacheTable::shardFor(const CacheKey& key) {
+    return *shards_[shardIndex(key)];
+}
+
+template <typename GetKey>
+std::vector<size_t> CacheTable::orderByShard(size_t count, GetKey&& get_key) const {
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return shardIndex(get_key(a)) < shardIndex(get_key(b));
+    });
+    return order;
+}
+
+void CacheTable::evictFairShare(Shard& shard, size_t max_entries) {
+    size_t fair_entries = (max_entries + shards_.size() - 1) / shards_.size();
+    size_t fair_bytes = max_bytes_.load() / shards_.size();
+    while ((count_.load() > max_entries && shard.table.size() > fair_entries) ||
+           (bytes_.load() > max_bytes_.load() && shard.table.bytes() > fair_bytes)) {
+        size_t entries_before = shard.table.size();
+        size_t bytes_before = shard.table.bytes();
+        if (!shard.table.evictOldest()) {
+            break;
+        }
+        account(shard.table, entries_before, bytes_before);
+    }
+}
+
+bool CacheTable::admit(Shard& shard, const CacheKey& key, const CacheEntry& entry, bool& evict_victim) {
+    evict_victim = false;
+    if (!admission_.load(std::memory_order_relaxed) || shard.table.contains(key)) {
+        return true;  // Substituição (ex: renovação) sempre entra
+    }
+
+    // Com espaço livre não há vítima: admitir
+    bool full = count_.load() >= max_entries_.load() ||
+                bytes_.load() + CacheShard::entryBytes(key, entry) > max_bytes_.load();
+    bool stale = false;
+    const CacheKey* victim = shard.table.victimKey(std::time(nullptr), stale);
+    if (!full || victim == nullptr) {
+        return true;
+    }
+
+    // Vítima já expirada (estoque stale): cede lugar a qualquer chave viva
+    if (stale) {
+        evict_victim = true;
+        return true;
+    }
+
+    admission_candidates_++;
+    if (shard.sketch.estimate(key.hash) > shard.sketch.estimate(victim->hash)) {
+        evict_victim = true;
+        return true;
+    }
+    admission_rejects_++;
+    return false;
+}
+
+void CacheTable::evictVictim(Shard& shard) {
+    // A chave nova é a mais recente: evictOldest remove a vítima comparada
+    // (stale que venceu primeiro ou a LRU do shard)
+    while (overCapacity() && shard.table.size() > 1) {
+        size_t entries_before = shard.table.size();
+        size_t bytes_before = shard.table.bytes();
+        if (!shard.table.evictOldest()) {
+            break;
+        }
+        account(shard.table, entries_before, bytes_before);
+    }
+}
+
+void CacheTable::resizeSketches() {
+    size_t per_shard = (max_entries_.load() + shards_.size() - 1) / shards_.size();
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->sketch.resize(per_shard);
+    }
+}
+
+void CacheTable::account(const CacheShard& table, size_t entries_before, size_t bytes_before) {
+    size_t entries_after = table.size();
+    if (entries_after > entries_before) {
+        count_.fetch_add(entries_after - entries_before);
+    } else if (entries_before > entries_after) {
+        count_.fetch_sub(entries_before - entries_after);
+    }
+
+    size_t bytes_after = table.bytes();
+    if (bytes_after > bytes_before) {
+        bytes_.fetch_add(bytes_after - bytes_before);
+    } else if (bytes_before > bytes_after) {
+        bytes_.fetch_sub(bytes_before - bytes_after);
+    }
+}
+
+bool CacheTable::overCapacity() const {
+    return count_.load() > max_entries_.load() || bytes_.load() > max_bytes_.load();
+}
+
+void CacheTable::enforceCapacity() {
+    // Nunca segura dois locks de shard ao mesmo tempo
+    // Primeiro passa por todos os shards removendo só estoque stale, para
+    // que um shard sem entradas expiradas não ceda uma viva no rodízio
+    time_t now = std::time(nullptr);
+    for (size_t i = 0; i < shards_.size() && overCapacity(); i++) {
+        Shard& shard = *shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t entries_before = shard.table.size();
+        size_t bytes_before = shard.table.bytes();
+        while (overCapacity() && shard.table.evictStale(now)) {
+            account(shard.table, entries_before, bytes_before);
+            entries_before = shard.table.size();
+            bytes_before = shard.table.bytes();
+        }
+    }
+
+    size_t empty_streak = 0;
+    while (overCapacity() && empty_streak < shards_.size()) {
+        Shard& victim = *shards_[next_victim_.fetch_add(1) % shards_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        size_t entries_before = victim.table.size();
+        size_t bytes_before = victim.table.bytes();
+        if (victim.table.evictOldest()) {
+            account(victim.table, entries_before, bytes_before);
+            empty_streak = 0;
+        } else {
+            empty_streak++;
+        }
+    }
+}
+
+bool CacheTable::lookup(const CacheKey& key, CacheEntry& out) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (admission_.load(std::memory_order_relaxed)) {
+        shard.sketch.increment(key.hash);
+    }
+
+    size_t entries_before = shard.table.size();
+    size_t bytes_before = shard.table.bytes();
+    const CacheEntry* entry = shard.table.lookup(key);
+    account(shard.table, entries_before, bytes_before);
+
+    if (entry == nullptr) {
+        return false;
+    }
+    out = *entry;
+    return true;
+}
+
+bool CacheTable::lookupStale(const CacheKey& key, CacheEntry& out) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    size_t entries_before = shard.table.size();
+    size_t bytes_before = shard.table.bytes();
+    const CacheEntry* entry = shard.table.lookupStale(key);
+    account(shard.table, entries_before, bytes_before);
+
+    if (entry == nullptr) {
+        return false;
+    }
+    out = *entry;
+    return true;
+}
+
+bool CacheTable::recordHits(const CacheKey& key, uint32_t hits, CacheEntry& out) {
+    if (hits == 0) {
+        return false;
+    }
+
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (admission_.load(std::memory_order_relaxed)) {
+        // Contadores saturam em 15 (mais o doorkeeper): não adianta repetir além
+        for (uint32_t i = 0; i < std::min<uint32_t>(hits, 16); i++) {
+            shard.sketch.increment(key.hash);
+        }
+    }
+
+    size_t entries_before = shard.table.size();
+    size_t bytes_before = shard.table.bytes();
+    const CacheEntry* entry = shard.table.lookup(key, hits);
+    account(shard.table, entries_before, bytes_before);
+
+    if (entry == nullptr) {
+        return false;
+    }
+    out = *entry;
+    return true;
+}
+
+bool CacheTable::insert(const CacheKey& key, const CacheEntry& entry) {
+    size_t max_entries = max_entries_.load();
+    if (max_entries == 0) {
+        return false;
+    }
+
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        bool evict_victim;
+        if (!admit(shard, key, entry, evict_victim)) {
+            return false;
+        }
+
+        size_t entries_before = shard.table.size();
+        size_t bytes_before = shard.table.bytes();
+        shard.table.insert(key, entry);
+        account(shard.table, entries_before, bytes_before);
+        evictFairShare(shard, max_entries);
+        if (evict_victim) {
+            evictVictim(shard);
+        }
+    }
+
+    enforceCapacity();
+    return true;
+}
+
+void CacheTable::lookupMany(const std::vector<CacheKey>& keys,
+                            std::vector<CacheEntry>& out, std::vector<bool>& found,
+                            size_t max_wire_bytes) {
+    out.assign(keys.size(), CacheEntry());
+    found.assign(keys.size(), false);
+    size_t wire_bytes = 0;
+
+    std::vector<size_t> order = orderByShard(keys.size(),
+        [&keys](size_t i) -> const CacheKey& { return keys[i]; });
+
+    for (size_t pos = 0; pos < order.size();) {
+        size_t shard_index = shardIndex(keys[order[pos]]);
+        Shard& shard = *shards_[shard_index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        size_t entries_before = shard.table.size();
+        size_t bytes_before = shard.table.bytes();
+        bool admission = admission_.load(std::memory_order_relaxed);
+        for (; pos < order.size() && shardIndex(keys[order[pos]]) == shard_index; pos++) {
+            if (admission) {
+                shard.sketch.increment(keys[order[pos]].hash);
+            }
+            // Tamanho conferido antes de lookup(), que conta o HIT e promove
+            const CacheEntry* peek = shard.table.lookupStale(keys[order[pos]]);
+            if (peek != nullptr && !peek->isExpired() &&
+                peek->wire.size() > max_wire_bytes - wire_bytes) {
+                continue;
+            }
+            const CacheEntry* entry = shard.table.lookup(keys[order[pos]]);
+            if (entry != nullptr) {
+                out[order[pos]] = *entry;
+                found[order[pos]] = true;
+                wire_bytes += entry->wire.size();
+            }
+        }
+        account(shard.table, entries_before, bytes_before);
+    }
+}
+
+std::vector<bool> CacheTable::insertMany(const std::vector<std::pair<CacheKey, CacheEntry>>& entries) {
+    std::vector<bool> admitted(entries.size(), false);
+    size_t max_entries = max_entries_.load();
+    if (max_entries == 0) {
+        return admitted;
+    }
+
+    std::vector<size_t> order = orderByShard(entries.size(),
+        [&entries](size_t i) -> const CacheKey& { return entries[i].first; });
+
+    for (size_t pos = 0; pos < order.size();) {
+        size_t shard_index = shardIndex(entries[order[pos]].first);
+        Shard& shard = *shards_[shard_index];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        for (; pos < order.size() && shardIndex(entries[order[pos]].first) == shard_index; pos++) {
+            bool evict_victim;
+            if (!admit(shard, entries[order[pos]].first, entries[order[pos]].second, evict_victim)) {
+                continue;
+            }
+            size_t entries_before = shard.table.size();
+            size_t bytes_before = shard.table.bytes();
+            shard.table.insert(entries[order[pos]].first, entries[order[pos]].second);
+            account(shard.table, entries_before, bytes_before);
+            evictFairShare(shard, max_entries);
+            if (evict_victim) {
+                evictVictim(shard);
+            }
+            admitted[order[pos]] = true;
+        }
+    }
+
+    enforceCapacity();
+    return admitted;
+}
+
+size_t CacheTable::removeExpired() {
+    size_t removed = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size_t bytes_before = shard->table.bytes();
+        size_t entries_before = shard->table.size();
+        removed += shard->table.removeExpired();
+        account(shard->table, entries_before, bytes_before);
+    }
+    return removed;
+}
+
+size_t CacheTable::expireDue(size_t budget_per_shard) {
+    time_t now = std::time(nullptr);
+    size_t removed = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size_t bytes_before = shard->table.bytes();
+        size_t entries_before = shard->table.size();
+        removed += shard->table.expireDue(now, budget_per_shard);
+        account(shard->table, entries_before, bytes_before);
+    }
+    return removed;
+}
+
+bool CacheTable::hasDue() const {
+    time_t now = std::time(nullptr);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if (shard->table.hasDue(now)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t CacheTable::clear() {
+    size_t removed = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size_t bytes_before = shard->table.bytes();
+        size_t entries_before = shard->table.size();
+        removed += shard->table.clear();
+        account(shard->table, entries_before, bytes_before);
+    }
+    return removed;
+}
+
+void CacheTable::setAdmission(bool enabled) {
+    if (enabled && !admission_.load()) {
+        resizeSketches();
+    }
+    admission_.store(enabled);
+}
+
+void CacheTable::setMaxEntries(size_t max_entries) {
+    max_entries_.store(max_entries);
+    if (admission_.load()) {
+        resizeSketches();
+    }
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size_t bytes_before = shard->table.bytes();
+        size_t entries_before = shard->table.size();
+        shard->table.setMaxEntries(max_entries);
+        account(shard->table, entries_before, bytes_before);
+    }
+    enforceCapacity();
+}
+
+void CacheTable::setMaxBytes(size_t max_bytes) {
+    max_bytes_.store(max_bytes);
+    enforceCapacity();
+}
+
+void CacheTable::setEvictionListener(const std::function<void(const CacheKey&)>& listener) {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->table.setEraseListener(listener);
+    }
+}
+
+void CacheTable::setStaleWindow(uint32_t seconds) {
+    stale_window_.store(seconds);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->table.setStaleWindow(seconds);
+    }
+}
+
+size_t CacheTable::size() const {
+    return count_.load();
+}
+
+size_t CacheTable::maxEntries() const {
+    return max_entries_.load();
+}
+
+} // namespace dns_cache
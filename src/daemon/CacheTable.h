@@ -0,0 +1,463 @@
+/*
+ * ----------------------------------------
+ * Arquivo: CacheTable.h
+ * Propósito: Tabela de cache particionada (shards) com endereçamento aberto e LRU O(1)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#pragma once
+
+#include "dns_resolver/types.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <ctime>
+
+namespace dns_cache {
+
+// Localiza o campo TTL de cada RR de uma resposta em wire format
+// Percorre só nomes e RDLENGTH (sem parsing de RDATA); ignora o pseudo-RR OPT
+// Lança std::runtime_error se a mensagem estiver truncada ou malformada
+std::vector<uint32_t> findTTLOffsets(std::string_view wire);
+
+// Entrada de cache com timestamp e TTL
+// Entradas positivas guardam a resposta em wire format (RFC 1035) e os
+// offsets dos TTLs; entradas negativas guardam apenas o RCODE
+struct CacheEntry {
+    std::string wire;
+    std::vector<uint32_t> ttl_offsets;
+    uint8_t rcode;
+    time_t timestamp;
+    uint32_t ttl;
+    uint32_t hits;   // HITs da chave (preservados ao substituir a entrada)
+
+    CacheEntry() : rcode(0), timestamp(0), ttl(0), hits(0) {}
+
+    CacheEntry(std::string data, uint8_t rc, uint32_t t)
+        : wire(std::move(data)),
+          ttl_offsets(wire.empty() ? std::vector<uint32_t>() : findTTLOffsets(wire)),
+          rcode(rc), timestamp(std::time(nullptr)), ttl(t), hits(0) {}
+
+    // Reescreve in place os TTLs do wire descontando o tempo decorrido desde
+    // timestamp (mínimo 0); usar na cópia devolvida por CacheTable::lookup
+    void ageTTLs(time_t now);
+
+    // Reescreve in place todos os TTLs do wire com um valor fixo
+    // (respostas servidas do estoque stale, RFC 8767)
+    void rewriteTTLs(uint32_t value);
+
+    // Verifica se entrada expirou
+    bool isExpired() const {
+        return (std::time(nullptr) - timestamp) > static_cast<time_t>(ttl);
+    }
+
+    // Verifica se a entrada passou também da janela stale (pode ser descartada)
+    bool isPastStaleWindow(time_t now, uint32_t stale_window) const {
+        return (now - timestamp) > static_cast<time_t>(ttl) + static_cast<time_t>(stale_window);
+    }
+
+    // Entrada popular (ao menos min_hits) que entrou nos últimos
+    // window_percent% do TTL: candidata a renovação antes de expirar
+    bool needsPrefetch(time_t now, uint32_t min_hits, uint32_t window_percent) const {
+        time_t elapsed = now - timestamp;
+        if (window_percent == 0 || hits < min_hits || elapsed > static_cast<time_t>(ttl)) {
+            return false;
+        }
+        uint64_t remaining = ttl - static_cast<uint32_t>(elapsed < 0 ? 0 : elapsed);
+        return remaining * 100 <= static_cast<uint64_t>(ttl) * window_percent;
+    }
+
+    // Retorna tempo restante de vida em segundos
+    uint32_t getRemainingTTL() const {
+        time_t elapsed = std::time(nullptr) - timestamp;
+        if (elapsed >= static_cast<time_t>(ttl)) {
+            return 0;
+        }
+        return ttl - static_cast<uint32_t>(elapsed);
+    }
+};
+
+// Chave normalizada do cache: (qname em minúsculas, qtype, qclass)
+// O hash é calculado uma única vez e reutilizado para shard e slot
+struct CacheKey {
+    std::string qname;
+    uint16_t qtype = 0;
+    uint16_t qclass = 0;
+    uint64_t hash = 0;
+
+    CacheKey() = default;
+    CacheKey(std::string_view name, uint16_t type, uint16_t cls);
+    explicit CacheKey(const dns_resolver::DNSQuestion& question)
+        : CacheKey(question.qname, question.qtype, question.qclass) {}
+
+    bool operator==(const CacheKey& other) const {
+        return hash == other.hash && qtype == other.qtype &&
+               qclass == other.qclass && qname == other.qname;
+    }
+};
+
+// Partição da tabela (não thread-safe)
+// Tabela hash com endereçamento aberto (sondagem linear) cujos slots
+// apontam para nós de um pool; os nós carregam a lista LRU intrusiva.
+class CacheShard {
+public:
+    explicit CacheShard(size_t max_entries);
+
+    // Busca entrada válida e a promove para mais recente
+    // Entradas expiradas além da janela stale são removidas; dentro dela
+    // permanecem (sem promoção) para lookupStale
+    // hits: HITs contabilizados (mais de um para leituras feitas fora do daemon)
+    const CacheEntry* lookup(const CacheKey& key, uint32_t hits = 1);
+
+    // Busca entrada ainda não descartada, mesmo expirada (serve-stale)
+    // Não conta HIT nem promove na LRU: o estoque stale envelhece até sair
+    const CacheEntry* lookupStale(const CacheKey& key);
+
+    // Insere (ou substitui) entrada, removendo uma vítima (evictOldest) se cheio
+    void insert(const CacheKey& key, const CacheEntry& entry);
+
+    // Remove todas as entradas expiradas
+    size_t removeExpired();
+
+    // Remove até budget entradas do heap de expiração vencidas em now
+    size_t expireDue(time_t now, size_t budget);
+
+    // Indica se há itens vencidos aguardando no heap
+    bool hasDue(time_t now) const;
+
+    // Remove todas as entradas
+    size_t clear();
+
+    // Configura capacidade (remove excedentes menos recentes)
+    void setMaxEntries(size_t max_entries);
+
+    // Remove a próxima vítima (false se vazio): a entrada cujo TTL venceu
+    // primeiro, se houver (estoque stale), senão a menos recente
+    bool evictOldest();
+
+    // Remove a entrada cujo TTL venceu primeiro (false se nenhuma expirou)
+    bool evictStale(time_t now);
+
+    // Indica se a chave está no shard (sem promover nem expirar)
+    bool contains(const CacheKey& key) const { return findSlot(key) >= 0; }
+
+    // Chave da entrada que evictOldest removeria (nullptr se vazio)
+    // stale: a vítima já expirou (estoque stale) em vez de ser a LRU
+    const CacheKey* victimKey(time_t now, bool& stale);
+
+    // Configura por quantos segundos após o TTL a entrada fica retida
+    void setStaleWindow(uint32_t seconds);
+
+    // Chamado com a chave de cada entrada removida (LRU, expiração,
+    // capacidade); clear() não chama
+    void setEraseListener(std::function<void(const CacheKey&)> listener) {
+        on_erase_ = std::move(listener);
+    }
+
+    size_t size() const { return count_; }
+    size_t maxEntries() const { return max_entries_; }
+
+    // Bytes ocupados pelas entradas (nó + buffers alocados)
+    size_t bytes() const { return bytes_; }
+
+    // Custo em memória de uma entrada (nó do pool + heap de chave, wire e offsets)
+    static size_t entryBytes(const CacheKey& key, const CacheEntry& entry);
+
+    // Visita as entradas da menos para a mais recente (reinserir nessa
+    // ordem reproduz a LRU)
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (int32_t idx = tail_; idx != NIL; idx = nodes_[idx].prev) {
+            fn(nodes_[idx].key, nodes_[idx].entry);
+        }
+    }
+
+private:
+    static constexpr int32_t EMPTY = -1;
+    static constexpr int32_t TOMBSTONE = -2;
+    static constexpr int32_t NIL = -1;
+
+    struct Node {
+        CacheKey key;
+        CacheEntry entry;
+        int32_t prev = NIL;   // Mais recente
+        int32_t next = NIL;   // Menos recente
+        uint32_t generation = 0;  // Invalida itens antigos do heap
+        size_t bytes = 0;         // Custo contabilizado em bytes_
+    };
+
+    // Item do heap de expiração (min-heap por instante absoluto)
+    // Itens cuja geração não confere com o nó são descartados ao sair do heap
+    struct ExpiryItem {
+        time_t expires_at;
+        int32_t idx;
+        uint32_t generation;
+    };
+
+    struct ExpiresLater {
+        bool operator()(const ExpiryItem& a, const ExpiryItem& b) const {
+            return a.expires_at > b.expires_at;
+        }
+    };
+
+    // Localiza o slot que contém a chave (-1 se ausente)
+    int64_t findSlot(const CacheKey& key) const;
+
+    // Reconstroi o vetor de slots com nova capacidade
+    void rehash(size_t new_capacity);
+
+    // Operações na lista de recência
+    void unlink(int32_t idx);
+    void pushFront(int32_t idx);
+
+    // Remove nó (slot, lista e pool)
+    void erase(int32_t idx);
+
+    // Instante em que o nó sai do cache (TTL + janela stale)
+    time_t expiresAt(const Node& node) const {
+        return node.entry.timestamp + static_cast<time_t>(node.entry.ttl) +
+               static_cast<time_t>(stale_window_);
+    }
+
+    // Nó vivo cujo TTL venceu primeiro (NIL se nenhum expirou em now)
+    // Descarta itens obsoletos do topo do heap
+    int32_t staleVictim(time_t now);
+
+    // Agenda expiração do nó (nova geração)
+    void scheduleExpiry(int32_t idx);
+
+    // Reconstroi o heap só com nós vivos quando há muitos itens obsoletos
+    void compactExpiryHeap();
+
+    std::vector<int32_t> slots_;     // Índices de nós, EMPTY ou TOMBSTONE
+    std::vector<Node> nodes_;        // Pool de nós
+    std::vector<int32_t> free_;      // Nós livres para reutilização
+    std::vector<ExpiryItem> expiry_heap_;
+    size_t count_ = 0;
+    size_t bytes_ = 0;
+    size_t tombstones_ = 0;
+    int32_t head_ = NIL;
+    int32_t tail_ = NIL;
+    size_t max_entries_;
+    uint32_t stale_window_ = 0;
+    std::function<void(const CacheKey&)> on_erase_;
+};
+
+// Estimador de frequência de acesso para admissão TinyLFU (não thread-safe)
+// Count-min sketch de 4 linhas com contadores de 4 bits (satura em 15),
+// precedido por um doorkeeper (filtro de Bloom): a primeira ocorrência de
+// uma chave só marca o doorkeeper, de modo que chaves vistas uma vez não
+// ocupam contadores. A cada SAMPLE_FACTOR × largura incrementos os
+// contadores são divididos por 2 e o doorkeeper é limpo (envelhecimento).
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t capacity = 0);
+
+    // Redimensiona para ~capacity chaves distintas (zera as contagens)
+    void resize(size_t capacity);
+
+    // Registra um acesso à chave
+    void increment(uint64_t hash);
+
+    // Frequência estimada (0 = nunca vista, no máximo 16)
+    uint32_t estimate(uint64_t hash) const;
+
+    static constexpr size_t SAMPLE_FACTOR = 10;
+    static constexpr size_t MAX_WIDTH = 1 << 18;
+
+private:
+    static constexpr int DEPTH = 4;
+
+    // Índice do contador da chave na linha row
+    size_t counterIndex(uint64_t hash, int row) const;
+    uint32_t counterAt(size_t index) const;
+
+    // Posições do doorkeeper para a chave
+    bool doorkeeperContains(uint64_t hash) const;
+    void doorkeeperAdd(uint64_t hash);
+
+    // Divide todos os contadores por 2 e limpa o doorkeeper
+    void age();
+
+    std::vector<uint64_t> counters_;     // 16 contadores de 4 bits por palavra
+    std::vector<uint64_t> doorkeeper_;   // Bits do filtro de Bloom
+    size_t width_ = 0;                   // Contadores por linha (potência de 2)
+    size_t additions_ = 0;
+    size_t sample_size_ = 0;
+};
+
+// Tabela de cache particionada em N shards, cada um com seu próprio lock
+// Consultas de vários workers só competem quando caem no mesmo shard.
+// A capacidade é global (entradas e bytes): ao exceder, remove-se a vítima
+// do próprio shard (se ele tiver ao menos sua fração) ou de outro shard
+// (rodízio). Entradas expiradas (estoque stale) saem antes das vivas.
+class CacheTable {
+public:
+    static constexpr size_t DEFAULT_SHARDS = 16;
+
+    explicit CacheTable(size_t max_entries, size_t num_shards = DEFAULT_SHARDS);
+
+    CacheTable(const CacheTable&) = delete;
+    CacheTable& operator=(const CacheTable&) = delete;
+
+    // Busca entrada válida; copia para out e promove na LRU do shard
+    bool lookup(const CacheKey& key, CacheEntry& out);
+
+    // Busca entrada expirada ainda dentro da janela stale (ou válida)
+    bool lookupStale(const CacheKey& key, CacheEntry& out);
+
+    // Conta hits HITs atendidos fora da tabela (memória compartilhada):
+    // frequência da admissão, HITs da entrada e recência, como lookup()
+    // false (out intacto) se a entrada não está válida
+    bool recordHits(const CacheKey& key, uint32_t hits, CacheEntry& out);
+
+    // Insere (ou substitui) entrada
+    // false se a admissão (ou capacidade 0) recusou a entrada
+    bool insert(const CacheKey& key, const CacheEntry& entry);
+
+    // Busca várias chaves com um lock por shard envolvido
+    // out[i] / found[i] correspondem a keys[i]
+    // max_wire_bytes: soma máxima dos wires devolvidos; a entrada que
+    // passaria do limite fica como não encontrada, sem contar HIT nem
+    // promover na LRU (a resposta do lote precisa caber num frame)
+    void lookupMany(const std::vector<CacheKey>& keys,
+                    std::vector<CacheEntry>& out, std::vector<bool>& found,
+                    size_t max_wire_bytes = SIZE_MAX);
+
+    // Insere várias entradas com um lock por shard envolvido
+    // Devolve, para cada entries[i], se a entrada foi admitida
+    std::vector<bool> insertMany(const std::vector<std::pair<CacheKey, CacheEntry>>& entries);
+
+    // Remove entradas expiradas de todos os shards
+    size_t removeExpired();
+
+    // Passo incremental de expiração: até budget itens por shard
+    size_t expireDue(size_t budget_per_shard);
+
+    // Indica se algum shard ainda tem itens vencidos
+    bool hasDue() const;
+
+    // Remove todas as entradas
+    size_t clear();
+
+    // Configura capacidade total (dividida entre os shards)
+    void setMaxEntries(size_t max_entries);
+
+    // Configura orçamento de memória em bytes (SIZE_MAX = sem limite)
+    void setMaxBytes(size_t max_bytes);
+
+    // Configura janela stale em segundos (0 = descartar ao expirar)
+    // O estoque stale só ocupa o espaço que as entradas vivas não usam:
+    // sob pressão de capacidade ele é removido primeiro (mais antigo
+    // primeiro) e nunca expulsa uma entrada viva
+    void setStaleWindow(uint32_t seconds);
+
+    // Admissão TinyLFU: com a tabela cheia, uma chave nova só entra se sua
+    // frequência estimada superar a da menos recente do shard (que seria
+    // removida). Varreduras de chaves únicas não expulsam entradas populares.
+    // Se a vítima for uma entrada stale, a chave nova entra sem comparação.
+    // Frequências são registradas nas consultas (lookup / lookupMany).
+    void setAdmission(bool enabled);
+    bool admissionEnabled() const { return admission_.load(); }
+
+    // Chamado (sob o lock do shard) para cada entrada removida por LRU,
+    // expiração ou capacidade; clear() não chama. Configurar antes do uso
+    // concorrente; o listener não pode acessar esta tabela.
+    void setEvictionListener(const std::function<void(const CacheKey&)>& listener);
+
+    // Visita as entradas de cada shard (menos recente primeiro)
+    // As entradas do shard são copiadas sob o lock e visitadas depois de
+    // liberá-lo: fn pode fazer I/O (snapshot) sem travar as consultas
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        std::vector<std::pair<CacheKey, CacheEntry>> entries;
+        for (auto& shard : shards_) {
+            entries.clear();
+            {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                entries.reserve(shard->table.size());
+                shard->table.forEach([&entries](const CacheKey& key, const CacheEntry& entry) {
+                    entries.emplace_back(key, entry);
+                });
+            }
+            for (const auto& item : entries) {
+                fn(item.first, item.second);
+            }
+        }
+    }
+
+    size_t size() const;
+    size_t maxEntries() const;
+    size_t bytes() const { return bytes_.load(); }
+    size_t maxBytes() const { return max_bytes_.load(); }
+    size_t shardCount() const { return shards_.size(); }
+    uint32_t staleWindow() const { return stale_window_.load(); }
+
+    // Chaves novas avaliadas com a tabela cheia / recusadas pela admissão
+    uint64_t admissionCandidates() const { return admission_candidates_.load(); }
+    uint64_t admissionRejects() const { return admission_rejects_.load(); }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        CacheShard table;
+        FrequencySketch sketch;   // Só usado com admissão ativa
+        explicit Shard(size_t max_entries) : table(max_entries) {}
+    };
+
+    // Decide se a chave entra no shard (chamado com o lock do shard)
+    // evict_victim: admitida contra a vítima do shard (stale ou LRU), que
+    // deve sair em seu lugar
+    bool admit(Shard& shard, const CacheKey& key, const CacheEntry& entry, bool& evict_victim);
+
+    // Remove a vítima do shard (a comparada na admissão) enquanto a
+    // tabela exceder a capacidade, em vez de um shard qualquer do
+    // enforceCapacity (chamado com o lock do shard, após inserir)
+    void evictVictim(Shard& shard);
+
+    // Dimensiona os sketches pela fração da capacidade de cada shard
+    void resizeSketches();
+
+    size_t shardIndex(const CacheKey& key) const;
+    Shard& shardFor(const CacheKey& key);
+
+    // Ordena índices de chaves pelo shard (para agrupar por lock)
+    template <typename GetKey>
+    std::vector<size_t> orderByShard(size_t count, GetKey&& get_key) const;
+
+    // Após inserir: shard com ao menos sua fração da capacidade cede a
+    // própria LRU (chamado com o lock do shard)
+    void evictFairShare(Shard& shard, size_t max_entries);
+
+    // Aplica aos contadores globais a variação de entradas e bytes de um shard
+    void account(const CacheShard& table, size_t entries_before, size_t bytes_before);
+
+    // Indica se entradas ou bytes excedem a capacidade
+    bool overCapacity() const;
+
+    // Remove entradas de outros shards até respeitar a capacidade global
+    // (estoque stale de todos os shards antes de qualquer entrada viva)
+    void enforceCapacity();
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> count_{0};
+    std::atomic<size_t> bytes_{0};
+    std::atomic<size_t> max_entries_;
+    std::atomic<size_t> max_bytes_{SIZE_MAX};
+    std::atomic<size_t> next_victim_{0};
+    std::atomic<uint32_t> stale_window_{0};
+    std::atomic<bool> admission_{false};
+    std::atomic<uint64_t> admission_candidates_{0};
+    std::atomic<uint64_t> admission_rejects_{0};
+};
+
+} // namespace dns_cache
@@ -9,10 +9,14 @@
  */
 
 #include "CacheDaemon.h"
+#include "dns_resolver/CacheProtocol.h"
 #include <iostream>
 #include <fstream>
 #include <csignal>
 #include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
@@ -20,12 +24,31 @@
 const char* PID_FILE = "/tmp/dns_cache.pid";
 const char* SOCKET_PATH = "/tmp/dns_cache.sock";
 
-// Envia comando ao daemon via Unix socket
-std::string sendCommand(const std::string& command) {
+// Limites das opções de concorrência do --activate
+const size_t MAX_WORKERS = 1024;
+const size_t MAX_BACKLOG = 65535;        // Kernel limita a net.core.somaxconn
+const size_t MAX_CONNECTIONS = 1000000;
+
+// Daemon em execução (alvo do handler de SIGTERM)
+dns_cache::CacheDaemon* g_daemon = nullptr;
+
+// SIGTERM/SIGINT: encerrar o loop para gravar o snapshot antes de sair
+void handleTerminate(int) {
+    if (g_daemon != nullptr) {
+        g_daemon->requestStop();
+    }
+}
+
+// Envia requisição ao daemon via Unix socket e aguarda a resposta
+dns_resolver::CacheReply sendCommand(dns_resolver::CacheMessageWriter& request) {
+    dns_resolver::CacheReply reply;
+    reply.opcode = dns_resolver::CacheOpcode::ERROR;
+    
     // Conectar ao socket
     int sock = socket(AF_UNIX, SOCK_STREAM, 0);
     if (sock < 0) {
-        return "ERROR: Failed to create socket";
+        reply.payload = "Failed to create socket\n";
+        return reply;
     }
     
     struct sockaddr_un addr;
@@ -35,45 +58,70 @@ std::string sendCommand(const std::string& command) {
     
     if (connect(sock, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
         close(sock);
-        return "ERROR: Daemon not running";
+        reply.payload = "Daemon not running\n";
+        return reply;
     }
     
-    // Enviar comando
-    send(sock, command.c_str(), command.size(), 0);
+    // Enviar requisição (request_id fixo: uma requisição por conexão)
+    std::string frame = request.finish();
+    dns_resolver::CacheProtocol::setRequestId(frame, 1);
+    send(sock, frame.data(), frame.size(), 0);
     
-    // Receber resposta
+    // Receber resposta até completar o frame
+    std::string inbuf;
+    dns_resolver::CacheFrameHeader header;
+    std::string_view payload;
+    size_t offset = 0;
     char buffer[4096];
-    ssize_t n = recv(sock, buffer, sizeof(buffer) - 1, 0);
-    close(sock);
-    
-    if (n <= 0) {
-        return "ERROR: No response from daemon";
+    try {
+        while (!dns_resolver::CacheProtocol::extractFrame(inbuf, offset, header, payload)) {
+            ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                close(sock);
+                reply.payload = "No response from daemon\n";
+                return reply;
+            }
+            inbuf.append(buffer, static_cast<size_t>(n));
+        }
+        
+        // OK e ERROR carregam uma mensagem de texto
+        dns_resolver::CacheMessageReader reader(payload);
+        reply.opcode = header.opcode;
+        reply.payload = std::string(reader.getBlob());
+    } catch (const std::exception& e) {
+        reply.opcode = dns_resolver::CacheOpcode::ERROR;
+        reply.payload = std::string("Invalid response from daemon: ") + e.what() + "\n";
     }
+    close(sock);
     
-    buffer[n] = '\0';
-    return std::string(buffer);
+    return reply;
 }
 
-// Parse resposta do daemon (formato: OK|message ou ERROR|message)
-void parseResponse(const std::string& response) {
-    size_t pos = response.find('|');
-    if (pos == std::string::npos) {
-        std::cout << response;
-        return;
+// Exibe resposta do daemon (mensagem de OK ou ERROR)
+void parseResponse(const dns_resolver::CacheReply& reply) {
+    if (reply.opcode == dns_resolver::CacheOpcode::OK) {
+        std::cout << reply.payload;
+    } else {
+        std::cerr << "Error: " << reply.payload;
     }
-    
-    std::string status = response.substr(0, pos);
-    std::string message = response.substr(pos + 1);
-    
-    if (status == "ERROR") {
-        std::cerr << "Error: " << message;
+}
+
+// Converte alvo textual (positive/negative/all) para o protocolo
+bool parseTarget(const std::string& type, dns_resolver::CacheTarget& target) {
+    if (type == "positive") {
+        target = dns_resolver::CacheTarget::POSITIVE;
+    } else if (type == "negative") {
+        target = dns_resolver::CacheTarget::NEGATIVE;
+    } else if (type == "all") {
+        target = dns_resolver::CacheTarget::ALL;
     } else {
-        std::cout << message;
+        return false;
     }
+    return true;
 }
 
 // Ativa o daemon (fork para background)
-void activate() {
+void activate(const dns_cache::DaemonConfig& config) {
     // Verificar se já está rodando
     std::ifstream check_pidfile(PID_FILE);
     if (check_pidfile.is_open()) {
@@ -118,7 +166,12 @@ void activate() {
     
     // Iniciar daemon
     dns_cache::CacheDaemon daemon;
+    daemon.setConfig(config);
+    g_daemon = &daemon;
+    std::signal(SIGTERM, handleTerminate);
+    std::signal(SIGINT, handleTerminate);
     daemon.run();
+    g_daemon = nullptr;
     
     // Cleanup ao terminar
     unlink(PID_FILE);
@@ -138,10 +191,11 @@ void deactivate() {
     
     // Enviar SIGTERM
     if (kill(pid, SIGTERM) == 0) {
+        // Aguardar o término (o daemon grava o snapshot antes de sair)
+        for (int i = 0; i < 100 && kill(pid, 0) == 0; i++) {
+            usleep(100000);
+        }
         std::cout << "Cache daemon deactivated" << std::endl;
-        
-        // Aguardar um pouco e remover PID file
-        sleep(1);
         unlink(PID_FILE);
     } else {
         std::cout << "Failed to stop daemon (PID: " << pid << ")" << std::endl;
@@ -167,8 +221,8 @@ void status() {
         std::cout << "Daemon: Running (PID: " << pid << ")" << std::endl;
         
         // Pegar informações detalhadas do daemon
-        std::string response = sendCommand("STATUS");
-        parseResponse(response);
+        dns_resolver::CacheMessageWriter request(dns_resolver::CacheOpcode::STATUS);
+        parseResponse(sendCommand(request));
     } else {
         std::cout << "Daemon: Not running (stale PID file)" << std::endl;
         unlink(PID_FILE);
@@ -177,36 +231,116 @@ void status() {
 
 // Limpa todo o cache
 void flush() {
-    std::string response = sendCommand("FLUSH");
-    parseResponse(response);
+    dns_resolver::CacheMessageWriter request(dns_resolver::CacheOpcode::FLUSH);
+    parseResponse(sendCommand(request));
 }
 
 // Lista cache
 void list(const std::string& type) {
-    std::string response = sendCommand("LIST " + type);
-    parseResponse(response);
+    dns_resolver::CacheTarget target;
+    if (!parseTarget(type, target)) {
+        std::cerr << "Invalid list type: " << type << std::endl;
+        return;
+    }
+    dns_resolver::CacheMessageWriter request(dns_resolver::CacheOpcode::LIST);
+    request.putU8(static_cast<uint8_t>(target));
+    parseResponse(sendCommand(request));
 }
 
 // Purge cache
 void purge(const std::string& type) {
-    std::string response = sendCommand("PURGE " + type);
-    parseResponse(response);
+    dns_resolver::CacheTarget target;
+    if (!parseTarget(type, target)) {
+        std::cerr << "Invalid purge type: " << type << std::endl;
+        return;
+    }
+    dns_resolver::CacheMessageWriter request(dns_resolver::CacheOpcode::PURGE);
+    request.putU8(static_cast<uint8_t>(target));
+    parseResponse(sendCommand(request));
+}
+
+// Converte tamanho com sufixo opcional (K, M, G) para bytes
+// Recusa sinal ('-' seria convertido por stoull em valor enorme), espaços
+// e valores que não cabem em size_t após o multiplicador
+bool parseByteSize(const std::string& text, size_t& bytes) {
+    if (text.empty() || text[0] == '-' || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    
+    size_t pos = 0;
+    unsigned long long value;
+    try {
+        value = std::stoull(text, &pos);
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    std::string suffix = text.substr(pos);
+    
+    unsigned long long multiplier = 1;
+    if (suffix == "K" || suffix == "k") {
+        multiplier = 1024ULL;
+    } else if (suffix == "M" || suffix == "m") {
+        multiplier = 1024ULL * 1024;
+    } else if (suffix == "G" || suffix == "g") {
+        multiplier = 1024ULL * 1024 * 1024;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    
+    if (value > SIZE_MAX / multiplier) {
+        return false;
+    }
+    bytes = static_cast<size_t>(value * multiplier);
+    return true;
+}
+
+// Converte contagem decimal em [min, max] (sem sinal, espaços nem sufixo)
+bool parseCount(const std::string& text, size_t min, size_t max, size_t& count) {
+    if (text.empty() || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+    
+    size_t pos = 0;
+    unsigned long value;
+    try {
+        value = std::stoul(text, &pos);
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+    if (pos != text.size() || value < min || value > max) {
+        return false;
+    }
+    count = static_cast<size_t>(value);
+    return true;
+}
+
+// Configura orçamento de memória
+void setMemory(const std::string& text) {
+    size_t bytes;
+    if (!parseByteSize(text, bytes)) {
+        std::cerr << "Invalid memory size: " << text << std::endl;
+        return;
+    }
+    dns_resolver::CacheMessageWriter request(dns_resolver::CacheOpcode::SET_MEMORY);
+    request.putU64(bytes);
+    parseResponse(sendCommand(request));
 }
 
 // Configura tamanho de cache
 void setCache(const std::string& type, size_t size) {
-    std::string cmd;
+    dns_resolver::CacheOpcode opcode;
     if (type == "positive") {
-        cmd = "SET_POSITIVE " + std::to_string(size);
+        opcode = dns_resolver::CacheOpcode::SET_POSITIVE;
     } else if (type == "negative") {
-        cmd = "SET_NEGATIVE " + std::to_string(size);
+        opcode = dns_resolver::CacheOpcode::SET_NEGATIVE;
     } else {
         std::cerr << "Invalid cache type: " << type << std::endl;
         return;
     }
     
-    std::string response = sendCommand(cmd);
-    parseResponse(response);
+    dns_resolver::CacheMessageWriter request(opcode);
+    request.putU32(static_cast<uint32_t>(size));
+    parseResponse(sendCommand(request));
 }
 
 // Mostra ajuda
@@ -215,12 +349,24 @@ void showHelp(const char* prog_name) {
     std::cout << "USAGE:\n\n";
     std::cout << "  Lifecycle:\n";
     std::cout << "    " << prog_name << " --activate           Start daemon in background\n";
+    std::cout << "        [--workers N]                Command worker threads (default: 4)\n";
+    std::cout << "        [--backlog N]                listen() backlog (default: 256)\n";
+    std::cout << "        [--max-connections N]        Concurrent client connections (default: 1024)\n";
+    std::cout << "        [--memory SIZE]              Cache memory budget, e.g. 512M (default: 64M)\n";
+    std::cout << "        [--prefetch-hits N]          Hits before an entry is prefetched (default: 5)\n";
+    std::cout << "        [--prefetch-window PCT]      Refresh in the last PCT% of TTL, 0 = off (default: 10)\n";
+    std::cout << "        [--snapshot PATH]            Warm-restart snapshot file, none = off (default: /tmp/dns_cache.d/dns_cache.snapshot)\n";
+    std::cout << "        [--snapshot-interval SECONDS] Periodic snapshot, 0 = only on stop (default: 300)\n";
+    std::cout << "        [--shm-slots N]              Publish cache in shared memory for resolvers, 0 = off (default: 0)\n";
+    std::cout << "        [--stale-window SECONDS]     Serve expired entries for up to SECONDS, 0 = off (default: 86400)\n";
+    std::cout << "        [--admission on|off]         TinyLFU admission filter for the positive cache (default: on)\n";
     std::cout << "    " << prog_name << " --deactivate         Stop daemon\n";
     std::cout << "    " << prog_name << " --status             Check daemon status\n\n";
     std::cout << "  Management:\n";
     std::cout << "    " << prog_name << " --flush              Clear all cache\n";
     std::cout << "    " << prog_name << " --set positive N     Set positive cache size\n";
     std::cout << "    " << prog_name << " --set negative N     Set negative cache size\n";
+    std::cout << "    " << prog_name << " --set memory SIZE    Set memory budget (K/M/G suffix)\n";
     std::cout << "    " << prog_name << " --purge positive     Clear positive cache\n";
     std::cout << "    " << prog_name << " --purge negative     Clear negative cache\n";
     std::cout << "    " << prog_name << " --purge all          Clear all cache\n";
@@ -232,7 +378,8 @@ void showHelp(const char* prog_name) {
     std::cout << "  " << prog_name << " --activate\n\n";
     std::cout << "  # Configure cache\n";
     std::cout << "  " << prog_name << " --set positive 100\n";
-    std::cout << "  " << prog_name << " --set negative 50\n\n";
+    std::cout << "  " << prog_name << " --set negative 50\n";
+    std::cout << "  " << prog_name << " --set memory 512M\n\n";
     std::cout << "  # Check status\n";
     std::cout << "  " << prog_name << " --status\n\n";
     std::cout << "  # Stop daemon\n";
@@ -249,7 +396,60 @@ int main(int argc, char* argv[]) {
     
     // Comandos de ciclo de vida
     if (cmd == "--activate") {
-        activate();
+        dns_cache::DaemonConfig config;
+        for (int i = 2; i + 1 < argc; i += 2) {
+            std::string opt = argv[i];
+            size_t value = std::atoi(argv[i + 1]);
+            if (opt == "--memory") {
+                if (!parseByteSize(argv[i + 1], config.memory_limit)) {
+                    std::cerr << "Invalid memory size: " << argv[i + 1] << std::endl;
+                    return 1;
+                }
+            } else if (opt == "--prefetch-hits") {
+                config.prefetch_min_hits = static_cast<uint32_t>(value);
+            } else if (opt == "--prefetch-window") {
+                config.prefetch_window = static_cast<uint32_t>(value > 100 ? 100 : value);
+            } else if (opt == "--snapshot") {
+                config.snapshot_path = (std::string(argv[i + 1]) == "none") ? "" : argv[i + 1];
+            } else if (opt == "--snapshot-interval") {
+                config.snapshot_interval = static_cast<uint32_t>(value);
+            } else if (opt == "--shm-slots") {
+                config.shm_slots = value;
+            } else if (opt == "--stale-window") {
+                config.stale_window = static_cast<uint32_t>(value);
+            } else if (opt == "--admission") {
+                std::string mode = argv[i + 1];
+                if (mode != "on" && mode != "off") {
+                    std::cerr << "Invalid admission mode: " << mode << " (use on|off)" << std::endl;
+                    return 1;
+                }
+                config.admission = (mode == "on");
+            } else if (opt == "--workers") {
+                if (!parseCount(argv[i + 1], 1, MAX_WORKERS, config.worker_threads)) {
+                    std::cerr << "Invalid worker count: " << argv[i + 1]
+                              << " (1-" << MAX_WORKERS << ")" << std::endl;
+                    return 1;
+                }
+            } else if (opt == "--backlog") {
+                size_t backlog;
+                if (!parseCount(argv[i + 1], 1, MAX_BACKLOG, backlog)) {
+                    std::cerr << "Invalid backlog: " << argv[i + 1]
+                              << " (1-" << MAX_BACKLOG << ")" << std::endl;
+                    return 1;
+                }
+                config.listen_backlog = static_cast<int>(backlog);
+            } else if (opt == "--max-connections") {
+                if (!parseCount(argv[i + 1], 1, MAX_CONNECTIONS, config.max_connections)) {
+                    std::cerr << "Invalid max connections: " << argv[i + 1]
+                              << " (1-" << MAX_CONNECTIONS << ")" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Unknown activate option: " << opt << std::endl;
+                return 1;
+            }
+        }
+        activate(config);
     } else if (cmd == "--deactivate") {
         deactivate();
     } else if (cmd == "--status") {
@@ -260,7 +460,9 @@ int main(int argc, char* argv[]) {
         showHelp(argv[0]);
     }
     // Comandos com argumentos
-    else if (cmd == "--set" && argc >= 4) {
+    else if (cmd == "--set" && argc >= 4 && std::string(argv[2]) == "memory") {
+        setMemory(argv[3]);
+    } else if (cmd == "--set" && argc >= 4) {
         std::string type = argv[2];
         size_t size = std::atoi(argv[3]);
         setCache(type, size);
@@ -0,0 +1,772 @@
+/*
+ * ----------------------------------------
+ * Arquivo: AsyncResolver.cpp
+ * Propósito: Implementação do motor de resolução orientado a eventos (epoll)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/AsyncResolver.h"
+#include "dns_resolver/DelegationCache.h"
+#include "dns_resolver/InfraCache.h"
+#include "dns_resolver/SharedCache.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace dns_resolver {
+
+// Estado de uma resolução em andamento
+struct AsyncResolver::Resolution {
+    uint64_t id = 0;
+    std::string domain;              // Nome pedido
+    uint16_t qtype = 0;
+    std::string key;                 // Registro em by_key_ (vazio = não compartilhável)
+    bool counted = false;            // Ocupa uma vaga de max_in_flight
+    std::vector<Callback> callbacks; // Chamadores que esperam esta resposta
+    std::vector<uint64_t> parents;   // NS sem glue: resoluções que esperam este endereço
+    std::string ns_name;             // Nome do NS resolvido (se há parents)
+    int depth = 0;
+
+    // Alvo atual (muda ao seguir CNAME)
+    std::string target;
+    int cname_depth = 0;
+    bool following_cname = false;
+    DNSMessage accumulated;          // Primeira resposta com CNAME + respostas seguintes
+    std::string cached_zone;         // Começou num zone cut do DelegationCache
+    std::string server_zone = ".";   // Zona servida pelos servidores do passo atual
+    int iterations = 0;
+
+    // Passo atual: servidores do conjunto NS, enviados um a cada RTO
+    std::vector<std::string> servers;
+    std::vector<int> rto_ms;
+    size_t sent = 0;
+    std::vector<uint8_t> query;
+    std::vector<int> fds;
+    std::vector<size_t> fd_server;
+    std::vector<Clock::time_point> sent_at;
+    Clock::time_point next_send;
+    Clock::time_point step_deadline;
+    uint64_t timer_generation = 0;
+    bool awaiting_tcp = false;
+
+    // Delegação sem glue: NS ainda não tentados
+    std::vector<std::string> pending_ns;
+};
+
+namespace {
+
+// Helpers usam só métodos const: trust anchors não são necessários
+ResolverConfig helperConfig(const ResolverConfig& config) {
+    ResolverConfig helper = config;
+    helper.use_cache = false;
+    helper.quiet_mode = true;
+    helper.trace_mode = false;
+    return helper;
+}
+
+std::string questionKey(const std::string& domain, uint16_t qtype) {
+    return normalizeCacheName(domain) + "/" + std::to_string(qtype);
+}
+
+} // namespace
+
+// ========== CICLO DE VIDA ==========
+
+bool AsyncResolver::supports(const ResolverConfig& config) {
+    return !config.dnssec_enabled && config.mode == QueryMode::UDP;
+}
+
+AsyncResolver::AsyncResolver(const ResolverConfig& config, size_t max_in_flight)
+    : config_(config),
+      engine_(helperConfig(config)),
+      max_in_flight_(max_in_flight == 0 ? 1 : max_in_flight) {
+    if (!supports(config)) {
+        throw std::invalid_argument("AsyncResolver requires UDP mode without DNSSEC");
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        if (epoll_fd_ >= 0) close(epoll_fd_);
+        if (wake_fd_ >= 0) close(wake_fd_);
+        throw std::runtime_error(std::string("Failed to create event loop: ") + strerror(errno));
+    }
+
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    tcp_pool_ = std::make_unique<ThreadPool>(2);
+    loop_thread_ = std::thread(&AsyncResolver::loop, this);
+}
+
+AsyncResolver::~AsyncResolver() {
+    stop_ = true;
+    wake();
+    if (loop_thread_.joinable()) {
+        loop_thread_.join();
+    }
+    // Consultas TCP em curso terminam antes de fechar o eventfd que elas usam
+    tcp_pool_.reset();
+    close(epoll_fd_);
+    close(wake_fd_);
+}
+
+void AsyncResolver::resolve(const std::string& domain, uint16_t qtype, Callback callback) {
+    pending_++;
+    {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        submitted_.push_back(Submission{domain, qtype, std::move(callback)});
+    }
+    wake();
+}
+
+std::future<DNSMessage> AsyncResolver::resolve(const std::string& domain, uint16_t qtype) {
+    auto promise = std::make_shared<std::promise<DNSMessage>>();
+    std::future<DNSMessage> future = promise->get_future();
+    resolve(domain, qtype, [promise](AsyncResult& result) {
+        if (result.ok) {
+            promise->set_value(std::move(result.response));
+        } else {
+            promise->set_exception(std::make_exception_ptr(std::runtime_error(result.error)));
+        }
+    });
+    return future;
+}
+
+void AsyncResolver::post(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        posted_.push_back(std::move(fn));
+    }
+    wake();
+}
+
+void AsyncResolver::wake() {
+    uint64_t one = 1;
+    ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+// ========== LOOP DE EVENTOS ==========
+
+void AsyncResolver::loop() {
+    struct epoll_event events[MAX_EVENTS];
+
+    while (!stop_) {
+        // Acordar no próximo timer (RTO ou prazo do passo)
+        int timeout_ms = -1;
+        while (!timers_.empty() && find(timers_.top().id) == nullptr) {
+            timers_.pop();
+        }
+        if (!timers_.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                timers_.top().when - Clock::now()).count();
+            timeout_ms = static_cast<int>(std::max<long long>(0, wait + 1));
+        }
+
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        if (n < 0 && errno != EINTR) {
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.fd == wake_fd_) {
+                uint64_t value;
+                while (read(wake_fd_, &value, sizeof(value)) > 0) {
+                }
+                drainSubmissions();
+            } else {
+                onReadable(events[i].data.fd);
+            }
+        }
+
+        fireTimers();
+        admitWaiting();
+    }
+
+    // Parada: quem ainda espera recebe erro
+    while (!active_.empty()) {
+        auto it = active_.begin();
+        it->second->parents.clear();
+        if (it->second->callbacks.empty()) {
+            closeSockets(*it->second);
+            active_.erase(it);
+            continue;
+        }
+        complete(*it->second, false, DNSMessage(), "Resolver stopped");
+    }
+    drainSubmissions();
+    for (auto& submission : waiting_) {
+        AsyncResult result;
+        result.domain = submission.domain;
+        result.qtype = submission.qtype;
+        result.error = "Resolver stopped";
+        pending_--;
+        submission.callback(result);
+    }
+    waiting_.clear();
+}
+
+void AsyncResolver::drainSubmissions() {
+    std::deque<Submission> submitted;
+    std::deque<std::function<void()>> posted;
+    {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        submitted.swap(submitted_);
+        posted.swap(posted_);
+    }
+    for (auto& submission : submitted) {
+        if (!join(submission)) {
+            waiting_.push_back(std::move(submission));
+        }
+    }
+    for (auto& fn : posted) {
+        fn();
+    }
+    admitWaiting();
+}
+
+void AsyncResolver::admitWaiting() {
+    while (!stop_ && !waiting_.empty()) {
+        if (join(waiting_.front())) {
+            waiting_.pop_front();
+            continue;
+        }
+        if (top_level_active_ >= max_in_flight_) {
+            break;
+        }
+        Submission submission = std::move(waiting_.front());
+        waiting_.pop_front();
+
+        Resolution& ref = create(submission.domain, submission.qtype);
+        ref.callbacks.push_back(std::move(submission.callback));
+        ref.counted = true;
+        top_level_active_++;
+        start(ref);
+    }
+}
+
+bool AsyncResolver::join(Submission& submission) {
+    if (!config_.coalesce_inflight) {
+        return false;
+    }
+    auto it = by_key_.find(questionKey(submission.domain, submission.qtype));
+    if (it == by_key_.end()) {
+        return false;
+    }
+    // Mesma pergunta já em curso: esperar a resposta dela, sem ocupar vaga
+    find(it->second)->callbacks.push_back(std::move(submission.callback));
+    coalesced_++;
+    return true;
+}
+
+AsyncResolver::Resolution& AsyncResolver::create(const std::string& domain, uint16_t qtype) {
+    auto r = std::make_unique<Resolution>();
+    r->id = next_id_++;
+    r->domain = domain;
+    r->qtype = qtype;
+    if (config_.coalesce_inflight) {
+        std::string key = questionKey(domain, qtype);
+        if (by_key_.emplace(key, r->id).second) {
+            r->key = key;
+        }
+    }
+    Resolution& ref = *r;
+    active_.emplace(ref.id, std::move(r));
+    return ref;
+}
+
+bool AsyncResolver::waitsFor(uint64_t waiter, uint64_t id) {
+    // Subir pelos parents de id: waiter espera (direta ou indiretamente) por id?
+    std::vector<uint64_t> stack{id};
+    std::vector<uint64_t> seen;
+    while (!stack.empty()) {
+        uint64_t current = stack.back();
+        stack.pop_back();
+        if (current == waiter) {
+            return true;
+        }
+        if (std::find(seen.begin(), seen.end(), current) != seen.end()) {
+            continue;
+        }
+        seen.push_back(current);
+        Resolution* r = find(current);
+        if (r != nullptr) {
+            stack.insert(stack.end(), r->parents.begin(), r->parents.end());
+        }
+    }
+    return false;
+}
+
+void AsyncResolver::fireTimers() {
+    auto now = Clock::now();
+    while (!timers_.empty() && timers_.top().when <= now) {
+        Timer timer = timers_.top();
+        timers_.pop();
+        Resolution* r = find(timer.id);
+        if (r != nullptr && r->timer_generation == timer.generation) {
+            onTimer(*r);
+        }
+    }
+}
+
+AsyncResolver::Resolution* AsyncResolver::find(uint64_t id) {
+    auto it = active_.find(id);
+    return it == active_.end() ? nullptr : it->second.get();
+}
+
+void AsyncResolver::armTimer(Resolution& r, Clock::time_point when) {
+    r.timer_generation++;
+    timers_.push(Timer{when, r.id, r.timer_generation});
+}
+
+void AsyncResolver::closeSockets(Resolution& r) {
+    for (int fd : r.fds) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        socket_owner_.erase(fd);
+        close(fd);
+    }
+    r.fds.clear();
+    r.fd_server.clear();
+    r.timer_generation++;   // Invalida o timer pendente
+}
+
+// ========== MÁQUINA DE ESTADOS ==========
+
+void AsyncResolver::start(Resolution& r) {
+    r.target = r.domain;
+    startLookup(r);
+}
+
+void AsyncResolver::startLookup(Resolution& r) {
+    // Zone cut mais profundo conhecido; sem ele, a raiz
+    std::string zone;
+    std::vector<std::string> pool;
+    std::string server = engine_.cachedStartServer(r.target, zone, pool);
+    r.iterations = 0;
+    if (server.empty()) {
+        r.cached_zone.clear();
+        r.server_zone = ".";
+        server = config_.root_servers[engine_.selectByRtt(config_.root_servers)];
+        beginStep(r, server, config_.root_servers);
+    } else {
+        r.cached_zone = zone;
+        r.server_zone = zone;
+        beginStep(r, server, pool);
+    }
+}
+
+void AsyncResolver::beginStep(
+    Resolution& r,
+    const std::string& primary,
+    const std::vector<std::string>& pool
+) {
+    if (++r.iterations > config_.max_iterations) {
+        stepFailed(r, "Max iterations (" + std::to_string(config_.max_iterations) + ") exceeded");
+        return;
+    }
+
+    r.servers = engine_.retryOrder(primary, pool);
+    r.rto_ms.clear();
+    for (const auto& server : r.servers) {
+        r.rto_ms.push_back(static_cast<int>(config_.use_infra_cache
+            ? InfraCache::instance().retryTimeoutMs(server)
+            : InfraCache::UNKNOWN_RTO_MS));
+    }
+    r.sent_at.assign(r.servers.size(), Clock::time_point());
+    r.sent = 0;
+    r.query = engine_.buildQuery(r.target, r.qtype);
+    r.step_deadline = Clock::now() + std::chrono::seconds(config_.timeout_seconds);
+    sendNext(r);
+}
+
+void AsyncResolver::sendNext(Resolution& r) {
+    while (r.sent < r.servers.size()) {
+        size_t i = r.sent++;
+
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(53);
+        if (inet_pton(AF_INET, r.servers[i].c_str(), &addr.sin_addr) <= 0) {
+            continue;
+        }
+
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            continue;
+        }
+        struct epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            send(fd, r.query.data(), r.query.size(), 0) != static_cast<ssize_t>(r.query.size()) ||
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+
+        auto now = Clock::now();
+        r.sent_at[i] = now;
+        r.fds.push_back(fd);
+        r.fd_server.push_back(i);
+        socket_owner_[fd] = r.id;
+        r.next_send = now + std::chrono::milliseconds(std::max(1, r.rto_ms[i]));
+        armTimer(r, r.sent < r.servers.size() ? std::min(r.next_send, r.step_deadline)
+                                              : r.step_deadline);
+        return;
+    }
+
+    // Todos enviados: aguardar o prazo do passo (ou falhar se nenhum socket ficou)
+    if (r.fds.empty()) {
+        stepFailed(r, "No reachable server for " + r.target);
+        return;
+    }
+    armTimer(r, r.step_deadline);
+}
+
+void AsyncResolver::onTimer(Resolution& r) {
+    if (Clock::now() >= r.step_deadline) {
+        if (config_.use_infra_cache) {
+            for (size_t i = 0; i < r.sent; i++) {
+                InfraCache::instance().recordTimeout(r.servers[i]);
+            }
+        }
+        closeSockets(r);
+        stepFailed(r, "Timeout ao aguardar resposta DNS de " + std::to_string(r.sent) +
+                      " servidor(es) (" + std::to_string(config_.timeout_seconds) + "s)");
+        return;
+    }
+    // RTO do último servidor expirou: a query segue também para o próximo
+    sendNext(r);
+}
+
+void AsyncResolver::onReadable(int fd) {
+    auto owner = socket_owner_.find(fd);
+    if (owner == socket_owner_.end()) {
+        return;
+    }
+    Resolution* found = find(owner->second);
+    if (found == nullptr) {
+        return;
+    }
+    Resolution& r = *found;
+    size_t slot = static_cast<size_t>(
+        std::find(r.fds.begin(), r.fds.end(), fd) - r.fds.begin());
+    size_t index = r.fd_server[slot];
+
+    std::vector<uint8_t> buffer(4096);
+    while (true) {
+        ssize_t n = recv(fd, buffer.data(), buffer.size(), 0);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (n < 0) {
+            // ICMP (porta inacessível): este servidor não responde; seguir com os outros
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            socket_owner_.erase(fd);
+            close(fd);
+            r.fds.erase(r.fds.begin() + static_cast<std::ptrdiff_t>(slot));
+            r.fd_server.erase(r.fd_server.begin() + static_cast<std::ptrdiff_t>(slot));
+            if (config_.use_infra_cache) {
+                InfraCache::instance().recordTimeout(r.servers[index]);
+            }
+            if (r.fds.empty()) {
+                sendNext(r);
+            }
+            return;
+        }
+        // Resposta curta ou ID diferente: descartar e continuar esperando
+        if (n < 12 || buffer[0] != r.query[0] || buffer[1] != r.query[1]) {
+            continue;
+        }
+        buffer.resize(static_cast<size_t>(n));
+        break;
+    }
+
+    // Quem recebeu a query antes e não respondeu estourou o próprio RTO
+    auto rtt = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - r.sent_at[index]).count();
+    if (config_.use_infra_cache) {
+        for (size_t i = 0; i < index; i++) {
+            InfraCache::instance().recordTimeout(r.servers[i]);
+        }
+        InfraCache::instance().recordRtt(r.servers[index], static_cast<uint32_t>(rtt));
+    }
+    closeSockets(r);
+
+    DNSMessage response;
+    try {
+        response = DNSParser::parse(buffer);
+    } catch (const std::exception& e) {
+        stepFailed(r, std::string("Invalid response: ") + e.what());
+        return;
+    }
+
+    if (!engine_.isTruncated(response)) {
+        onResponse(r, response);
+        return;
+    }
+
+    // Truncada: TCP bloqueante fora do loop, resultado volta via post()
+    r.awaiting_tcp = true;
+    uint64_t id = r.id;
+    std::string server = r.servers[index];
+    std::vector<uint8_t> query = r.query;
+    int timeout = config_.timeout_seconds * 2;
+    tcp_pool_->enqueue([this, id, server, query, timeout]() {
+        std::string error;
+        DNSMessage tcp_response;
+        try {
+            tcp_response = DNSParser::parse(NetworkModule::queryTCP(server, query, timeout));
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        post([this, id, error, tcp_response]() {
+            Resolution* target = find(id);
+            if (target == nullptr || !target->awaiting_tcp) {
+                return;
+            }
+            target->awaiting_tcp = false;
+            if (error.empty()) {
+                onResponse(*target, tcp_response);
+            } else {
+                stepFailed(*target, error);
+            }
+        });
+    });
+}
+
+void AsyncResolver::onResponse(Resolution& r, const DNSMessage& response) {
+    // RCODE de erro: resposta final (servidor lame do cache → recomeçar na raiz)
+    if (response.header.rcode != 0) {
+        if ((response.header.rcode == 2 || response.header.rcode == 5) && !r.cached_zone.empty()) {
+            stepFailed(r, "Cached delegation returned RCODE " +
+                          std::to_string(response.header.rcode));
+            return;
+        }
+        complete(r, true, response, "");
+        return;
+    }
+
+    if (response.header.ancount > 0) {
+        if (engine_.hasCNAME(response, r.qtype)) {
+            followCNAME(r, response);
+            return;
+        }
+        complete(r, true, response, "");
+        return;
+    }
+
+    if (engine_.isNODATA(response, r.qtype)) {
+        complete(r, true, response, "");
+        return;
+    }
+
+    if (!engine_.isDelegation(response)) {
+        stepFailed(r, "Unexpected response: no answer, not a delegation, and not NODATA");
+        return;
+    }
+
+    std::vector<std::string> nameservers = engine_.extractNameservers(response);
+    std::map<std::string, std::string> glue_records = engine_.extractGlueRecords(response);
+    std::string zone;
+    for (const auto& rr : response.authority) {
+        if (rr.type == DNSType::NS && !rr.name.empty()) {
+            zone = rr.name;
+            break;
+        }
+    }
+    engine_.rememberDelegation(response, r.target, r.server_zone, zone, nameservers, glue_records);
+    r.server_zone = zone;
+
+    std::vector<std::string> pool;
+    for (const auto& ns : nameservers) {
+        auto it = glue_records.find(ns);
+        if (it != glue_records.end()) {
+            pool.push_back(it->second);
+        }
+    }
+    if (!pool.empty()) {
+        beginStep(r, pool[engine_.selectByRtt(pool)], pool);
+        return;
+    }
+
+    // Sem glue: resolver os NS, um por vez, como sub-resoluções
+    r.pending_ns = nameservers;
+    std::reverse(r.pending_ns.begin(), r.pending_ns.end());
+    resolveNextNameserver(r);
+}
+
+void AsyncResolver::followCNAME(Resolution& r, const DNSMessage& response) {
+    if (r.cname_depth >= MAX_CNAME_DEPTH) {
+        complete(r, false, response,
+                 "CNAME chain too long (depth > " + std::to_string(MAX_CNAME_DEPTH) + ")");
+        return;
+    }
+
+    std::string cname = engine_.extractCNAME(response);
+    if (cname.empty()) {
+        complete(r, false, response, "No CNAME found in response");
+        return;
+    }
+
+    // Manter todos os CNAMEs (como ResolverEngine::followCNAME)
+    if (!r.following_cname) {
+        r.accumulated = response;
+        r.following_cname = true;
+    } else {
+        r.accumulated.answers.insert(r.accumulated.answers.end(),
+                                     response.answers.begin(), response.answers.end());
+    }
+    r.cname_depth++;
+    r.target = cname;
+    startLookup(r);
+}
+
+void AsyncResolver::resolveNextNameserver(Resolution& r) {
+    while (!r.pending_ns.empty()) {
+        std::string ns = r.pending_ns.back();
+        r.pending_ns.pop_back();
+
+        if (config_.use_delegation_cache) {
+            std::string cached = DelegationCache::instance().findAddress(ns);
+            if (!cached.empty()) {
+                beginStep(r, cached, {cached});
+                return;
+            }
+        }
+
+        if (r.depth + 1 > MAX_DEPTH) {
+            stepFailed(r, "Recursion depth exceeded (max " + std::to_string(MAX_DEPTH) + ")");
+            return;
+        }
+
+        // Endereço do NS já em resolução (outra delegação da mesma zona, ou
+        // um chamador): esperar por ela, a menos que ela espere por r
+        if (config_.coalesce_inflight) {
+            auto running = by_key_.find(questionKey(ns, DNSType::A));
+            if (running != by_key_.end() && !waitsFor(running->second, r.id)) {
+                Resolution* existing = find(running->second);
+                if (existing->ns_name.empty()) {
+                    existing->ns_name = ns;
+                }
+                existing->parents.push_back(r.id);
+                coalesced_++;
+                return;
+            }
+        }
+
+        // Sub-resolução do endereço do NS; r continua quando ela terminar
+        Resolution& ref = create(ns, DNSType::A);
+        ref.parents.push_back(r.id);
+        ref.ns_name = ns;
+        ref.depth = r.depth + 1;
+        start(ref);
+        return;
+    }
+
+    stepFailed(r, "No usable nameserver found in delegation");
+}
+
+void AsyncResolver::stepFailed(Resolution& r, const std::string& error) {
+    // Começou num zone cut em cache: descartar a delegação e recomeçar na raiz
+    if (!r.cached_zone.empty()) {
+        DelegationCache::instance().invalidate(r.cached_zone);
+        r.cached_zone.clear();
+        r.server_zone = ".";
+        r.iterations = 0;
+        r.pending_ns.clear();
+        std::string root = config_.root_servers[engine_.selectByRtt(config_.root_servers)];
+        beginStep(r, root, config_.root_servers);
+        return;
+    }
+    complete(r, false, DNSMessage(), error);
+}
+
+void AsyncResolver::complete(
+    Resolution& r,
+    bool ok,
+    const DNSMessage& response,
+    const std::string& error
+) {
+    closeSockets(r);
+    auto node = active_.find(r.id);
+    std::unique_ptr<Resolution> owned = std::move(node->second);
+    active_.erase(node);
+    if (!owned->key.empty()) {
+        by_key_.erase(owned->key);
+    }
+
+    // Sub-resolução de NS: devolver o endereço a quem espera
+    if (!owned->parents.empty()) {
+        std::string address;
+        if (ok) {
+            for (const auto& rr : response.answers) {
+                if (rr.type == DNSType::A && !rr.rdata_a.empty()) {
+                    address = rr.rdata_a;
+                    if (config_.use_delegation_cache) {
+                        DelegationCache::instance().storeAddress(owned->ns_name, address, rr.ttl);
+                    }
+                    break;
+                }
+            }
+        }
+        for (uint64_t id : owned->parents) {
+            Resolution* parent = find(id);
+            if (parent == nullptr) {
+                continue;
+            }
+            if (!address.empty()) {
+                beginStep(*parent, address, {address});
+            } else {
+                resolveNextNameserver(*parent);
+            }
+        }
+    }
+
+    if (owned->callbacks.empty()) {
+        return;
+    }
+
+    AsyncResult result;
+    result.domain = owned->domain;
+    result.qtype = owned->qtype;
+    result.ok = ok;
+    result.error = error;
+    if (ok && owned->following_cname) {
+        // Combinar respostas (manter todos os CNAMEs + registro final)
+        result.response = std::move(owned->accumulated);
+        result.response.answers.insert(result.response.answers.end(),
+                                       response.answers.begin(), response.answers.end());
+        result.response.header.ancount = static_cast<uint16_t>(result.response.answers.size());
+    } else if (ok) {
+        result.response = response;
+    }
+
+    if (owned->counted) {
+        top_level_active_--;
+    }
+    pending_ -= owned->callbacks.size();
+    for (auto& callback : owned->callbacks) {
+        // Cada chamador recebe a sua cópia (o callback pode mover a resposta)
+        AsyncResult copy = result;
+        callback(copy);
+    }
+}
+
+} // namespace dns_resolver
@@ -9,17 +9,105 @@
  */
 
 #include "dns_resolver/CacheClient.h"
+#include "dns_resolver/DNSParser.h"
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <ctime>
 #include <iostream>
-#include <sstream>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace dns_resolver {
 
-CacheClient::CacheClient(const std::string& socket_path)
-    : socket_path_(socket_path) {
+namespace {
+
+// Conexão persistente com o daemon, uma por thread e caminho de socket
+// Reutilizada por todas as instâncias de CacheClient da thread
+struct ThreadConnection {
+    int fd = -1;
+    uint32_t next_request_id = 1;
+    std::string inbuf;
+
+    ~ThreadConnection() { reset(); }
+
+    void reset() {
+        if (fd >= 0) {
+            close(fd);
+        }
+        fd = -1;
+        inbuf.clear();
+    }
+};
+
+thread_local std::unordered_map<std::string, ThreadConnection> thread_connections;
+
+// Segmento de memória compartilhada do daemon, mapeado uma vez por processo
+// Se o daemon reinicia, o segmento antigo fica inativo e é remapeado
+struct SharedMapping {
+    std::shared_ptr<const SharedCache> cache;
+    time_t next_attach = 0;   // Tentativas de mapear limitadas a 1/s
+};
+
+std::mutex shared_mappings_mutex;
+std::unordered_map<std::string, SharedMapping> shared_mappings;
+
+// Cópia do mapeamento por thread: consultas não tocam o mutex global,
+// que só é usado para (re)mapear o segmento
+thread_local std::unordered_map<std::string, SharedMapping> thread_mappings;
+
+std::shared_ptr<const SharedCache> sharedCache(const std::string& name) {
+    SharedMapping& local = thread_mappings[name];
+    if (local.cache && local.cache->isActive()) {
+        return local.cache;
+    }
+    local.cache.reset();
+    
+    time_t now = std::time(nullptr);
+    if (now < local.next_attach) {
+        return nullptr;
+    }
+    local.next_attach = now + 1;
+    
+    std::lock_guard<std::mutex> lock(shared_mappings_mutex);
+    SharedMapping& mapping = shared_mappings[name];
+    if (mapping.cache && !mapping.cache->isActive()) {
+        mapping.cache.reset();
+    }
+    if (!mapping.cache && now >= mapping.next_attach) {
+        mapping.cache = SharedCache::attach(name);
+        mapping.next_attach = now + 1;
+    }
+    local.cache = mapping.cache;
+    return local.cache;
+}
+
+std::unique_ptr<DNSMessage> makeNegativeResponse(uint8_t rcode) {
+    auto negative_msg = std::make_unique<DNSMessage>();
+    negative_msg->header.qr = true;
+    negative_msg->header.rcode = rcode;
+    negative_msg->header.ancount = 0;
+    negative_msg->header.qdcount = 1;
+    return negative_msg;
+}
+
+// Desconta o tempo decorrido dos TTLs (mínimo 0); OPT não tem TTL real
+void ageRecords(std::vector<DNSResourceRecord>& records, uint32_t elapsed) {
+    for (auto& rr : records) {
+        if (rr.type != DNSType::OPT) {
+            rr.ttl = (rr.ttl > elapsed) ? rr.ttl - elapsed : 0;
+        }
+    }
+}
+
+} // namespace
+
+CacheClient::CacheClient(const std::string& socket_path, const std::string& shm_name)
+    : socket_path_(socket_path), shm_name_(shm_name) {
 }
 
 void CacheClient::setTraceEnabled(bool enabled) {
@@ -30,102 +118,232 @@ std::unique_ptr<DNSMessage> CacheClient::query(
     const std::string& qname,
     uint16_t qtype,
     uint16_t qclass
+) {
+    return lookup(CacheOpcode::QUERY, qname, qtype, qclass);
+}
+
+std::unique_ptr<DNSMessage> CacheClient::queryStale(
+    const std::string& qname,
+    uint16_t qtype,
+    uint16_t qclass
+) {
+    return lookup(CacheOpcode::QUERY_STALE, qname, qtype, qclass);
+}
+
+std::unique_ptr<DNSMessage> CacheClient::lookup(
+    CacheOpcode opcode,
+    const std::string& qname,
+    uint16_t qtype,
+    uint16_t qclass
 ) {
     // Se cache já foi detectado como indisponível, não tentar
     if (!daemon_available_) {
         return nullptr;
     }
     
-    traceLog("Querying cache for " + qname + " (type " + std::to_string(qtype) + ")...");
+    // Caminho rápido: espelho em memória compartilhada, sem syscall
+    if (opcode == CacheOpcode::QUERY) {
+        auto shared = lookupShared(qname, qtype, qclass);
+        if (shared) {
+            return shared;
+        }
+    }
     
-    // Conectar ao daemon
-    int sockfd;
-    if (!connectToCache(sockfd, 1000)) {
-        daemon_available_ = false;
-        traceLog("  Cache daemon unavailable (will use full resolution)");
+    bool stale = (opcode == CacheOpcode::QUERY_STALE);
+    traceLog(std::string(stale ? "Querying cache (stale) for " : "Querying cache for ") +
+             qname + " (type " + std::to_string(qtype) + ")...");
+    
+    // Construir requisição QUERY / QUERY_STALE
+    std::string frame = CacheMessageWriter(opcode)
+        .putString(qname)
+        .putU16(qtype)
+        .putU16(qclass)
+        .finish();
+    
+    // Enviar pela conexão persistente e aguardar resposta
+    CacheReply reply;
+    if (!transact(std::move(frame), reply)) {
+        if (!daemon_available_) {
+            traceLog("  Cache daemon unavailable (will use full resolution)");
+        } else {
+            traceLog("  Failed to query cache");
+        }
+        return nullptr;
+    }
+    
+    try {
+        CacheMessageReader reader(reply.payload);
+        
+        switch (reply.opcode) {
+        case CacheOpcode::MISS:
+            traceLog(stale ? "Cache MISS - no stale entry"
+                           : "Cache MISS - proceeding with full resolution");
+            return nullptr;
+        
+        case CacheOpcode::NEGATIVE: {
+            // Resposta negativa cacheada
+            uint8_t rcode = reader.getU8();
+            
+            std::string type = (rcode == 3) ? "NXDOMAIN" : "NODATA";
+            traceLog(std::string(stale ? " Cache HIT (NEGATIVE, stale): " : " Cache HIT (NEGATIVE): ") + type);
+            
+            // Criar DNSMessage com resposta negativa
+            return makeNegativeResponse(rcode);
+        }
+        
+        case CacheOpcode::HIT: {
+            traceLog(stale ? " Cache HIT (stale)" : " Cache HIT");
+            return parseHitResponse(reader.getBlob());
+        }
+        
+        default:
+            break;
+        }
+    } catch (const std::exception& e) {
+        traceLog("  Malformed cache response: " + std::string(e.what()));
         return nullptr;
     }
     
-    // RAII para socket
-    struct SocketGuard {
-        int fd;
-        ~SocketGuard() { if (fd >= 0) close(fd); }
-    } guard{sockfd};
+    // Resposta inesperada
+    traceLog("  Unexpected cache response (opcode " +
+             std::to_string(static_cast<int>(reply.opcode)) + ")");
+    return nullptr;
+}
+
+std::vector<std::unique_ptr<DNSMessage>> CacheClient::queryMany(
+    const std::vector<DNSQuestion>& questions
+) {
+    std::vector<std::unique_ptr<DNSMessage>> results(questions.size());
+    if (!daemon_available_ || questions.empty()) {
+        return results;
+    }
     
-    // Construir comando QUERY
-    std::ostringstream oss;
-    oss << "QUERY|" << qname << "|" << qtype << "|" << qclass << "\n";
-    std::string command = oss.str();
+    // Espelho em memória compartilhada primeiro; só o resto vai ao daemon
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < questions.size(); i++) {
+        const DNSQuestion& q = questions[i];
+        results[i] = lookupShared(q.qname, q.qtype, q.qclass);
+        if (!results[i]) {
+            pending.push_back(i);
+        }
+    }
+    if (pending.empty()) {
+        return results;
+    }
     
-    // Enviar comando
-    if (!sendCommand(sockfd, command)) {
-        traceLog("  Failed to send query to cache");
-        return nullptr;
+    traceLog("Querying cache for " + std::to_string(pending.size()) + " names (batch)...");
+    
+    // Um frame MQUERY a cada MAX_BATCH_ITEMS chaves, todos em pipeline
+    std::vector<std::string> frames;
+    for (size_t start = 0; start < pending.size(); start += MAX_BATCH_ITEMS) {
+        size_t end = std::min(pending.size(), start + MAX_BATCH_ITEMS);
+        CacheMessageWriter writer(CacheOpcode::MQUERY);
+        writer.putU32(static_cast<uint32_t>(end - start));
+        for (size_t i = start; i < end; i++) {
+            const DNSQuestion& q = questions[pending[i]];
+            writer.putString(q.qname).putU16(q.qtype).putU16(q.qclass);
+        }
+        frames.push_back(writer.finish());
     }
     
-    // Receber resposta
-    std::string response = receiveResponse(sockfd);
+    std::vector<CacheReply> replies;
+    if (!transact(frames, replies)) {
+        traceLog(daemon_available_ ? "  Failed to query cache"
+                                   : "  Cache daemon unavailable (will use full resolution)");
+        return results;
+    }
     
-    if (response.empty()) {
-        traceLog("  Empty response from cache");
+    size_t hits = 0;
+    for (size_t f = 0; f < replies.size(); f++) {
+        if (replies[f].opcode != CacheOpcode::MRESULT) {
+            traceLog("  Unexpected cache response (opcode " +
+                     std::to_string(static_cast<int>(replies[f].opcode)) + ")");
+            continue;
+        }
+        
+        size_t start = f * MAX_BATCH_ITEMS;
+        size_t end = std::min(pending.size(), start + MAX_BATCH_ITEMS);
+        try {
+            CacheMessageReader reader(replies[f].payload);
+            if (reader.getU32() != end - start) {
+                throw std::runtime_error("item count mismatch");
+            }
+            for (size_t i = start; i < end; i++) {
+                auto status = static_cast<CacheOpcode>(reader.getU8());
+                if (status == CacheOpcode::HIT) {
+                    results[pending[i]] = parseHitResponse(reader.getBlob());
+                } else if (status == CacheOpcode::NEGATIVE) {
+                    results[pending[i]] = makeNegativeResponse(reader.getU8());
+                } else if (status != CacheOpcode::MISS) {
+                    throw std::runtime_error("invalid item status");
+                }
+                hits += results[pending[i]] ? 1 : 0;
+            }
+        } catch (const std::exception& e) {
+            traceLog("  Malformed cache response: " + std::string(e.what()));
+            for (size_t i = start; i < end; i++) {
+                results[pending[i]].reset();
+            }
+        }
+    }
+    
+    traceLog(" Cache batch: " + std::to_string(hits) + " HIT, " +
+             std::to_string(pending.size() - hits) + " MISS");
+    return results;
+}
+
+std::unique_ptr<DNSMessage> CacheClient::lookupShared(
+    const std::string& qname,
+    uint16_t qtype,
+    uint16_t qclass
+) {
+    if (shm_name_.empty()) {
+        return nullptr;
+    }
+    auto shared = sharedCache(shm_name_);
+    if (!shared) {
         return nullptr;
     }
     
-    // Parsear resposta
-    // Verificar se é MISS (primeiros 4 caracteres)
-    if (response.size() >= 4 && response.substr(0, 4) == "MISS") {
-        traceLog("Cache MISS - proceeding with full resolution");
+    SharedCacheHit hit;
+    time_t now = std::time(nullptr);
+    if (!shared->lookup(qname, qtype, qclass, now, hit)) {
         return nullptr;
     }
     
-    // Verificar se é NEGATIVE (resposta negativa cacheada)
-    if (response.size() >= 8 && response.substr(0, 8) == "NEGATIVE") {
-        // Formato: NEGATIVE|rcode
-        size_t delimiter_pos = response.find('|');
-        if (delimiter_pos != std::string::npos) {
-            std::string rcode_str = response.substr(delimiter_pos + 1);
-            uint8_t rcode = std::stoi(rcode_str);
-            
-            std::string type = (rcode == 3) ? "NXDOMAIN" : "NODATA";
-            traceLog(" Cache HIT (NEGATIVE): " + type);
-            
-            // Criar DNSMessage com resposta negativa
-            auto negative_msg = std::make_unique<DNSMessage>();
-            negative_msg->header.qr = true;
-            negative_msg->header.rcode = rcode;
-            negative_msg->header.ancount = 0;
-            negative_msg->header.qdcount = 1;
-            
-            return negative_msg;
-        }
+    // Perto de expirar: consultar o daemon, que conta o HIT e pode renovar
+    uint32_t elapsed = (now > hit.timestamp) ? static_cast<uint32_t>(now - hit.timestamp) : 0;
+    uint64_t remaining = hit.ttl - elapsed;
+    if (remaining * 100 <= static_cast<uint64_t>(hit.ttl) * SHARED_BYPASS_PERCENT) {
+        return nullptr;
     }
     
-    // Verificar se é HIT (resposta positiva)
-    if (response.size() >= 3 && response.substr(0, 3) == "HIT") {
-        traceLog(" Cache HIT");
-        // Extrair dados após "HIT|"
-        size_t delimiter_pos = response.find('|');
-        if (delimiter_pos != std::string::npos) {
-            std::string data = response.substr(delimiter_pos + 1);
-            return parseHitResponse(data);
-        }
+    if (hit.negative) {
+        traceLog(std::string(" Cache HIT (NEGATIVE, shared memory): ") +
+                 (hit.rcode == 3 ? "NXDOMAIN" : "NODATA"));
+        return makeNegativeResponse(hit.rcode);
     }
     
-    // Resposta inesperada
-    traceLog("  Unexpected cache response: " + response.substr(0, 20));
-    return nullptr;
+    auto response = parseHitResponse(hit.wire);
+    if (response) {
+        traceLog(" Cache HIT (shared memory)");
+        ageRecords(response->answers, elapsed);
+        ageRecords(response->authority, elapsed);
+        ageRecords(response->additional, elapsed);
+    }
+    return response;
 }
 
 bool CacheClient::isAvailable() const {
     int sockfd;
-    if (!const_cast<CacheClient*>(this)->connectToCache(sockfd, 500)) {
+    if (!connectToCache(sockfd, 500)) {
         return false;
     }
     close(sockfd);
     return true;
 }
 
-bool CacheClient::connectToCache(int& sockfd, int timeout_ms) {
+bool CacheClient::connectToCache(int& sockfd, int timeout_ms) const {
     // Criar socket
     sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
     if (sockfd < 0) {
@@ -154,27 +372,139 @@ bool CacheClient::connectToCache(int& sockfd, int timeout_ms) {
     return true;
 }
 
-bool CacheClient::sendCommand(int sockfd, const std::string& command) {
-    ssize_t sent = send(sockfd, command.c_str(), command.size(), 0);
-    return (sent == static_cast<ssize_t>(command.size()));
-}
-
-std::string CacheClient::receiveResponse(int sockfd) {
-    char buffer[4096];
-    ssize_t n = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+bool CacheClient::transact(
+    std::vector<std::string>& frames,
+    std::vector<CacheReply>& replies
+) {
+    replies.assign(frames.size(), CacheReply());
+    if (frames.empty()) {
+        return true;
+    }
     
-    if (n <= 0) {
-        return "";
+    // Uma nova tentativa se a conexão reaproveitada estiver quebrada
+    // (ex: daemon reiniciado); comandos do cache são idempotentes
+    for (int attempt = 0; attempt < 2; attempt++) {
+        ThreadConnection& conn = thread_connections[socket_path_];
+        bool fresh = false;
+        
+        if (conn.fd < 0) {
+            if (!connectToCache(conn.fd, 1000)) {
+                conn.fd = -1;
+                daemon_available_ = false;
+                return false;
+            }
+            fresh = true;
+        }
+        
+        // Numerar os frames e enviá-los juntos (pipeline)
+        std::unordered_map<uint32_t, size_t> slots;
+        for (size_t i = 0; i < frames.size(); i++) {
+            uint32_t id = conn.next_request_id++;
+            if (id == 0) {
+                id = conn.next_request_id++;
+            }
+            CacheProtocol::setRequestId(frames[i], id);
+            slots[id] = i;
+        }
+        
+        // Frame único é enviado direto; vários são concatenados num só send
+        std::string joined;
+        if (frames.size() > 1) {
+            for (const std::string& frame : frames) {
+                joined.append(frame);
+            }
+        }
+        const std::string& out = frames.size() > 1 ? joined : frames[0];
+        
+        size_t sent = 0;
+        while (sent < out.size()) {
+            ssize_t n = send(conn.fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        if (sent < out.size()) {
+            conn.reset();
+            if (!fresh && sent == 0) {
+                continue;
+            }
+            return false;
+        }
+        
+        // Coletar respostas (podem chegar fora de ordem)
+        size_t received = 0;
+        bool broken = false;
+        while (received < frames.size()) {
+            size_t offset = 0;
+            try {
+                CacheFrameHeader header;
+                std::string_view payload;
+                while (CacheProtocol::extractFrame(conn.inbuf, offset, header, payload)) {
+                    auto slot = slots.find(header.request_id);
+                    if (slot != slots.end()) {
+                        replies[slot->second].opcode = header.opcode;
+                        replies[slot->second].payload.assign(payload.data(), payload.size());
+                        slots.erase(slot);
+                        received++;
+                    }
+                    // IDs desconhecidos: respostas de requisições que expiraram
+                }
+            } catch (const std::exception&) {
+                broken = true;
+                break;
+            }
+            conn.inbuf.erase(0, offset);
+            
+            if (received == frames.size()) {
+                break;
+            }
+            
+            char buffer[16384];
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                broken = true;
+                break;
+            }
+            conn.inbuf.append(buffer, static_cast<size_t>(n));
+        }
+        
+        if (!broken) {
+            return true;
+        }
+        
+        // Conexão em estado desconhecido (timeout/EOF): descartar
+        conn.reset();
+        if (!fresh && received == 0) {
+            continue;
+        }
+        return false;
     }
     
-    buffer[n] = '\0';
-    return std::string(buffer);
+    return false;
 }
 
-std::unique_ptr<DNSMessage> CacheClient::parseHitResponse(const std::string& response) {
+bool CacheClient::transact(std::string frame, CacheReply& reply) {
+    std::vector<std::string> frames;
+    frames.push_back(std::move(frame));
+    std::vector<CacheReply> replies;
+    if (!transact(frames, replies)) {
+        return false;
+    }
+    reply = std::move(replies[0]);
+    return true;
+}
+
+std::unique_ptr<DNSMessage> CacheClient::parseHitResponse(std::string_view wire) {
     try {
-        DNSMessage msg = deserializeFromCache(response);
-        return std::make_unique<DNSMessage>(msg);
+        std::vector<uint8_t> buffer(wire.begin(), wire.end());
+        return std::make_unique<DNSMessage>(DNSParser::parse(buffer));
     } catch (const std::exception& e) {
         traceLog("  Failed to parse cached response: " + std::string(e.what()));
         return nullptr;
@@ -183,118 +513,36 @@ std::unique_ptr<DNSMessage> CacheClient::parseHitResponse(const std::string& res
 
 // ========== SERIALIZAÇÃO ==========
 
-std::string CacheClient::serializeForCache(const DNSMessage& msg) const {
-    std::ostringstream oss;
-    
-    // Header básico
-    oss << "rcode:" << static_cast<int>(msg.header.rcode) << ";";
-    
-    // Answers (formato: name|type|ttl|rdata##name|type|ttl|rdata)
-    oss << "answers:";
-    
-    bool first = true;
-    for (const auto& rr : msg.answers) {
-        // Serializar apenas tipos suportados (pular RRSIG por enquanto)
-        if (rr.type == DNSType::RRSIG || rr.type == DNSType::DNSKEY || 
-            rr.type == DNSType::DS || rr.type == DNSType::OPT) {
-            continue;  // Pular registros DNSSEC
-        }
-        
-        if (!first) {
-            oss << "##";
-        }
-        first = false;
-        
-        oss << rr.name << "|" << rr.type << "|" << rr.ttl << "|";
-        
-        // RDATA baseado no tipo
-        if (rr.type == DNSType::A && !rr.rdata_a.empty()) {
-            oss << rr.rdata_a;
-        } else if (rr.type == DNSType::NS && !rr.rdata_ns.empty()) {
-            oss << rr.rdata_ns;
-        } else if (rr.type == DNSType::CNAME && !rr.rdata_cname.empty()) {
-            oss << rr.rdata_cname;
-        } else if (rr.type == DNSType::AAAA && !rr.rdata_aaaa.empty()) {
-            oss << rr.rdata_aaaa;
-        } else {
-            // Outros tipos: armazenar vazio
-            oss << "";
-        }
-    }
-    
-    return oss.str();
+std::string CacheClient::serializeForCache(const DNSMessage& msg) {
+    // Cópia sem o pseudo-RR OPT: EDNS0 é por transação, não deve ir ao cache
+    DNSMessage cached = msg;
+    cached.use_edns = false;
+    cached.additional.erase(
+        std::remove_if(cached.additional.begin(), cached.additional.end(),
+                       [](const DNSResourceRecord& rr) { return rr.type == DNSType::OPT; }),
+        cached.additional.end()
+    );
+    cached.header.qdcount = static_cast<uint16_t>(cached.questions.size());
+    cached.header.ancount = static_cast<uint16_t>(cached.answers.size());
+    cached.header.nscount = static_cast<uint16_t>(cached.authority.size());
+    cached.header.arcount = static_cast<uint16_t>(cached.additional.size());
+    
+    std::vector<uint8_t> wire = DNSParser::serialize(cached);
+    return std::string(wire.begin(), wire.end());
 }
 
-DNSMessage CacheClient::deserializeFromCache(const std::string& data) const {
-    DNSMessage msg;
-    
-    // Remover newline se existir
-    std::string clean_data = data;
-    if (!clean_data.empty() && clean_data.back() == '\n') {
-        clean_data.pop_back();
-    }
-    
-    // Parsear campos separados por ;
-    std::istringstream iss(clean_data);
-    std::string field;
-    
-    while (std::getline(iss, field, ';')) {
-        size_t colon_pos = field.find(':');
-        if (colon_pos == std::string::npos) continue;
-        
-        std::string key = field.substr(0, colon_pos);
-        std::string value = field.substr(colon_pos + 1);
-        
-        if (key == "rcode") {
-            msg.header.rcode = std::stoi(value);
-            msg.header.qr = true;  // É uma resposta
-        } else if (key == "ancount") {
-            // Apenas para validação
-        } else if (key == "answers") {
-            // Parsear answers (formato: name|type|ttl|rdata##name|type|ttl|rdata)
-            std::istringstream ans_stream(value);
-            std::string rr_str;
-            
-            while (std::getline(ans_stream, rr_str, '#')) {
-                if (rr_str.empty() || rr_str == "#") continue;
-                
-                // Parsear RR individual (name|type|ttl|rdata)
-                std::istringstream rr_stream(rr_str);
-                std::string rr_field;
-                std::vector<std::string> rr_parts;
-                
-                while (std::getline(rr_stream, rr_field, '|')) {
-                    rr_parts.push_back(rr_field);
-                }
-                
-                if (rr_parts.size() >= 4) {
-                    DNSResourceRecord rr;
-                    rr.name = rr_parts[0];
-                    rr.type = std::stoi(rr_parts[1]);
-                    rr.ttl = std::stoi(rr_parts[2]);
-                    rr.rr_class = DNSClass::IN;
-                    
-                    // RDATA baseado no tipo
-                    if (rr.type == DNSType::A) {
-                        rr.rdata_a = rr_parts[3];
-                    } else if (rr.type == DNSType::NS) {
-                        rr.rdata_ns = rr_parts[3];
-                    } else if (rr.type == DNSType::CNAME) {
-                        rr.rdata_cname = rr_parts[3];
-                    } else if (rr.type == DNSType::AAAA) {
-                        rr.rdata_aaaa = rr_parts[3];
-                    }
-                    
-                    msg.answers.push_back(rr);
-                }
+uint32_t CacheClient::cacheTTL(const DNSMessage& msg) {
+    // Calcular TTL (menor TTL dos answers)
+    uint32_t ttl = 300;  // Default 5 minutos
+    if (!msg.answers.empty()) {
+        ttl = msg.answers[0].ttl;
+        for (const auto& rr : msg.answers) {
+            if (rr.ttl < ttl) {
+                ttl = rr.ttl;
             }
         }
     }
-    
-    msg.header.ancount = msg.answers.size();
-    msg.header.qdcount = 1;  // Sempre 1 question
-    
-    return msg;
+    return ttl;
 }
 
 bool CacheClient::store(
@@ -307,51 +555,82 @@ bool CacheClient::store(
         return false;
     }
     
-    // Conectar ao daemon
-    int sockfd;
-    if (!connectToCache(sockfd, 1000)) {
-        daemon_available_ = false;
+    uint32_t ttl = cacheTTL(response);
+    
+    // Construir requisição STORE com a resposta serializada
+    std::string frame = CacheMessageWriter(CacheOpcode::STORE)
+        .putString(qname)
+        .putU16(qtype)
+        .putU16(DNSClass::IN)
+        .putU32(ttl)
+        .putBlob(serializeForCache(response))
+        .finish();
+    
+    // Enviar e receber confirmação
+    CacheReply reply;
+    if (!transact(std::move(frame), reply)) {
         return false;
     }
     
-    struct SocketGuard {
-        int fd;
-        ~SocketGuard() { if (fd >= 0) close(fd); }
-    } guard{sockfd};
+    if (reply.opcode == CacheOpcode::OK) {
+        traceLog("Response stored in cache (TTL: " + std::to_string(ttl) + "s)");
+        return true;
+    }
     
-    // Calcular TTL (menor TTL dos answers)
-    uint32_t ttl = 300;  // Default 5 minutos
-    if (!response.answers.empty()) {
-        ttl = response.answers[0].ttl;
-        for (const auto& rr : response.answers) {
-            if (rr.ttl < ttl) {
-                ttl = rr.ttl;
+    return false;
+}
+
+bool CacheClient::storeMany(const std::vector<CacheStoreItem>& items) {
+    if (!daemon_available_ || items.empty()) {
+        return false;
+    }
+    
+    // Frames MSTORE limitados em itens e bytes, enviados em pipeline
+    std::vector<std::string> frames;
+    size_t index = 0;
+    while (index < items.size()) {
+        std::vector<std::string> wires;
+        size_t bytes = 0;
+        size_t start = index;
+        for (; index < items.size() && index - start < MAX_BATCH_ITEMS &&
+               bytes < MAX_BATCH_BYTES; index++) {
+            if (!items[index].negative) {
+                wires.push_back(serializeForCache(items[index].response));
+                bytes += wires.back().size();
             }
+            bytes += items[index].qname.size() + 16;
         }
+        
+        CacheMessageWriter writer(CacheOpcode::MSTORE);
+        writer.putU32(static_cast<uint32_t>(index - start));
+        size_t next_wire = 0;
+        for (size_t i = start; i < index; i++) {
+            const CacheStoreItem& item = items[i];
+            if (item.negative) {
+                writer.putU8(static_cast<uint8_t>(CacheOpcode::STORE_NEGATIVE))
+                      .putString(item.qname).putU16(item.qtype).putU16(DNSClass::IN)
+                      .putU32(item.ttl).putU8(item.rcode);
+            } else {
+                writer.putU8(static_cast<uint8_t>(CacheOpcode::STORE))
+                      .putString(item.qname).putU16(item.qtype).putU16(DNSClass::IN)
+                      .putU32(cacheTTL(item.response)).putBlob(wires[next_wire++]);
+            }
+        }
+        frames.push_back(writer.finish());
     }
     
-    // Serializar resposta
-    std::string serialized = serializeForCache(response);
-    
-    // Construir comando STORE
-    std::ostringstream oss;
-    oss << "STORE|" << qname << "|" << qtype << "|1|" << ttl << "|" << serialized << "\n";
-    std::string command = oss.str();
-    
-    // Enviar comando
-    if (!sendCommand(sockfd, command)) {
+    std::vector<CacheReply> replies;
+    if (!transact(frames, replies)) {
         return false;
     }
     
-    // Receber confirmação
-    std::string resp = receiveResponse(sockfd);
-    
-    if (resp.substr(0, 2) == "OK") {
-        traceLog("Response stored in cache (TTL: " + std::to_string(ttl) + "s)");
-        return true;
+    for (const CacheReply& reply : replies) {
+        if (reply.opcode != CacheOpcode::OK) {
+            return false;
+        }
     }
-    
-    return false;
+    traceLog(std::to_string(items.size()) + " responses stored in cache (batch)");
+    return true;
 }
 
 // ========== CACHE NEGATIVO ==========
@@ -367,32 +646,22 @@ bool CacheClient::storeNegative(
         return false;
     }
     
-    // Conectar ao daemon
-    int sockfd;
-    if (!connectToCache(sockfd, 1000)) {
-        daemon_available_ = false;
-        return false;
-    }
-    
-    struct SocketGuard {
-        int fd;
-        ~SocketGuard() { if (fd >= 0) close(fd); }
-    } guard{sockfd};
-    
-    // Construir comando STORE_NEGATIVE
-    std::ostringstream oss;
-    oss << "STORE_NEGATIVE|" << qname << "|" << qtype << "|1|" << ttl << "|" << static_cast<int>(rcode) << "\n";
-    std::string command = oss.str();
-    
-    // Enviar comando
-    if (!sendCommand(sockfd, command)) {
+    // Construir requisição STORE_NEGATIVE
+    std::string frame = CacheMessageWriter(CacheOpcode::STORE_NEGATIVE)
+        .putString(qname)
+        .putU16(qtype)
+        .putU16(DNSClass::IN)
+        .putU32(ttl)
+        .putU8(rcode)
+        .finish();
+    
+    // Enviar e receber confirmação
+    CacheReply reply;
+    if (!transact(std::move(frame), reply)) {
         return false;
     }
     
-    // Receber confirmação
-    std::string resp = receiveResponse(sockfd);
-    
-    if (resp.substr(0, 2) == "OK") {
+    if (reply.opcode == CacheOpcode::OK) {
         std::string type = (rcode == 3) ? "NXDOMAIN" : "NODATA";
         traceLog(type + " stored in cache (TTL: " + std::to_string(ttl) + "s)");
         return true;
@@ -0,0 +1,208 @@
+/*
+ * ----------------------------------------
+ * Arquivo: CacheProtocol.cpp
+ * Propósito: Implementação do protocolo binário do IPC do cache
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/CacheProtocol.h"
+
+namespace dns_resolver {
+
+namespace {
+
+void appendU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>((value >> 8) & 0xFF));
+    out.push_back(static_cast<char>(value & 0xFF));
+}
+
+void appendU32(std::string& out, uint32_t value) {
+    out.push_back(static_cast<char>((value >> 24) & 0xFF));
+    out.push_back(static_cast<char>((value >> 16) & 0xFF));
+    out.push_back(static_cast<char>((value >> 8) & 0xFF));
+    out.push_back(static_cast<char>(value & 0xFF));
+}
+
+void writeU32At(std::string& out, size_t pos, uint32_t value) {
+    out[pos] = static_cast<char>((value >> 24) & 0xFF);
+    out[pos + 1] = static_cast<char>((value >> 16) & 0xFF);
+    out[pos + 2] = static_cast<char>((value >> 8) & 0xFF);
+    out[pos + 3] = static_cast<char>(value & 0xFF);
+}
+
+uint16_t readU16(std::string_view in, size_t pos) {
+    return static_cast<uint16_t>((static_cast<uint8_t>(in[pos]) << 8) |
+                                 static_cast<uint8_t>(in[pos + 1]));
+}
+
+uint32_t readU32(std::string_view in, size_t pos) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(in[pos])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(in[pos + 1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(in[pos + 2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(in[pos + 3]));
+}
+
+} // namespace
+
+// ========== FRAMES ==========
+
+bool CacheProtocol::extractFrame(
+    std::string_view buffer,
+    size_t& offset,
+    CacheFrameHeader& header,
+    std::string_view& payload
+) {
+    if (buffer.size() - offset < HEADER_SIZE) {
+        return false;
+    }
+
+    if (readU16(buffer, offset) != MAGIC) {
+        throw std::runtime_error("Invalid cache frame magic");
+    }
+
+    uint8_t version = static_cast<uint8_t>(buffer[offset + 2]);
+    if (version != VERSION) {
+        throw std::runtime_error("Unsupported cache protocol version " +
+                                 std::to_string(version));
+    }
+
+    uint32_t length = readU32(buffer, offset + 8);
+    if (length > MAX_PAYLOAD_SIZE) {
+        throw std::runtime_error("Cache frame payload too large");
+    }
+
+    if (buffer.size() - offset - HEADER_SIZE < length) {
+        return false;
+    }
+
+    header.version = version;
+    header.opcode = static_cast<CacheOpcode>(static_cast<uint8_t>(buffer[offset + 3]));
+    header.request_id = readU32(buffer, offset + 4);
+    header.length = length;
+    payload = buffer.substr(offset + HEADER_SIZE, length);
+    offset += HEADER_SIZE + length;
+    return true;
+}
+
+void CacheProtocol::setRequestId(std::string& frame, uint32_t request_id) {
+    if (frame.size() < HEADER_SIZE) {
+        throw std::runtime_error("Cache frame too short");
+    }
+    writeU32At(frame, 4, request_id);
+}
+
+// ========== ESCRITA ==========
+
+CacheMessageWriter::CacheMessageWriter(CacheOpcode opcode, uint32_t request_id) {
+    frame_.reserve(64);
+    appendU16(frame_, CacheProtocol::MAGIC);
+    frame_.push_back(static_cast<char>(CacheProtocol::VERSION));
+    frame_.push_back(static_cast<char>(opcode));
+    appendU32(frame_, request_id);
+    appendU32(frame_, 0);  // Tamanho preenchido em finish()
+}
+
+CacheMessageWriter& CacheMessageWriter::putU8(uint8_t value) {
+    frame_.push_back(static_cast<char>(value));
+    return *this;
+}
+
+CacheMessageWriter& CacheMessageWriter::putU16(uint16_t value) {
+    appendU16(frame_, value);
+    return *this;
+}
+
+CacheMessageWriter& CacheMessageWriter::putU32(uint32_t value) {
+    appendU32(frame_, value);
+    return *this;
+}
+
+CacheMessageWriter& CacheMessageWriter::putU64(uint64_t value) {
+    appendU32(frame_, static_cast<uint32_t>(value >> 32));
+    appendU32(frame_, static_cast<uint32_t>(value & 0xFFFFFFFF));
+    return *this;
+}
+
+CacheMessageWriter& CacheMessageWriter::putString(std::string_view value) {
+    if (value.size() > 0xFFFF) {
+        throw std::runtime_error("Cache string field too long");
+    }
+    appendU16(frame_, static_cast<uint16_t>(value.size()));
+    frame_.append(value.data(), value.size());
+    return *this;
+}
+
+CacheMessageWriter& CacheMessageWriter::putBlob(std::string_view value) {
+    if (value.size() > CacheProtocol::MAX_PAYLOAD_SIZE) {
+        throw std::runtime_error("Cache blob field too long");
+    }
+    appendU32(frame_, static_cast<uint32_t>(value.size()));
+    frame_.append(value.data(), value.size());
+    return *this;
+}
+
+std::string CacheMessageWriter::finish() {
+    size_t length = frame_.size() - CacheProtocol::HEADER_SIZE;
+    if (length > CacheProtocol::MAX_PAYLOAD_SIZE) {
+        throw std::runtime_error("Cache frame payload too large");
+    }
+    writeU32At(frame_, 8, static_cast<uint32_t>(length));
+    return std::move(frame_);
+}
+
+// ========== LEITURA ==========
+
+CacheMessageReader::CacheMessageReader(std::string_view payload)
+    : payload_(payload) {
+}
+
+void CacheMessageReader::require(size_t bytes) const {
+    if (payload_.size() - pos_ < bytes) {
+        throw std::runtime_error("Truncated cache message");
+    }
+}
+
+uint8_t CacheMessageReader::getU8() {
+    require(1);
+    return static_cast<uint8_t>(payload_[pos_++]);
+}
+
+uint16_t CacheMessageReader::getU16() {
+    require(2);
+    uint16_t value = readU16(payload_, pos_);
+    pos_ += 2;
+    return value;
+}
+
+uint32_t CacheMessageReader::getU32() {
+    require(4);
+    uint32_t value = readU32(payload_, pos_);
+    pos_ += 4;
+    return value;
+}
+
+uint64_t CacheMessageReader::getU64() {
+    uint64_t high = getU32();
+    return (high << 32) | getU32();
+}
+
+std::string_view CacheMessageReader::getString() {
+    size_t length = getU16();
+    require(length);
+    std::string_view value = payload_.substr(pos_, length);
+    pos_ += length;
+    return value;
+}
+
+std::string_view CacheMessageReader::getBlob() {
+    size_t length = getU32();
+    require(length);
+    std::string_view value = payload_.substr(pos_, length);
+    pos_ += length;
+    return value;
+}
+
+} // namespace dns_resolver
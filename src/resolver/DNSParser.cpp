@@ -33,17 +33,26 @@ std::vector<uint8_t> DNSParser::serialize(const DNSMessage& message) {
     buffer.push_back(flags & 0xFF);
     
     // Contadores de seções (8 bytes, big-endian)
+    // Seções de RRs: tamanho do vetor quando há registros; senão o valor do
+    // header (mensagens de consulta montadas só com contadores)
+    uint16_t ancount = message.answers.empty()
+        ? message.header.ancount : static_cast<uint16_t>(message.answers.size());
+    uint16_t nscount = message.authority.empty()
+        ? message.header.nscount : static_cast<uint16_t>(message.authority.size());
+    uint16_t arcount = message.additional.empty()
+        ? message.header.arcount : static_cast<uint16_t>(message.additional.size());
+    
     buffer.push_back((message.header.qdcount >> 8) & 0xFF);
     buffer.push_back(message.header.qdcount & 0xFF);
     
-    buffer.push_back((message.header.ancount >> 8) & 0xFF);
-    buffer.push_back(message.header.ancount & 0xFF);
+    buffer.push_back((ancount >> 8) & 0xFF);
+    buffer.push_back(ancount & 0xFF);
     
-    buffer.push_back((message.header.nscount >> 8) & 0xFF);
-    buffer.push_back(message.header.nscount & 0xFF);
+    buffer.push_back((nscount >> 8) & 0xFF);
+    buffer.push_back(nscount & 0xFF);
     
-    buffer.push_back((message.header.arcount >> 8) & 0xFF);
-    buffer.push_back(message.header.arcount & 0xFF);
+    buffer.push_back((arcount >> 8) & 0xFF);
+    buffer.push_back(arcount & 0xFF);
     
     // Serializar seção de questions
     for (const auto& question : message.questions) {
@@ -60,8 +69,16 @@ std::vector<uint8_t> DNSParser::serialize(const DNSMessage& message) {
         buffer.push_back(question.qclass & 0xFF);
     }
     
-    // Implementação de answers, authority e additional será feita
-    // quando necessário para parsing completo de respostas
+    // Serializar answers, authority e additional (nomes sem compressão)
+    for (const auto& rr : message.answers) {
+        serializeResourceRecord(rr, buffer);
+    }
+    for (const auto& rr : message.authority) {
+        serializeResourceRecord(rr, buffer);
+    }
+    for (const auto& rr : message.additional) {
+        serializeResourceRecord(rr, buffer);
+    }
     
     // Suporte a EDNS0 (Extended DNS) se habilitado
     if (message.use_edns) {
@@ -92,14 +109,170 @@ std::vector<uint8_t> DNSParser::serialize(const DNSMessage& message) {
         buffer.push_back(0x00);
         
         // Atualizar ARCOUNT no header para incluir OPT
-        uint16_t arcount = message.header.arcount + 1;
-        buffer[10] = (arcount >> 8) & 0xFF;
-        buffer[11] = arcount & 0xFF;
+        uint16_t total_arcount = arcount + 1;
+        buffer[10] = (total_arcount >> 8) & 0xFF;
+        buffer[11] = total_arcount & 0xFF;
     }
     
     return buffer;
 }
 
+void DNSParser::serializeResourceRecord(
+    const DNSResourceRecord& rr,
+    std::vector<uint8_t>& buffer
+) {
+    // Nome do registro (raiz pode vir como "" do parser)
+    std::vector<uint8_t> encoded_name = encodeName(rr.name);
+    buffer.insert(buffer.end(), encoded_name.begin(), encoded_name.end());
+    
+    // TYPE, CLASS, TTL
+    buffer.push_back((rr.type >> 8) & 0xFF);
+    buffer.push_back(rr.type & 0xFF);
+    buffer.push_back((rr.rr_class >> 8) & 0xFF);
+    buffer.push_back(rr.rr_class & 0xFF);
+    buffer.push_back((rr.ttl >> 24) & 0xFF);
+    buffer.push_back((rr.ttl >> 16) & 0xFF);
+    buffer.push_back((rr.ttl >> 8) & 0xFF);
+    buffer.push_back(rr.ttl & 0xFF);
+    
+    // RDLENGTH + RDATA
+    std::vector<uint8_t> rdata = encodeRData(rr);
+    if (rdata.size() > 0xFFFF) {
+        throw std::runtime_error("RDATA excede 65535 bytes");
+    }
+    buffer.push_back((rdata.size() >> 8) & 0xFF);
+    buffer.push_back(rdata.size() & 0xFF);
+    buffer.insert(buffer.end(), rdata.begin(), rdata.end());
+}
+
+std::vector<uint8_t> DNSParser::encodeRData(const DNSResourceRecord& rr) {
+    std::vector<uint8_t> out;
+    
+    auto appendName = [&out](const std::string& name) {
+        std::vector<uint8_t> encoded = encodeName(name);
+        out.insert(out.end(), encoded.begin(), encoded.end());
+    };
+    auto appendUint16 = [&out](uint16_t value) {
+        out.push_back((value >> 8) & 0xFF);
+        out.push_back(value & 0xFF);
+    };
+    auto appendUint32 = [&out](uint32_t value) {
+        out.push_back((value >> 24) & 0xFF);
+        out.push_back((value >> 16) & 0xFF);
+        out.push_back((value >> 8) & 0xFF);
+        out.push_back(value & 0xFF);
+    };
+    
+    // RDATA bruto recebido pode conter ponteiros de compressão que só fazem
+    // sentido na mensagem original: tipos com nomes são recodificados a
+    // partir dos campos parsed; os demais reutilizam o RDATA bruto
+    switch (rr.type) {
+        case DNSType::A:
+            if (rr.rdata.empty() && !rr.rdata_a.empty()) {
+                out.resize(4);
+                if (inet_pton(AF_INET, rr.rdata_a.c_str(), out.data()) != 1) {
+                    throw std::invalid_argument("Endereço IPv4 inválido: " + rr.rdata_a);
+                }
+                return out;
+            }
+            break;
+        
+        case DNSType::AAAA:
+            if (rr.rdata.empty() && !rr.rdata_aaaa.empty()) {
+                out.resize(16);
+                if (inet_pton(AF_INET6, rr.rdata_aaaa.c_str(), out.data()) != 1) {
+                    throw std::invalid_argument("Endereço IPv6 inválido: " + rr.rdata_aaaa);
+                }
+                return out;
+            }
+            break;
+        
+        case DNSType::NS:
+            appendName(rr.rdata_ns);
+            return out;
+        
+        case DNSType::CNAME:
+            appendName(rr.rdata_cname);
+            return out;
+        
+        case DNSType::PTR:
+            appendName(rr.rdata_ptr);
+            return out;
+        
+        case DNSType::MX: {
+            // rdata_mx no formato "prioridade exchange"
+            size_t space = rr.rdata_mx.find(' ');
+            if (space == std::string::npos) {
+                throw std::invalid_argument("Registro MX inválido: " + rr.rdata_mx);
+            }
+            appendUint16(static_cast<uint16_t>(std::stoul(rr.rdata_mx.substr(0, space))));
+            appendName(rr.rdata_mx.substr(space + 1));
+            return out;
+        }
+        
+        case DNSType::SOA:
+            appendName(rr.rdata_soa.mname);
+            appendName(rr.rdata_soa.rname);
+            appendUint32(rr.rdata_soa.serial);
+            appendUint32(rr.rdata_soa.refresh);
+            appendUint32(rr.rdata_soa.retry);
+            appendUint32(rr.rdata_soa.expire);
+            appendUint32(rr.rdata_soa.minimum);
+            return out;
+        
+        case DNSType::TXT:
+            if (rr.rdata.empty() && !rr.rdata_txt.empty()) {
+                if (rr.rdata_txt.size() > 255) {
+                    throw std::invalid_argument("String TXT excede 255 bytes");
+                }
+                out.push_back(static_cast<uint8_t>(rr.rdata_txt.size()));
+                out.insert(out.end(), rr.rdata_txt.begin(), rr.rdata_txt.end());
+                return out;
+            }
+            break;
+        
+        case DNSType::DNSKEY:
+            if (rr.rdata.empty()) {
+                appendUint16(rr.rdata_dnskey.flags);
+                out.push_back(rr.rdata_dnskey.protocol);
+                out.push_back(rr.rdata_dnskey.algorithm);
+                out.insert(out.end(), rr.rdata_dnskey.public_key.begin(),
+                           rr.rdata_dnskey.public_key.end());
+                return out;
+            }
+            break;
+        
+        case DNSType::DS:
+            if (rr.rdata.empty()) {
+                appendUint16(rr.rdata_ds.key_tag);
+                out.push_back(rr.rdata_ds.algorithm);
+                out.push_back(rr.rdata_ds.digest_type);
+                out.insert(out.end(), rr.rdata_ds.digest.begin(), rr.rdata_ds.digest.end());
+                return out;
+            }
+            break;
+        
+        case DNSType::RRSIG:
+            appendUint16(rr.rdata_rrsig.type_covered);
+            out.push_back(rr.rdata_rrsig.algorithm);
+            out.push_back(rr.rdata_rrsig.labels);
+            appendUint32(rr.rdata_rrsig.original_ttl);
+            appendUint32(rr.rdata_rrsig.signature_expiration);
+            appendUint32(rr.rdata_rrsig.signature_inception);
+            appendUint16(rr.rdata_rrsig.key_tag);
+            appendName(rr.rdata_rrsig.signer_name);
+            out.insert(out.end(), rr.rdata_rrsig.signature.begin(),
+                       rr.rdata_rrsig.signature.end());
+            return out;
+        
+        default:
+            break;
+    }
+    
+    // Tipos sem nomes no RDATA: bytes brutos
+    return rr.rdata;
+}
+
 // Implementação do parsing de mensagens DNS
 
 DNSMessage DNSParser::parse(const std::vector<uint8_t>& buffer) {
@@ -579,6 +752,14 @@ std::vector<uint8_t> DNSParser::encodeDomainName(const std::string& domain) {
     return encoded;
 }
 
+std::vector<uint8_t> DNSParser::encodeName(const std::string& name) {
+    // Raiz: parser devolve "" e registros montados usam "."
+    if (name.empty()) {
+        return std::vector<uint8_t>{0x00};
+    }
+    return encodeDomainName(name);
+}
+
 uint16_t DNSParser::encodeFlags(const DNSHeader& header) {
     uint16_t flags = 0;
     
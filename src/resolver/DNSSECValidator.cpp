@@ -10,10 +10,14 @@
 
 #include "dns_resolver/DNSSECValidator.h"
 #include "dns_resolver/DNSParser.h"
+#include "dns_resolver/PKeyCache.h"
+#include "dns_resolver/SharedCache.h"
+#include "dns_resolver/ThreadPool.h"
 #include <openssl/sha.h>
 #include <openssl/evp.h>
 #include <openssl/rsa.h>
 #include <openssl/ec.h>
+#include <openssl/ecdsa.h>
 #include <openssl/bn.h>
 #include <openssl/err.h>
 #include <stdexcept>
@@ -22,13 +26,55 @@
 #include <iomanip>
 #include <algorithm>
 #include <ctime>
+#include <future>
+#include <memory>
+#include <tuple>
 
 namespace dns_resolver {
 
+namespace {
+
+// Labels de um nome normalizado ("" ou "." = raiz, sem labels)
+std::vector<std::string> splitLabels(const std::string& name) {
+    std::vector<std::string> labels;
+    std::istringstream iss(name == "." ? "" : name);
+    std::string label;
+    while (std::getline(iss, label, '.')) {
+        if (!label.empty()) {
+            labels.push_back(label);
+        }
+    }
+    return labels;
+}
+
+// Contagem do campo Labels do RRSIG: sem a raiz e sem um "*" inicial (RFC 4034 §3.1.3)
+uint8_t countLabels(const std::string& name) {
+    std::vector<std::string> labels = splitLabels(name);
+    size_t count = labels.size();
+    if (count > 0 && labels.front() == "*") {
+        count--;
+    }
+    return static_cast<uint8_t>(std::min<size_t>(count, 255));
+}
+
+// name é igual a zone ou está abaixo dela (comparação sem maiúsculas)
+bool nameWithinZone(const std::string& name, const std::string& zone) {
+    std::string n = normalizeCacheName(name);
+    std::string z = normalizeCacheName(zone);
+    if (z.empty() || z == ".") {
+        return true;
+    }
+    return n == z || (n.size() > z.size() && n.compare(n.size() - z.size(), z.size(), z) == 0 &&
+                      n[n.size() - z.size() - 1] == '.');
+}
+
+} // namespace
+
 DNSSECValidator::DNSSECValidator(
     const TrustAnchorStore& trust_anchors,
-    bool trace_enabled
-) : trust_anchors_(trust_anchors), trace_enabled_(trace_enabled) {
+    bool trace_enabled,
+    ValidatedKeyCache* key_cache
+) : trust_anchors_(trust_anchors), trace_enabled_(trace_enabled), key_cache_(key_cache) {
 }
 
 // ========== CÁLCULO DE KEY TAG ==========
@@ -206,11 +252,22 @@ bool DNSSECValidator::validateDNSKEYWithTrustAnchor(
 ValidationResult DNSSECValidator::validateChain(
     const std::string& target_zone,
     const std::map<std::string, std::vector<DNSKEYRecord>>& dnskeys,
-    const std::map<std::string, std::vector<DSRecord>>& ds_records
+    const std::map<std::string, std::vector<DSRecord>>& ds_records,
+    const std::map<std::string, std::vector<RRSIGRecord>>& dnskey_rrsigs,
+    std::map<std::string, std::vector<DNSKEYRecord>>* authenticated_keys
 ) {
     traceLog("\n=== DNSSEC Chain Validation ===");
     traceLog("Target zone: " + target_zone);
     
+    if (authenticated_keys != nullptr) {
+        authenticated_keys->clear();
+    }
+    auto rrsigsOf = [&dnskey_rrsigs](const std::string& zone) -> const std::vector<RRSIGRecord>& {
+        static const std::vector<RRSIGRecord> none;
+        auto it = dnskey_rrsigs.find(zone);
+        return it != dnskey_rrsigs.end() ? it->second : none;
+    };
+    
     // 1. Validar root DNSKEY com trust anchor
     auto root_tas = trust_anchors_.getTrustAnchorsForZone(".");
     if (root_tas.empty()) {
@@ -227,21 +284,23 @@ ValidationResult DNSSECValidator::validateChain(
         return ValidationResult::Insecure;
     }
     
-    bool root_validated = false;
+    // Trust anchors no formato DS: o elo da raiz é validado como os demais
+    std::vector<DSRecord> root_ds;
     for (const auto& ta : root_tas) {
-        traceLog("  Trying trust anchor (Key Tag " + std::to_string(ta.key_tag) + ")");
-        
-        for (const auto& dnskey : root_dnskeys_it->second) {
-            if (validateDNSKEYWithTrustAnchor(dnskey, ta, ".")) {
-                traceLog(" Root DNSKEY validated with trust anchor!");
-                root_validated = true;
-                break;
-            }
-        }
-        if (root_validated) break;
+        DSRecord ds;
+        ds.key_tag = ta.key_tag;
+        ds.algorithm = ta.algorithm;
+        ds.digest_type = ta.digest_type;
+        ds.digest = ta.digest;
+        root_ds.push_back(ds);
     }
     
-    if (!root_validated) {
+    if (validateZoneKeys(".", root_dnskeys_it->second, root_ds, rrsigsOf("."))) {
+        traceLog(" Root DNSKEY validated with trust anchor!");
+        if (authenticated_keys != nullptr) {
+            (*authenticated_keys)["."] = root_dnskeys_it->second;
+        }
+    } else {
         traceLog(" Root DNSKEY validation failed - BOGUS!");
         return ValidationResult::Bogus;
     }
@@ -272,19 +331,12 @@ ValidationResult DNSSECValidator::validateChain(
         traceLog("  Found " + std::to_string(dnskey_it->second.size()) + " DNSKEY(s)");
         
         // Validar pelo menos uma DNSKEY com algum DS
-        bool zone_validated = false;
-        for (const auto& ds : ds_it->second) {
-            for (const auto& dnskey : dnskey_it->second) {
-                if (validateDNSKEY(dnskey, ds, current_zone)) {
-                    traceLog(" Zone '" + current_zone + "' DNSKEY validated!");
-                    zone_validated = true;
-                    break;
-                }
+        if (validateZoneKeys(current_zone, dnskey_it->second, ds_it->second, rrsigsOf(current_zone))) {
+            traceLog(" Zone '" + current_zone + "' DNSKEY validated!");
+            if (authenticated_keys != nullptr) {
+                (*authenticated_keys)[current_zone] = dnskey_it->second;
             }
-            if (zone_validated) break;
-        }
-        
-        if (!zone_validated) {
+        } else {
             traceLog(" Zone '" + current_zone + "' DNSKEY validation failed - BOGUS!");
             return ValidationResult::Bogus;
         }
@@ -296,6 +348,76 @@ ValidationResult DNSSECValidator::validateChain(
     return ValidationResult::Secure;
 }
 
+bool DNSSECValidator::validateZoneKeys(
+    const std::string& zone,
+    const std::vector<DNSKEYRecord>& dnskeys,
+    const std::vector<DSRecord>& ds_records,
+    const std::vector<RRSIGRecord>& rrsigs
+) {
+    // Mesmos conjuntos já validados antes: sem key tag, digest nem assinatura
+    // (o resultado cobre exatamente estas chaves, já autenticadas)
+    bool trusted = false;
+    if (key_cache_ != nullptr && key_cache_->lookup(zone, dnskeys, ds_records, trusted)) {
+        traceLog("  Using cached validation for '" + zone + "' (" +
+                 (trusted ? "trusted" : "bogus") + ")");
+        return trusted;
+    }
+    
+    // 1. Chaves de entrada: as que conferem com algum DS (ou trust anchor)
+    std::vector<const DNSKEYRecord*> entry_keys;
+    for (const auto& dnskey : dnskeys) {
+        for (const auto& ds : ds_records) {
+            traceLog("  Trying DS (Key Tag " + std::to_string(ds.key_tag) + ")");
+            if (validateDNSKEY(dnskey, ds, zone)) {
+                entry_keys.push_back(&dnskey);
+                break;
+            }
+        }
+    }
+    
+    // 2. Uma delas precisa assinar o RRset DNSKEY: só então as demais chaves
+    // (ZSKs) do conjunto passam a valer
+    if (!entry_keys.empty()) {
+        std::string zone_name = normalizeCacheName(zone);
+        std::vector<DNSResourceRecord> rrset;
+        for (const auto& dnskey : dnskeys) {
+            DNSResourceRecord rr;
+            rr.name = zone_name;
+            rr.type = DNSType::DNSKEY;
+            rr.rr_class = DNSClass::IN;
+            rr.rdata_dnskey = dnskey;
+            rrset.push_back(rr);
+        }
+        for (const auto& rrsig : rrsigs) {
+            std::string signer = normalizeCacheName(rrsig.signer_name);
+            if (rrsig.type_covered != DNSType::DNSKEY || (signer.empty() ? "." : signer) != zone_name) {
+                continue;
+            }
+            for (const DNSKEYRecord* key : entry_keys) {
+                try {
+                    if (validateRRSIG(rrset, rrsig, *key, zone)) {
+                        trusted = true;
+                        break;
+                    }
+                } catch (const std::exception&) {
+                    // Chave que não pôde ser convertida: tentar a próxima
+                }
+            }
+            if (trusted) break;
+        }
+        if (!trusted) {
+            traceLog("  DNSKEY RRset of '" + zone + "' not signed by a DS-matched key");
+        }
+    }
+    
+    // Só elos confiáveis são guardados: a falha pode vir de um RRSIG forjado,
+    // que não faz parte da chave do cache e bloquearia a resposta legítima
+    if (trusted && key_cache_ != nullptr) {
+        key_cache_->store(zone, dnskeys, ds_records, trusted);
+    }
+    return trusted;
+}
+
 // ========== HELPERS ==========
 
 std::string DNSSECValidator::getParentZone(const std::string& zone) const {
@@ -406,11 +528,11 @@ bool DNSSECValidator::validateRRSIG(
     if (rrsig.algorithm == 8) {
         // RSA/SHA-256
         traceLog("    Verifying RSA/SHA-256 signature...");
-        signature_valid = verifyRSASignature(dnskey.public_key, verification_buffer, rrsig.signature);
+        signature_valid = verifyRSASignature(dnskey.public_key, dnskey_tag, verification_buffer, rrsig.signature);
     } else if (rrsig.algorithm == 13) {
         // ECDSA P-256/SHA-256
         traceLog("    Verifying ECDSA P-256/SHA-256 signature...");
-        signature_valid = verifyECDSASignature(dnskey.public_key, verification_buffer, rrsig.signature);
+        signature_valid = verifyECDSASignature(dnskey.public_key, dnskey_tag, verification_buffer, rrsig.signature);
     } else {
         traceLog("     Unsupported algorithm: " + std::to_string(rrsig.algorithm));
         return false;
@@ -425,35 +547,236 @@ bool DNSSECValidator::validateRRSIG(
     }
 }
 
+// ========== VALIDAÇÃO DOS RRSETS DA RESPOSTA ==========
+
+ValidationResult DNSSECValidator::validateRRsets(
+    const DNSMessage& response,
+    const std::string& target_zone,
+    const std::map<std::string, std::vector<DNSKEYRecord>>& zone_keys,
+    ThreadPool* pool
+) {
+    traceLog("\n=== DNSSEC RRset Validation ===");
+    
+    // Chaves utilizáveis: só zonas da cadeia validada (target_zone e ancestrais)
+    // chain_zone: a mais profunda delas; RRsets da answer dentro dela têm de
+    // estar assinados
+    std::map<std::string, const std::vector<DNSKEYRecord>*> trusted_keys;
+    std::string chain_zone;
+    for (const auto& entry : zone_keys) {
+        if (nameWithinZone(target_zone, entry.first)) {
+            std::string zone = normalizeCacheName(entry.first);
+            trusted_keys[zone.empty() ? "." : zone] = &entry.second;
+            if (chain_zone.empty() || countLabels(zone) > countLabels(chain_zone)) {
+                chain_zone = zone.empty() ? "." : zone;
+            }
+        }
+    }
+    auto inChain = [&chain_zone](const std::string& owner) {
+        return !chain_zone.empty() && nameWithinZone(owner, chain_zone);
+    };
+    
+    // Agrupar em RRsets por (owner, tipo, classe); RRSIGs pelo tipo coberto
+    struct RRset {
+        std::string owner;
+        std::vector<DNSResourceRecord> records;
+        std::vector<RRSIGRecord> signatures;
+        bool required = false;    // Answer: precisa ser verificado
+    };
+    std::vector<RRset> rrsets;
+    auto groupSection = [&rrsets](const std::vector<DNSResourceRecord>& section, bool required) {
+        std::map<std::tuple<std::string, uint16_t, uint16_t>, size_t> index;
+        auto slot = [&](const std::string& owner, uint16_t type, uint16_t rr_class) -> RRset& {
+            auto key = std::make_tuple(owner, type, rr_class);
+            auto it = index.find(key);
+            if (it == index.end()) {
+                it = index.emplace(key, rrsets.size()).first;
+                rrsets.emplace_back();
+                rrsets.back().owner = owner;
+                rrsets.back().required = required;
+            }
+            return rrsets[it->second];
+        };
+        for (const auto& rr : section) {
+            std::string owner = normalizeCacheName(rr.name);
+            if (rr.type == DNSType::RRSIG) {
+                slot(owner, rr.rdata_rrsig.type_covered, rr.rr_class).signatures.push_back(rr.rdata_rrsig);
+            } else if (rr.type != DNSType::OPT) {
+                slot(owner, rr.type, rr.rr_class).records.push_back(rr);
+            }
+        }
+    };
+    groupSection(response.answers, true);
+    groupSection(response.authority, false);
+    
+    // Candidatos: cada RRSIG com cada chave da zona assinante que confere
+    // (algoritmo, key tag, flag de zona); basta um válido por RRset
+    struct Candidate {
+        size_t rrset;
+        const RRSIGRecord* rrsig;
+        const DNSKEYRecord* dnskey;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<bool> has_candidate(rrsets.size(), false);
+    bool unverifiable = false;
+    
+    for (size_t i = 0; i < rrsets.size(); i++) {
+        const RRset& rrset = rrsets[i];
+        if (rrset.records.empty()) {
+            continue;  // RRSIG sem o RRset coberto
+        }
+        if (rrset.signatures.empty()) {
+            if (rrset.required) {
+                traceLog("  RRset " + rrset.owner + " type " + std::to_string(rrset.records.front().type) +
+                         " has no RRSIG");
+                if (inChain(rrset.owner)) {
+                    traceLog(" Unsigned RRset inside signed zone " + chain_zone + " - BOGUS!");
+                    return ValidationResult::Bogus;
+                }
+                unverifiable = true;
+            }
+            continue;
+        }
+        
+        uint8_t owner_labels = countLabels(rrset.owner);
+        for (const auto& rrsig : rrset.signatures) {
+            std::string signer = normalizeCacheName(rrsig.signer_name);
+            auto keys_it = trusted_keys.find(signer.empty() ? "." : signer);
+            if (keys_it == trusted_keys.end() || !nameWithinZone(rrset.owner, signer) ||
+                rrsig.labels > owner_labels) {
+                continue;
+            }
+            for (const auto& dnskey : *keys_it->second) {
+                if ((dnskey.flags & 0x0100) != 0 && dnskey.algorithm == rrsig.algorithm &&
+                    calculateKeyTag(dnskey) == rrsig.key_tag) {
+                    candidates.push_back({i, &rrsig, &dnskey});
+                    has_candidate[i] = true;
+                }
+            }
+        }
+        
+        if (!has_candidate[i]) {
+            traceLog("  RRset " + rrset.owner + " type " + std::to_string(rrset.records.front().type) +
+                     " signed by a key outside the validated chain");
+            if (rrset.required && inChain(rrset.owner)) {
+                traceLog(" RRset inside signed zone " + chain_zone + " without usable RRSIG - BOGUS!");
+                return ValidationResult::Bogus;
+            }
+            unverifiable = true;
+        }
+    }
+    
+    if (candidates.empty()) {
+        traceLog(" No verifiable RRset");
+        return ValidationResult::Indeterminate;
+    }
+    
+    // Verificações independentes em paralelo: o custo total é o da mais
+    // lenta, não a soma. Cada tarefa usa um validador próprio sem trace
+    const TrustAnchorStore& anchors = trust_anchors_;
+    auto verify = [&anchors, &rrsets](const Candidate& c) {
+        try {
+            DNSSECValidator task_validator(anchors);
+            return task_validator.validateRRSIG(rrsets[c.rrset].records, *c.rrsig, *c.dnskey,
+                                                c.rrsig->signer_name);
+        } catch (const std::exception&) {
+            return false;  // RDATA que não pôde ser canonicalizado
+        }
+    };
+    
+    std::vector<bool> verified(rrsets.size(), false);
+    if (pool != nullptr && candidates.size() > 1) {
+        std::vector<std::future<bool>> results;
+        results.reserve(candidates.size());
+        for (const auto& candidate : candidates) {
+            results.push_back(pool->enqueue(verify, candidate));
+        }
+        for (size_t i = 0; i < candidates.size(); i++) {
+            if (results[i].get()) {
+                verified[candidates[i].rrset] = true;
+            }
+        }
+    } else {
+        for (const auto& candidate : candidates) {
+            if (!verified[candidate.rrset] && verify(candidate)) {
+                verified[candidate.rrset] = true;
+            }
+        }
+    }
+    
+    traceLog("  Verified " + std::to_string(candidates.size()) + " signature(s) over " +
+             std::to_string(rrsets.size()) + " RRset(s)");
+    
+    for (size_t i = 0; i < rrsets.size(); i++) {
+        if (has_candidate[i] && !verified[i]) {
+            traceLog(" RRset " + rrsets[i].owner + " type " + std::to_string(rrsets[i].records.front().type) +
+                     " has no valid signature - BOGUS!");
+            return ValidationResult::Bogus;
+        }
+    }
+    
+    if (unverifiable) {
+        traceLog(" Some RRsets could not be verified: INDETERMINATE");
+        return ValidationResult::Indeterminate;
+    }
+    
+    traceLog(" All RRset signatures valid: SECURE");
+    return ValidationResult::Secure;
+}
+
 std::vector<uint8_t> DNSSECValidator::canonicalizeRRset(
     const std::vector<DNSResourceRecord>& rrset,
     const RRSIGRecord& rrsig
 ) {
     // RFC 4034 §6.2: Canonical RR Form
     std::vector<uint8_t> buffer;
+    if (rrset.empty()) {
+        return buffer;
+    }
     
-    // Copiar rrset para ordenar
-    std::vector<DNSResourceRecord> sorted_rrset = rrset;
+    // Owner name (lowercase, sem compressão); resposta sintetizada de um
+    // curinga tem mais labels que o RRSIG: assinado como "*.<sufixo>"
+    std::string owner = normalizeCacheName(rrset.front().name);
+    if (rrsig.labels < countLabels(owner)) {
+        std::vector<std::string> labels = splitLabels(owner);
+        std::string suffix;
+        for (size_t i = labels.size() - rrsig.labels; i < labels.size(); i++) {
+            suffix += "." + labels[i];
+        }
+        owner = "*" + suffix;
+    }
+    std::vector<uint8_t> owner_encoded = encodeDomainName(owner);
+    
+    // RDATA canônico: recodificado a partir dos campos parsed (o bruto pode
+    // ter ponteiros de compressão) com os nomes em minúsculas (§6.2 item 3)
+    std::vector<std::vector<uint8_t>> rdatas;
+    rdatas.reserve(rrset.size());
+    for (const auto& rr : rrset) {
+        DNSResourceRecord lower = rr;
+        lower.rdata_ns = toLowercase(rr.rdata_ns);
+        lower.rdata_cname = toLowercase(rr.rdata_cname);
+        lower.rdata_ptr = toLowercase(rr.rdata_ptr);
+        lower.rdata_mx = toLowercase(rr.rdata_mx);
+        lower.rdata_soa.mname = toLowercase(rr.rdata_soa.mname);
+        lower.rdata_soa.rname = toLowercase(rr.rdata_soa.rname);
+        rdatas.push_back(DNSParser::encodeRData(lower));
+    }
     
-    // Ordenar lexicograficamente por RDATA
-    std::sort(sorted_rrset.begin(), sorted_rrset.end(), 
-        [](const DNSResourceRecord& a, const DNSResourceRecord& b) {
-            return a.rdata < b.rdata;
-        });
+    // Ordenar lexicograficamente por RDATA e remover duplicatas (§6.3)
+    std::sort(rdatas.begin(), rdatas.end());
+    rdatas.erase(std::unique(rdatas.begin(), rdatas.end()), rdatas.end());
     
-    for (const auto& rr : sorted_rrset) {
-        // Owner name (lowercase, sem compressão)
-        std::string owner_lower = toLowercase(rr.name);
-        std::vector<uint8_t> owner_encoded = encodeDomainName(owner_lower);
+    uint16_t type = rrset.front().type;
+    uint16_t rr_class = rrset.front().rr_class;
+    for (const auto& rdata : rdatas) {
         buffer.insert(buffer.end(), owner_encoded.begin(), owner_encoded.end());
         
         // Type (2 bytes)
-        buffer.push_back((rr.type >> 8) & 0xFF);
-        buffer.push_back(rr.type & 0xFF);
+        buffer.push_back((type >> 8) & 0xFF);
+        buffer.push_back(type & 0xFF);
         
         // Class (2 bytes)
-        buffer.push_back((rr.rr_class >> 8) & 0xFF);
-        buffer.push_back(rr.rr_class & 0xFF);
+        buffer.push_back((rr_class >> 8) & 0xFF);
+        buffer.push_back(rr_class & 0xFF);
         
         // Original TTL do RRSIG (4 bytes)
         uint32_t original_ttl = rrsig.original_ttl;
@@ -462,12 +785,11 @@ std::vector<uint8_t> DNSSECValidator::canonicalizeRRset(
         buffer.push_back((original_ttl >> 8) & 0xFF);
         buffer.push_back(original_ttl & 0xFF);
         
-        // RDLENGTH (2 bytes)
-        buffer.push_back((rr.rdlength >> 8) & 0xFF);
-        buffer.push_back(rr.rdlength & 0xFF);
+        // RDLENGTH (2 bytes) do RDATA canônico
+        buffer.push_back((rdata.size() >> 8) & 0xFF);
+        buffer.push_back(rdata.size() & 0xFF);
         
-        // RDATA (bruto)
-        buffer.insert(buffer.end(), rr.rdata.begin(), rr.rdata.end());
+        buffer.insert(buffer.end(), rdata.begin(), rdata.end());
     }
     
     return buffer;
@@ -525,13 +847,6 @@ std::vector<uint8_t> DNSSECValidator::buildVerificationBuffer(
 
 // ========== ALGORITMOS CRIPTOGRÁFICOS ==========
 
-// RAII Guard para EVP_PKEY
-struct PKEYGuard {
-    EVP_PKEY* pkey;
-    PKEYGuard(EVP_PKEY* p) : pkey(p) {}
-    ~PKEYGuard() { if (pkey) EVP_PKEY_free(pkey); }
-};
-
 void* DNSSECValidator::convertDNSKEYToECDSA(const std::vector<uint8_t>& public_key) {
     // ECDSA P-256: 64 bytes (32 X + 32 Y) - RFC 6605
     if (public_key.size() != 64) {
@@ -660,6 +975,7 @@ void* DNSSECValidator::convertDNSKEYToRSA(const std::vector<uint8_t>& public_key
 
 bool DNSSECValidator::verifyECDSASignature(
     const std::vector<uint8_t>& public_key,
+    uint16_t key_tag,
     const std::vector<uint8_t>& data,
     const std::vector<uint8_t>& signature
 ) {
@@ -671,21 +987,51 @@ bool DNSSECValidator::verifyECDSASignature(
         return false;
     }
     
-    // Converter DNSKEY para EVP_PKEY
-    EVP_PKEY* pkey = nullptr;
-    try {
-        pkey = static_cast<EVP_PKEY*>(convertDNSKEYToECDSA(public_key));
-    } catch (const std::exception& e) {
-        traceLog("   Failed to convert DNSKEY to ECDSA: " + std::string(e.what()));
-        return false;
+    // Converter DNSKEY para EVP_PKEY (uma vez por chave no processo)
+    PKeyCache& pkeys = PKeyCache::instance();
+    PKeyCache::Handle handle = pkeys.find(13, key_tag, public_key);
+    if (!handle) {
+        try {
+            handle = pkeys.insert(13, key_tag, public_key,
+                                  static_cast<EVP_PKEY*>(convertDNSKEYToECDSA(public_key)));
+        } catch (const std::exception& e) {
+            traceLog("   Failed to convert DNSKEY to ECDSA: " + std::string(e.what()));
+            return false;
+        }
     }
     
-    if (!pkey) {
+    if (!handle) {
         traceLog("   Failed to create ECDSA key (null)");
         return false;
     }
     
-    PKEYGuard guard(pkey);
+    EVP_PKEY* pkey = handle.get();
+    
+    // DNSSEC transporta r || s (2 × 32 bytes, RFC 6605 §4); o OpenSSL
+    // espera a assinatura ECDSA codificada em DER
+    if (signature.size() != 64) {
+        traceLog("   Invalid ECDSA signature size: " + std::to_string(signature.size()));
+        return false;
+    }
+    ECDSA_SIG* ecdsa_sig = ECDSA_SIG_new();
+    BIGNUM* r = BN_bin2bn(signature.data(), 32, nullptr);
+    BIGNUM* s = BN_bin2bn(signature.data() + 32, 32, nullptr);
+    if (!ecdsa_sig || !r || !s || ECDSA_SIG_set0(ecdsa_sig, r, s) != 1) {
+        BN_free(r);
+        BN_free(s);
+        ECDSA_SIG_free(ecdsa_sig);
+        traceLog("   Failed to decode ECDSA signature");
+        return false;
+    }
+    int der_len = i2d_ECDSA_SIG(ecdsa_sig, nullptr);
+    std::vector<uint8_t> der_signature(der_len > 0 ? der_len : 0);
+    uint8_t* der_out = der_signature.data();
+    if (der_len <= 0 || i2d_ECDSA_SIG(ecdsa_sig, &der_out) != der_len) {
+        ECDSA_SIG_free(ecdsa_sig);
+        traceLog("   Failed to encode ECDSA signature (DER)");
+        return false;
+    }
+    ECDSA_SIG_free(ecdsa_sig);
     
     // Criar contexto de verificação
     EVP_MD_CTX* ctx = EVP_MD_CTX_new();
@@ -706,7 +1052,7 @@ bool DNSSECValidator::verifyECDSASignature(
     }
     
     // Verificar assinatura
-    result = EVP_DigestVerify(ctx, signature.data(), signature.size(),
+    result = EVP_DigestVerify(ctx, der_signature.data(), der_signature.size(),
                               data.data(), data.size());
     
     EVP_MD_CTX_free(ctx);
@@ -729,6 +1075,7 @@ bool DNSSECValidator::verifyECDSASignature(
 
 bool DNSSECValidator::verifyRSASignature(
     const std::vector<uint8_t>& public_key,
+    uint16_t key_tag,
     const std::vector<uint8_t>& data,
     const std::vector<uint8_t>& signature
 ) {
@@ -740,21 +1087,25 @@ bool DNSSECValidator::verifyRSASignature(
         return false;
     }
     
-    // Converter DNSKEY para EVP_PKEY
-    EVP_PKEY* pkey = nullptr;
-    try {
-        pkey = static_cast<EVP_PKEY*>(convertDNSKEYToRSA(public_key));
-    } catch (const std::exception& e) {
-        traceLog("   Failed to convert DNSKEY to RSA: " + std::string(e.what()));
-        return false;
+    // Converter DNSKEY para EVP_PKEY (uma vez por chave no processo)
+    PKeyCache& pkeys = PKeyCache::instance();
+    PKeyCache::Handle handle = pkeys.find(8, key_tag, public_key);
+    if (!handle) {
+        try {
+            handle = pkeys.insert(8, key_tag, public_key,
+                                  static_cast<EVP_PKEY*>(convertDNSKEYToRSA(public_key)));
+        } catch (const std::exception& e) {
+            traceLog("   Failed to convert DNSKEY to RSA: " + std::string(e.what()));
+            return false;
+        }
     }
     
-    if (!pkey) {
+    if (!handle) {
         traceLog("   Failed to create RSA key (null)");
         return false;
     }
     
-    PKEYGuard guard(pkey);
+    EVP_PKEY* pkey = handle.get();
     
     // Criar contexto de verificação
     EVP_MD_CTX* ctx = EVP_MD_CTX_new();
@@ -0,0 +1,179 @@
+/*
+ * ----------------------------------------
+ * Arquivo: DelegationCache.cpp
+ * Propósito: Implementação do cache de delegações (zone cuts, NS e glue)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/DelegationCache.h"
+#include "dns_resolver/SharedCache.h"
+#include <algorithm>
+
+namespace dns_resolver {
+
+namespace {
+
+// name é igual a zone ou está abaixo dela (nomes já normalizados)
+bool inZone(const std::string& name, const std::string& zone) {
+    if (zone.empty() || zone == ".") {
+        return true;
+    }
+    return name == zone ||
+           (name.size() > zone.size() &&
+            name.compare(name.size() - zone.size(), zone.size(), zone) == 0 &&
+            name[name.size() - zone.size() - 1] == '.');
+}
+
+} // namespace
+
+DelegationCache::DelegationCache(size_t max_zones)
+    : max_zones_(max_zones == 0 ? 1 : max_zones) {
+}
+
+DelegationCache& DelegationCache::instance() {
+    static DelegationCache cache;
+    return cache;
+}
+
+template <typename Map>
+void DelegationCache::makeRoom(Map& map, time_t now) {
+    if (map.size() < max_zones_) {
+        return;
+    }
+    for (auto it = map.begin(); it != map.end();) {
+        it = (it->second.expires_at <= now) ? map.erase(it) : std::next(it);
+    }
+    if (map.size() >= max_zones_) {
+        auto oldest = std::min_element(map.begin(), map.end(),
+            [](const auto& a, const auto& b) { return a.second.expires_at < b.second.expires_at; });
+        map.erase(oldest);
+    }
+}
+
+void DelegationCache::store(
+    const std::string& server_zone,
+    const std::string& zone,
+    const std::vector<std::string>& nameservers,
+    const std::map<std::string, std::string>& glue,
+    uint32_t ttl,
+    time_t now
+) {
+    std::string key = normalizeCacheName(zone);
+    // Root vem da configuração (root_servers); TTL 0 não é cacheado
+    if (key.empty() || key == "." || nameservers.empty() || ttl == 0) {
+        return;
+    }
+    // Referência para a própria zona do servidor, um ancestral ou uma zona
+    // fora dela: o servidor não tem autoridade para delegá-la
+    std::string parent = normalizeCacheName(server_zone);
+    if (key == parent || !inZone(key, parent)) {
+        return;
+    }
+
+    Delegation delegation;
+    delegation.zone = key;
+    delegation.expires_at = now + static_cast<time_t>(std::min(ttl, MAX_TTL));
+    for (const auto& ns : nameservers) {
+        std::string ns_name = normalizeCacheName(ns);
+        delegation.nameservers.push_back(ns_name);
+        // Glue só vale para NS dentro da zona delegada; os demais são
+        // resolvidos (ou vêm do mapa de endereços)
+        auto it = glue.find(ns);
+        if (it != glue.end() && inZone(ns_name, key)) {
+            delegation.addresses[ns_name] = it->second;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Glue também vale para outras zonas servidas pelos mesmos NS
+    for (const auto& addr : delegation.addresses) {
+        if (addresses_.count(addr.first) == 0) {
+            makeRoom(addresses_, now);
+        }
+        addresses_[addr.first] = Address{addr.second, delegation.expires_at};
+    }
+    if (zones_.count(key) == 0) {
+        makeRoom(zones_, now);
+    }
+    zones_[key] = std::move(delegation);
+}
+
+void DelegationCache::storeAddress(
+    const std::string& ns_name,
+    const std::string& address,
+    uint32_t ttl,
+    time_t now
+) {
+    std::string key = normalizeCacheName(ns_name);
+    if (key.empty() || address.empty() || ttl == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (addresses_.count(key) == 0) {
+        makeRoom(addresses_, now);
+    }
+    addresses_[key] = Address{address, now + static_cast<time_t>(std::min(ttl, MAX_TTL))};
+}
+
+bool DelegationCache::findDeepest(const std::string& qname, Delegation& out, time_t now) const {
+    std::string name = normalizeCacheName(qname);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Do nome completo em direção à raiz: primeiro ancestral com delegação válida
+    size_t pos = 0;
+    while (pos < name.size()) {
+        auto it = zones_.find(name.substr(pos));
+        if (it != zones_.end() && it->second.expires_at > now) {
+            out = it->second;
+            for (const auto& ns : out.nameservers) {
+                if (out.addresses.count(ns) > 0) {
+                    continue;
+                }
+                auto addr = addresses_.find(ns);
+                if (addr != addresses_.end() && addr->second.expires_at > now) {
+                    out.addresses[ns] = addr->second.ip;
+                }
+            }
+            return true;
+        }
+        size_t dot = name.find('.', pos);
+        if (dot == std::string::npos) {
+            break;
+        }
+        pos = dot + 1;
+    }
+    return false;
+}
+
+std::string DelegationCache::findAddress(const std::string& ns_name, time_t now) const {
+    std::string key = normalizeCacheName(ns_name);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = addresses_.find(key);
+    if (it != addresses_.end() && it->second.expires_at > now) {
+        return it->second.ip;
+    }
+    return "";
+}
+
+void DelegationCache::invalidate(const std::string& zone) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    zones_.erase(normalizeCacheName(zone));
+}
+
+void DelegationCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    zones_.clear();
+    addresses_.clear();
+}
+
+size_t DelegationCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return zones_.size();
+}
+
+} // namespace dns_resolver
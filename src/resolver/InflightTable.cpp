@@ -0,0 +1,115 @@
+/*
+ * ----------------------------------------
+ * Arquivo: InflightTable.cpp
+ * Propósito: Implementação da coalescência de resoluções em andamento
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/InflightTable.h"
+#include "dns_resolver/SharedCache.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace dns_resolver {
+
+namespace {
+
+// Keys lideradas pela thread atual (da mais externa para a mais interna)
+thread_local std::vector<std::string> led_keys;
+
+} // namespace
+
+InflightTable& InflightTable::instance() {
+    static InflightTable table;
+    return table;
+}
+
+std::string InflightTable::makeKey(
+    const std::string& qname,
+    uint16_t qtype,
+    const std::string& variant
+) {
+    return normalizeCacheName(qname) + "/" + std::to_string(qtype) + "/" + variant;
+}
+
+bool InflightTable::run(
+    const std::string& key,
+    const std::function<DNSMessage()>& resolve,
+    DNSMessage& out,
+    const Clock::time_point* deadline
+) {
+    // A própria thread já resolve esta key mais acima na pilha: não esperar por si mesma
+    if (std::find(led_keys.begin(), led_keys.end(), key) != led_keys.end()) {
+        out = resolve();
+        return true;
+    }
+
+    std::shared_future<DNSMessage> running;
+    std::promise<DNSMessage> promise;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = inflight_.find(key);
+        if (it != inflight_.end()) {
+            running = it->second;
+        } else if (deadline == nullptr) {
+            inflight_.emplace(key, promise.get_future().share());
+            leader = true;
+        }
+    }
+
+    // Seguidor: esperar o líder
+    if (running.valid()) {
+        if (deadline != nullptr) {
+            if (running.wait_until(*deadline) != std::future_status::ready) {
+                throw std::runtime_error("Latency budget exceeded");
+            }
+        } else if (!led_keys.empty() &&
+                   running.wait_for(std::chrono::milliseconds(NESTED_WAIT_MS)) !=
+                       std::future_status::ready) {
+            // Possível ciclo com outra thread: seguir sozinho
+            out = resolve();
+            return true;
+        }
+        coalesced_++;
+        out = running.get();
+        return false;
+    }
+
+    // Com orçamento próprio e nada em curso: resolver fora da tabela
+    if (!leader) {
+        out = resolve();
+        return true;
+    }
+
+    led_keys.push_back(key);
+    try {
+        out = resolve();
+    } catch (...) {
+        led_keys.pop_back();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            inflight_.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    led_keys.pop_back();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inflight_.erase(key);
+    }
+    promise.set_value(out);
+    return true;
+}
+
+size_t InflightTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inflight_.size();
+}
+
+} // namespace dns_resolver
@@ -0,0 +1,167 @@
+/*
+ * ----------------------------------------
+ * Arquivo: InfraCache.cpp
+ * Propósito: Implementação da tabela de RTT por servidor e da seleção por SRTT
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/InfraCache.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace dns_resolver {
+
+InfraCache::InfraCache(size_t max_servers)
+    : max_servers_(max_servers == 0 ? 1 : max_servers), rng_(std::random_device{}()) {
+}
+
+InfraCache& InfraCache::instance() {
+    static InfraCache cache;
+    return cache;
+}
+
+void InfraCache::makeRoom(time_t now) {
+    if (servers_.size() < max_servers_) {
+        return;
+    }
+    for (auto it = servers_.begin(); it != servers_.end();) {
+        it = (now - it->second.updated_at > STATS_TTL) ? servers_.erase(it) : std::next(it);
+    }
+    if (servers_.size() >= max_servers_) {
+        auto oldest = std::min_element(servers_.begin(), servers_.end(),
+            [](const auto& a, const auto& b) { return a.second.updated_at < b.second.updated_at; });
+        servers_.erase(oldest);
+    }
+}
+
+void InfraCache::recordRtt(const std::string& server, uint32_t rtt_ms, time_t now) {
+    rtt_ms = std::min(rtt_ms, MAX_RTT_MS);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = servers_.find(server);
+    if (it == servers_.end()) {
+        makeRoom(now);
+        it = servers_.emplace(server, ServerStats()).first;
+    }
+
+    ServerStats& s = it->second;
+    bool fresh = (s.samples == 0 && s.timeouts == 0) || now - s.updated_at > STATS_TTL;
+    if (fresh) {
+        s.srtt_ms = rtt_ms;
+        s.rttvar_ms = rtt_ms / 2;
+    } else if (s.timeouts > 0) {
+        // Voltou a responder: abandona metade da penalidade de uma vez
+        s.srtt_ms = (s.srtt_ms + rtt_ms) / 2;
+        s.rttvar_ms = std::max(s.rttvar_ms, rtt_ms / 2);
+    } else {
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - RTT|; SRTT = 7/8 SRTT + 1/8 RTT (RFC 6298)
+        uint32_t delta = s.srtt_ms > rtt_ms ? s.srtt_ms - rtt_ms : rtt_ms - s.srtt_ms;
+        s.rttvar_ms = static_cast<uint32_t>((3ULL * s.rttvar_ms + delta) / 4);
+        s.srtt_ms = static_cast<uint32_t>((7ULL * s.srtt_ms + rtt_ms) / 8);
+    }
+    s.samples++;
+    s.timeouts = 0;
+    s.updated_at = now;
+}
+
+void InfraCache::recordTimeout(const std::string& server, time_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = servers_.find(server);
+    if (it == servers_.end()) {
+        makeRoom(now);
+        it = servers_.emplace(server, ServerStats()).first;
+        it->second.srtt_ms = UNKNOWN_RTT_MS;
+    }
+
+    // Backoff: cada falha consecutiva dobra a estimativa
+    ServerStats& s = it->second;
+    uint64_t doubled = std::max<uint64_t>(2ULL * s.srtt_ms, TIMEOUT_RTT_MS);
+    s.srtt_ms = static_cast<uint32_t>(std::min<uint64_t>(doubled, MAX_RTT_MS));
+    s.timeouts++;
+    s.updated_at = now;
+}
+
+uint32_t InfraCache::effectiveRttLocked(const std::string& server, time_t now) const {
+    auto it = servers_.find(server);
+    if (it == servers_.end() || now - it->second.updated_at > STATS_TTL) {
+        return UNKNOWN_RTT_MS;
+    }
+    return it->second.srtt_ms;
+}
+
+uint32_t InfraCache::effectiveRtt(const std::string& server, time_t now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return effectiveRttLocked(server, now);
+}
+
+uint32_t InfraCache::retryTimeoutMs(const std::string& server, time_t now) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = servers_.find(server);
+    if (it == servers_.end() || now - it->second.updated_at > STATS_TTL) {
+        return UNKNOWN_RTO_MS;
+    }
+    uint64_t rto = it->second.srtt_ms + 4ULL * it->second.rttvar_ms;
+    return static_cast<uint32_t>(std::clamp<uint64_t>(rto, MIN_RTO_MS, MAX_RTO_MS));
+}
+
+size_t InfraCache::select(const std::vector<std::string>& servers, time_t now) {
+    if (servers.empty()) {
+        throw std::invalid_argument("No servers to select from");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uniform_int_distribution<size_t> pick(0, servers.size() - 1);
+    if (servers.size() == 1) {
+        return 0;
+    }
+
+    // Exploração: de vez em quando, um candidato qualquer
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    if (percent(rng_) < explore_percent_) {
+        return pick(rng_);
+    }
+
+    // Menor RTT efetivo; empates resolvidos a partir de uma posição sorteada
+    size_t start = pick(rng_);
+    size_t best = start;
+    uint32_t best_rtt = effectiveRttLocked(servers[start], now);
+    for (size_t step = 1; step < servers.size(); step++) {
+        size_t i = (start + step) % servers.size();
+        uint32_t rtt = effectiveRttLocked(servers[i], now);
+        if (rtt < best_rtt) {
+            best = i;
+            best_rtt = rtt;
+        }
+    }
+    return best;
+}
+
+bool InfraCache::stats(const std::string& server, ServerStats& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = servers_.find(server);
+    if (it == servers_.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+void InfraCache::setExplorePercent(uint32_t percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    explore_percent_ = std::min<uint32_t>(percent, 100);
+}
+
+void InfraCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    servers_.clear();
+}
+
+size_t InfraCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return servers_.size();
+}
+
+} // namespace dns_resolver
@@ -13,6 +13,9 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <poll.h>
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <cerrno>
 #include <sstream>
@@ -169,6 +172,125 @@ std::vector<uint8_t> NetworkModule::queryUDP(
     return response;
 }
 
+// ========== UDP ESCALONADO (RETRY ENTRE SERVIDORES) ==========
+
+NetworkModule::StaggeredResult NetworkModule::queryUDPStaggered(
+    const std::vector<std::string>& servers,
+    const std::vector<uint8_t>& query,
+    const std::vector<int>& retry_after_ms,
+    int timeout_ms
+) {
+    if (servers.empty()) {
+        throw std::invalid_argument("Lista de servidores vazia");
+    }
+    
+    if (query.size() < 12) {
+        throw std::invalid_argument("Query DNS vazia");
+    }
+    
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::milliseconds(timeout_ms);
+    
+    // Um socket conectado por servidor: o kernel descarta datagramas de outras origens
+    std::vector<SocketRAII> sockets;
+    std::vector<struct pollfd> fds;
+    std::vector<size_t> fd_server;
+    std::vector<Clock::time_point> sent_at(servers.size());
+    
+    StaggeredResult result;
+    auto next_send = start;
+    
+    while (true) {
+        auto now = Clock::now();
+        
+        // Próximo servidor: na hora marcada ou se todos os sockets já falharam
+        if (result.sent < servers.size() && (now >= next_send || fds.empty())) {
+            size_t i = result.sent++;
+            int wait_ms = (i < retry_after_ms.size()) ? retry_after_ms[i] : timeout_ms;
+            next_send = now + std::chrono::milliseconds(std::max(1, wait_ms));
+            
+            struct sockaddr_in server_addr;
+            std::memset(&server_addr, 0, sizeof(server_addr));
+            server_addr.sin_family = AF_INET;
+            server_addr.sin_port = htons(53);
+            if (inet_pton(AF_INET, servers[i].c_str(), &server_addr.sin_addr) <= 0) {
+                continue;  // IP inválido: passa direto ao próximo
+            }
+            
+            SocketRAII sock(socket(AF_INET, SOCK_DGRAM, 0));
+            if (sock.get() < 0 ||
+                connect(sock.get(), reinterpret_cast<struct sockaddr*>(&server_addr),
+                        sizeof(server_addr)) < 0 ||
+                send(sock.get(), query.data(), query.size(), 0) !=
+                    static_cast<ssize_t>(query.size())) {
+                continue;
+            }
+            
+            sent_at[i] = now;
+            fds.push_back({sock.get(), POLLIN, 0});
+            fd_server.push_back(i);
+            sockets.push_back(std::move(sock));
+            continue;
+        }
+        
+        if (now >= deadline || (fds.empty() && result.sent >= servers.size())) {
+            return result;
+        }
+        
+        auto wake = deadline;
+        if (result.sent < servers.size()) {
+            wake = std::min(wake, next_send);
+        }
+        int wait = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            wake - now).count());
+        
+        int ready = poll(fds.data(), fds.size(), std::max(0, wait));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(
+                std::string("Falha ao aguardar resposta DNS: ") + strerror(errno)
+            );
+        }
+        
+        for (size_t k = 0; k < fds.size() && ready > 0; k++) {
+            if (fds[k].revents == 0) {
+                continue;
+            }
+            
+            std::vector<uint8_t> response(4096);
+            ssize_t recv_bytes = recv(fds[k].fd, response.data(), response.size(), 0);
+            // Erro (ex: ICMP port unreachable), resposta curta ou ID diferente: ignorar
+            if (recv_bytes < 12 || response[0] != query[0] || response[1] != query[1]) {
+                if (recv_bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    fds[k].fd = -1;  // poll ignora fds negativos
+                }
+                continue;
+            }
+            
+            response.resize(static_cast<size_t>(recv_bytes));
+            result.answered = true;
+            result.server_index = fd_server[k];
+            result.rtt_ms = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    Clock::now() - sent_at[fd_server[k]]).count());
+            result.response = std::move(response);
+            return result;
+        }
+        
+        // Descartar sockets com erro; sem nenhum ativo, antecipar o próximo envio
+        for (size_t k = fds.size(); k-- > 0;) {
+            if (fds[k].fd < 0) {
+                fds.erase(fds.begin() + static_cast<std::ptrdiff_t>(k));
+                fd_server.erase(fd_server.begin() + static_cast<std::ptrdiff_t>(k));
+                sockets.erase(sockets.begin() + static_cast<std::ptrdiff_t>(k));
+            }
+        }
+    }
+}
+
 // ========== IMPLEMENTAÇÃO TCP  ==========
 
 std::vector<uint8_t> NetworkModule::queryTCP(
@@ -0,0 +1,99 @@
+/*
+ * ----------------------------------------
+ * Arquivo: PKeyCache.cpp
+ * Propósito: Implementação do cache de chaves DNSKEY convertidas (EVP_PKEY)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/PKeyCache.h"
+#include <openssl/evp.h>
+
+namespace dns_resolver {
+
+size_t PKeyCache::KeyHash::operator()(const Key& key) const {
+    // FNV-1a de 64 bits sobre algoritmo, key tag e chave pública
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint8_t byte) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    };
+    mix(key.algorithm);
+    mix(static_cast<uint8_t>(key.key_tag >> 8));
+    mix(static_cast<uint8_t>(key.key_tag & 0xFF));
+    for (uint8_t byte : key.public_key) {
+        mix(byte);
+    }
+    return static_cast<size_t>(hash);
+}
+
+PKeyCache::PKeyCache(size_t max_keys)
+    : max_keys_(max_keys == 0 ? 1 : max_keys) {
+}
+
+PKeyCache& PKeyCache::instance() {
+    static PKeyCache cache;
+    return cache;
+}
+
+PKeyCache::Handle PKeyCache::find(
+    uint8_t algorithm,
+    uint16_t key_tag,
+    const std::vector<uint8_t>& public_key
+) {
+    Key key{algorithm, key_tag, public_key};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->pkey;
+}
+
+PKeyCache::Handle PKeyCache::insert(
+    uint8_t algorithm,
+    uint16_t key_tag,
+    const std::vector<uint8_t>& public_key,
+    EVP_PKEY* pkey
+) {
+    if (!pkey) {
+        return nullptr;
+    }
+    Handle handle(pkey, EVP_PKEY_free);
+    Key key{algorithm, key_tag, public_key};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // Conversão concorrente da mesma chave: fica a primeira
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->pkey;
+    }
+
+    if (lru_.size() >= max_keys_) {
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+    lru_.push_front(Entry{key, handle});
+    index_.emplace(std::move(key), lru_.begin());
+    return handle;
+}
+
+void PKeyCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+}
+
+size_t PKeyCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+}
+
+} // namespace dns_resolver
@@ -0,0 +1,149 @@
+/*
+ * ----------------------------------------
+ * Arquivo: ResolverContext.cpp
+ * Propósito: Implementação do estado de resolução compartilhado (trust anchors, DNSKEY/DS)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/ResolverContext.h"
+#include "dns_resolver/SharedCache.h"
+#include <algorithm>
+
+namespace dns_resolver {
+
+ResolverContext::ResolverContext(
+    const std::string& trust_anchor_file,
+    bool quiet,
+    size_t max_zones
+) : trust_anchor_file_(trust_anchor_file),
+    max_zones_(max_zones == 0 ? 1 : max_zones) {
+    if (!trust_anchor_file_.empty()) {
+        trust_anchors_.loadFromFile(trust_anchor_file_, quiet);
+    } else {
+        trust_anchors_.loadDefaultRootAnchor(quiet);
+    }
+}
+
+template <typename Record>
+bool ResolverContext::find(
+    const ZoneMap<Record>& map,
+    const std::string& zone,
+    std::vector<Record>& out,
+    std::vector<RRSIGRecord>* rrsigs,
+    time_t now
+) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map.find(normalizeCacheName(zone));
+    if (it == map.end() || it->second.expires_at <= now) {
+        return false;
+    }
+    out = it->second.records;
+    if (rrsigs != nullptr) {
+        *rrsigs = it->second.rrsigs;
+    }
+    return true;
+}
+
+template <typename Record>
+void ResolverContext::store(
+    ZoneMap<Record>& map,
+    const std::string& zone,
+    const std::vector<Record>& records,
+    const std::vector<RRSIGRecord>& rrsigs,
+    uint32_t ttl,
+    time_t now
+) {
+    if (records.empty()) {
+        ttl = NEGATIVE_TTL;
+    }
+    if (ttl == 0) {
+        return;
+    }
+
+    Entry<Record> entry;
+    entry.records = records;
+    entry.rrsigs = rrsigs;
+    entry.expires_at = now + static_cast<time_t>(std::min(ttl, MAX_TTL));
+    std::string key = normalizeCacheName(zone);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Limite atingido: descartar expiradas e, se preciso, a que vence antes
+    if (map.count(key) == 0 && map.size() >= max_zones_) {
+        for (auto it = map.begin(); it != map.end();) {
+            it = (it->second.expires_at <= now) ? map.erase(it) : std::next(it);
+        }
+        if (map.size() >= max_zones_) {
+            auto oldest = std::min_element(map.begin(), map.end(),
+                [](const auto& a, const auto& b) { return a.second.expires_at < b.second.expires_at; });
+            map.erase(oldest);
+        }
+    }
+    map[key] = std::move(entry);
+}
+
+bool ResolverContext::findDNSKEY(
+    const std::string& zone,
+    std::vector<DNSKEYRecord>& out,
+    std::vector<RRSIGRecord>& rrsigs,
+    time_t now
+) const {
+    return find(dnskeys_, zone, out, &rrsigs, now);
+}
+
+bool ResolverContext::findDS(
+    const std::string& zone,
+    std::vector<DSRecord>& out,
+    time_t now
+) const {
+    return find(ds_, zone, out, nullptr, now);
+}
+
+void ResolverContext::storeDNSKEY(
+    const std::string& zone,
+    const std::vector<DNSKEYRecord>& keys,
+    const std::vector<RRSIGRecord>& rrsigs,
+    uint32_t ttl,
+    time_t now
+) {
+    store(dnskeys_, zone, keys, rrsigs, ttl, now);
+}
+
+void ResolverContext::storeDS(
+    const std::string& zone,
+    const std::vector<DSRecord>& records,
+    uint32_t ttl,
+    time_t now
+) {
+    store(ds_, zone, records, {}, ttl, now);
+}
+
+ThreadPool& ResolverContext::fetchPool() {
+    std::call_once(fetch_pool_once_, [this]() {
+        fetch_pool_ = std::make_unique<ThreadPool>(FETCH_THREADS);
+    });
+    return *fetch_pool_;
+}
+
+ThreadPool& ResolverContext::verifyPool() {
+    std::call_once(verify_pool_once_, [this]() {
+        verify_pool_ = std::make_unique<ThreadPool>(VERIFY_THREADS);
+    });
+    return *verify_pool_;
+}
+
+void ResolverContext::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dnskeys_.clear();
+    ds_.clear();
+    validated_keys_.clear();
+}
+
+size_t ResolverContext::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dnskeys_.size() + ds_.size();
+}
+
+} // namespace dns_resolver
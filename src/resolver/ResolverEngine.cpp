@@ -10,6 +10,7 @@
 
 #include "dns_resolver/ResolverEngine.h"
 #include "dns_resolver/ThreadPool.h"
+#include <algorithm>
 #include <iostream>
 #include <random>
 #include <stdexcept>
@@ -20,7 +21,12 @@ namespace dns_resolver {
 // Construtor
 
 ResolverEngine::ResolverEngine(const ResolverConfig& config)
-    : config_(config) {
+    : ResolverEngine(config, std::make_shared<ResolverContext>(config.trust_anchor_file, config.quiet_mode)) {
+}
+
+ResolverEngine::ResolverEngine(const ResolverConfig& config, std::shared_ptr<ResolverContext> context)
+    : config_(config), context_(std::move(context)),
+      cache_client_("/tmp/dns_cache.sock", config_.cache_shm_name) {
     // Validar configuração
     if (config_.root_servers.empty()) {
         throw std::invalid_argument("Root servers list cannot be empty");
@@ -30,19 +36,25 @@ ResolverEngine::ResolverEngine(const ResolverConfig& config)
         throw std::invalid_argument("max_iterations must be >= 1");
     }
     
-    // Carregar trust anchors 
-    if (!config_.trust_anchor_file.empty()) {
-        trust_anchors_.loadFromFile(config_.trust_anchor_file, config_.quiet_mode);
-    } else {
-        trust_anchors_.loadDefaultRootAnchor(config_.quiet_mode);
+    if (!context_) {
+        throw std::invalid_argument("Resolver context cannot be null");
+    }
+    
+    if (context_->trustAnchorFile() != config_.trust_anchor_file) {
+        throw std::invalid_argument("Resolver context uses a different trust anchor file");
     }
     
-    traceLog("Trust anchors loaded: " + std::to_string(trust_anchors_.count()));
+    traceLog("Trust anchors loaded: " + std::to_string(context_->trustAnchors().count()));
     
     // Configurar cache client
     cache_client_.setTraceEnabled(config_.trace_mode);
 }
 
+ResolverEngine::~ResolverEngine() {
+    // Consultas DNSKEY/DS ainda no pool referenciam este engine
+    joinDNSSECFetches();
+}
+
 // Método principal: resolve
 
 DNSMessage ResolverEngine::resolve(const std::string& domain, uint16_t qtype) {
@@ -51,27 +63,99 @@ DNSMessage ResolverEngine::resolve(const std::string& domain, uint16_t qtype) {
         throw std::invalid_argument("Domain cannot be empty");
     }
     
-    // Consultar cache primeiro
-    auto cached_response = cache_client_.query(domain, qtype);
-    if (cached_response) {
-        // Cache HIT - retornar diretamente
-        return *cached_response;
+    // Consultar cache primeiro (desativado no prefetch do próprio daemon)
+    std::unique_ptr<DNSMessage> stale_response;
+    if (config_.use_cache) {
+        auto cached_response = cache_client_.query(domain, qtype);
+        if (cached_response) {
+            // Cache HIT - retornar diretamente
+            return *cached_response;
+        }
+        
+        // Serve-stale (RFC 8767): guardar entrada expirada como reserva
+        if (config_.serve_stale) {
+            stale_response = cache_client_.queryStale(domain, qtype);
+        }
     }
     
     // Cache MISS ou offline - continuar com resolução normal
     
+    // Com reserva stale, a resolução tem prazo: ao estourar, responder stale
+    has_deadline_ = stale_response && config_.stale_budget_ms > 0;
+    if (has_deadline_) {
+        deadline_ = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(config_.stale_budget_ms);
+        traceLog("Stale answer available (latency budget: " +
+                 std::to_string(config_.stale_budget_ms) + " ms)");
+    }
+    
+    // Iniciar resolução iterativa; com a mesma pergunta já em curso noutra
+    // thread, esperar por ela em vez de repetir a caminhada
+    try {
+        DNSMessage result;
+        bool resolved_here = true;
+        if (config_.coalesce_inflight) {
+            resolved_here = InflightTable::instance().run(
+                InflightTable::makeKey(domain, qtype, inflightVariant()),
+                [&]() { return resolveUncached(domain, qtype); },
+                result,
+                has_deadline_ ? &deadline_ : nullptr
+            );
+            if (!resolved_here) {
+                traceLog("Joined in-flight resolution of " + domain + " (type " +
+                         std::to_string(qtype) + ")");
+            }
+        } else {
+            result = resolveUncached(domain, qtype);
+        }
+        has_deadline_ = false;
+        
+        // SERVFAIL com reserva stale: a resposta antiga é mais útil
+        if (stale_response && result.header.rcode == 2) {
+            traceLog("Upstream returned SERVFAIL - serving stale answer");
+            return *stale_response;
+        }
+        
+        // Sem cache (prefetch do daemon, lote): o chamador decide o que armazenar
+        // Só quem resolveu armazena: seguidores recebem o mesmo resultado
+        CacheStoreItem item;
+        if (resolved_here && config_.use_cache && makeCacheItem(domain, qtype, result, item)) {
+            if (item.negative) {
+                cache_client_.storeNegative(domain, qtype, item.rcode, item.ttl);
+            } else {
+                cache_client_.store(result, domain, qtype);
+            }
+        }
+        
+        return result;
+    } catch (const std::exception& e) {
+        has_deadline_ = false;
+        traceLog("========================================");
+        traceLog(std::string("Resolution failed: ") + e.what());
+        traceLog("========================================");
+        
+        // Falha ou orçamento esgotado: responder stale (o daemon já agendou a renovação)
+        if (stale_response) {
+            traceLog("Serving stale answer");
+            return *stale_response;
+        }
+        throw;
+    }
+}
+
+DNSMessage ResolverEngine::resolveUncached(const std::string& domain, uint16_t qtype) {
     // Limpar cache de servidores consultados
     queried_servers_.clear();
     
     // Limpar registros DNSSEC coletados
     collected_dnskeys_.clear();
+    collected_dnskey_rrsigs_.clear();
     collected_ds_.clear();
+    fetched_dnskey_ttls_.clear();
+    fetched_ds_ttls_.clear();
     
-    // Selecionar root server aleatório
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<size_t> dis(0, config_.root_servers.size() - 1);
-    std::string root_server = config_.root_servers[dis(gen)];
+    // Selecionar root server (menor RTT suavizado)
+    std::string root_server = config_.root_servers[selectByRtt(config_.root_servers)];
     
     traceLog("========================================");
     traceLog("Starting resolution for " + domain + " (type " + std::to_string(qtype) + ")");
@@ -83,69 +167,107 @@ DNSMessage ResolverEngine::resolve(const std::string& domain, uint16_t qtype) {
         collectDNSKEY(".", root_server);
     }
     
-    // Iniciar resolução iterativa
+    // DNSKEY/DS correm em paralelo com a caminhada: juntar antes de validar
+    // (também na falha - as consultas usam este engine)
+    DNSMessage result;
     try {
-        DNSMessage result = performIterativeLookup(domain, qtype, root_server, 0);
-        traceLog("========================================");
-        traceLog("Resolution completed successfully");
-        traceLog("========================================");
+        result = lookupFromDeepestCut(domain, qtype, root_server, 0);
+    } catch (...) {
+        joinDNSSECFetches();
+        throw;
+    }
+    joinDNSSECFetches();
+    
+    traceLog("========================================");
+    traceLog("Resolution completed successfully");
+    traceLog("========================================");
+    
+    // Validar cadeia DNSSEC se ativo
+    if (config_.dnssec_enabled && !collected_dnskeys_.empty()) {
+        traceLog("");
+        DNSSECValidator validator(context_->trustAnchors(), config_.trace_mode, &context_->validatedKeys());
+        std::map<std::string, std::vector<DNSKEYRecord>> authenticated_keys;
+        ValidationResult validation = validator.validateChain(
+            domain,
+            collected_dnskeys_,
+            collected_ds_,
+            collected_dnskey_rrsigs_,
+            &authenticated_keys
+        );
+        rememberAuthenticated(authenticated_keys);
         
-        // Validar cadeia DNSSEC se ativo
-        if (config_.dnssec_enabled && !collected_dnskeys_.empty()) {
-            traceLog("");
-            DNSSECValidator validator(trust_anchors_, config_.trace_mode);
-            ValidationResult validation = validator.validateChain(
+        // Chaves autenticadas: verificar as assinaturas da própria resposta
+        // (verificações independentes em paralelo no pool do contexto)
+        if (validation == ValidationResult::Secure) {
+            validation = validator.validateRRsets(
+                result,
                 domain,
-                collected_dnskeys_,
-                collected_ds_
+                authenticated_keys,
+                &context_->verifyPool()
             );
-            
-            // Mapear ValidationResult → AD bit
-            if (validation == ValidationResult::Secure) {
-                traceLog(" DNSSEC Status: SECURE");
-                result.header.ad = true;
-                traceLog("Setting AD=1 (authenticated data)");
-            } else if (validation == ValidationResult::Insecure) {
-                traceLog("  DNSSEC Status: INSECURE (zone not signed)");
-                result.header.ad = false;
-                traceLog("Keeping AD=0 (zone unsigned)");
-            } else if (validation == ValidationResult::Bogus) {
-                traceLog(" DNSSEC Status: BOGUS (validation failed - possible attack!)");
-                result.header.ad = false;
-                traceLog("Keeping AD=0 (bogus)");
-                throw std::runtime_error("DNSSEC validation failed!");
-            } else {
-                traceLog(" DNSSEC Status: INDETERMINATE (insufficient data)");
-                result.header.ad = false;
-                traceLog("Keeping AD=0 (indeterminate)");
-            }
         }
         
-        // Armazenar resposta bem-sucedida no cache
-        if (result.header.rcode == 0 && result.header.ancount > 0) {
-            cache_client_.store(result, domain, qtype);
-        }
-        // Armazenar respostas negativas no cache
-        else if (isNXDOMAIN(result)) {
-            // NXDOMAIN - extrair TTL do SOA
-            DNSResourceRecord soa = extractSOA(result);
-            uint32_t ttl = (soa.type == DNSType::SOA) ? soa.rdata_soa.minimum : 300;
-            cache_client_.storeNegative(domain, qtype, 3, ttl);  // RCODE=3
-        }
-        else if (isNODATA(result, qtype)) {
-            // NODATA - extrair TTL do SOA
-            DNSResourceRecord soa = extractSOA(result);
-            uint32_t ttl = (soa.type == DNSType::SOA) ? soa.rdata_soa.minimum : 300;
-            cache_client_.storeNegative(domain, qtype, 0, ttl);  // RCODE=0, NODATA
+        // Mapear ValidationResult → AD bit
+        if (validation == ValidationResult::Secure) {
+            traceLog(" DNSSEC Status: SECURE");
+            result.header.ad = true;
+            traceLog("Setting AD=1 (authenticated data)");
+        } else if (validation == ValidationResult::Insecure) {
+            traceLog("  DNSSEC Status: INSECURE (zone not signed)");
+            result.header.ad = false;
+            traceLog("Keeping AD=0 (zone unsigned)");
+        } else if (validation == ValidationResult::Bogus) {
+            traceLog(" DNSSEC Status: BOGUS (validation failed - possible attack!)");
+            result.header.ad = false;
+            traceLog("Keeping AD=0 (bogus)");
+            throw std::runtime_error("DNSSEC validation failed!");
+        } else {
+            traceLog(" DNSSEC Status: INDETERMINATE (insufficient data)");
+            result.header.ad = false;
+            traceLog("Keeping AD=0 (indeterminate)");
         }
-        
-        return result;
-    } catch (const std::exception& e) {
-        traceLog("========================================");
-        traceLog(std::string("Resolution failed: ") + e.what());
-        traceLog("========================================");
-        throw;
     }
+    
+    return result;
+}
+
+std::string ResolverEngine::inflightVariant() const {
+    // Resultados só são intercambiáveis entre resolvers com a mesma validação e transporte
+    std::string variant = config_.dnssec_enabled ? "do:" + config_.trust_anchor_file : "plain";
+    if (config_.mode == QueryMode::TCP) {
+        variant += "/tcp";
+    } else if (config_.mode == QueryMode::DoT) {
+        variant += "/dot";
+    }
+    return variant;
+}
+
+bool ResolverEngine::makeCacheItem(
+    const std::string& domain,
+    uint16_t qtype,
+    const DNSMessage& result,
+    CacheStoreItem& item
+) const {
+    item.qname = domain;
+    item.qtype = qtype;
+    
+    // Resposta bem-sucedida
+    if (result.header.rcode == 0 && result.header.ancount > 0) {
+        item.negative = false;
+        item.response = result;
+        return true;
+    }
+    
+    // Respostas negativas: NXDOMAIN (RCODE=3) ou NODATA (RCODE=0), TTL do SOA
+    bool nxdomain = isNXDOMAIN(result);
+    if (!nxdomain && !isNODATA(result, qtype)) {
+        return false;
+    }
+    DNSResourceRecord soa = extractSOA(result);
+    item.negative = true;
+    item.rcode = nxdomain ? 3 : 0;
+    item.ttl = (soa.type == DNSType::SOA) ? soa.rdata_soa.minimum : 300;
+    return true;
 }
 
 // ========== ALGORITMO ITERATIVO ==========
@@ -154,7 +276,9 @@ DNSMessage ResolverEngine::performIterativeLookup(
     const std::string& domain,
     uint16_t qtype,
     const std::string& initial_server,
-    int depth
+    int depth,
+    const std::vector<std::string>& server_pool,
+    const std::string& server_zone
 ) {
     // Proteção contra recursão profunda
     const int MAX_DEPTH = 5;
@@ -165,6 +289,15 @@ DNSMessage ResolverEngine::performIterativeLookup(
     }
     
     std::string current_server = initial_server;
+    std::string current_zone = server_zone;   // Zona servida por current_server
+    
+    // Alternativas ao servidor atual (mesmo conjunto NS) se ele não responder
+    std::vector<std::string> current_pool = server_pool;
+    if (current_pool.empty() &&
+        std::find(config_.root_servers.begin(), config_.root_servers.end(), initial_server) !=
+            config_.root_servers.end()) {
+        current_pool = config_.root_servers;
+    }
     int iterations = 0;
     
     while (iterations < config_.max_iterations) {
@@ -182,8 +315,11 @@ DNSMessage ResolverEngine::performIterativeLookup(
         queried_servers_.insert(current_server);
         
         try {
-            // Enviar query e receber resposta
-            DNSMessage response = queryServer(current_server, domain, qtype);
+            // Enviar query e receber resposta (com retry no conjunto NS)
+            std::string answered_by;
+            DNSMessage response = queryWithRetry(
+                retryOrder(current_server, current_pool), domain, qtype, answered_by);
+            current_server = answered_by;
             
             // Verificar RCODE
             if (response.header.rcode != 0) {
@@ -276,6 +412,8 @@ DNSMessage ResolverEngine::performIterativeLookup(
                     }
                 }
                 
+                rememberDelegation(response, domain, current_zone, delegated_zone, nameservers, glue_records);
+                
                 // Coletar DS DA ZONA DELEGADA do servidor PAI (antes de mudar)
                 if (config_.dnssec_enabled && !delegated_zone.empty() && delegated_zone != ".") {
                     collectDS(delegated_zone, current_server);
@@ -283,6 +421,13 @@ DNSMessage ResolverEngine::performIterativeLookup(
                 
                 // Selecionar próximo servidor (com ou sem fan-out)
                 std::string next_server;
+                std::vector<std::string> next_pool;
+                for (const auto& ns : nameservers) {
+                    auto it = glue_records.find(ns);
+                    if (it != glue_records.end()) {
+                        next_pool.push_back(it->second);
+                    }
+                }
                 
                 // Fan-out se habilitado e múltiplos servidores com glue
                 if (config_.fanout_enabled && glue_records.size() > 1) {
@@ -319,6 +464,8 @@ DNSMessage ResolverEngine::performIterativeLookup(
                 
                 // Atualizar servidor atual
                 current_server = next_server;
+                current_pool = std::move(next_pool);
+                current_zone = delegated_zone;
                 
                 // Coletar DNSKEY DA ZONA DELEGADA do novo servidor
                 if (config_.dnssec_enabled && !delegated_zone.empty()) {
@@ -337,8 +484,7 @@ DNSMessage ResolverEngine::performIterativeLookup(
             std::string error_msg = e.what();
             traceLog("Error querying " + current_server + ": " + error_msg);
             
-            // Se foi timeout, podemos tentar outro servidor
-            // Por enquanto, propagar exceção
+            // Alternativas do conjunto NS já foram tentadas em queryWithRetry
             throw;
         }
     }
@@ -351,6 +497,117 @@ DNSMessage ResolverEngine::performIterativeLookup(
 
 // ========== HELPERS PARA DELEGAÇÕES ==========
 
+// ========== CACHE DE DELEGAÇÕES ==========
+
+namespace {
+
+// name é igual a zone ou está abaixo dela (comparação sem maiúsculas)
+bool isWithinZone(const std::string& name, const std::string& zone) {
+    std::string n = normalizeCacheName(name);
+    std::string z = normalizeCacheName(zone);
+    if (z.empty() || z == ".") {
+        return true;
+    }
+    return n == z || (n.size() > z.size() && n.compare(n.size() - z.size(), z.size(), z) == 0 &&
+                      n[n.size() - z.size() - 1] == '.');
+}
+
+} // namespace
+
+DNSMessage ResolverEngine::lookupFromDeepestCut(
+    const std::string& domain,
+    uint16_t qtype,
+    const std::string& root_server,
+    int depth
+) {
+    std::string zone;
+    std::vector<std::string> pool;
+    std::string start_server = cachedStartServer(domain, zone, pool);
+    if (start_server.empty()) {
+        return performIterativeLookup(domain, qtype, root_server, depth);
+    }
+    
+    traceLog("Starting at cached zone cut " + zone + " (" + start_server + ")");
+    try {
+        DNSMessage response = performIterativeLookup(domain, qtype, start_server, depth, pool, zone);
+        // Servidor lame (SERVFAIL / REFUSED): a delegação em cache não serve mais
+        if (response.header.rcode != 2 && response.header.rcode != 5) {
+            return response;
+        }
+        traceLog("Cached delegation for " + zone + " returned RCODE " +
+                 std::to_string(response.header.rcode) + ", restarting from root");
+    } catch (const std::exception& e) {
+        checkDeadline();
+        traceLog("Cached delegation for " + zone + " failed (" + e.what() +
+                 "), restarting from root");
+    }
+    
+    DelegationCache::instance().invalidate(zone);
+    return performIterativeLookup(domain, qtype, root_server, depth);
+}
+
+std::string ResolverEngine::cachedStartServer(
+    const std::string& domain,
+    std::string& zone,
+    std::vector<std::string>& pool
+) const {
+    if (!config_.use_delegation_cache || config_.dnssec_enabled) {
+        return "";
+    }
+    
+    Delegation delegation;
+    if (!DelegationCache::instance().findDeepest(domain, delegation)) {
+        return "";
+    }
+    
+    // Um NS com endereço conhecido, o de menor RTT suavizado
+    std::vector<std::string> candidates;
+    for (const auto& ns : delegation.nameservers) {
+        auto it = delegation.addresses.find(ns);
+        if (it != delegation.addresses.end()) {
+            candidates.push_back(it->second);
+        }
+    }
+    if (candidates.empty()) {
+        return "";
+    }
+    
+    zone = delegation.zone;
+    pool = candidates;
+    return candidates[selectByRtt(candidates)];
+}
+
+void ResolverEngine::rememberDelegation(
+    const DNSMessage& response,
+    const std::string& domain,
+    const std::string& server_zone,
+    const std::string& zone,
+    const std::vector<std::string>& nameservers,
+    const std::map<std::string, std::string>& glue_records
+) const {
+    // Referência para zona que não contém o nome consultado não é cacheada
+    // (zona fora de server_zone e glue fora da zona: DelegationCache::store)
+    if (!config_.use_delegation_cache || zone.empty() || !isWithinZone(domain, zone)) {
+        return;
+    }
+    
+    // TTL: o menor entre os NS da zona e os glue usados
+    uint32_t ttl = DelegationCache::MAX_TTL;
+    for (const auto& rr : response.authority) {
+        if (rr.type == DNSType::NS && normalizeCacheName(rr.name) == normalizeCacheName(zone)) {
+            ttl = std::min(ttl, rr.ttl);
+        }
+    }
+    for (const auto& rr : response.additional) {
+        if ((rr.type == DNSType::A || rr.type == DNSType::AAAA) && glue_records.count(rr.name) > 0 &&
+            isWithinZone(rr.name, zone)) {
+            ttl = std::min(ttl, rr.ttl);
+        }
+    }
+    
+    DelegationCache::instance().store(server_zone, zone, nameservers, glue_records, ttl);
+}
+
 bool ResolverEngine::isDelegation(const DNSMessage& response) const {
     // Uma delegação tem:
     // - ANSWER vazio (ancount == 0)
@@ -395,6 +652,27 @@ std::map<std::string, std::string> ResolverEngine::extractGlueRecords(
     return glue_map;
 }
 
+size_t ResolverEngine::selectByRtt(const std::vector<std::string>& servers) const {
+    if (servers.size() <= 1) {
+        return 0;
+    }
+    
+    if (!config_.use_infra_cache) {
+        thread_local std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<size_t> dis(0, servers.size() - 1);
+        return dis(gen);
+    }
+    
+    size_t chosen = InfraCache::instance().select(servers);
+    ServerStats stats;
+    if (config_.trace_mode && InfraCache::instance().stats(servers[chosen], stats)) {
+        traceLog("Selected " + servers[chosen] + " (srtt " + std::to_string(stats.srtt_ms) +
+                 "ms, " + std::to_string(stats.timeouts) + " consecutive timeouts) among " +
+                 std::to_string(servers.size()) + " servers");
+    }
+    return chosen;
+}
+
 std::string ResolverEngine::selectNextServer(
     const std::vector<std::string>& nameservers,
     const std::map<std::string, std::string>& glue_records,
@@ -404,14 +682,21 @@ std::string ResolverEngine::selectNextServer(
         throw std::runtime_error("No nameservers provided");
     }
     
-    // Estratégia 1: Tentar usar glue record primeiro
+    // Estratégia 1: Entre os NS com glue, o de menor RTT suavizado
+    std::vector<std::string> glued_names;
+    std::vector<std::string> glued_ips;
     for (const auto& ns : nameservers) {
         auto it = glue_records.find(ns);
         if (it != glue_records.end()) {
-            traceLog("Using glue record for " + ns + " → " + it->second);
-            return it->second;
+            glued_names.push_back(ns);
+            glued_ips.push_back(it->second);
         }
     }
+    if (!glued_ips.empty()) {
+        size_t chosen = selectByRtt(glued_ips);
+        traceLog("Using glue record for " + glued_names[chosen] + " → " + glued_ips[chosen]);
+        return glued_ips[chosen];
+    }
     
     // Estratégia 2: Resolver primeiro nameserver sem glue
     traceLog("No glue records available");
@@ -433,24 +718,42 @@ std::string ResolverEngine::selectNextServer(
 }
 
 std::string ResolverEngine::resolveNameserver(const std::string& ns_name, int depth) {
+    // Endereço já conhecido (glue de outra delegação ou resolução anterior)
+    if (config_.use_delegation_cache) {
+        std::string cached = DelegationCache::instance().findAddress(ns_name);
+        if (!cached.empty()) {
+            traceLog("  [NS Resolution] Cached address for " + ns_name + " → " + cached);
+            return cached;
+        }
+    }
+    
     // IMPORTANTE: Usar um root server para evitar dependência circular
     // Exemplo: se resolvendo google.com e NS é ns1.google.com, não podemos
     // usar google.com para resolver ns1.google.com
+    // (o zone cut em cache vem de referências anteriores, não da zona em curso)
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<size_t> dis(0, config_.root_servers.size() - 1);
-    std::string root_server = config_.root_servers[dis(gen)];
+    std::string root_server = config_.root_servers[selectByRtt(config_.root_servers)];
     
     traceLog("  [NS Resolution] Using root server " + root_server);
     
-    // Resolver tipo A
-    DNSMessage ns_response = performIterativeLookup(
-        ns_name,
-        DNSType::A,
-        root_server,
-        depth + 1
-    );
+    // Resolver tipo A (vários lookups sob a mesma zona disputam o mesmo NS)
+    DNSMessage ns_response;
+    auto lookup = [&]() {
+        return lookupFromDeepestCut(ns_name, DNSType::A, root_server, depth + 1);
+    };
+    if (config_.coalesce_inflight) {
+        bool resolved_here = InflightTable::instance().run(
+            InflightTable::makeKey(ns_name, DNSType::A, "ns/" + inflightVariant()),
+            lookup,
+            ns_response,
+            has_deadline_ ? &deadline_ : nullptr
+        );
+        if (!resolved_here) {
+            traceLog("  [NS Resolution] Joined in-flight lookup of " + ns_name);
+        }
+    } else {
+        ns_response = lookup();
+    }
     
     // Verificar se obtivemos resposta
     if (ns_response.answers.empty()) {
@@ -460,6 +763,9 @@ std::string ResolverEngine::resolveNameserver(const std::string& ns_name, int de
     // Retornar primeiro IP tipo A encontrado
     for (const auto& rr : ns_response.answers) {
         if (rr.type == DNSType::A && !rr.rdata_a.empty()) {
+            if (config_.use_delegation_cache) {
+                DelegationCache::instance().storeAddress(ns_name, rr.rdata_a, rr.ttl);
+            }
             return rr.rdata_a;
         }
     }
@@ -475,6 +781,39 @@ void ResolverEngine::traceLog(const std::string& message) const {
     }
 }
 
+namespace {
+
+// Mede uma troca com o servidor para a InfraCache: success() registra o RTT;
+// sair por exceção (timeout, erro de rede ou resposta inválida) conta como falha
+class RttProbe {
+public:
+    RttProbe(const std::string& server, bool enabled)
+        : server_(server), enabled_(enabled), started_(std::chrono::steady_clock::now()) {}
+    
+    ~RttProbe() {
+        if (enabled_ && !done_) {
+            InfraCache::instance().recordTimeout(server_);
+        }
+    }
+    
+    void success() {
+        if (enabled_) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - started_).count();
+            InfraCache::instance().recordRtt(server_, static_cast<uint32_t>(elapsed));
+        }
+        done_ = true;
+    }
+    
+private:
+    const std::string& server_;
+    bool enabled_;
+    bool done_ = false;
+    std::chrono::steady_clock::time_point started_;
+};
+
+} // namespace
+
 uint16_t ResolverEngine::generateTransactionID() const {
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -482,11 +821,25 @@ uint16_t ResolverEngine::generateTransactionID() const {
     return dis(gen);
 }
 
-DNSMessage ResolverEngine::queryServer(
-    const std::string& server,
-    const std::string& domain,
-    uint16_t qtype
-) {
+void ResolverEngine::checkDeadline() const {
+    if (has_deadline_ && std::chrono::steady_clock::now() >= deadline_) {
+        throw std::runtime_error("Latency budget exceeded");
+    }
+}
+
+int ResolverEngine::boundedTimeout(int timeout_seconds) const {
+    if (!has_deadline_) {
+        return timeout_seconds;
+    }
+    
+    // Arredondar para cima (timeouts de rede são em segundos; mínimo 1)
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline_ - std::chrono::steady_clock::now()).count();
+    int remaining_seconds = static_cast<int>((remaining + 999) / 1000);
+    return std::max(1, std::min(timeout_seconds, remaining_seconds));
+}
+
+std::vector<uint8_t> ResolverEngine::buildQuery(const std::string& domain, uint16_t qtype) const {
     // Construir query
     DNSMessage query;
     query.header.id = generateTransactionID();
@@ -508,10 +861,22 @@ DNSMessage ResolverEngine::queryServer(
     }
     
     // Serializar
-    std::vector<uint8_t> query_bytes = DNSParser::serialize(query);
+    return DNSParser::serialize(query);
+}
+
+DNSMessage ResolverEngine::queryServer(
+    const std::string& server,
+    const std::string& domain,
+    uint16_t qtype
+) {
+    // Serve-stale: não iniciar nova consulta após o prazo
+    checkDeadline();
+    
+    std::vector<uint8_t> query_bytes = buildQuery(domain, qtype);
     
     std::vector<uint8_t> response_bytes;
     DNSMessage response;
+    RttProbe probe(server, config_.use_infra_cache);
     
     // Escolher método de comunicação baseado no modo
     switch (config_.mode) {
@@ -522,7 +887,7 @@ DNSMessage ResolverEngine::queryServer(
             response_bytes = NetworkModule::queryTCP(
                 server,
                 query_bytes,
-                config_.timeout_seconds * 2  // TCP timeout maior
+                boundedTimeout(config_.timeout_seconds * 2)  // TCP timeout maior
             );
             
             response = DNSParser::parse(response_bytes);
@@ -546,7 +911,7 @@ DNSMessage ResolverEngine::queryServer(
                 server,
                 query_bytes,
                 config_.default_sni,
-                15  // DoT timeout maior (handshake TLS é lento)
+                boundedTimeout(15)  // DoT timeout maior (handshake TLS é lento)
             );
             
             response = DNSParser::parse(response_bytes);
@@ -561,7 +926,7 @@ DNSMessage ResolverEngine::queryServer(
             response_bytes = NetworkModule::queryUDP(
                 server,
                 query_bytes,
-                config_.timeout_seconds
+                boundedTimeout(config_.timeout_seconds)
             );
             
             response = DNSParser::parse(response_bytes);
@@ -575,7 +940,7 @@ DNSMessage ResolverEngine::queryServer(
                 response_bytes = NetworkModule::queryTCP(
                     server,
                     query_bytes,
-                    config_.timeout_seconds * 2  // TCP timeout maior (10s)
+                    boundedTimeout(config_.timeout_seconds * 2)  // TCP timeout maior (10s)
                 );
                 
                 response = DNSParser::parse(response_bytes);
@@ -586,6 +951,121 @@ DNSMessage ResolverEngine::queryServer(
             break;
     }
     
+    probe.success();
+    return response;
+}
+
+// ========== RETRY ENTRE SERVIDORES DO CONJUNTO NS ==========
+
+std::vector<std::string> ResolverEngine::retryOrder(
+    const std::string& primary,
+    const std::vector<std::string>& pool
+) const {
+    std::vector<std::string> servers = {primary};
+    
+    std::vector<std::string> alternates;
+    for (const auto& server : pool) {
+        if (server != primary &&
+            std::find(alternates.begin(), alternates.end(), server) == alternates.end()) {
+            alternates.push_back(server);
+        }
+    }
+    if (config_.use_infra_cache) {
+        std::stable_sort(alternates.begin(), alternates.end(),
+            [](const std::string& a, const std::string& b) {
+                return InfraCache::instance().effectiveRtt(a) < InfraCache::instance().effectiveRtt(b);
+            });
+    }
+    
+    size_t limit = static_cast<size_t>(std::max(1, config_.retry_servers));
+    for (const auto& server : alternates) {
+        if (servers.size() >= limit) {
+            break;
+        }
+        servers.push_back(server);
+    }
+    return servers;
+}
+
+DNSMessage ResolverEngine::queryWithRetry(
+    const std::vector<std::string>& servers,
+    const std::string& domain,
+    uint16_t qtype,
+    std::string& answered_by
+) {
+    if (servers.empty()) {
+        throw std::runtime_error("No servers to query");
+    }
+    
+    answered_by = servers[0];
+    if (servers.size() == 1) {
+        return queryServer(servers[0], domain, qtype);
+    }
+    
+    // TCP/DoT: uma conexão por vez, próximo servidor só após falha
+    if (config_.mode != QueryMode::UDP) {
+        for (size_t i = 0; ; i++) {
+            try {
+                answered_by = servers[i];
+                return queryServer(servers[i], domain, qtype);
+            } catch (const std::runtime_error& e) {
+                if (i + 1 == servers.size()) {
+                    throw;
+                }
+                checkDeadline();
+                traceLog("No answer from " + servers[i] + " (" + e.what() + "), trying " +
+                         servers[i + 1]);
+            }
+        }
+    }
+    
+    checkDeadline();
+    std::vector<uint8_t> query_bytes = buildQuery(domain, qtype);
+    
+    // Espera por servidor derivada do RTT medido (sem InfraCache: a do desconhecido)
+    std::vector<int> retry_after;
+    for (const auto& server : servers) {
+        retry_after.push_back(static_cast<int>(config_.use_infra_cache
+            ? InfraCache::instance().retryTimeoutMs(server)
+            : InfraCache::UNKNOWN_RTO_MS));
+    }
+    
+    int timeout_ms = boundedTimeout(config_.timeout_seconds) * 1000;
+    NetworkModule::StaggeredResult result =
+        NetworkModule::queryUDPStaggered(servers, query_bytes, retry_after, timeout_ms);
+    
+    // Quem recebeu a query antes de quem respondeu estourou o próprio RTO
+    size_t timed_out = result.answered ? result.server_index : result.sent;
+    for (size_t i = 0; i < timed_out; i++) {
+        traceLog("No answer from " + servers[i] + " within " + std::to_string(retry_after[i]) +
+                 "ms, query also sent to " + (i + 1 < servers.size() ? servers[i + 1] : "nobody"));
+        if (config_.use_infra_cache) {
+            InfraCache::instance().recordTimeout(servers[i]);
+        }
+    }
+    
+    if (!result.answered) {
+        throw std::runtime_error(
+            "Timeout ao aguardar resposta DNS de " + std::to_string(result.sent) +
+            " servidor(es) (" + std::to_string(timeout_ms / 1000) + "s)"
+        );
+    }
+    
+    answered_by = servers[result.server_index];
+    if (config_.use_infra_cache) {
+        InfraCache::instance().recordRtt(answered_by, result.rtt_ms);
+    }
+    
+    DNSMessage response = DNSParser::parse(result.response);
+    if (isTruncated(response)) {
+        traceLog("Response truncated (TC=1), retrying with TCP...");
+        std::vector<uint8_t> response_bytes = NetworkModule::queryTCP(
+            answered_by,
+            query_bytes,
+            boundedTimeout(config_.timeout_seconds * 2)
+        );
+        response = DNSParser::parse(response_bytes);
+    }
     return response;
 }
 
@@ -715,10 +1195,7 @@ DNSMessage ResolverEngine::followCNAME(
     
     // Fazer nova query para o canonical name
     // Começar nova resolução iterativa (pode estar em outro domínio)
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<size_t> dis(0, config_.root_servers.size() - 1);
-    std::string root_server = config_.root_servers[dis(gen)];
+    std::string root_server = config_.root_servers[selectByRtt(config_.root_servers)];
     
     traceLog("Starting new iterative resolution for CNAME target: " + cname);
     
@@ -757,67 +1234,188 @@ void ResolverEngine::collectDNSKEY(const std::string& zone, const std::string& s
         return;  // DNSSEC desabilitado
     }
     
-    traceLog("Collecting DNSKEY for zone: " + zone + " from " + server);
+    // Conjunto já consultado por outra resolução do mesmo contexto
+    std::vector<DNSKEYRecord> known;
+    std::vector<RRSIGRecord> known_rrsigs;
+    if (context_->findDNSKEY(zone, known, known_rrsigs)) {
+        traceLog("DNSKEY for zone " + zone + " from resolver context (" +
+                 std::to_string(known.size()) + " key(s))");
+        if (!known.empty()) {
+            collected_dnskeys_[zone] = std::move(known);
+            collected_dnskey_rrsigs_[zone] = std::move(known_rrsigs);
+        }
+        return;
+    }
     
+    for (const auto& pending : pending_dnskeys_) {
+        if (pending.first == zone) {
+            return;  // Já em curso nesta resolução
+        }
+    }
+    
+    // Em paralelo com a próxima referência; juntado antes da validação
+    traceLog("Collecting DNSKEY for zone: " + zone + " from " + server + " (in background)");
+    pending_dnskeys_.emplace_back(zone, context_->fetchPool().enqueue(
+        [this, zone, server]() { return fetchDNSKEY(zone, server); }
+    ));
+}
+
+void ResolverEngine::collectDS(const std::string& zone, const std::string& server) {
+    if (!config_.dnssec_enabled) {
+        return;  // DNSSEC desabilitado
+    }
+    
+    std::vector<DSRecord> known;
+    if (context_->findDS(zone, known)) {
+        traceLog("DS for zone " + zone + " from resolver context (" +
+                 std::to_string(known.size()) + " record(s))");
+        if (!known.empty()) {
+            collected_ds_[zone] = std::move(known);
+        }
+        return;
+    }
+    
+    for (const auto& pending : pending_ds_) {
+        if (pending.first == zone) {
+            return;
+        }
+    }
+    
+    traceLog("Collecting DS for zone: " + zone + " from " + server + " (in background)");
+    pending_ds_.emplace_back(zone, context_->fetchPool().enqueue(
+        [this, zone, server]() { return fetchDS(zone, server); }
+    ));
+}
+
+ResolverEngine::DNSKEYSet ResolverEngine::fetchDNSKEY(const std::string& zone, const std::string& server) {
+    DNSKEYSet result;
+    std::vector<DNSKEYRecord>& keys = result.keys;
     try {
         DNSMessage response = queryServer(server, zone, DNSType::DNSKEY);
         
+        // Nada vai para o contexto aqui: só conjuntos autenticados pela
+        // cadeia são guardados (rememberAuthenticated), nunca erros nem
+        // conjuntos vazios (NODATA sem negação verificada não prova nada)
+        if (response.header.rcode != 0) {
+            traceLog("  [" + zone + "] DNSKEY query returned RCODE " +
+                     std::to_string(response.header.rcode));
+            return result;
+        }
+        
         // Extrair DNSKEYs da resposta
         int ksk_count = 0;
         int zsk_count = 0;
+        result.ttl = ResolverContext::MAX_TTL;
         
         for (const auto& rr : response.answers) {
             if (rr.type == DNSType::DNSKEY) {
-                collected_dnskeys_[zone].push_back(rr.rdata_dnskey);
+                keys.push_back(rr.rdata_dnskey);
+                result.ttl = std::min(result.ttl, rr.ttl);
                 
                 if (rr.rdata_dnskey.isKSK()) {
                     ksk_count++;
                 } else {
                     zsk_count++;
                 }
+            } else if (rr.type == DNSType::RRSIG && rr.rdata_rrsig.type_covered == DNSType::DNSKEY) {
+                result.rrsigs.push_back(rr.rdata_rrsig);
             }
         }
         
         if (ksk_count > 0 || zsk_count > 0) {
-            traceLog("  Collected " + std::to_string(ksk_count) + " KSK(s) and " +
+            traceLog("  [" + zone + "] Collected " + std::to_string(ksk_count) + " KSK(s) and " +
                      std::to_string(zsk_count) + " ZSK(s)");
         } else {
-            traceLog("  No DNSKEY records found");
+            traceLog("  [" + zone + "] No DNSKEY records found");
         }
         
     } catch (const std::exception& e) {
-        traceLog("  DNSKEY query failed: " + std::string(e.what()));
+        traceLog("  [" + zone + "] DNSKEY query failed: " + std::string(e.what()));
         // Não é fatal - zona pode não ter DNSSEC
     }
+    return result;
 }
 
-void ResolverEngine::collectDS(const std::string& zone, const std::string& server) {
-    if (!config_.dnssec_enabled) {
-        return;  // DNSSEC desabilitado
-    }
-    
-    traceLog("Collecting DS for zone: " + zone + " from " + server);
-    
+ResolverEngine::DSSet ResolverEngine::fetchDS(const std::string& zone, const std::string& server) {
+    DSSet result;
+    std::vector<DSRecord>& records = result.records;
     try {
         DNSMessage response = queryServer(server, zone, DNSType::DS);
         
+        // Como em fetchDNSKEY: guardado só depois de autenticado
+        if (response.header.rcode != 0) {
+            traceLog("  [" + zone + "] DS query returned RCODE " +
+                     std::to_string(response.header.rcode));
+            return result;
+        }
+        
         // Extrair DS da resposta
+        result.ttl = ResolverContext::MAX_TTL;
         for (const auto& rr : response.answers) {
             if (rr.type == DNSType::DS) {
-                collected_ds_[zone].push_back(rr.rdata_ds);
+                records.push_back(rr.rdata_ds);
+                result.ttl = std::min(result.ttl, rr.ttl);
             }
         }
         
-        if (!collected_ds_[zone].empty()) {
-            traceLog("  Collected " + std::to_string(collected_ds_[zone].size()) + " DS record(s)");
+        if (!records.empty()) {
+            traceLog("  [" + zone + "] Collected " + std::to_string(records.size()) + " DS record(s)");
         } else {
-            traceLog("  No DS records found (zone may not be signed)");
+            traceLog("  [" + zone + "] No DS records found (zone may not be signed)");
         }
         
     } catch (const std::exception& e) {
-        traceLog("  DS query failed: " + std::string(e.what()));
+        traceLog("  [" + zone + "] DS query failed: " + std::string(e.what()));
         // Não é fatal - zona pode não ter DNSSEC
     }
+    return result;
+}
+
+void ResolverEngine::rememberAuthenticated(
+    const std::map<std::string, std::vector<DNSKEYRecord>>& authenticated_keys
+) {
+    // Elo validado: DNSKEY assinado por uma chave que confere com o DS (que
+    // por sua vez confere com ela); conjuntos vindos do contexto já estão lá
+    for (const auto& entry : authenticated_keys) {
+        const std::string& zone = entry.first;
+        auto dnskey_ttl = fetched_dnskey_ttls_.find(zone);
+        if (dnskey_ttl != fetched_dnskey_ttls_.end()) {
+            context_->storeDNSKEY(zone, collected_dnskeys_[zone], collected_dnskey_rrsigs_[zone],
+                                  dnskey_ttl->second);
+        }
+        auto ds_ttl = fetched_ds_ttls_.find(zone);
+        if (ds_ttl != fetched_ds_ttls_.end()) {
+            context_->storeDS(zone, collected_ds_[zone], ds_ttl->second);
+        }
+    }
+}
+
+void ResolverEngine::joinDNSSECFetches() {
+    for (auto& pending : pending_dnskeys_) {
+        try {
+            DNSKEYSet set = pending.second.get();
+            if (!set.keys.empty()) {
+                collected_dnskeys_[pending.first] = std::move(set.keys);
+                collected_dnskey_rrsigs_[pending.first] = std::move(set.rrsigs);
+                fetched_dnskey_ttls_[pending.first] = set.ttl;
+            }
+        } catch (...) {
+            // Falha de uma consulta DNSKEY não é fatal (zona fica sem chaves)
+        }
+    }
+    pending_dnskeys_.clear();
+    
+    for (auto& pending : pending_ds_) {
+        try {
+            DSSet set = pending.second.get();
+            if (!set.records.empty()) {
+                collected_ds_[pending.first] = std::move(set.records);
+                fetched_ds_ttls_[pending.first] = set.ttl;
+            }
+        } catch (...) {
+        }
+    }
+    pending_ds_.clear();
 }
 
 /**
@@ -0,0 +1,437 @@
+/*
+ * ----------------------------------------
+ * Arquivo: SharedCache.cpp
+ * Propósito: Implementação do espelho do cache em memória compartilhada (seqlock por slot)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/SharedCache.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace dns_resolver {
+
+// ========== LAYOUT DO SEGMENTO ==========
+
+// [Header][Slot 0][Slot 1]... — sem ponteiros (endereços diferem por processo)
+struct SharedCache::Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t wire_capacity;
+    std::atomic<uint32_t> active;
+};
+
+struct SharedCache::Slot {
+    std::atomic<uint32_t> seq;   // Ímpar durante escrita
+    uint8_t state;               // SLOT_EMPTY, SLOT_POSITIVE, SLOT_NEGATIVE
+    uint8_t rcode;
+    uint8_t qname_len;
+    uint8_t reserved;
+    uint16_t qtype;
+    uint16_t qclass;
+    uint16_t wire_len;
+    uint16_t padding;
+    uint32_t ttl;
+    int64_t timestamp;
+    uint64_t hash;
+    char qname[MAX_NAME];
+    char wire[WIRE_CAPACITY];
+};
+
+namespace {
+
+constexpr uint32_t SHM_MAGIC = 0x44435348;  // "DCSH"
+constexpr uint32_t SHM_VERSION = 2;   // 2: segmento de contadores de HITs
+constexpr uint8_t SLOT_EMPTY = 0;
+constexpr uint8_t SLOT_POSITIVE = 1;
+constexpr uint8_t SLOT_NEGATIVE = 2;
+constexpr int READ_RETRIES = 4;
+constexpr size_t HEADER_BYTES = 64;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Atomics em memória compartilhada precisam ser lock-free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Contadores de HITs sem espaço extra");
+
+std::string hitsName(const std::string& name) {
+    return name + "_hits";
+}
+
+// Slots alinhados a 64 bytes: seqlocks vizinhos não dividem linha de cache
+constexpr size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+SharedCache::Slot& SharedCache::slotAt(size_t index) const {
+    constexpr size_t stride = alignUp(sizeof(Slot), 64);
+    return *reinterpret_cast<Slot*>(static_cast<char*>(base_) + HEADER_BYTES + index * stride);
+}
+
+size_t SharedCache::indexOf(const Slot& slot) const {
+    constexpr size_t stride = alignUp(sizeof(Slot), 64);
+    return static_cast<size_t>(reinterpret_cast<const char*>(&slot) -
+                               (static_cast<const char*>(base_) + HEADER_BYTES)) / stride;
+}
+
+// ========== CRIAÇÃO / MAPEAMENTO ==========
+
+SharedCache::SharedCache(void* base, size_t size, const std::string& name, bool owner)
+    : base_(base), size_(size), name_(name), owner_(owner) {
+    slot_count_ = static_cast<Header*>(base_)->slot_count;
+    mapHits(owner);
+}
+
+void SharedCache::mapHits(bool create) {
+    std::string name = hitsName(name_);
+    size_t size = slot_count_ * sizeof(std::atomic<uint32_t>);
+    int fd;
+    if (create) {
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+        // Leitores de qualquer usuário contam HITs (umask não se aplica)
+        if (fd >= 0 && (fchmod(fd, 0666) < 0 || ftruncate(fd, static_cast<off_t>(size)) < 0)) {
+            close(fd);
+            shm_unlink(name.c_str());
+            fd = -1;
+        }
+    } else {
+        fd = shm_open(name.c_str(), O_RDWR, 0);
+        struct stat st;
+        if (fd >= 0 && (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) != size)) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd < 0) {
+        return;  // Sem contadores: HITs da memória compartilhada não são contados
+    }
+
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        if (create) {
+            shm_unlink(name.c_str());
+        }
+        return;
+    }
+    hits_ = static_cast<std::atomic<uint32_t>*>(map);
+    hits_size_ = size;
+}
+
+std::unique_ptr<SharedCache> SharedCache::create(const std::string& name, size_t slots) {
+    static_assert(sizeof(Header) <= HEADER_BYTES, "Header excede a área reservada");
+
+    size_t slot_count = PROBE_WINDOW;
+    while (slot_count < slots) {
+        slot_count <<= 1;
+    }
+    size_t size = HEADER_BYTES + slot_count * alignUp(sizeof(Slot), 64);
+
+    // Segmento de execução anterior (daemon encerrado sem limpar) é descartado
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create shared memory segment: " + name);
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Cannot size shared memory segment: " + name);
+    }
+
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Cannot map shared memory segment: " + name);
+    }
+
+    // ftruncate zera o segmento: todos os slots vazios com seq = 0
+    Header* header = static_cast<Header*>(base);
+    header->magic = SHM_MAGIC;
+    header->version = SHM_VERSION;
+    header->slot_count = static_cast<uint32_t>(slot_count);
+    header->wire_capacity = static_cast<uint32_t>(WIRE_CAPACITY);
+    header->active.store(1, std::memory_order_release);
+
+    return std::unique_ptr<SharedCache>(new SharedCache(base, size, name, true));
+}
+
+std::unique_ptr<SharedCache> SharedCache::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+
+    // Layout precisa conferir com o deste binário
+    const Header* header = static_cast<const Header*>(base);
+    size_t expected = HEADER_BYTES + static_cast<size_t>(header->slot_count) *
+                                     alignUp(sizeof(Slot), 64);
+    if (header->magic != SHM_MAGIC || header->version != SHM_VERSION ||
+        header->wire_capacity != WIRE_CAPACITY || header->slot_count == 0 ||
+        (header->slot_count & (header->slot_count - 1)) != 0 || expected != size ||
+        header->active.load(std::memory_order_acquire) == 0) {
+        munmap(base, size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedCache>(new SharedCache(base, size, name, false));
+}
+
+SharedCache::~SharedCache() {
+    if (owner_) {
+        static_cast<Header*>(base_)->active.store(0, std::memory_order_release);
+        shm_unlink(name_.c_str());
+        if (hits_ != nullptr) {
+            shm_unlink(hitsName(name_).c_str());
+        }
+    }
+    if (hits_ != nullptr) {
+        munmap(hits_, hits_size_);
+    }
+    munmap(base_, size_);
+}
+
+bool SharedCache::isActive() const {
+    return static_cast<const Header*>(base_)->active.load(std::memory_order_acquire) != 0;
+}
+
+// ========== ESCRITA (DAEMON) ==========
+
+void SharedCache::writeSlot(Slot& slot, uint64_t hash, std::string_view qname, uint16_t qtype,
+                            uint16_t qclass, bool negative, uint8_t rcode, std::string_view wire,
+                            time_t timestamp, uint32_t ttl) {
+    // Slot passa a outra chave: HITs pendentes da anterior são descartados
+    if (hits_ != nullptr && (slot.state == SLOT_EMPTY || slot.hash != hash)) {
+        hits_[indexOf(slot)].store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.state = negative ? SLOT_NEGATIVE : SLOT_POSITIVE;
+    slot.rcode = rcode;
+    slot.qname_len = static_cast<uint8_t>(qname.size());
+    slot.qtype = qtype;
+    slot.qclass = qclass;
+    slot.wire_len = static_cast<uint16_t>(wire.size());
+    slot.ttl = ttl;
+    slot.timestamp = static_cast<int64_t>(timestamp);
+    slot.hash = hash;
+    std::memcpy(slot.qname, qname.data(), qname.size());
+    std::memcpy(slot.wire, wire.data(), wire.size());
+
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+void SharedCache::eraseSlot(Slot& slot) {
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.state = SLOT_EMPTY;
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+void SharedCache::publish(std::string_view qname, uint16_t qtype, uint16_t qclass,
+                          bool negative, uint8_t rcode, std::string_view wire,
+                          time_t timestamp, uint32_t ttl) {
+    if (!owner_) {
+        return;
+    }
+
+    std::string name = normalizeCacheName(qname);
+    uint64_t hash = cacheKeyHash(name, qtype, qclass);
+    bool fits = name.size() <= MAX_NAME && wire.size() <= WIRE_CAPACITY;
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    // Escritor único: os campos dos slots podem ser lidos sem seqlock
+    size_t mask = slot_count_ - 1;
+    Slot* target = nullptr;
+    Slot* victim = nullptr;
+    int64_t victim_expiry = INT64_MAX;
+
+    for (size_t i = 0; i < PROBE_WINDOW; i++) {
+        Slot& slot = slotAt((static_cast<size_t>(hash) + i) & mask);
+        if (slot.state != SLOT_EMPTY && slot.hash == hash && slot.qtype == qtype &&
+            slot.qclass == qclass && slot.qname_len == name.size() &&
+            std::memcmp(slot.qname, name.data(), name.size()) == 0) {
+            target = &slot;
+            break;
+        }
+        // Vaga: slot vazio ou, na falta, o que expira primeiro
+        int64_t expiry = (slot.state == SLOT_EMPTY) ? INT64_MIN
+                                                    : slot.timestamp + static_cast<int64_t>(slot.ttl);
+        if (expiry < victim_expiry) {
+            victim = &slot;
+            victim_expiry = expiry;
+        }
+    }
+
+    if (!fits) {
+        // Não cabe: remover a versão anterior para não servir resposta antiga
+        if (target != nullptr) {
+            eraseSlot(*target);
+        }
+        return;
+    }
+
+    writeSlot(target != nullptr ? *target : *victim, hash, name, qtype, qclass,
+              negative, rcode, negative ? std::string_view() : wire, timestamp, ttl);
+}
+
+SharedCache::Slot* SharedCache::findSlot(const std::string& name, uint64_t hash,
+                                         uint16_t qtype, uint16_t qclass) const {
+    size_t mask = slot_count_ - 1;
+    for (size_t i = 0; i < PROBE_WINDOW; i++) {
+        Slot& slot = slotAt((static_cast<size_t>(hash) + i) & mask);
+        if (slot.state != SLOT_EMPTY && slot.hash == hash && slot.qtype == qtype &&
+            slot.qclass == qclass && slot.qname_len == name.size() &&
+            std::memcmp(slot.qname, name.data(), name.size()) == 0) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void SharedCache::unpublish(std::string_view qname, uint16_t qtype, uint16_t qclass, bool negative) {
+    if (!owner_) {
+        return;
+    }
+
+    std::string name = normalizeCacheName(qname);
+    if (name.size() > MAX_NAME) {
+        return;
+    }
+    uint64_t hash = cacheKeyHash(name, qtype, qclass);
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    // A mesma chave pode estar no espelho pela outra tabela: só remover a do tipo pedido
+    Slot* slot = findSlot(name, hash, qtype, qclass);
+    if (slot != nullptr && slot->state == (negative ? SLOT_NEGATIVE : SLOT_POSITIVE)) {
+        eraseSlot(*slot);
+    }
+}
+
+std::vector<SharedCacheHits> SharedCache::drainHits() {
+    std::vector<SharedCacheHits> sampled;
+    if (!owner_ || hits_ == nullptr) {
+        return sampled;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (size_t i = 0; i < slot_count_; i++) {
+        if (hits_[i].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        uint32_t hits = hits_[i].exchange(0, std::memory_order_relaxed);
+        const Slot& slot = slotAt(i);
+        if (slot.state == SLOT_EMPTY) {
+            continue;
+        }
+        SharedCacheHits entry;
+        entry.qname.assign(slot.qname, slot.qname_len);
+        entry.qtype = slot.qtype;
+        entry.qclass = slot.qclass;
+        entry.negative = (slot.state == SLOT_NEGATIVE);
+        entry.hits = hits;
+        sampled.push_back(std::move(entry));
+    }
+    return sampled;
+}
+
+void SharedCache::clear(bool positive, bool negative) {
+    if (!owner_) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    for (size_t i = 0; i < slot_count_; i++) {
+        Slot& slot = slotAt(i);
+        if ((positive && slot.state == SLOT_POSITIVE) ||
+            (negative && slot.state == SLOT_NEGATIVE)) {
+            eraseSlot(slot);
+        }
+    }
+}
+
+// ========== LEITURA (RESOLVERS) ==========
+
+bool SharedCache::lookup(std::string_view qname, uint16_t qtype, uint16_t qclass,
+                         time_t now, SharedCacheHit& out) const {
+    std::string name = normalizeCacheName(qname);
+    if (name.size() > MAX_NAME) {
+        return false;
+    }
+    uint64_t hash = cacheKeyHash(name, qtype, qclass);
+    size_t mask = slot_count_ - 1;
+
+    for (size_t i = 0; i < PROBE_WINDOW; i++) {
+        const Slot& slot = slotAt((static_cast<size_t>(hash) + i) & mask);
+
+        for (int attempt = 0; attempt < READ_RETRIES; attempt++) {
+            uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;  // Escrita em andamento
+            }
+
+            // Cópia otimista; só é válida se a sequência não mudou
+            uint8_t state = slot.state;
+            bool match = state != SLOT_EMPTY && slot.hash == hash && slot.qtype == qtype &&
+                         slot.qclass == qclass && slot.qname_len == name.size() &&
+                         std::memcmp(slot.qname, name.data(), name.size()) == 0;
+            if (match) {
+                uint16_t wire_len = slot.wire_len;
+                out.negative = (state == SLOT_NEGATIVE);
+                out.rcode = slot.rcode;
+                out.timestamp = static_cast<time_t>(slot.timestamp);
+                out.ttl = slot.ttl;
+                out.wire.assign(slot.wire, wire_len <= WIRE_CAPACITY ? wire_len : 0);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != before) {
+                continue;  // Slot reescrito durante a cópia
+            }
+
+            if (!match) {
+                break;  // Próximo slot da janela
+            }
+            if ((now - out.timestamp) > static_cast<time_t>(out.ttl)) {
+                return false;
+            }
+            if (hits_ != nullptr) {
+                hits_[indexOf(slot)].fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace dns_resolver
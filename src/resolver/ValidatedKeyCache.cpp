@@ -0,0 +1,105 @@
+/*
+ * ----------------------------------------
+ * Arquivo: ValidatedKeyCache.cpp
+ * Propósito: Implementação do cache de elos DS → DNSKEY validados
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver Recursivo Validante com Cache e DNSSEC
+ * ----------------------------------------
+ */
+
+#include "dns_resolver/ValidatedKeyCache.h"
+#include "dns_resolver/SharedCache.h"
+#include <algorithm>
+
+namespace dns_resolver {
+
+namespace {
+
+bool sameKey(const DNSKEYRecord& a, const DNSKEYRecord& b) {
+    return a.flags == b.flags && a.protocol == b.protocol &&
+           a.algorithm == b.algorithm && a.public_key == b.public_key;
+}
+
+bool sameDS(const DSRecord& a, const DSRecord& b) {
+    return a.key_tag == b.key_tag && a.algorithm == b.algorithm &&
+           a.digest_type == b.digest_type && a.digest == b.digest;
+}
+
+// Mesmos registros na mesma ordem (a ordem vem da resposta e do cache do contexto)
+template <typename Record, typename Equal>
+bool sameSet(const std::vector<Record>& a, const std::vector<Record>& b, Equal equal) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), equal);
+}
+
+} // namespace
+
+ValidatedKeyCache::ValidatedKeyCache(size_t max_zones)
+    : max_zones_(max_zones == 0 ? 1 : max_zones) {
+}
+
+bool ValidatedKeyCache::lookup(
+    const std::string& zone,
+    const std::vector<DNSKEYRecord>& dnskeys,
+    const std::vector<DSRecord>& ds,
+    bool& trusted,
+    time_t now
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = zones_.find(normalizeCacheName(zone));
+    if (it == zones_.end() || it->second.expires_at <= now ||
+        !sameSet(it->second.dnskeys, dnskeys, sameKey) ||
+        !sameSet(it->second.ds, ds, sameDS)) {
+        misses_++;
+        return false;
+    }
+    trusted = it->second.trusted;
+    hits_++;
+    return true;
+}
+
+void ValidatedKeyCache::store(
+    const std::string& zone,
+    const std::vector<DNSKEYRecord>& dnskeys,
+    const std::vector<DSRecord>& ds,
+    bool trusted,
+    uint32_t ttl,
+    time_t now
+) {
+    if (ttl == 0) {
+        return;
+    }
+
+    Entry entry;
+    entry.dnskeys = dnskeys;
+    entry.ds = ds;
+    entry.trusted = trusted;
+    entry.expires_at = now + static_cast<time_t>(std::min(ttl, MAX_TTL));
+    std::string key = normalizeCacheName(zone);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Limite atingido: descartar expiradas e, se preciso, a que vence antes
+    if (zones_.count(key) == 0 && zones_.size() >= max_zones_) {
+        for (auto it = zones_.begin(); it != zones_.end();) {
+            it = (it->second.expires_at <= now) ? zones_.erase(it) : std::next(it);
+        }
+        if (zones_.size() >= max_zones_) {
+            auto oldest = std::min_element(zones_.begin(), zones_.end(),
+                [](const auto& a, const auto& b) { return a.second.expires_at < b.second.expires_at; });
+            zones_.erase(oldest);
+        }
+    }
+    zones_[key] = std::move(entry);
+}
+
+void ValidatedKeyCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    zones_.clear();
+}
+
+size_t ValidatedKeyCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return zones_.size();
+}
+
+} // namespace dns_resolver
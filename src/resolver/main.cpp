@@ -13,6 +13,7 @@
 #include "dns_resolver/NetworkModule.h"
 #include "dns_resolver/ResolverEngine.h"
 #include "dns_resolver/ThreadPool.h"
+#include "dns_resolver/AsyncResolver.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -367,7 +368,8 @@ void processBatch(
     const std::string& filename,
     uint16_t qtype,
     const ResolverConfig& config,
-    size_t num_workers
+    size_t num_workers,
+    size_t max_in_flight
 ) {
     // Ler domínios do arquivo
     std::ifstream file(filename);
@@ -397,47 +399,134 @@ void processBatch(
     
     std::cout << "\n=================================================\n";
     std::cout << "  DNS Resolver - Batch Processing\n";
-    std::cout << "  Workers:  " << num_workers << "\n";
+    // Sem DNSSEC, em UDP: uma thread de eventos conduz todas as resoluções
+    bool use_async = AsyncResolver::supports(config);
+    if (use_async) {
+        std::cout << "  Engine:   async (epoll, " << max_in_flight << " in flight)\n";
+    } else {
+        std::cout << "  Workers:  " << num_workers << "\n";
+    }
     std::cout << "  Domains:  " << domains.size() << "\n";
     std::cout << "=================================================\n\n";
     
-    // Criar ThreadPool
-    ThreadPool pool(num_workers);
-    
-    // Enfileirar tarefas
-    std::vector<std::future<std::pair<std::string, bool>>> results;
     auto start_time = std::chrono::steady_clock::now();
     
-    for (const auto& domain : domains) {
-        results.push_back(pool.enqueue([domain, qtype, &config]() -> std::pair<std::string, bool> {
+    // Consultar o cache para a lista inteira num round trip (MQUERY)
+    CacheClient cache_client("/tmp/dns_cache.sock", config.cache_shm_name);
+    cache_client.setTraceEnabled(config.trace_mode);
+    std::vector<std::unique_ptr<DNSMessage>> cached(domains.size());
+    if (config.use_cache) {
+        std::vector<DNSQuestion> questions;
+        questions.reserve(domains.size());
+        for (const auto& domain : domains) {
+            questions.emplace_back(domain, qtype, DNSClass::IN);
+        }
+        cached = cache_client.queryMany(questions);
+    }
+    
+    // Workers resolvem só os MISS, sem cache: o lote é armazenado no fim (MSTORE)
+    ResolverConfig worker_config = config;
+    worker_config.use_cache = false;
+    
+    // Um contexto para o lote: trust anchors carregados uma vez e DNSKEY/DS
+    // de cada zona consultados uma vez, não um por domínio
+    auto context = std::make_shared<ResolverContext>(config.trust_anchor_file, config.quiet_mode);
+    
+    struct BatchOutcome {
+        bool success = false;
+        bool cacheable = false;
+        CacheStoreItem item;
+    };
+    
+    // Motor assíncrono ou ThreadPool (DNSSEC, TCP e DoT seguem bloqueantes)
+    std::unique_ptr<ResolverEngine> helper;
+    std::unique_ptr<AsyncResolver> async;
+    std::unique_ptr<ThreadPool> pool;
+    if (use_async) {
+        async = std::make_unique<AsyncResolver>(worker_config, max_in_flight);
+        helper = std::make_unique<ResolverEngine>(worker_config, context);
+    } else {
+        pool = std::make_unique<ThreadPool>(num_workers);
+    }
+    
+    // Enfileirar tarefas
+    std::vector<std::future<BatchOutcome>> results(domains.size());
+    for (size_t i = 0; i < domains.size(); i++) {
+        if (cached[i]) {
+            continue;
+        }
+        const std::string& domain = domains[i];
+        if (async) {
+            // Callback na thread de eventos: só monta o resultado
+            auto promise = std::make_shared<std::promise<BatchOutcome>>();
+            results[i] = promise->get_future();
+            async->resolve(domain, qtype, [promise, &helper, &config](AsyncResult& result) {
+                BatchOutcome outcome;
+                if (result.ok) {
+                    outcome.success = !result.response.answers.empty() &&
+                                      result.response.header.rcode == 0;
+                    outcome.cacheable = config.use_cache &&
+                        helper->makeCacheItem(result.domain, result.qtype, result.response, outcome.item);
+                }
+                promise->set_value(std::move(outcome));
+            });
+            continue;
+        }
+        results[i] = pool->enqueue([&domain, qtype, &worker_config, &config, &context]() -> BatchOutcome {
+            BatchOutcome outcome;
             try {
-                ResolverEngine resolver(config);
+                ResolverEngine resolver(worker_config, context);
                 DNSMessage response = resolver.resolve(domain, qtype);
                 
                 // Verificar se foi bem-sucedido
-                bool success = !response.answers.empty() && response.header.rcode == 0;
-                return {domain, success};
-            } catch (const std::exception& e) {
-                return {domain, false};
+                outcome.success = !response.answers.empty() && response.header.rcode == 0;
+                outcome.cacheable = config.use_cache &&
+                                    resolver.makeCacheItem(domain, qtype, response, outcome.item);
+            } catch (const std::exception&) {
+                outcome.success = false;
             }
-        }));
+            return outcome;
+        });
     }
     
     // Coletar resultados
     size_t success_count = 0;
     size_t fail_count = 0;
+    size_t cached_count = 0;
+    std::vector<CacheStoreItem> to_store;
     
-    for (auto& result : results) {
-        auto [domain, success] = result.get();
+    for (size_t i = 0; i < domains.size(); i++) {
+        bool success;
+        if (cached[i]) {
+            success = !cached[i]->answers.empty() && cached[i]->header.rcode == 0;
+            cached_count++;
+        } else {
+            BatchOutcome outcome = results[i].get();
+            success = outcome.success;
+            if (outcome.cacheable) {
+                to_store.push_back(std::move(outcome.item));
+            }
+            // Resolução falhou: entrada expirada na janela stale (RFC 8767)
+            if (!success && config.use_cache && config.serve_stale) {
+                auto stale = cache_client.queryStale(domains[i], qtype);
+                success = stale && !stale->answers.empty() && stale->header.rcode == 0;
+            }
+        }
+        
         if (success) {
-            std::cout << "✓ " << domain << "\n";
+            std::cout << "✓ " << domains[i] << "\n";
             success_count++;
         } else {
-            std::cout << "✗ " << domain << "\n";
+            std::cout << "✗ " << domains[i] << "\n";
             fail_count++;
         }
     }
     
+    // Armazenar as respostas novas num round trip (MSTORE)
+    if (!to_store.empty()) {
+        cache_client.storeMany(to_store);
+    }
+    
     auto end_time = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     
@@ -446,6 +535,7 @@ void processBatch(
     std::cout << "=================================================\n";
     std::cout << "  Success:   " << success_count << "/" << domains.size() << "\n";
     std::cout << "  Failed:    " << fail_count << "/" << domains.size() << "\n";
+    std::cout << "  Cached:    " << cached_count << "/" << domains.size() << "\n";
     std::cout << "  Time:      " << duration.count() << " ms\n";
     std::cout << "  Avg/query: " << (domains.empty() ? 0 : duration.count() / domains.size()) << " ms\n";
     std::cout << "=================================================\n\n";
@@ -688,9 +778,13 @@ void showHelp(const char* prog_name) {
     std::cout << "  --max-iterations <n>           Maximum resolution iterations (default: 15)\n";
     std::cout << "                                 Valid range: 1-50\n";
     std::cout << "  --workers <n>                  Thread pool size for batch processing (default: 4)\n";
-    std::cout << "                                 Valid range: 1-16\n";
+    std::cout << "                                 Valid range: 1-16 (DNSSEC, TCP and DoT batches)\n";
+    std::cout << "  --in-flight <n>                Concurrent resolutions in async batch mode (default: 256)\n";
+    std::cout << "                                 Valid range: 1-1024 (UDP batches without DNSSEC)\n";
     std::cout << "  --batch <file>                 Process multiple domains from file (one per line)\n";
-    std::cout << "  --fanout                       Query multiple nameservers in parallel (reduces latency)\n\n";
+    std::cout << "  --fanout                       Query multiple nameservers in parallel (reduces latency)\n";
+    std::cout << "  --cache-shm [name]             Read cache hits from the daemon's shared memory\n";
+    std::cout << "                                 (daemon started with --shm-slots; default name: " << SharedCache::DEFAULT_NAME << ")\n\n";
     
     std::cout << "DNSSEC OPTIONS:\n";
     std::cout << "  --dnssec                       Enable DNSSEC validation\n";
@@ -765,6 +859,7 @@ int main(int argc, char* argv[]) {
     std::string dot_server;  // Servidor DNS específico para DoT
     uint16_t qtype = DNSType::A;
     size_t num_workers = 4;  // Default workers para batch
+    size_t max_in_flight = AsyncResolver::DEFAULT_MAX_IN_FLIGHT;  // Lote assíncrono
     std::string batch_file;  // Arquivo batch
     
     for (int i = 1; i < argc; i++) {
@@ -877,9 +972,30 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Try 'resolver --help' for more information\n";
                 return 1;
             }
+        } else if (std::strcmp(argv[i], "--in-flight") == 0 && i + 1 < argc) {
+            try {
+                int in_flight = std::stoi(argv[++i]);
+                if (in_flight < 1 || in_flight > 1024) {
+                    std::cerr << "Error: --in-flight must be between 1 and 1024\n";
+                    std::cerr << "Try 'resolver --help' for more information\n";
+                    return 1;
+                }
+                max_in_flight = static_cast<size_t>(in_flight);
+            } catch (const std::exception&) {
+                std::cerr << "Error: --in-flight requires a valid number\n";
+                std::cerr << "Try 'resolver --help' for more information\n";
+                return 1;
+            }
         } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
             batch_file = argv[++i];
             use_recursive = true;
+        } else if (std::strcmp(argv[i], "--cache-shm") == 0) {
+            // Nome opcional: próximo argumento se não for outra opção
+            if (i + 1 < argc && argv[i + 1][0] == '/') {
+                config.cache_shm_name = argv[++i];
+            } else {
+                config.cache_shm_name = SharedCache::DEFAULT_NAME;
+            }
         } else if (std::strcmp(argv[i], "--fanout") == 0) {
             config.fanout_enabled = true;
             use_recursive = true;
@@ -905,7 +1021,7 @@ int main(int argc, char* argv[]) {
     
     // Modo batch tem precedência (não requer --name)
     if (!batch_file.empty()) {
-        processBatch(batch_file, qtype, config, num_workers);
+        processBatch(batch_file, qtype, config, num_workers, max_in_flight);
         return 0;
     }
     
@@ -0,0 +1,411 @@
+/*
+ * Arquivo: test_async_resolver.cpp
+ * Propósito: Testes unitários para o motor de resolução assíncrono (AsyncResolver)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para AsyncResolver, cobrindo:
+ * - Configurações suportadas (UDP, sem DNSSEC)
+ * - Resolução iterativa root → autoritativo via future
+ * - CNAME, NS sem glue (sub-resolução) e NXDOMAIN
+ * - Centenas de resoluções simultâneas numa thread, com limite de in-flight
+ * - Servidor que não responde e parada com resoluções pendentes
+ * - Pedidos repetidos coalescidos numa única resolução
+ *
+ * Servidores falsos em 127.0.0.x:53 (loopback) fazem o papel de root e
+ * autoritativo; sem permissão para a porta 53 os testes de rede são pulados.
+ */
+
+#include "dns_resolver/AsyncResolver.h"
+#include "dns_resolver/DNSParser.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Servidores Falsos ==========
+
+const char* ROOT_IP = "127.0.0.2";
+const char* AUTH_IP = "127.0.0.3";
+const char* SILENT_IP = "127.0.0.5";
+
+int bindLoopbackDNS(const char* ip) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(53);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    if (fd >= 0 && bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        return fd;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return -1;
+}
+
+DNSResourceRecord makeRR(const std::string& name, uint16_t type, const std::string& value) {
+    DNSResourceRecord rr;
+    rr.name = name;
+    rr.type = type;
+    rr.rr_class = DNSClass::IN;
+    rr.ttl = 300;
+    if (type == DNSType::A) rr.rdata_a = value;
+    if (type == DNSType::NS) rr.rdata_ns = value;
+    if (type == DNSType::CNAME) rr.rdata_cname = value;
+    return rr;
+}
+
+bool endsWith(const std::string& name, const std::string& suffix) {
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Root: delega example.test (com glue) e other.test (NS sem glue, em example.test)
+DNSMessage answerRoot(const DNSMessage& query) {
+    DNSMessage response;
+    response.header = query.header;
+    response.header.qr = true;
+    response.questions = query.questions;
+    const std::string& name = query.questions[0].qname;
+
+    if (endsWith(name, "example.test")) {
+        response.authority.push_back(makeRR("example.test", DNSType::NS, "a.ns.example.test"));
+        response.additional.push_back(makeRR("a.ns.example.test", DNSType::A, AUTH_IP));
+    } else if (endsWith(name, "other.test")) {
+        response.authority.push_back(makeRR("other.test", DNSType::NS, "ns.example.test"));
+    } else {
+        response.header.rcode = 3;
+    }
+    return response;
+}
+
+// Autoritativo de example.test e other.test
+DNSMessage answerAuth(const DNSMessage& query) {
+    DNSMessage response;
+    response.header = query.header;
+    response.header.qr = true;
+    response.header.aa = true;
+    response.questions = query.questions;
+    const std::string& name = query.questions[0].qname;
+
+    if (name == "alias.example.test") {
+        response.answers.push_back(makeRR(name, DNSType::CNAME, "www.example.test"));
+    } else if (name == "ns.example.test") {
+        response.answers.push_back(makeRR(name, DNSType::A, AUTH_IP));
+    } else if (name == "www.other.test") {
+        response.answers.push_back(makeRR(name, DNSType::A, "192.0.2.2"));
+    } else if (name == "www.example.test" || endsWith(name, ".bulk.example.test")) {
+        response.answers.push_back(makeRR(name, DNSType::A, "192.0.2.1"));
+    } else {
+        response.header.rcode = 3;
+    }
+    return response;
+}
+
+// Atende root e autoritativo numa thread; o silencioso só recebe
+class FakeServers {
+public:
+    bool start() {
+        root_ = bindLoopbackDNS(ROOT_IP);
+        auth_ = bindLoopbackDNS(AUTH_IP);
+        silent_ = bindLoopbackDNS(SILENT_IP);
+        if (root_ < 0 || auth_ < 0 || silent_ < 0) {
+            return false;
+        }
+        thread_ = std::thread([this]() { serve(); });
+        return true;
+    }
+
+    ~FakeServers() {
+        stop_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (root_ >= 0) close(root_);
+        if (auth_ >= 0) close(auth_);
+        if (silent_ >= 0) close(silent_);
+    }
+
+private:
+    void serve() {
+        struct pollfd fds[2] = {{root_, POLLIN, 0}, {auth_, POLLIN, 0}};
+        uint8_t buffer[4096];
+        while (!stop_) {
+            if (poll(fds, 2, 50) <= 0) {
+                continue;
+            }
+            for (int i = 0; i < 2; i++) {
+                if ((fds[i].revents & POLLIN) == 0) {
+                    continue;
+                }
+                struct sockaddr_in from {};
+                socklen_t len = sizeof(from);
+                ssize_t n = recvfrom(fds[i].fd, buffer, sizeof(buffer), 0,
+                                     reinterpret_cast<struct sockaddr*>(&from), &len);
+                if (n <= 0) {
+                    continue;
+                }
+                try {
+                    DNSMessage query = DNSParser::parse(std::vector<uint8_t>(buffer, buffer + n));
+                    DNSMessage response = (i == 0) ? answerRoot(query) : answerAuth(query);
+                    std::vector<uint8_t> bytes = DNSParser::serialize(response);
+                    sendto(fds[i].fd, bytes.data(), bytes.size(), 0,
+                           reinterpret_cast<struct sockaddr*>(&from), len);
+                } catch (const std::exception&) {
+                }
+            }
+        }
+    }
+
+    int root_ = -1;
+    int auth_ = -1;
+    int silent_ = -1;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+ResolverConfig loopbackConfig() {
+    ResolverConfig config;
+    config.root_servers = {ROOT_IP};
+    config.use_cache = false;
+    config.quiet_mode = true;
+    config.timeout_seconds = 2;
+    return config;
+}
+
+std::string firstA(const DNSMessage& response) {
+    for (const auto& rr : response.answers) {
+        if (rr.type == DNSType::A) {
+            return rr.rdata_a;
+        }
+    }
+    return "";
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa as configurações suportadas
+ */
+void test_supported_configs() {
+    std::cout << "\n[TEST] AsyncResolver - Configurações suportadas\n";
+
+    ResolverConfig config = loopbackConfig();
+    test_assert(AsyncResolver::supports(config), "UDP sem DNSSEC");
+
+    ResolverConfig dnssec = config;
+    dnssec.dnssec_enabled = true;
+    ResolverConfig tcp = config;
+    tcp.mode = QueryMode::TCP;
+    test_assert(!AsyncResolver::supports(dnssec) && !AsyncResolver::supports(tcp),
+                "DNSSEC e TCP ficam no motor síncrono");
+
+    bool threw = false;
+    try {
+        AsyncResolver resolver(dnssec);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    test_assert(threw, "Construtor rejeita configuração não suportada");
+}
+
+/**
+ * Testa resoluções individuais
+ */
+void test_resolution() {
+    std::cout << "\n[TEST] AsyncResolver - Resolução iterativa\n";
+
+    AsyncResolver resolver(loopbackConfig());
+
+    DNSMessage www = resolver.resolve("www.example.test", DNSType::A).get();
+    test_assert(www.header.rcode == 0 && firstA(www) == "192.0.2.1", "Root → autoritativo");
+
+    DNSMessage alias = resolver.resolve("alias.example.test", DNSType::A).get();
+    test_assert(alias.answers.size() == 2 && alias.answers[0].type == DNSType::CNAME &&
+                firstA(alias) == "192.0.2.1",
+                "CNAME seguido (CNAME + registro final)");
+
+    DNSMessage other = resolver.resolve("www.other.test", DNSType::A).get();
+    test_assert(firstA(other) == "192.0.2.2", "NS sem glue resolvido por sub-resolução");
+
+    DNSMessage missing = resolver.resolve("missing.example.test", DNSType::A).get();
+    test_assert(missing.header.rcode == 3, "NXDOMAIN entregue como resposta");
+    test_assert(resolver.pending() == 0, "Nada pendente");
+}
+
+/**
+ * Testa muitas resoluções simultâneas numa única thread
+ */
+void test_concurrency() {
+    std::cout << "\n[TEST] AsyncResolver - Resoluções simultâneas\n";
+
+    AsyncResolver resolver(loopbackConfig(), 64);
+    const int total = 500;
+    std::atomic<int> ok{0};
+    std::atomic<int> done{0};
+    std::promise<void> finished;
+
+    for (int i = 0; i < total; i++) {
+        resolver.resolve("h" + std::to_string(i) + ".bulk.example.test", DNSType::A,
+            [&](AsyncResult& result) {
+                if (result.ok && firstA(result.response) == "192.0.2.1") {
+                    ok++;
+                }
+                if (++done == total) {
+                    finished.set_value();
+                }
+            });
+    }
+
+    bool completed = finished.get_future().wait_for(std::chrono::seconds(30)) ==
+                     std::future_status::ready;
+    test_assert(completed && ok == total, "500 resoluções concluídas (64 em voo)");
+    test_assert(resolver.pending() == 0, "Contador pending zerado");
+}
+
+/**
+ * Testa falhas: servidor mudo e parada com pendentes
+ */
+void test_failures() {
+    std::cout << "\n[TEST] AsyncResolver - Falhas\n";
+
+    ResolverConfig config = loopbackConfig();
+    config.root_servers = {SILENT_IP};
+    config.timeout_seconds = 1;
+    config.use_delegation_cache = false;
+
+    {
+        AsyncResolver resolver(config);
+        auto start = std::chrono::steady_clock::now();
+        bool threw = false;
+        try {
+            resolver.resolve("www.example.test", DNSType::A).get();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        test_assert(threw && elapsed < 2500, "Servidor mudo: erro após o prazo do passo");
+    }
+
+    std::future<DNSMessage> orphan;
+    {
+        AsyncResolver resolver(config);
+        orphan = resolver.resolve("www.example.test", DNSType::A);
+    }
+    bool stopped = false;
+    try {
+        orphan.get();
+    } catch (const std::runtime_error& e) {
+        stopped = std::string(e.what()) == "Resolver stopped";
+    }
+    test_assert(stopped, "Destrutor conclui pendentes com erro");
+}
+
+/**
+ * Testa a coalescência de pedidos iguais
+ */
+void test_coalescing() {
+    std::cout << "\n[TEST] AsyncResolver - Coalescência de pedidos iguais\n";
+
+    // Servidor mudo: a primeira resolução dura o prazo do passo e todas as
+    // cópias chegam enquanto ela está ativa
+    ResolverConfig config = loopbackConfig();
+    config.root_servers = {SILENT_IP};
+    config.timeout_seconds = 1;
+    config.use_delegation_cache = false;
+
+    AsyncResolver resolver(config, 1);
+    const int copies = 10;
+    std::vector<std::future<DNSMessage>> futures;
+    for (int i = 0; i < copies; i++) {
+        futures.push_back(resolver.resolve("www.example.test", DNSType::A));
+    }
+    auto start = std::chrono::steady_clock::now();
+    int failed = 0;
+    for (auto& future : futures) {
+        try {
+            future.get();
+        } catch (const std::runtime_error&) {
+            failed++;
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    test_assert(failed == copies && resolver.coalesced() == copies - 1,
+                "10 pedidos, uma resolução (9 coalescidos)");
+    test_assert(elapsed < 2500, "Cópias não ocupam a vaga única (sem fila serial)");
+    test_assert(resolver.pending() == 0, "Contador pending zerado");
+
+    // Com servidores respondendo, cada chamador recebe a resposta completa
+    AsyncResolver live(loopbackConfig());
+    std::vector<std::future<DNSMessage>> answers;
+    for (int i = 0; i < copies; i++) {
+        answers.push_back(live.resolve("alias.example.test", DNSType::A));
+    }
+    int complete = 0;
+    for (auto& future : answers) {
+        DNSMessage response = future.get();
+        if (response.answers.size() == 2 && firstA(response) == "192.0.2.1") {
+            complete++;
+        }
+    }
+    test_assert(complete == copies, "Todas as cópias recebem CNAME + registro final");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: AsyncResolver (epoll)\n";
+    std::cout << "==========================================\n";
+
+    test_supported_configs();
+
+    FakeServers servers;
+    if (servers.start()) {
+        test_resolution();
+        test_concurrency();
+        test_failures();
+        test_coalescing();
+    } else {
+        std::cout << "\n(testes de rede pulados: porta 53 em loopback indisponível)\n";
+    }
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
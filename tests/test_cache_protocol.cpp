@@ -0,0 +1,223 @@
+/*
+ * Arquivo: test_cache_protocol.cpp
+ * Propósito: Testes unitários para o protocolo binário do IPC entre CacheClient e cache daemon
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para o protocolo binário do cache, cobrindo:
+ * - Cabeçalho fixo de 12 bytes (magic, versão, opcode, request_id, tamanho)
+ * - Campos com prefixo de tamanho (strings u16, blobs u32) ida e volta
+ * - Vários frames no mesmo buffer (pipeline)
+ * - Frames incompletos (leituras parciais do socket) e payloads > 4 KB
+ * - Rejeição de magic, versão e tamanho inválidos e de payload truncado
+ */
+
+#include "dns_resolver/CacheProtocol.h"
+#include <iostream>
+#include <string>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Helpers ==========
+
+bool throwsRuntimeError(std::string_view buffer) {
+    size_t offset = 0;
+    CacheFrameHeader header;
+    std::string_view payload;
+    try {
+        CacheProtocol::extractFrame(buffer, offset, header, payload);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa layout do cabeçalho do frame
+ */
+void test_frame_header() {
+    std::cout << "\n[TEST] CacheProtocol - Cabeçalho do frame\n";
+
+    std::string frame = CacheMessageWriter(CacheOpcode::QUERY, 0x01020304)
+        .putU8(0xAB)
+        .finish();
+
+    test_assert(frame.size() == CacheProtocol::HEADER_SIZE + 1, "Tamanho = 12 + payload");
+    test_assert(static_cast<uint8_t>(frame[0]) == 0xDC && static_cast<uint8_t>(frame[1]) == 0xAC,
+                "Magic 0xDCAC");
+    test_assert(frame[2] == CacheProtocol::VERSION, "Versão do protocolo");
+    test_assert(frame[3] == static_cast<char>(CacheOpcode::QUERY), "Opcode");
+    test_assert(frame[4] == 1 && frame[5] == 2 && frame[6] == 3 && frame[7] == 4,
+                "request_id big-endian");
+    test_assert(frame[8] == 0 && frame[9] == 0 && frame[10] == 0 && frame[11] == 1,
+                "Tamanho do payload big-endian");
+
+    CacheProtocol::setRequestId(frame, 0x0A0B0C0D);
+    size_t offset = 0;
+    CacheFrameHeader header;
+    std::string_view payload;
+    test_assert(CacheProtocol::extractFrame(frame, offset, header, payload) &&
+                header.request_id == 0x0A0B0C0D, "setRequestId regrava o ID");
+}
+
+/**
+ * Testa campos com prefixo de tamanho (ida e volta)
+ */
+void test_fields_round_trip() {
+    std::cout << "\n[TEST] CacheProtocol - Campos ida e volta\n";
+
+    std::string blob("bin\0ary|data", 12);
+    std::string frame = CacheMessageWriter(CacheOpcode::STORE, 7)
+        .putString("www.example.com")
+        .putU16(28)
+        .putU16(1)
+        .putU32(86400)
+        .putU64(512ULL * 1024 * 1024 * 1024)
+        .putBlob(blob)
+        .finish();
+
+    size_t offset = 0;
+    CacheFrameHeader header;
+    std::string_view payload;
+    test_assert(CacheProtocol::extractFrame(frame, offset, header, payload), "Frame extraído");
+    test_assert(header.opcode == CacheOpcode::STORE && header.request_id == 7, "Opcode e ID");
+
+    CacheMessageReader reader(payload);
+    test_assert(reader.getString() == "www.example.com", "String (u16) preservada");
+    test_assert(reader.getU16() == 28, "u16 qtype");
+    test_assert(reader.getU16() == 1, "u16 qclass");
+    test_assert(reader.getU32() == 86400, "u32 ttl");
+    test_assert(reader.getU64() == 512ULL * 1024 * 1024 * 1024, "u64 acima de 4 GB");
+    test_assert(reader.getBlob() == blob, "Blob com bytes nulos e '|' preservado");
+    test_assert(reader.atEnd(), "Payload consumido por completo");
+
+    bool threw = false;
+    try {
+        reader.getU8();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    test_assert(threw, "Leitura além do payload lança exceção");
+}
+
+/**
+ * Testa extração de vários frames do mesmo buffer
+ */
+void test_pipelined_frames() {
+    std::cout << "\n[TEST] CacheProtocol - Frames em pipeline\n";
+
+    std::string buffer;
+    buffer += CacheMessageWriter(CacheOpcode::MISS, 7).finish();
+    buffer += CacheMessageWriter(CacheOpcode::NEGATIVE, 8).putU8(3).finish();
+    buffer += CacheMessageWriter(CacheOpcode::OK, 9).putBlob("Stored").finish();
+
+    size_t offset = 0;
+    CacheFrameHeader header;
+    std::string_view payload;
+
+    test_assert(CacheProtocol::extractFrame(buffer, offset, header, payload) &&
+                header.request_id == 7 && header.opcode == CacheOpcode::MISS &&
+                payload.empty(), "Frame 1 (MISS) extraído");
+    test_assert(CacheProtocol::extractFrame(buffer, offset, header, payload) &&
+                header.request_id == 8 && CacheMessageReader(payload).getU8() == 3,
+                "Frame 2 (NEGATIVE) extraído");
+    test_assert(CacheProtocol::extractFrame(buffer, offset, header, payload) &&
+                header.request_id == 9 && CacheMessageReader(payload).getBlob() == "Stored",
+                "Frame 3 (OK) extraído");
+    test_assert(!CacheProtocol::extractFrame(buffer, offset, header, payload), "Sem mais frames");
+    test_assert(offset == buffer.size(), "Offset no fim do buffer");
+}
+
+/**
+ * Testa frames incompletos e payloads maiores que 4 KB
+ */
+void test_partial_and_large_frames() {
+    std::cout << "\n[TEST] CacheProtocol - Frames parciais e grandes\n";
+
+    std::string large(20000, 'x');
+    std::string full = CacheMessageWriter(CacheOpcode::HIT, 42).putBlob(large).finish();
+
+    // Alimentar em blocos de 4096 bytes até completar
+    std::string buffer;
+    size_t offset = 0;
+    CacheFrameHeader header;
+    std::string_view payload;
+    bool extracted = false;
+    bool offsets_ok = true;
+
+    for (size_t fed = 0; fed < full.size() && !extracted; fed += 4096) {
+        buffer.append(full, fed, 4096);
+        extracted = CacheProtocol::extractFrame(buffer, offset, header, payload);
+        offsets_ok = offsets_ok && (extracted || offset == 0);
+    }
+
+    test_assert(offsets_ok, "Frame incompleto não avança offset");
+    test_assert(extracted && header.request_id == 42, "Frame grande extraído após leituras parciais");
+    test_assert(CacheMessageReader(payload).getBlob() == large, "Blob de 20000 bytes íntegro");
+}
+
+/**
+ * Testa rejeição de cabeçalhos inválidos
+ */
+void test_invalid_headers() {
+    std::cout << "\n[TEST] CacheProtocol - Cabeçalhos inválidos\n";
+
+    std::string valid = CacheMessageWriter(CacheOpcode::STATUS).finish();
+
+    std::string bad_magic = valid;
+    bad_magic[0] = 'Q';
+    test_assert(throwsRuntimeError(bad_magic), "Magic inválido lança exceção");
+
+    std::string bad_version = valid;
+    bad_version[2] = 9;
+    test_assert(throwsRuntimeError(bad_version), "Versão desconhecida lança exceção");
+
+    std::string oversized = valid;
+    oversized[8] = static_cast<char>(0xFF);
+    test_assert(throwsRuntimeError(oversized), "Tamanho acima do limite lança exceção");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: CacheProtocol (IPC do Cache)\n";
+    std::cout << "==========================================\n";
+
+    test_frame_header();
+    test_fields_round_trip();
+    test_pipelined_frames();
+    test_partial_and_large_frames();
+    test_invalid_headers();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
@@ -0,0 +1,297 @@
+/*
+ * Arquivo: test_cache_snapshot.cpp
+ * Propósito: Testes unitários para o snapshot das tabelas do cache daemon (reinício a quente)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para CacheSnapshot, cobrindo:
+ * - Gravação e carga (ida e volta) de entradas positivas e negativas
+ * - Expiração absoluta: TTL restante e HITs preservados após a carga
+ * - Descarte de entradas vencidas (respeitando a janela stale)
+ * - Preservação da ordem LRU
+ * - Arquivo inexistente, assinatura inválida e snapshot truncado
+ * - Diretório privado, arquivo 0600 e recusa de arquivos de outro dono,
+ *   graváveis por outros ou links simbólicos
+ */
+
+#include "CacheSnapshot.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace dns_cache;
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Helpers ==========
+
+std::string snapshotPath() {
+    return "/tmp/test_cache_snapshot_" + std::to_string(getpid()) + ".bin";
+}
+
+CacheKey makeKey(const std::string& name) {
+    return CacheKey(name, DNSType::A, DNSClass::IN);
+}
+
+// Resposta mínima: example.com A (TTL 300) 1.2.3.4
+std::string makeWire() {
+    const uint8_t bytes[] = {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 0x03, 'c', 'o', 'm', 0x00,
+        0x00, 0x01, 0x00, 0x01,
+        0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2C, 0x00, 0x04,
+        1, 2, 3, 4
+    };
+    return std::string(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+bool loadThrows(const std::string& path, CacheTable& positive, CacheTable& negative) {
+    try {
+        CacheSnapshot::load(path, positive, negative);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+bool saveThrows(const std::string& path, CacheTable& positive, CacheTable& negative) {
+    try {
+        CacheSnapshot::save(path, positive, negative);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa gravação e carga de entradas positivas e negativas
+ */
+void test_round_trip() {
+    std::cout << "\n[TEST] CacheSnapshot - Ida e volta\n";
+
+    std::string path = snapshotPath();
+    CacheTable positive(10, 2);
+    CacheTable negative(10, 2);
+
+    CacheEntry entry(makeWire(), 0, 300);
+    entry.timestamp -= 100;  // Restam 200s
+    positive.insert(makeKey("example.com"), entry);
+    CacheEntry out;
+    positive.lookup(makeKey("example.com"), out);
+    positive.lookup(makeKey("example.com"), out);
+    negative.insert(makeKey("nx.example"), CacheEntry(std::string(), 3, 60));
+
+    test_assert(CacheSnapshot::save(path, positive, negative) == 2, "2 entradas gravadas");
+    test_assert(readFile(path).compare(0, CacheSnapshot::SIGNATURE.size(),
+                                       CacheSnapshot::SIGNATURE) == 0, "Assinatura no início");
+
+    CacheTable positive2(10, 2);
+    CacheTable negative2(10, 2);
+    test_assert(CacheSnapshot::load(path, positive2, negative2) == 2, "2 entradas carregadas");
+
+    CacheEntry loaded;
+    test_assert(positive2.lookup(makeKey("example.com"), loaded) && loaded.wire == makeWire(),
+                "Wire preservado");
+    test_assert(loaded.timestamp == entry.timestamp && loaded.ttl == 300,
+                "Expiração absoluta preservada");
+    test_assert(loaded.getRemainingTTL() <= 200 && loaded.getRemainingTTL() >= 199,
+                "TTL restante continua a contar");
+    test_assert(loaded.hits == 3, "HITs preservados");
+    test_assert(loaded.ttl_offsets.size() == 1, "Offsets de TTL reindexados");
+    test_assert(negative2.lookup(makeKey("nx.example"), loaded) && loaded.rcode == 3,
+                "Entrada negativa na tabela negativa");
+    test_assert(!positive2.lookup(makeKey("nx.example"), loaded), "Tabelas não se misturam");
+
+    std::remove(path.c_str());
+}
+
+/**
+ * Testa descarte de entradas vencidas durante a parada
+ */
+void test_drops_expired() {
+    std::cout << "\n[TEST] CacheSnapshot - Entradas vencidas\n";
+
+    std::string path = snapshotPath();
+    CacheTable positive(10, 1);
+    CacheTable negative(10, 1);
+    positive.setStaleWindow(100);
+
+    CacheEntry stale(makeWire(), 0, 10);
+    stale.timestamp -= 60;   // Vencida, mas dentro da janela stale
+    CacheEntry gone(makeWire(), 0, 10);
+    gone.timestamp -= 500;   // Vencida além da janela
+    positive.insert(makeKey("stale.com"), stale);
+    positive.insert(makeKey("gone.com"), gone);
+    positive.insert(makeKey("fresh.com"), CacheEntry(makeWire(), 0, 300));
+    test_assert(CacheSnapshot::save(path, positive, negative) == 3, "3 entradas gravadas");
+
+    CacheTable with_window(10, 1);
+    CacheTable negative2(10, 1);
+    with_window.setStaleWindow(100);
+    test_assert(CacheSnapshot::load(path, with_window, negative2) == 2,
+                "Com janela stale: 2 entradas carregadas");
+    CacheEntry out;
+    test_assert(with_window.lookupStale(makeKey("stale.com"), out), "Stale disponível");
+
+    CacheTable no_window(10, 1);
+    test_assert(CacheSnapshot::load(path, no_window, negative2) == 1,
+                "Sem janela stale: só a válida");
+    test_assert(no_window.lookup(makeKey("fresh.com"), out), "Válida carregada");
+
+    std::remove(path.c_str());
+}
+
+/**
+ * Testa que a carga reproduz a ordem LRU
+ */
+void test_preserves_recency() {
+    std::cout << "\n[TEST] CacheSnapshot - Ordem LRU\n";
+
+    std::string path = snapshotPath();
+    CacheTable positive(3, 1);
+    CacheTable negative(3, 1);
+    positive.insert(makeKey("a.com"), CacheEntry(makeWire(), 0, 300));
+    positive.insert(makeKey("b.com"), CacheEntry(makeWire(), 0, 300));
+    positive.insert(makeKey("c.com"), CacheEntry(makeWire(), 0, 300));
+    CacheEntry out;
+    positive.lookup(makeKey("a.com"), out);  // b.com passa a ser a menos recente
+    CacheSnapshot::save(path, positive, negative);
+
+    CacheTable loaded(3, 1);
+    CacheSnapshot::load(path, loaded, negative);
+    loaded.insert(makeKey("d.com"), CacheEntry(makeWire(), 0, 300));
+    test_assert(!loaded.lookup(makeKey("b.com"), out), "Menos recente removida após a carga");
+    test_assert(loaded.lookup(makeKey("a.com"), out), "Mais recente preservada");
+
+    std::remove(path.c_str());
+}
+
+/**
+ * Testa arquivo inexistente e snapshots inválidos
+ */
+void test_invalid_files() {
+    std::cout << "\n[TEST] CacheSnapshot - Arquivos inválidos\n";
+
+    std::string path = snapshotPath();
+    CacheTable positive(10, 1);
+    CacheTable negative(10, 1);
+
+    std::remove(path.c_str());
+    test_assert(CacheSnapshot::load(path, positive, negative) == 0, "Inexistente: 0 entradas");
+
+    writeFile(path, "NOTASNAPSHOT");
+    test_assert(loadThrows(path, positive, negative), "Assinatura inválida lança exceção");
+
+    positive.insert(makeKey("a.com"), CacheEntry(makeWire(), 0, 300));
+    positive.insert(makeKey("b.com"), CacheEntry(makeWire(), 0, 300));
+    CacheSnapshot::save(path, positive, negative);
+    std::string data = readFile(path);
+    writeFile(path, data.substr(0, data.size() - 5));
+
+    CacheTable partial(10, 1);
+    test_assert(loadThrows(path, partial, negative), "Snapshot truncado lança exceção");
+    test_assert(partial.size() == 1, "Entradas antes do corte são mantidas");
+
+    std::remove(path.c_str());
+}
+
+/**
+ * Testa permissões: diretório privado e arquivos que não são carregados
+ */
+void test_permissions() {
+    std::cout << "\n[TEST] CacheSnapshot - Permissões\n";
+
+    std::string dir = "/tmp/test_cache_snapshot_dir_" + std::to_string(getpid());
+    std::string path = dir + "/snapshot";
+    CacheTable positive(10, 1);
+    CacheTable negative(10, 1);
+    positive.insert(makeKey("a.com"), CacheEntry(makeWire(), 0, 300));
+
+    CacheSnapshot::save(path, positive, negative);
+    struct stat st;
+    test_assert(lstat(dir.c_str(), &st) == 0 && (st.st_mode & 0777) == 0700,
+                "Diretório inexistente criado com 0700");
+    test_assert(lstat(path.c_str(), &st) == 0 && (st.st_mode & 0777) == 0600,
+                "Snapshot gravado com 0600");
+
+    CacheTable loaded(10, 1);
+    chmod(path.c_str(), 0664);
+    test_assert(loadThrows(path, loaded, negative) && loaded.size() == 0,
+                "Arquivo gravável pelo grupo recusado");
+    chmod(path.c_str(), 0600);
+
+    std::string link = dir + "/link";
+    symlink(path.c_str(), link.c_str());
+    test_assert(loadThrows(link, loaded, negative), "Link simbólico recusado");
+    unlink(link.c_str());
+
+    // Trocar o dono só é possível como root
+    if (chown(path.c_str(), geteuid() + 1, static_cast<gid_t>(-1)) == 0) {
+        test_assert(loadThrows(path, loaded, negative), "Arquivo de outro dono recusado");
+    }
+
+    chmod(dir.c_str(), 0777);
+    test_assert(saveThrows(path, positive, negative), "Diretório gravável por outros recusado");
+    chmod(dir.c_str(), 01777);
+    test_assert(!saveThrows(path, positive, negative), "Diretório com sticky bit aceito");
+
+    std::remove(path.c_str());
+    rmdir(dir.c_str());
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: CacheSnapshot (Reinício a Quente)\n";
+    std::cout << "==========================================\n";
+
+    test_round_trip();
+    test_drops_expired();
+    test_preserves_recency();
+    test_invalid_files();
+    test_permissions();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
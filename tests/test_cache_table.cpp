@@ -0,0 +1,785 @@
+/*
+ * Arquivo: test_cache_table.cpp
+ * Propósito: Testes unitários para CacheTable, validando shards, hash e política LRU do cache daemon
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para a tabela de cache do daemon, cobrindo:
+ * - Inserção e consulta de entradas
+ * - Remoção da entrada menos recentemente usada quando cheio
+ * - Promoção de recência em consultas (HIT)
+ * - Substituição de entradas existentes
+ * - Remoção de entradas expiradas
+ * - Redução de capacidade
+ * - Normalização da chave (maiúsculas / trailing dot)
+ * - Distribuição entre shards e crescimento da tabela hash
+ * - Expiração incremental via heap (orçamento por passo)
+ * - Reescrita dos TTLs com o tempo restante em HITs (wire format)
+ * - Contabilidade em bytes e orçamento de memória
+ * - Contagem de HITs e janela de prefetch
+ * - Janela stale (serve-stale, RFC 8767)
+ * - Estoque stale removido antes das entradas válidas quando cheio
+ * - Consultas e inserções em lote (um lock por shard, orçamento de bytes)
+ * - Sketch de frequência e admissão TinyLFU
+ * - Visita das entradas (forEach) sem segurar o lock do shard
+ * - HITs atendidos fora da tabela (recordHits) e aviso de remoções
+ */
+
+#include "CacheTable.h"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace dns_cache;
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Helpers ==========
+
+CacheKey makeKey(const std::string& name, uint16_t qtype = DNSType::A) {
+    return CacheKey(name, qtype, DNSClass::IN);
+}
+
+bool hit(CacheTable& table, const CacheKey& key) {
+    CacheEntry entry;
+    return table.lookup(key, entry);
+}
+
+CacheEntry makeEntry(uint8_t rcode, uint32_t ttl = 300) {
+    return CacheEntry(std::string(), rcode, ttl);
+}
+
+// Resposta em wire format: example.com A (TTL 300), CNAME com nome
+// comprimido (TTL 50) e OPT no additional (campo TTL = flags EDNS)
+std::string makeWire() {
+    const uint8_t bytes[] = {
+        0x12, 0x34, 0x81, 0x80, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01,
+        // Question: example.com A IN
+        0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 0x03, 'c', 'o', 'm', 0x00,
+        0x00, 0x01, 0x00, 0x01,
+        // Answer 1: ptr(12) A IN TTL=300 93.184.216.34
+        0xC0, 0x0C, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2C, 0x00, 0x04,
+        93, 184, 216, 34,
+        // Answer 2: www.ptr(12) CNAME IN TTL=50 -> ptr(12)
+        0x03, 'w', 'w', 'w', 0xC0, 0x0C, 0x00, 0x05, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x32, 0x00, 0x02, 0xC0, 0x0C,
+        // Additional: OPT (udp 4096, DO)
+        0x00, 0x00, 0x29, 0x10, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00
+    };
+    return std::string(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+uint32_t ttlAt(const std::string& wire, uint32_t offset) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(wire[offset])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(wire[offset + 1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(wire[offset + 2])) << 8) |
+           static_cast<uint32_t>(static_cast<uint8_t>(wire[offset + 3]));
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa inserção e consulta básica
+ */
+void test_insert_and_lookup() {
+    std::cout << "\n[TEST] CacheTable - Inserção e consulta\n";
+
+    CacheTable table(10);
+    table.insert(makeKey("example.com"), makeEntry(0));
+
+    test_assert(table.size() == 1, "1 entrada após inserção");
+    test_assert(hit(table, makeKey("example.com")), "HIT para example.com");
+    test_assert(!hit(table, makeKey("example.org")), "MISS para example.org");
+    test_assert(!hit(table, makeKey("example.com", DNSType::AAAA)),
+                "MISS para tipo diferente");
+}
+
+/**
+ * Testa remoção da entrada menos recente quando a tabela está cheia
+ */
+void test_evicts_least_recent() {
+    std::cout << "\n[TEST] CacheTable - Remoção LRU quando cheio\n";
+
+    CacheTable table(3, 1);
+    table.insert(makeKey("a.com"), makeEntry(0));
+    table.insert(makeKey("b.com"), makeEntry(0));
+    table.insert(makeKey("c.com"), makeEntry(0));
+    table.insert(makeKey("d.com"), makeEntry(0));
+
+    test_assert(table.size() == 3, "Tamanho limitado a 3");
+    test_assert(!hit(table, makeKey("a.com")), "a.com (mais antiga) removida");
+    test_assert(hit(table, makeKey("d.com")), "d.com presente");
+}
+
+/**
+ * Testa que um HIT promove a entrada e a protege da remoção
+ */
+void test_lookup_updates_recency() {
+    std::cout << "\n[TEST] CacheTable - HIT atualiza recência\n";
+
+    CacheTable table(3, 1);
+    table.insert(makeKey("a.com"), makeEntry(0));
+    table.insert(makeKey("b.com"), makeEntry(0));
+    table.insert(makeKey("c.com"), makeEntry(0));
+
+    // a.com passa a ser a mais recente; b.com vira a menos recente
+    test_assert(hit(table, makeKey("a.com")), "HIT em a.com");
+    table.insert(makeKey("d.com"), makeEntry(0));
+
+    test_assert(hit(table, makeKey("a.com")), "a.com sobreviveu");
+    test_assert(!hit(table, makeKey("b.com")), "b.com removida");
+}
+
+/**
+ * Testa substituição de entrada existente (sem crescer a tabela)
+ */
+void test_replace_existing() {
+    std::cout << "\n[TEST] CacheTable - Substituição de entrada\n";
+
+    CacheTable table(2, 1);
+    table.insert(makeKey("a.com"), makeEntry(0));
+    table.insert(makeKey("b.com"), makeEntry(0));
+    table.insert(makeKey("a.com"), makeEntry(3));
+
+    test_assert(table.size() == 2, "Tamanho inalterado");
+    CacheEntry entry;
+    test_assert(table.lookup(makeKey("a.com"), entry) && entry.rcode == 3,
+                "Valor atualizado");
+    test_assert(hit(table, makeKey("b.com")), "b.com preservada");
+}
+
+/**
+ * Testa remoção de entradas expiradas (consulta e varredura)
+ */
+void test_expired_entries() {
+    std::cout << "\n[TEST] CacheTable - Entradas expiradas\n";
+
+    CacheTable table(10, 1);
+    CacheEntry old_entry = makeEntry(0, 10);
+    old_entry.timestamp -= 60;  // Inserida há 60s com TTL 10s
+
+    table.insert(makeKey("old.com"), old_entry);
+    table.insert(makeKey("old2.com"), old_entry);
+    table.insert(makeKey("new.com"), makeEntry(0));
+
+    test_assert(!hit(table, makeKey("old.com")), "Consulta ignora expirada");
+    test_assert(table.size() == 2, "Expirada removida na consulta");
+    test_assert(table.removeExpired() == 1, "Varredura remove 1 expirada");
+    test_assert(table.size() == 1, "Apenas new.com restante");
+}
+
+/**
+ * Testa redução de capacidade e limpeza
+ */
+void test_capacity_and_clear() {
+    std::cout << "\n[TEST] CacheTable - Capacidade e limpeza\n";
+
+    CacheTable table(5, 1);
+    for (int i = 0; i < 5; i++) {
+        table.insert(makeKey("d" + std::to_string(i) + ".com"), makeEntry(0));
+    }
+
+    table.setMaxEntries(2);
+    test_assert(table.size() == 2, "Reduzido para 2 entradas");
+    test_assert(hit(table, makeKey("d4.com")), "Mais recente preservada");
+    test_assert(!hit(table, makeKey("d0.com")), "Mais antiga removida");
+
+    test_assert(table.clear() == 2, "clear() retorna 2");
+    test_assert(table.size() == 0, "Tabela vazia");
+
+    CacheTable disabled(0);
+    disabled.insert(makeKey("a.com"), makeEntry(0));
+    test_assert(disabled.size() == 0, "Capacidade 0 não armazena");
+}
+
+/**
+ * Testa normalização da chave (DNS não diferencia maiúsculas)
+ */
+void test_key_normalization() {
+    std::cout << "\n[TEST] CacheTable - Normalização da chave\n";
+
+    CacheKey a("WWW.Example.COM", DNSType::A, DNSClass::IN);
+    CacheKey b("www.example.com.", DNSType::A, DNSClass::IN);
+    CacheKey c("www.example.com", DNSType::AAAA, DNSClass::IN);
+
+    test_assert(a == b, "Chaves iguais ignorando caixa e ponto final");
+    test_assert(a.hash == b.hash, "Hash idêntico");
+    test_assert(!(a == c), "Tipo diferente gera chave diferente");
+
+    CacheTable table(10);
+    table.insert(a, makeEntry(0));
+    test_assert(hit(table, makeKey("www.EXAMPLE.com")), "HIT com caixa diferente");
+}
+
+/**
+ * Testa muitas entradas distribuídas entre shards (rehash e tombstones)
+ */
+void test_sharded_growth() {
+    std::cout << "\n[TEST] CacheTable - Shards e crescimento\n";
+
+    CacheTable table(2000, 8);
+    test_assert(table.shardCount() == 8, "8 shards configurados");
+
+    for (int i = 0; i < 1000; i++) {
+        table.insert(makeKey("host" + std::to_string(i) + ".example.com"), makeEntry(0));
+    }
+    test_assert(table.size() == 1000, "1000 entradas armazenadas");
+
+    bool all_found = true;
+    for (int i = 0; i < 1000; i++) {
+        all_found = all_found && hit(table, makeKey("host" + std::to_string(i) + ".example.com"));
+    }
+    test_assert(all_found, "Todas as entradas encontradas");
+
+    // Reinserções após remoções reutilizam nós e slots (tombstones)
+    table.setMaxEntries(100);
+    test_assert(table.size() <= 100, "Capacidade total respeitada após redução");
+    table.setMaxEntries(2000);
+    for (int i = 0; i < 1000; i++) {
+        table.insert(makeKey("again" + std::to_string(i) + ".example.com"), makeEntry(0));
+    }
+    test_assert(hit(table, makeKey("again999.example.com")), "Entrada recente encontrada");
+    test_assert(!hit(table, makeKey("missing.example.com")), "MISS para chave ausente");
+}
+
+/**
+ * Testa drenagem incremental do heap de expiração
+ */
+void test_incremental_expiry() {
+    std::cout << "\n[TEST] CacheTable - Expiração incremental\n";
+
+    CacheTable table(100, 1);
+    CacheEntry old_entry = makeEntry(0, 10);
+    old_entry.timestamp -= 60;
+
+    for (int i = 0; i < 10; i++) {
+        table.insert(makeKey("old" + std::to_string(i) + ".com"), old_entry);
+    }
+    table.insert(makeKey("new.com"), makeEntry(0));
+
+    // Substituir uma expirada por uma válida invalida o item antigo do heap
+    table.insert(makeKey("old0.com"), makeEntry(0));
+
+    test_assert(table.hasDue(), "Há itens vencidos");
+    test_assert(table.expireDue(4) <= 4, "Passo respeita orçamento");
+    test_assert(table.hasDue(), "Restam itens após primeiro passo");
+
+    while (table.hasDue()) {
+        table.expireDue(4);
+    }
+    test_assert(table.size() == 2, "Apenas entradas válidas restantes");
+    test_assert(hit(table, makeKey("old0.com")), "Entrada substituída não expirou");
+    test_assert(hit(table, makeKey("new.com")), "new.com preservada");
+}
+
+/**
+ * Testa reescrita dos TTLs (tempo restante) direto no wire format
+ */
+void test_ttl_rewrite() {
+    std::cout << "\n[TEST] CacheTable - TTL restante em HITs\n";
+
+    CacheEntry entry(makeWire(), 0, 50);
+    test_assert(entry.ttl_offsets.size() == 2, "2 TTLs indexados (OPT ignorado)");
+    test_assert(entry.ttl_offsets.size() == 2 && entry.ttl_offsets[0] == 35 &&
+                entry.ttl_offsets[1] == 55, "Offsets após nomes comprimidos");
+
+    // 20 segundos depois: 300 -> 280, 50 -> 30
+    CacheEntry aged = entry;
+    aged.ageTTLs(entry.timestamp + 20);
+    test_assert(ttlAt(aged.wire, 35) == 280, "TTL 300 - 20s = 280");
+    test_assert(ttlAt(aged.wire, 55) == 30, "TTL 50 - 20s = 30");
+    test_assert(ttlAt(entry.wire, 35) == 300, "Entrada original intacta");
+
+    // TTL menor que o tempo decorrido vai a 0 (sem underflow)
+    aged = entry;
+    aged.ageTTLs(entry.timestamp + 120);
+    test_assert(ttlAt(aged.wire, 35) == 180, "TTL 300 - 120s = 180");
+    test_assert(ttlAt(aged.wire, 55) == 0, "TTL 50 - 120s = 0");
+
+    // Relógio sem avanço (ou para trás) não altera
+    aged = entry;
+    aged.ageTTLs(entry.timestamp - 5);
+    test_assert(aged.wire == entry.wire, "Sem tempo decorrido: wire inalterado");
+
+    // Flags EDNS do OPT (campo TTL) preservadas
+    aged = entry;
+    aged.ageTTLs(entry.timestamp + 1000);
+    test_assert(static_cast<uint8_t>(aged.wire[aged.wire.size() - 4]) == 0x80,
+                "Flags do OPT preservadas");
+
+    // Via tabela: cópia devolvida por lookup pode ser envelhecida
+    CacheTable table(10, 1);
+    table.insert(makeKey("example.com"), entry);
+    CacheEntry out;
+    test_assert(table.lookup(makeKey("example.com"), out) && out.ttl_offsets.size() == 2,
+                "Offsets preservados na tabela");
+
+    // Mensagens malformadas são rejeitadas ao indexar
+    std::string truncated = makeWire().substr(0, 40);
+    bool threw = false;
+    try {
+        CacheEntry bad(truncated, 0, 60);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    test_assert(threw, "Resposta truncada lança exceção");
+}
+
+/**
+ * Testa contabilidade em bytes e remoção por orçamento de memória
+ */
+void test_memory_budget() {
+    std::cout << "\n[TEST] CacheTable - Orçamento de memória\n";
+
+    CacheTable table(1000, 4);
+    CacheEntry small(std::string(), 0, 300);
+    CacheEntry large(std::string(), 0, 300);
+    large.wire.assign(4096, 'x');  // Só o tamanho importa aqui
+
+    size_t small_cost = CacheShard::entryBytes(makeKey("small.com"), small);
+    size_t large_cost = CacheShard::entryBytes(makeKey("large.com"), large);
+    test_assert(large_cost >= small_cost + 4096, "Custo inclui o buffer wire");
+
+    table.insert(makeKey("small.com"), small);
+    table.insert(makeKey("large.com"), large);
+    test_assert(table.bytes() == small_cost + large_cost, "bytes() soma as entradas");
+
+    // Substituição ajusta o total
+    table.insert(makeKey("large.com"), small);
+    test_assert(table.bytes() == small_cost + CacheShard::entryBytes(makeKey("large.com"), small),
+                "Substituição atualiza bytes");
+
+    table.clear();
+    test_assert(table.bytes() == 0, "clear() zera bytes");
+
+    // Orçamento de ~8 entradas grandes: entradas além dele são removidas por bytes
+    table.setMaxBytes(large_cost * 8);
+    for (int i = 0; i < 40; i++) {
+        table.insert(makeKey("big" + std::to_string(i) + ".com"), large);
+    }
+    test_assert(table.bytes() <= table.maxBytes(), "Orçamento respeitado");
+    test_assert(table.size() <= 8 && table.size() > 0, "Entradas limitadas pelos bytes");
+    test_assert(hit(table, makeKey("big39.com")), "Mais recente preservada");
+
+    // Reduzir o orçamento remove entradas imediatamente
+    table.setMaxBytes(large_cost * 2);
+    test_assert(table.bytes() <= large_cost * 2, "Redução do orçamento aplicada");
+
+    // Expiração devolve os bytes
+    CacheTable expiring(10, 1);
+    CacheEntry old_entry = large;
+    old_entry.timestamp -= 1000;
+    expiring.insert(makeKey("old.com"), old_entry);
+    expiring.removeExpired();
+    test_assert(expiring.size() == 0 && expiring.bytes() == 0, "Expiração libera bytes");
+}
+
+/**
+ * Testa contagem de HITs e decisão de prefetch
+ */
+void test_prefetch_window() {
+    std::cout << "\n[TEST] CacheTable - HITs e janela de prefetch\n";
+
+    CacheTable table(10, 1);
+    table.insert(makeKey("hot.com"), makeEntry(0, 100));
+
+    CacheEntry out;
+    for (int i = 0; i < 5; i++) {
+        table.lookup(makeKey("hot.com"), out);
+    }
+    test_assert(out.hits == 5, "5 HITs contados");
+
+    table.insert(makeKey("hot.com"), makeEntry(0, 100));
+    table.lookup(makeKey("hot.com"), out);
+    test_assert(out.hits == 6, "Substituição preserva a contagem");
+
+    // TTL 100s, janela de 10%: renovar a partir de 90s decorridos
+    time_t t0 = out.timestamp;
+    test_assert(!out.needsPrefetch(t0 + 50, 5, 10), "Metade do TTL: sem prefetch");
+    test_assert(!out.needsPrefetch(t0 + 89, 5, 10), "11% restante: sem prefetch");
+    test_assert(out.needsPrefetch(t0 + 90, 5, 10), "10% restante: prefetch");
+    test_assert(out.needsPrefetch(t0 + 100, 5, 10), "Último segundo: prefetch");
+    test_assert(!out.needsPrefetch(t0 + 101, 5, 10), "Expirada: sem prefetch");
+    test_assert(!out.needsPrefetch(t0 + 95, 7, 10), "Poucos HITs: sem prefetch");
+    test_assert(!out.needsPrefetch(t0 + 95, 5, 0), "Janela 0 desativa");
+}
+
+/**
+ * Testa retenção de entradas expiradas na janela stale
+ */
+void test_stale_window() {
+    std::cout << "\n[TEST] CacheTable - Janela stale\n";
+
+    CacheTable table(10, 1);
+    table.setStaleWindow(100);
+
+    CacheEntry stale = makeEntry(0, 10);
+    stale.timestamp -= 60;   // Expirada há 50s: dentro da janela
+    CacheEntry gone = makeEntry(0, 10);
+    gone.timestamp -= 200;   // Expirada há 190s: fora da janela
+    table.insert(makeKey("stale.com"), stale);
+    table.insert(makeKey("gone.com"), gone);
+
+    CacheEntry out;
+    test_assert(!table.lookup(makeKey("stale.com"), out), "Consulta normal: MISS");
+    test_assert(table.size() == 2, "Expirada na janela não é removida");
+    test_assert(table.lookupStale(makeKey("stale.com"), out) && out.hits == 0,
+                "lookupStale devolve entrada sem contar HIT");
+    test_assert(!table.lookupStale(makeKey("gone.com"), out), "Fora da janela: MISS");
+    test_assert(table.size() == 1, "Fora da janela é removida");
+
+    test_assert(table.removeExpired() == 0, "Varredura preserva a janela stale");
+    table.setStaleWindow(30);
+    test_assert(table.removeExpired() == 1, "Janela menor reagenda a expiração");
+
+    CacheEntry entry(makeWire(), 0, 10);
+    entry.rewriteTTLs(30);
+    test_assert(ttlAt(entry.wire, 35) == 30 && ttlAt(entry.wire, 55) == 30,
+                "TTLs stale reescritos para 30s");
+}
+
+/**
+ * Testa consultas e inserções em lote (MQUERY / MSTORE)
+ */
+void test_batch_operations() {
+    std::cout << "\n[TEST] CacheTable - Operações em lote\n";
+
+    CacheTable table(100, 4);
+    std::vector<std::pair<CacheKey, CacheEntry>> entries;
+    for (int i = 0; i < 20; i++) {
+        entries.emplace_back(makeKey("d" + std::to_string(i) + ".com"),
+                             makeEntry(static_cast<uint8_t>(i % 4)));
+    }
+    table.insertMany(entries);
+    test_assert(table.size() == 20, "insertMany: 20 entradas em 4 shards");
+
+    std::vector<CacheKey> keys = {
+        makeKey("d3.com"), makeKey("absent.com"), makeKey("D17.COM."), makeKey("d3.com")
+    };
+    std::vector<CacheEntry> out;
+    std::vector<bool> found;
+    table.lookupMany(keys, out, found);
+    test_assert(found.size() == 4 && out.size() == 4, "Um resultado por chave");
+    test_assert(found[0] && out[0].rcode == 3, "HIT na ordem das chaves");
+    test_assert(!found[1], "MISS para chave ausente");
+    test_assert(found[2] && out[2].rcode == 1, "Chave normalizada no lote");
+    test_assert(found[3] && out[3].hits == 2, "Chave repetida conta dois HITs");
+
+    // Capacidade respeitada no lote (LRU por shard)
+    CacheTable small(5, 1);
+    small.insertMany(entries);
+    test_assert(small.size() == 5, "insertMany respeita a capacidade");
+    test_assert(hit(small, makeKey("d19.com")) && !hit(small, makeKey("d0.com")),
+                "Inserção em ordem: mais antigas removidas");
+
+    table.lookupMany({}, out, found);
+    test_assert(out.empty() && found.empty(), "Lote vazio");
+
+    // Orçamento de bytes: o que não cabe fica MISS sem contar HIT
+    CacheTable sized(10, 1);
+    sized.insert(makeKey("a.com"), CacheEntry(makeWire(), 0, 300));
+    sized.insert(makeKey("b.com"), CacheEntry(makeWire(), 0, 300));
+    size_t wire_size = makeWire().size();
+    sized.lookupMany({makeKey("a.com"), makeKey("b.com")}, out, found, wire_size + 1);
+    test_assert(found[0] && !found[1], "Entrada além do orçamento não é devolvida");
+    CacheEntry b_entry;
+    test_assert(sized.lookup(makeKey("b.com"), b_entry) && b_entry.hits == 1,
+                "Entrada recusada pelo orçamento não conta HIT");
+}
+
+/**
+ * Testa o sketch de frequência (count-min + doorkeeper)
+ */
+void test_frequency_sketch() {
+    std::cout << "\n[TEST] CacheTable - Sketch de frequência\n";
+
+    FrequencySketch sketch(64);
+    uint64_t hot = makeKey("hot.com").hash;
+    uint64_t once = makeKey("once.com").hash;
+
+    test_assert(sketch.estimate(hot) == 0, "Chave nunca vista: 0");
+    sketch.increment(once);
+    test_assert(sketch.estimate(once) == 1, "Primeira ocorrência só no doorkeeper");
+    for (int i = 0; i < 8; i++) {
+        sketch.increment(hot);
+    }
+    test_assert(sketch.estimate(hot) >= 8, "Frequência acumulada");
+    for (int i = 0; i < 40; i++) {
+        sketch.increment(hot);
+    }
+    test_assert(sketch.estimate(hot) == 16, "Contadores saturam em 15 (+ doorkeeper)");
+
+    // Envelhecimento após SAMPLE_FACTOR × largura incrementos
+    FrequencySketch aging(16);
+    for (int i = 0; i < 10; i++) {
+        aging.increment(hot);
+    }
+    uint32_t before = aging.estimate(hot);
+    for (size_t i = 0; i < FrequencySketch::SAMPLE_FACTOR * 16; i++) {
+        aging.increment(makeKey("k" + std::to_string(i) + ".com").hash);
+    }
+    test_assert(aging.estimate(hot) < before, "Contagens divididas ao envelhecer");
+}
+
+/**
+ * Testa a admissão TinyLFU com a tabela cheia
+ */
+void test_stale_evicted_first() {
+    std::cout << "\n[TEST] CacheTable - Estoque stale sai antes das válidas\n";
+
+    CacheEntry stale = makeEntry(0, 10);
+    stale.timestamp -= 60;   // Expirada há 50s: dentro da janela
+
+    // stale.com é mais recente que a.com, mas já expirou
+    CacheTable table(3, 1);
+    table.setStaleWindow(100);
+    table.insert(makeKey("a.com"), makeEntry(0));
+    table.insert(makeKey("stale.com"), stale);
+    table.insert(makeKey("b.com"), makeEntry(0));
+    table.insert(makeKey("c.com"), makeEntry(0));
+
+    CacheEntry out;
+    test_assert(table.size() == 3, "Tamanho limitado a 3");
+    test_assert(!table.lookupStale(makeKey("stale.com"), out), "Stale removida primeiro");
+    test_assert(hit(table, makeKey("a.com")), "Válida menos recente preservada");
+
+    // Sem stale restante, volta a valer a LRU
+    table.insert(makeKey("d.com"), makeEntry(0));
+    test_assert(!hit(table, makeKey("b.com")), "Sem stale: LRU removida");
+
+    // Admissão: chave nova entra contra vítima stale sem comparar frequência
+    CacheTable admitted(2, 1);
+    admitted.setStaleWindow(100);
+    admitted.setAdmission(true);
+    admitted.insert(makeKey("hot.com"), makeEntry(0));
+    for (int i = 0; i < 5; i++) {
+        hit(admitted, makeKey("hot.com"));
+    }
+    admitted.insert(makeKey("stale.com"), stale);
+    test_assert(admitted.insert(makeKey("new.com"), makeEntry(0)),
+                "Chave nova admitida contra vítima stale");
+    test_assert(admitted.admissionCandidates() == 0, "Sem comparação de frequência");
+    test_assert(hit(admitted, makeKey("hot.com")) && hit(admitted, makeKey("new.com")),
+                "Válidas preservadas");
+    test_assert(!admitted.lookupStale(makeKey("stale.com"), out), "Stale removida");
+}
+
+void test_admission() {
+    std::cout << "\n[TEST] CacheTable - Admissão TinyLFU\n";
+
+    CacheTable table(4, 1);
+    table.setAdmission(true);
+    for (const char* name : {"a.com", "b.com", "c.com", "d.com"}) {
+        table.insert(makeKey(name), makeEntry(0));
+        for (int i = 0; i < 3; i++) {
+            hit(table, makeKey(name));
+        }
+    }
+    test_assert(table.size() == 4 && table.admissionCandidates() == 0,
+                "Com espaço livre tudo é admitido");
+
+    // Varredura: cada chave consultada uma vez (MISS) e armazenada
+    size_t scan_admitted = 0;
+    for (int i = 0; i < 20; i++) {
+        CacheKey key = makeKey("scan" + std::to_string(i) + ".com");
+        hit(table, key);
+        scan_admitted += table.insert(key, makeEntry(0)) ? 1 : 0;
+    }
+    test_assert(scan_admitted == 0, "insert() informa a recusa");
+    test_assert(hit(table, makeKey("a.com")) && hit(table, makeKey("d.com")),
+                "Varredura não expulsa entradas populares");
+    test_assert(table.admissionRejects() == 20 && table.admissionCandidates() == 20,
+                "20 chaves de varredura recusadas");
+
+    // Chave mais frequente que a vítima é admitida
+    CacheKey popular = makeKey("popular.com");
+    for (int i = 0; i < 10; i++) {
+        hit(table, popular);
+    }
+    test_assert(table.insert(popular, makeEntry(0)), "insert() informa a admissão");
+    test_assert(hit(table, popular) && table.size() == 4, "Chave frequente admitida");
+
+    // Lote: uma chave nova sem histórico (recusada) e uma substituição (admitida)
+    std::vector<bool> admitted = table.insertMany({
+        {makeKey("cold.com"), makeEntry(0)}, {makeKey("popular.com"), makeEntry(2)}
+    });
+    test_assert(admitted.size() == 2 && !admitted[0] && admitted[1],
+                "insertMany() informa a admissão de cada entrada");
+
+    // Substituição de chave presente sempre entra
+    table.insert(makeKey("a.com"), makeEntry(3));
+    CacheEntry out;
+    test_assert(table.lookup(makeKey("a.com"), out) && out.rcode == 3, "Substituição admitida");
+
+    // Vários shards: sai a vítima comparada (LRU do shard da chave nova),
+    // não a de outro shard (mesma regra de CacheTable::shardIndex)
+    CacheTable sharded(8, 4);
+    sharded.setAdmission(true);
+    auto shardOf = [&sharded](const CacheKey& key) { return (key.hash >> 40) % sharded.shardCount(); };
+    // Shard 1 com uma só entrada (abaixo da fração justa); o enforceCapacity
+    // começaria pelo shard 0
+    const size_t per_shard[] = {3, 1, 2, 2};
+    size_t placed[4] = {0, 0, 0, 0};
+    std::vector<CacheKey> resident;
+    CacheKey victim = makeKey("none");
+    for (int i = 0; resident.size() < 8; i++) {
+        CacheKey key = makeKey("r" + std::to_string(i) + ".com");
+        size_t index = shardOf(key);
+        if (placed[index] == per_shard[index]) {
+            continue;
+        }
+        placed[index]++;
+        if (index == 1) {
+            victim = key;
+        }
+        resident.push_back(key);
+        sharded.insert(key, makeEntry(0));
+        for (int j = 0; j < 3; j++) {
+            hit(sharded, key);
+        }
+    }
+    CacheKey newcomer = makeKey("newcomer0.com");
+    for (int i = 1; shardOf(newcomer) != 1; i++) {
+        newcomer = makeKey("newcomer" + std::to_string(i) + ".com");
+    }
+    for (int i = 0; i < 10; i++) {
+        hit(sharded, newcomer);
+    }
+    sharded.insert(newcomer, makeEntry(0));
+    bool others_kept = true;
+    for (const auto& key : resident) {
+        if (key.qname != victim.qname) {
+            others_kept = others_kept && hit(sharded, key);
+        }
+    }
+    test_assert(!hit(sharded, victim) && others_kept && sharded.size() == 8,
+                "Admissão remove a vítima comparada, não a de outro shard");
+
+    // Sem admissão (padrão): LRU pura
+    CacheTable plain(2, 1);
+    plain.insert(makeKey("a.com"), makeEntry(0));
+    plain.insert(makeKey("b.com"), makeEntry(0));
+    plain.insert(makeKey("c.com"), makeEntry(0));
+    test_assert(!plain.admissionEnabled() && !hit(plain, makeKey("a.com")),
+                "Admissão desativada por padrão");
+}
+
+/**
+ * Testa forEach: ordem LRU por shard e callback fora do lock
+ */
+void test_for_each_copies() {
+    std::cout << "\n[TEST] CacheTable - forEach fora do lock\n";
+
+    CacheTable table(10, 1);
+    table.insert(makeKey("a.com"), makeEntry(0));
+    table.insert(makeKey("b.com"), makeEntry(0));
+
+    // O callback consulta a própria tabela (mesmo shard): com o lock
+    // segurado durante a visita isto travaria
+    std::vector<std::string> visited;
+    size_t found = 0;
+    table.forEach([&](const CacheKey& key, const CacheEntry&) {
+        visited.push_back(key.qname);
+        CacheEntry out;
+        found += table.lookup(key, out) ? 1 : 0;
+    });
+    test_assert(visited.size() == 2 && visited[0] == "a.com" && visited[1] == "b.com",
+                "Entradas visitadas da menos para a mais recente");
+    test_assert(found == 2, "Callback pode usar a tabela durante a visita");
+}
+
+/**
+ * Testa HITs externos (memória compartilhada) e o aviso de remoções
+ */
+void test_external_hits_and_evictions() {
+    std::cout << "\n[TEST] CacheTable - HITs externos e remoções\n";
+
+    CacheTable table(2, 1);
+    std::vector<std::string> erased;
+    table.setEvictionListener([&erased](const CacheKey& key) { erased.push_back(key.qname); });
+
+    table.insert(makeKey("a.com"), makeEntry(0));
+    table.insert(makeKey("b.com"), makeEntry(0));
+    CacheEntry out;
+    test_assert(table.recordHits(makeKey("a.com"), 7, out) && out.hits == 7,
+                "recordHits soma os HITs da entrada");
+    test_assert(!table.recordHits(makeKey("absent.com"), 3, out), "Chave ausente: false");
+
+    // a.com promovida por recordHits: b.com é a menos recente
+    table.insert(makeKey("c.com"), makeEntry(0));
+    test_assert(erased.size() == 1 && erased[0] == "b.com", "Remoção por LRU avisada com a chave");
+
+    CacheEntry old = makeEntry(0, 10);
+    old.timestamp -= 100;
+    table.insert(makeKey("old.com"), old);   // Sai a.com (LRU)
+    table.removeExpired();
+    test_assert(erased.size() == 3 && erased.back() == "old.com", "Remoção por expiração avisada");
+
+    table.clear();
+    test_assert(erased.size() == 3, "clear() não avisa (espelho limpo à parte)");
+
+    // HITs externos contam para a admissão
+    CacheTable admitting(2, 1);
+    admitting.setAdmission(true);
+    admitting.insert(makeKey("x.com"), makeEntry(0));
+    admitting.insert(makeKey("y.com"), makeEntry(0));
+    admitting.recordHits(makeKey("z.com"), 5, out);
+    test_assert(admitting.insert(makeKey("z.com"), makeEntry(0)), "HITs externos contam na frequência");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: CacheTable (Cache Daemon)\n";
+    std::cout << "==========================================\n";
+
+    test_insert_and_lookup();
+    test_evicts_least_recent();
+    test_lookup_updates_recency();
+    test_replace_existing();
+    test_expired_entries();
+    test_capacity_and_clear();
+    test_key_normalization();
+    test_sharded_growth();
+    test_incremental_expiry();
+    test_ttl_rewrite();
+    test_memory_budget();
+    test_prefetch_window();
+    test_stale_window();
+    test_stale_evicted_first();
+    test_batch_operations();
+    test_frequency_sketch();
+    test_admission();
+    test_for_each_copies();
+    test_external_hits_and_evictions();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
@@ -0,0 +1,206 @@
+/*
+ * Arquivo: test_delegation_cache.cpp
+ * Propósito: Testes unitários para o cache de delegações (zone cuts, NS e glue)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para DelegationCache, cobrindo:
+ * - Zone cut mais profundo para um nome (e normalização)
+ * - Expiração pelo TTL do conjunto NS (com teto MAX_TTL)
+ * - Endereços de glue e de nameservers resolvidos
+ * - Invalidação, root ignorado e limite de zonas
+ * - Bailiwick: referência para a zona pai e glue fora da zona delegada
+ */
+
+#include "dns_resolver/DelegationCache.h"
+#include <iostream>
+#include <string>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa a busca do zone cut mais profundo
+ */
+void test_deepest_zone_cut() {
+    std::cout << "\n[TEST] DelegationCache - Zone cut mais profundo\n";
+
+    DelegationCache cache;
+    time_t now = 1000;
+    cache.store(".", "com", {"a.gtld-servers.net"}, {{"a.gtld-servers.net", "192.5.6.30"}}, 172800, now);
+    cache.store("com", "Example.COM.", {"ns1.example.com", "ns2.example.com"},
+                {{"ns1.example.com", "199.43.135.53"}}, 3600, now);
+
+    Delegation out;
+    test_assert(cache.findDeepest("www.example.com", out, now) && out.zone == "example.com",
+                "www.example.com → example.com");
+    test_assert(out.nameservers.size() == 2 && out.addresses.size() == 1 &&
+                out.addresses["ns1.example.com"] == "199.43.135.53",
+                "NS e glue preservados");
+    test_assert(cache.findDeepest("EXAMPLE.com.", out, now) && out.zone == "example.com",
+                "O próprio zone cut (normalizado)");
+    test_assert(cache.findDeepest("google.com", out, now) && out.zone == "com",
+                "google.com → com");
+    test_assert(!cache.findDeepest("example.org", out, now), "Sem ancestral em cache: MISS");
+    test_assert(!cache.findDeepest("notexample.com.br", out, now), "Sufixo sem fronteira de label");
+}
+
+/**
+ * Testa expiração pelo TTL
+ */
+void test_expiry() {
+    std::cout << "\n[TEST] DelegationCache - Expiração\n";
+
+    DelegationCache cache;
+    time_t now = 1000;
+    cache.store(".", "com", {"a.gtld-servers.net"}, {{"a.gtld-servers.net", "192.5.6.30"}}, 10000000, now);
+    cache.store("com", "example.com", {"ns.example.com"}, {{"ns.example.com", "10.0.0.1"}}, 60, now);
+
+    Delegation out;
+    test_assert(cache.findDeepest("www.example.com", out, now + 59) && out.zone == "example.com",
+                "Válida dentro do TTL");
+    test_assert(cache.findDeepest("www.example.com", out, now + 60) && out.zone == "com",
+                "Expirada: cai para o ancestral");
+    test_assert(!cache.findDeepest("www.example.com", out,
+                                   now + static_cast<time_t>(DelegationCache::MAX_TTL)),
+                "TTL limitado a MAX_TTL");
+
+    cache.store("com", "zero.com", {"ns.zero.com"}, {}, 0, now);
+    test_assert(cache.size() == 2, "TTL 0 não é cacheado");
+}
+
+/**
+ * Testa endereços de nameservers
+ */
+void test_addresses() {
+    std::cout << "\n[TEST] DelegationCache - Endereços de nameservers\n";
+
+    DelegationCache cache;
+    time_t now = 1000;
+    cache.store("com", "example.com", {"ns1.dns-host.net", "ns2.dns-host.net"}, {}, 3600, now);
+
+    Delegation out;
+    cache.findDeepest("example.com", out, now);
+    test_assert(out.addresses.empty(), "Sem glue: nenhum endereço");
+
+    cache.storeAddress("NS2.dns-host.net.", "203.0.113.2", 300, now);
+    cache.findDeepest("example.com", out, now);
+    test_assert(out.addresses.size() == 1 && out.addresses["ns2.dns-host.net"] == "203.0.113.2",
+                "Endereço resolvido completa a delegação");
+    test_assert(cache.findAddress("ns2.dns-host.net", now) == "203.0.113.2", "findAddress");
+    test_assert(cache.findAddress("ns2.dns-host.net", now + 300).empty(), "Endereço expira");
+
+    cache.store("org", "other.org", {"ns.other.org"}, {{"ns.other.org", "198.51.100.1"}}, 3600, now);
+    test_assert(cache.findAddress("ns.other.org", now) == "198.51.100.1",
+                "Glue disponível para outras zonas");
+}
+
+/**
+ * Testa invalidação, root e limite de zonas
+ */
+void test_invalidate_and_limits() {
+    std::cout << "\n[TEST] DelegationCache - Invalidação e limites\n";
+
+    DelegationCache cache(2);
+    time_t now = 1000;
+    cache.store(".", ".", {"a.root-servers.net"}, {{"a.root-servers.net", "198.41.0.4"}}, 3600, now);
+    test_assert(cache.size() == 0, "Root não é cacheado");
+
+    cache.store("com", "a.com", {"ns.a.com"}, {{"ns.a.com", "10.0.0.1"}}, 100, now);
+    cache.store("com", "b.com", {"ns.b.com"}, {{"ns.b.com", "10.0.0.2"}}, 200, now);
+    cache.store("com", "c.com", {"ns.c.com"}, {{"ns.c.com", "10.0.0.3"}}, 300, now);
+
+    Delegation out;
+    test_assert(cache.size() == 2, "Limite de zonas respeitado");
+    test_assert(!cache.findDeepest("a.com", out, now), "Descarta a que vence antes");
+    test_assert(cache.findDeepest("c.com", out, now), "Mais nova preservada");
+
+    cache.invalidate("C.COM");
+    test_assert(!cache.findDeepest("c.com", out, now), "invalidate remove a delegação");
+
+    cache.clear();
+    test_assert(cache.size() == 0 && cache.findAddress("ns.b.com", now).empty(), "clear");
+}
+
+/**
+ * Testa a proteção contra envenenamento (bailiwick)
+ */
+void test_bailiwick() {
+    std::cout << "\n[TEST] DelegationCache - Bailiwick\n";
+
+    DelegationCache cache;
+    time_t now = 1000;
+    Delegation out;
+
+    // Servidor de example.com devolvendo referência para a zona pai
+    cache.store("example.com", "com", {"ns.evil.com"}, {{"ns.evil.com", "6.6.6.6"}}, 3600, now);
+    test_assert(cache.size() == 0 && !cache.findDeepest("google.com", out, now),
+                "Referência para a zona pai é ignorada");
+    cache.store("example.com", "example.com", {"ns.example.com"}, {{"ns.example.com", "6.6.6.6"}}, 3600, now);
+    test_assert(cache.size() == 0, "Referência para a própria zona é ignorada");
+    cache.store("org", "example.com", {"ns.example.com"}, {{"ns.example.com", "6.6.6.6"}}, 3600, now);
+    test_assert(cache.size() == 0, "Referência para zona fora da do servidor é ignorada");
+    cache.store("com", "example.com", {"ns.example.com"}, {{"ns.example.com", "10.0.0.1"}}, 3600, now);
+    test_assert(cache.findDeepest("www.example.com", out, now) && out.zone == "example.com",
+                "Referência para zona filha é aceita");
+
+    // Glue de NS fora da zona delegada
+    cache.store("com", "shop.com", {"ns.shop.com", "ns.attacker.net"},
+                {{"ns.shop.com", "10.0.0.2"}, {"ns.attacker.net", "6.6.6.6"}}, 3600, now);
+    cache.findDeepest("shop.com", out, now);
+    test_assert(out.nameservers.size() == 2 && out.addresses.size() == 1 &&
+                out.addresses["ns.shop.com"] == "10.0.0.2",
+                "Só o glue dentro da zona delegada é aceito");
+    test_assert(cache.findAddress("ns.attacker.net", now).empty(), "Glue fora da zona não é guardado");
+
+    cache.storeAddress("ns.victim.net", "203.0.113.5", 3600, now);
+    cache.store("com", "evil.com", {"ns.victim.net"}, {{"ns.victim.net", "6.6.6.6"}}, 3600, now);
+    cache.findDeepest("evil.com", out, now);
+    test_assert(cache.findAddress("ns.victim.net", now) == "203.0.113.5" &&
+                out.addresses["ns.victim.net"] == "203.0.113.5",
+                "Glue fora da zona não substitui endereço conhecido");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: DelegationCache (Cache de Infraestrutura)\n";
+    std::cout << "==========================================\n";
+
+    test_deepest_zone_cut();
+    test_expiry();
+    test_addresses();
+    test_invalidate_and_limits();
+    test_bailiwick();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
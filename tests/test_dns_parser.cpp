@@ -343,6 +343,150 @@ void test_network_byte_order() {
     std::cout << "\n";
 }
 
+// ========== Testes de Respostas Completas ==========
+// Estes testes verificam a serialização das seções de RRs (answers,
+// authority, additional), usada para guardar respostas no cache em wire format.
+
+/**
+ * Testa ida e volta de uma resposta com vários tipos de registro
+ * Verifica se serialize + parse preservam A, AAAA, CNAME, MX, TXT, RRSIG
+ * e SOA (authority), com nomes codificados sem compressão.
+ */
+void test_serialize_response_round_trip() {
+    std::cout << "  [TEST] serialize/parse - resposta completa... ";
+    
+    DNSMessage msg;
+    msg.header.id = 0x4242;
+    msg.header.qr = true;
+    msg.header.rd = true;
+    msg.header.ra = true;
+    msg.header.qdcount = 1;
+    msg.questions.emplace_back("www.example.com", DNSType::A, DNSClass::IN);
+    
+    DNSResourceRecord cname;
+    cname.name = "www.example.com";
+    cname.type = DNSType::CNAME;
+    cname.rr_class = DNSClass::IN;
+    cname.ttl = 3600;
+    cname.rdata_cname = "web.example.com";
+    msg.answers.push_back(cname);
+    
+    DNSResourceRecord a;
+    a.name = "web.example.com";
+    a.type = DNSType::A;
+    a.rr_class = DNSClass::IN;
+    a.ttl = 300;
+    a.rdata_a = "93.184.216.34";
+    msg.answers.push_back(a);
+    
+    DNSResourceRecord aaaa;
+    aaaa.name = "web.example.com";
+    aaaa.type = DNSType::AAAA;
+    aaaa.rr_class = DNSClass::IN;
+    aaaa.ttl = 300;
+    aaaa.rdata_aaaa = "2606:2800:220:1:248:1893:25c8:1946";
+    msg.answers.push_back(aaaa);
+    
+    DNSResourceRecord mx;
+    mx.name = "example.com";
+    mx.type = DNSType::MX;
+    mx.rr_class = DNSClass::IN;
+    mx.ttl = 600;
+    mx.rdata_mx = "10 mail.example.com";
+    msg.answers.push_back(mx);
+    
+    DNSResourceRecord txt;
+    txt.name = "example.com";
+    txt.type = DNSType::TXT;
+    txt.rr_class = DNSClass::IN;
+    txt.ttl = 600;
+    txt.rdata_txt = "v=spf1 -all";
+    msg.answers.push_back(txt);
+    
+    DNSResourceRecord rrsig;
+    rrsig.name = "web.example.com";
+    rrsig.type = DNSType::RRSIG;
+    rrsig.rr_class = DNSClass::IN;
+    rrsig.ttl = 300;
+    rrsig.rdata_rrsig.type_covered = DNSType::A;
+    rrsig.rdata_rrsig.algorithm = 13;
+    rrsig.rdata_rrsig.labels = 3;
+    rrsig.rdata_rrsig.original_ttl = 300;
+    rrsig.rdata_rrsig.signature_expiration = 1900000000;
+    rrsig.rdata_rrsig.signature_inception = 1800000000;
+    rrsig.rdata_rrsig.key_tag = 12345;
+    rrsig.rdata_rrsig.signer_name = "example.com";
+    rrsig.rdata_rrsig.signature = {0xDE, 0xAD, 0xBE, 0xEF};
+    msg.answers.push_back(rrsig);
+    
+    DNSResourceRecord soa;
+    soa.name = "example.com";
+    soa.type = DNSType::SOA;
+    soa.rr_class = DNSClass::IN;
+    soa.ttl = 900;
+    soa.rdata_soa.mname = "ns1.example.com";
+    soa.rdata_soa.rname = "hostmaster.example.com";
+    soa.rdata_soa.serial = 2025101401;
+    soa.rdata_soa.refresh = 7200;
+    soa.rdata_soa.retry = 3600;
+    soa.rdata_soa.expire = 1209600;
+    soa.rdata_soa.minimum = 300;
+    msg.authority.push_back(soa);
+    
+    DNSMessage parsed = DNSParser::parse(DNSParser::serialize(msg));
+    
+    assert(parsed.header.id == 0x4242 && parsed.header.qr && parsed.header.ra);
+    assert(parsed.header.ancount == 6 && parsed.header.nscount == 1);
+    assert(parsed.answers.size() == 6 && parsed.authority.size() == 1);
+    assert(parsed.answers[0].rdata_cname == "web.example.com");
+    assert(parsed.answers[0].ttl == 3600);
+    assert(parsed.answers[1].rdata_a == "93.184.216.34");
+    assert(parsed.answers[2].rdata_aaaa == "2606:2800:220:1:248:1893:25c8:1946");
+    assert(parsed.answers[3].rdata_mx == "10 mail.example.com");
+    assert(parsed.answers[4].rdata_txt == "v=spf1 -all");
+    assert(parsed.answers[5].rdata_rrsig.signer_name == "example.com");
+    assert(parsed.answers[5].rdata_rrsig.key_tag == 12345);
+    assert(parsed.answers[5].rdata_rrsig.signature.size() == 4);
+    assert(parsed.authority[0].rdata_soa.rname == "hostmaster.example.com");
+    assert(parsed.authority[0].rdata_soa.minimum == 300);
+    
+    std::cout << "\n";
+}
+
+/**
+ * Testa reserialização de uma resposta com compressão de nomes
+ * O RDATA bruto de um CNAME comprimido aponta para a mensagem original;
+ * a reserialização deve expandir o nome para que o parse continue válido.
+ */
+void test_serialize_expands_compressed_names() {
+    std::cout << "  [TEST] serialize - expande nomes comprimidos... ";
+    
+    // Resposta: www.example.com CNAME -> ponteiro para "example.com" (offset 16)
+    std::vector<uint8_t> wire = {
+        0x00, 0x01, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+        0x03, 'w', 'w', 'w', 0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e',
+        0x03, 'c', 'o', 'm', 0x00, 0x00, 0x05, 0x00, 0x01,
+        0xC0, 0x0C, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x0E, 0x10, 0x00, 0x02,
+        0xC0, 0x10
+    };
+    
+    DNSMessage first = DNSParser::parse(wire);
+    assert(first.answers.size() == 1);
+    assert(first.answers[0].rdata_cname == "example.com");
+    
+    // Remover a question muda os offsets: só nomes expandidos sobrevivem
+    first.questions.clear();
+    first.header.qdcount = 0;
+    DNSMessage second = DNSParser::parse(DNSParser::serialize(first));
+    
+    assert(second.answers.size() == 1);
+    assert(second.answers[0].name == "www.example.com");
+    assert(second.answers[0].rdata_cname == "example.com");
+    assert(second.answers[0].ttl == 3600);
+    
+    std::cout << "\n";
+}
+
 // ========== Função Principal de Testes ==========
 
 /**
@@ -372,6 +516,10 @@ int main() {
     std::cout << "\n→ Testes de Endianness (Big-Endian):\n";
     test_network_byte_order();
     
+    std::cout << "\n→ Testes de Respostas Completas:\n";
+    test_serialize_response_round_trip();
+    test_serialize_expands_compressed_names();
+    
     std::cout << "\n========================================\n";
     std::cout << "   Todos os testes passaram!\n";
     std::cout << "========================================\n\n";
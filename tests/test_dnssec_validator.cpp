@@ -12,6 +12,10 @@
  * - Cálculo de digests SHA-1 e SHA-256 para verificação de integridade
  * - Validação de cadeia de confiança completa
  * - Validação contra trust anchors (âncoras de confiança)
+ * - Cache de elos validados (ValidatedKeyCache) na validação de cadeia,
+ *   com o RRset DNSKEY assinado por uma chave que confere com o DS
+ * - Verificação das assinaturas RRSIG dos RRsets da resposta (ECDSA P-256),
+ *   incluindo forma canônica, curingas e verificação em paralelo
  * 
  * Os testes verificam conformidade com RFC 4034 (DNSSEC) e garantem que
  * o validador consegue executar corretamente algoritmos criptográficos
@@ -20,9 +24,15 @@
 
 #include "dns_resolver/DNSSECValidator.h"
 #include "dns_resolver/TrustAnchorStore.h"
+#include "dns_resolver/ThreadPool.h"
+#include <openssl/core_names.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
 #include <iostream>
 #include <cassert>
 #include <iomanip>
+#include <algorithm>
+#include <sstream>
 
 using namespace dns_resolver;
 
@@ -311,7 +321,7 @@ void test_validate_chain_empty() {
         std::map<std::string, std::vector<DSRecord>> ds_records;
         
         // Sem dados - deve retornar Insecure ou Indeterminate
-        ValidationResult result = validator.validateChain("example.com", dnskeys, ds_records);
+        ValidationResult result = validator.validateChain("example.com", dnskeys, ds_records, {});
         
         assert(result == ValidationResult::Insecure || 
                result == ValidationResult::Indeterminate);
@@ -341,7 +351,7 @@ void test_validate_chain_no_trust_anchor() {
         std::map<std::string, std::vector<DSRecord>> ds_records;
         
         // Sem trust anchor - deve retornar Indeterminate
-        ValidationResult result = validator.validateChain("example.com", dnskeys, ds_records);
+        ValidationResult result = validator.validateChain("example.com", dnskeys, ds_records, {});
         
         assert(result == ValidationResult::Indeterminate);
         
@@ -535,6 +545,467 @@ void test_validate_with_trust_anchor_success() {
     }
 }
 
+// ========== Testes de Cache de Elos Validados ==========
+// Estes testes verificam que validateChain reaproveita elos DS → DNSKEY já
+// validados (mesmos conjuntos) e refaz a validação quando eles mudam.
+
+DNSKEYRecord makeChainKey(uint8_t seed) {
+    DNSKEYRecord dnskey;
+    dnskey.flags = 257;
+    dnskey.protocol = 3;
+    dnskey.algorithm = 8;
+    dnskey.public_key = {seed, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    return dnskey;
+}
+
+DSRecord makeChainDS(DNSSECValidator& validator, const DNSKEYRecord& dnskey, const std::string& zone) {
+    DSRecord ds;
+    ds.key_tag = validator.calculateKeyTag(dnskey);
+    ds.algorithm = dnskey.algorithm;
+    ds.digest_type = 2;
+    ds.digest = validator.calculateDigest(dnskey, zone, 2);
+    return ds;
+}
+
+/**
+ * Testa expiração, normalização e limite do ValidatedKeyCache
+ */
+void test_validated_key_cache_entries() {
+    std::cout << "  [TEST] ValidatedKeyCache expiração e limite... ";
+    
+    try {
+        ValidatedKeyCache cache(2);
+        std::vector<DNSKEYRecord> keys = {makeChainKey(0x40)};
+        std::vector<DSRecord> ds;
+        time_t now = 1000000;
+        bool trusted = false;
+        
+        cache.store("Example.COM.", keys, ds, true, 60, now);
+        assert(cache.lookup("example.com", keys, ds, trusted, now + 10) && trusted);
+        assert(!cache.lookup("example.com", keys, ds, trusted, now + 60));
+        
+        // TTL 0 não é guardado; acima do teto vale MAX_TTL
+        cache.store("zero.com", keys, ds, true, 0, now);
+        assert(!cache.lookup("zero.com", keys, ds, trusted, now));
+        cache.store("long.com", keys, ds, true, 10 * ValidatedKeyCache::MAX_TTL, now);
+        assert(!cache.lookup("long.com", keys, ds, trusted, now + ValidatedKeyCache::MAX_TTL));
+        
+        // Cheio: sai a entrada que vence antes
+        cache.clear();
+        cache.store("a.com", keys, ds, true, 100, now);
+        cache.store("b.com", keys, ds, true, 200, now);
+        cache.store("c.com", keys, ds, true, 300, now);
+        assert(cache.size() == 2);
+        assert(!cache.lookup("a.com", keys, ds, trusted, now));
+        assert(cache.lookup("c.com", keys, ds, trusted, now));
+        
+        std::cout << "\n";
+        tests_passed++;
+        
+    } catch (const std::exception& e) {
+        std::cout << RED << " (" << e.what() << ")\n" << RESET;
+        tests_failed++;
+    }
+}
+
+// ========== Testes de Verificação de RRsets ==========
+// Assinaturas reais (chave ECDSA P-256 gerada no teste) sobre dados
+// montados aqui de forma independente do validador (RFC 4034 §3.1.8.1, §6).
+
+// Nome em wire format, minúsculas e sem compressão
+std::vector<uint8_t> wireName(const std::string& name) {
+    std::vector<uint8_t> out;
+    std::istringstream iss(name);
+    std::string label;
+    while (std::getline(iss, label, '.')) {
+        if (label.empty()) continue;
+        out.push_back(static_cast<uint8_t>(label.size()));
+        for (char c : label) {
+            out.push_back(static_cast<uint8_t>(std::tolower(static_cast<unsigned char>(c))));
+        }
+    }
+    out.push_back(0);
+    return out;
+}
+
+void appendU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(value >> 8);
+    out.push_back(value & 0xFF);
+}
+
+void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+    appendU16(out, value >> 16);
+    appendU16(out, value & 0xFFFF);
+}
+
+struct SigningKey {
+    EVP_PKEY* pkey = nullptr;
+    DNSKEYRecord dnskey;
+    ~SigningKey() { EVP_PKEY_free(pkey); }
+};
+
+// Gera chave P-256 e a DNSKEY correspondente (X || Y, RFC 6605)
+void makeSigningKey(SigningKey& key) {
+    key.pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+    assert(key.pkey != nullptr);
+    uint8_t point[65];
+    size_t point_len = 0;
+    assert(EVP_PKEY_get_octet_string_param(key.pkey, OSSL_PKEY_PARAM_PUB_KEY,
+                                           point, sizeof(point), &point_len) == 1);
+    assert(point_len == 65 && point[0] == 0x04);
+    key.dnskey.flags = 256;
+    key.dnskey.protocol = 3;
+    key.dnskey.algorithm = 13;
+    key.dnskey.public_key.assign(point + 1, point + 65);
+}
+
+DNSResourceRecord makeA(const std::string& owner, uint8_t last_octet) {
+    DNSResourceRecord rr;
+    rr.name = owner;
+    rr.type = DNSType::A;
+    rr.rr_class = 1;
+    rr.ttl = 300;
+    rr.rdata = {192, 0, 2, last_octet};
+    rr.rdlength = 4;
+    return rr;
+}
+
+DNSResourceRecord makeNS(const std::string& owner, const std::string& target) {
+    DNSResourceRecord rr;
+    rr.name = owner;
+    rr.type = DNSType::NS;
+    rr.rr_class = 1;
+    rr.ttl = 300;
+    rr.rdata_ns = target;
+    rr.rdata = {0xC0, 0x0C};    // Ponteiro de compressão (só válido na mensagem original)
+    rr.rdlength = 2;
+    return rr;
+}
+
+// RRSIG sobre rrset (com canonical_rdatas já em forma canônica), assinado por key
+DNSResourceRecord signRRset(
+    const SigningKey& key,
+    DNSSECValidator& validator,
+    const std::string& signed_owner,    // Owner como assinado ("*.zona" para curinga)
+    const std::string& reply_owner,     // Owner do RRSIG na resposta
+    uint16_t type,
+    uint8_t labels,
+    std::vector<std::vector<uint8_t>> canonical_rdatas,
+    const std::string& signer
+) {
+    RRSIGRecord rrsig;
+    rrsig.type_covered = type;
+    rrsig.algorithm = 13;
+    rrsig.labels = labels;
+    rrsig.original_ttl = 300;
+    rrsig.signature_inception = static_cast<uint32_t>(time(nullptr) - 3600);
+    rrsig.signature_expiration = static_cast<uint32_t>(time(nullptr) + 3600);
+    rrsig.key_tag = validator.calculateKeyTag(key.dnskey);
+    rrsig.signer_name = signer;
+    
+    std::vector<uint8_t> data;
+    appendU16(data, rrsig.type_covered);
+    data.push_back(rrsig.algorithm);
+    data.push_back(rrsig.labels);
+    appendU32(data, rrsig.original_ttl);
+    appendU32(data, rrsig.signature_expiration);
+    appendU32(data, rrsig.signature_inception);
+    appendU16(data, rrsig.key_tag);
+    std::vector<uint8_t> signer_wire = wireName(signer);
+    data.insert(data.end(), signer_wire.begin(), signer_wire.end());
+    
+    std::sort(canonical_rdatas.begin(), canonical_rdatas.end());
+    std::vector<uint8_t> owner_wire = wireName(signed_owner);
+    for (const auto& rdata : canonical_rdatas) {
+        data.insert(data.end(), owner_wire.begin(), owner_wire.end());
+        appendU16(data, type);
+        appendU16(data, 1);
+        appendU32(data, rrsig.original_ttl);
+        appendU16(data, static_cast<uint16_t>(rdata.size()));
+        data.insert(data.end(), rdata.begin(), rdata.end());
+    }
+    
+    // Assinar (DER) e converter para r || s
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    size_t der_len = 0;
+    assert(EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, key.pkey) == 1);
+    assert(EVP_DigestSign(ctx, nullptr, &der_len, data.data(), data.size()) == 1);
+    std::vector<uint8_t> der(der_len);
+    assert(EVP_DigestSign(ctx, der.data(), &der_len, data.data(), data.size()) == 1);
+    EVP_MD_CTX_free(ctx);
+    
+    const uint8_t* der_ptr = der.data();
+    ECDSA_SIG* sig = d2i_ECDSA_SIG(nullptr, &der_ptr, static_cast<long>(der_len));
+    assert(sig != nullptr);
+    rrsig.signature.resize(64);
+    BN_bn2binpad(ECDSA_SIG_get0_r(sig), rrsig.signature.data(), 32);
+    BN_bn2binpad(ECDSA_SIG_get0_s(sig), rrsig.signature.data() + 32, 32);
+    ECDSA_SIG_free(sig);
+    
+    DNSResourceRecord rr;
+    rr.name = reply_owner;
+    rr.type = DNSType::RRSIG;
+    rr.rr_class = 1;
+    rr.ttl = 300;
+    rr.rdata_rrsig = rrsig;
+    return rr;
+}
+
+// Chave de entrada (KSK, flag SEP) da zona
+void makeEntryKey(SigningKey& key) {
+    makeSigningKey(key);
+    key.dnskey.flags = 257;
+}
+
+// RDATA de uma DNSKEY (flags, protocolo, algoritmo, chave pública)
+std::vector<uint8_t> dnskeyRData(const DNSKEYRecord& dnskey) {
+    std::vector<uint8_t> out;
+    appendU16(out, dnskey.flags);
+    out.push_back(dnskey.protocol);
+    out.push_back(dnskey.algorithm);
+    out.insert(out.end(), dnskey.public_key.begin(), dnskey.public_key.end());
+    return out;
+}
+
+// RRSIG do RRset DNSKEY de zone, assinado por key
+RRSIGRecord signDNSKEYSet(
+    const SigningKey& key,
+    DNSSECValidator& validator,
+    const std::string& zone,
+    const std::vector<DNSKEYRecord>& keys
+) {
+    std::vector<std::vector<uint8_t>> rdatas;
+    for (const auto& dnskey : keys) {
+        rdatas.push_back(dnskeyRData(dnskey));
+    }
+    uint8_t labels = zone == "." ? 0 : static_cast<uint8_t>(std::count(zone.begin(), zone.end(), '.') + 1);
+    return signRRset(key, validator, zone, zone, DNSType::DNSKEY, labels, rdatas, zone).rdata_rrsig;
+}
+
+/**
+ * Testa cadeia root → com → example.com validada uma vez e reaproveitada;
+ * cada RRset DNSKEY precisa da assinatura de uma chave que confere com o DS
+ */
+void test_validate_chain_cached() {
+    std::cout << "  [TEST] validateChain() com ValidatedKeyCache... ";
+    
+    try {
+        TrustAnchorStore store;
+        ValidatedKeyCache cache;
+        DNSSECValidator validator(store, false, &cache);
+        
+        SigningKey root_key, com_key, example_key, example_zsk, forged;
+        makeEntryKey(root_key);
+        makeEntryKey(com_key);
+        makeEntryKey(example_key);
+        makeSigningKey(example_zsk);
+        makeSigningKey(forged);
+        
+        DSRecord root_ds = makeChainDS(validator, root_key.dnskey, ".");
+        TrustAnchor ta;
+        ta.zone = ".";
+        ta.key_tag = root_ds.key_tag;
+        ta.algorithm = root_ds.algorithm;
+        ta.digest_type = root_ds.digest_type;
+        ta.digest = root_ds.digest;
+        store.addTrustAnchor(ta);
+        
+        std::vector<DNSKEYRecord> example_set = {example_key.dnskey, example_zsk.dnskey};
+        std::map<std::string, std::vector<DNSKEYRecord>> dnskeys = {
+            {".", {root_key.dnskey}}, {"com", {com_key.dnskey}}, {"example.com", example_set}
+        };
+        std::map<std::string, std::vector<DSRecord>> ds_records = {
+            {"com", {makeChainDS(validator, com_key.dnskey, "com")}},
+            {"example.com", {makeChainDS(validator, example_key.dnskey, "example.com")}}
+        };
+        std::map<std::string, std::vector<RRSIGRecord>> rrsigs = {
+            {".", {signDNSKEYSet(root_key, validator, ".", {root_key.dnskey})}},
+            {"com", {signDNSKEYSet(com_key, validator, "com", {com_key.dnskey})}},
+            {"example.com", {signDNSKEYSet(example_key, validator, "example.com", example_set)}}
+        };
+        
+        // Primeira validação: 3 elos calculados e guardados
+        std::map<std::string, std::vector<DNSKEYRecord>> authenticated;
+        assert(validator.validateChain("example.com", dnskeys, ds_records, rrsigs, &authenticated) ==
+               ValidationResult::Secure);
+        assert(authenticated.size() == 3 && authenticated["example.com"].size() == 2);
+        assert(cache.size() == 3 && cache.hits() == 0 && cache.misses() == 3);
+        
+        // Segunda (outro validador, mesmo cache): nenhum digest
+        DNSSECValidator second(store, false, &cache);
+        assert(second.validateChain("example.com", dnskeys, ds_records, rrsigs) == ValidationResult::Secure);
+        assert(cache.hits() == 3 && cache.misses() == 3);
+        
+        // Chave injetada no conjunto: a assinatura não o cobre mais, BOGUS
+        // e nenhuma chave de example.com autenticada
+        dnskeys["example.com"].push_back(forged.dnskey);
+        assert(second.validateChain("example.com", dnskeys, ds_records, rrsigs, &authenticated) ==
+               ValidationResult::Bogus);
+        assert(authenticated.count("example.com") == 0);
+        assert(cache.misses() == 4);
+        
+        // Resultado BOGUS não é guardado: a próxima tentativa valida de novo
+        assert(second.validateChain("example.com", dnskeys, ds_records, rrsigs) == ValidationResult::Bogus);
+        assert(cache.misses() == 5);
+        
+        // RRSIG forjado sobre as chaves verdadeiras não impede a resposta
+        // legítima seguinte (a assinatura não faz parte da chave do cache)
+        dnskeys["example.com"] = example_set;
+        ValidatedKeyCache fresh;
+        DNSSECValidator third(store, false, &fresh);
+        std::map<std::string, std::vector<RRSIGRecord>> forged_rrsigs = rrsigs;
+        forged_rrsigs["example.com"] = {signDNSKEYSet(forged, validator, "example.com", example_set)};
+        assert(third.validateChain("example.com", dnskeys, ds_records, forged_rrsigs) ==
+               ValidationResult::Bogus);
+        assert(fresh.size() == 1);   // Só a root (validada antes de descer a cadeia)
+        assert(third.validateChain("example.com", dnskeys, ds_records, rrsigs) == ValidationResult::Secure);
+        assert(fresh.size() == 3);
+        
+        // Conjunto assinado só pela ZSK (sem elo com o DS): BOGUS
+        rrsigs["example.com"] = {signDNSKEYSet(example_zsk, validator, "example.com", example_set)};
+        DNSSECValidator uncached(store);
+        assert(uncached.validateChain("example.com", dnskeys, ds_records, rrsigs) == ValidationResult::Bogus);
+        
+        // RRset DNSKEY sem RRSIG: BOGUS
+        rrsigs.erase("example.com");
+        assert(uncached.validateChain("example.com", dnskeys, ds_records, rrsigs) == ValidationResult::Bogus);
+        
+        std::cout << "\n";
+        tests_passed++;
+        
+    } catch (const std::exception& e) {
+        std::cout << RED << " (" << e.what() << ")\n" << RESET;
+        tests_failed++;
+    }
+}
+
+/**
+ * Testa RRsets assinados: forma canônica (maiúsculas, ordem, compressão),
+ * verificação em paralelo e RRset adulterado (BOGUS)
+ */
+void test_validate_rrsets_signed() {
+    std::cout << "  [TEST] validateRRsets() com assinaturas ECDSA... ";
+    
+    try {
+        TrustAnchorStore store;
+        DNSSECValidator validator(store);
+        SigningKey key;
+        makeSigningKey(key);
+        std::map<std::string, std::vector<DNSKEYRecord>> zone_keys = {{"example.com", {key.dnskey}}};
+        
+        // Answer: A com dois registros (fora de ordem, owner com maiúsculas)
+        DNSMessage response;
+        response.answers.push_back(makeA("WWW.Example.COM", 20));
+        response.answers.push_back(makeA("WWW.Example.COM", 10));
+        response.answers.push_back(signRRset(key, validator, "www.example.com", "WWW.Example.COM",
+                                             DNSType::A, 3, {{192, 0, 2, 10}, {192, 0, 2, 20}},
+                                             "Example.com"));
+        
+        // Authority: NS com nome em maiúsculas e RDATA comprimido na mensagem
+        response.authority.push_back(makeNS("example.com", "NS1.Example.com"));
+        response.authority.push_back(signRRset(key, validator, "example.com", "example.com",
+                                               DNSType::NS, 2, {wireName("ns1.example.com")},
+                                               "example.com"));
+        
+        // Sequencial e em paralelo: mesmo resultado
+        assert(validator.validateRRsets(response, "example.com", zone_keys) == ValidationResult::Secure);
+        ThreadPool pool(2);
+        assert(validator.validateRRsets(response, "example.com", zone_keys, &pool) == ValidationResult::Secure);
+        
+        // Authority sem RRSIG (NS de delegação) não impede SECURE
+        DNSMessage with_delegation = response;
+        with_delegation.authority.push_back(makeNS("sub.example.com", "ns.sub.example.com"));
+        assert(validator.validateRRsets(with_delegation, "example.com", zone_keys, &pool) ==
+               ValidationResult::Secure);
+        
+        // Registro adulterado: assinatura não confere
+        DNSMessage tampered = response;
+        tampered.answers[0].rdata = {192, 0, 2, 99};
+        assert(validator.validateRRsets(tampered, "example.com", zone_keys, &pool) == ValidationResult::Bogus);
+        
+        // Registro duplicado na resposta: forma canônica remove (RFC 4034 §6.3)
+        DNSMessage duplicated = response;
+        duplicated.answers.insert(duplicated.answers.begin(), makeA("www.example.com", 10));
+        assert(validator.validateRRsets(duplicated, "example.com", zone_keys) == ValidationResult::Secure);
+        
+        std::cout << "\n";
+        tests_passed++;
+        
+    } catch (const std::exception& e) {
+        std::cout << RED << " (" << e.what() << ")\n" << RESET;
+        tests_failed++;
+    }
+}
+
+/**
+ * Testa curinga, RRset sem assinatura e chaves fora da cadeia validada
+ */
+void test_validate_rrsets_unverifiable() {
+    std::cout << "  [TEST] validateRRsets() curinga, BOGUS e INDETERMINATE... ";
+    
+    try {
+        TrustAnchorStore store;
+        DNSSECValidator validator(store);
+        SigningKey key;
+        makeSigningKey(key);
+        std::map<std::string, std::vector<DNSKEYRecord>> zone_keys = {{"example.com", {key.dnskey}}};
+        
+        // Resposta sintetizada de *.example.com (RRSIG com 2 labels)
+        DNSMessage wildcard;
+        wildcard.answers.push_back(makeA("a.b.example.com", 1));
+        wildcard.answers.push_back(signRRset(key, validator, "*.example.com", "a.b.example.com",
+                                             DNSType::A, 2, {{192, 0, 2, 1}}, "example.com"));
+        assert(validator.validateRRsets(wildcard, "example.com", zone_keys) == ValidationResult::Secure);
+        
+        // Answer sem RRSIG dentro da zona assinada: BOGUS
+        DNSMessage unsigned_answer;
+        unsigned_answer.answers.push_back(makeA("www.example.com", 1));
+        assert(validator.validateRRsets(unsigned_answer, "example.com", zone_keys) ==
+               ValidationResult::Bogus);
+        
+        // Answer assinado por chave fora do conjunto autenticado: BOGUS
+        SigningKey other;
+        makeSigningKey(other);
+        DNSMessage foreign_key;
+        foreign_key.answers.push_back(makeA("www.example.com", 1));
+        foreign_key.answers.push_back(signRRset(other, validator, "www.example.com", "www.example.com",
+                                                DNSType::A, 3, {{192, 0, 2, 1}}, "example.com"));
+        assert(validator.validateRRsets(foreign_key, "example.com", zone_keys) ==
+               ValidationResult::Bogus);
+        
+        // Alvo de CNAME em outra zona, sem RRSIG: fora da cadeia, INDETERMINATE
+        DNSResourceRecord cname;
+        cname.name = "www.example.com";
+        cname.type = DNSType::CNAME;
+        cname.rr_class = 1;
+        cname.ttl = 300;
+        cname.rdata_cname = "www.cdn.net";
+        DNSMessage cross_zone;
+        cross_zone.answers.push_back(cname);
+        cross_zone.answers.push_back(signRRset(key, validator, "www.example.com", "www.example.com",
+                                               DNSType::CNAME, 3, {wireName("www.cdn.net")},
+                                               "example.com"));
+        cross_zone.answers.push_back(makeA("www.cdn.net", 1));
+        assert(validator.validateRRsets(cross_zone, "example.com", zone_keys) ==
+               ValidationResult::Indeterminate);
+        
+        // Assinante fora da cadeia validada (target em outra zona)
+        assert(validator.validateRRsets(wildcard, "example.org", zone_keys) ==
+               ValidationResult::Indeterminate);
+        
+        // Resposta vazia: nada autenticado
+        assert(validator.validateRRsets(DNSMessage(), "example.com", zone_keys) ==
+               ValidationResult::Indeterminate);
+        
+        std::cout << "\n";
+        tests_passed++;
+        
+    } catch (const std::exception& e) {
+        std::cout << RED << " (" << e.what() << ")\n" << RESET;
+        tests_failed++;
+    }
+}
+
 // ========== Função Principal de Testes ==========
 
 /**
@@ -549,6 +1020,8 @@ void test_validate_with_trust_anchor_success() {
  * - Validação de registros DNSKEY contra DS
  * - Validação de cadeia de confiança completa
  * - Validação contra trust anchors
+ * - Cache de elos validados (RRset DNSKEY assinado pela chave do DS)
+ * - Assinaturas RRSIG dos RRsets da resposta
  */
 int main() {
     std::cout << "\n==========================================\n";
@@ -587,6 +1060,16 @@ int main() {
     std::cout << "\n→ Testes de validateDNSKEYWithTrustAnchor():\n";
     test_validate_with_trust_anchor_success();
     
+    // Testes de Cache de Elos Validados
+    std::cout << "\n→ Testes de ValidatedKeyCache:\n";
+    test_validate_chain_cached();
+    test_validated_key_cache_entries();
+    
+    // Testes de Verificação de RRsets
+    std::cout << "\n→ Testes de validateRRsets():\n";
+    test_validate_rrsets_signed();
+    test_validate_rrsets_unverifiable();
+    
     // Resultados Finais
     std::cout << "\n==========================================\n";
     std::cout << "  RESULTADOS FINAIS\n";
@@ -604,7 +1087,9 @@ int main() {
         std::cout << "    • calculateDigest(): SHA-1/SHA-256 \n";
         std::cout << "    • validateDNSKEY(): Validação DS \n";
         std::cout << "    • validateChain(): Cadeia completa \n";
-        std::cout << "    • Trust Anchors: Validação raiz \n\n" << RESET;
+        std::cout << "    • Trust Anchors: Validação raiz \n";
+        std::cout << "    • ValidatedKeyCache: Elos reaproveitados \n";
+        std::cout << "    • validateRRsets(): Assinaturas da resposta \n\n" << RESET;
         return 0;
     } else {
         std::cout << RED << " ALGUNS TESTES FALHARAM\n\n";
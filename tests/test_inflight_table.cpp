@@ -0,0 +1,262 @@
+/*
+ * Arquivo: test_inflight_table.cpp
+ * Propósito: Testes unitários para a coalescência de resoluções em andamento (InflightTable)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para InflightTable, cobrindo:
+ * - Formato e normalização das keys
+ * - Chamadas concorrentes com a mesma key executam uma única resolução
+ * - Keys diferentes não se bloqueiam
+ * - Exceção do líder propagada aos seguidores
+ * - Seguidor com prazo (orçamento stale) e chamada reentrante na mesma thread
+ */
+
+#include "dns_resolver/InflightTable.h"
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+DNSMessage answerWithId(uint16_t id) {
+    DNSMessage message;
+    message.header.id = id;
+    return message;
+}
+
+// Espera até a key aparecer na tabela (o líder começou)
+void waitForLeader(InflightTable& table, size_t expected) {
+    for (int i = 0; i < 500 && table.size() < expected; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa a montagem das keys
+ */
+void test_keys() {
+    std::cout << "\n[TEST] InflightTable - Keys\n";
+
+    test_assert(InflightTable::makeKey("WWW.Example.COM.", 1, "plain") ==
+                InflightTable::makeKey("www.example.com", 1, "plain"),
+                "Nome normalizado (caixa e ponto final)");
+    test_assert(InflightTable::makeKey("example.com", 1, "plain") !=
+                InflightTable::makeKey("example.com", 28, "plain"),
+                "Tipo faz parte da key");
+    test_assert(InflightTable::makeKey("example.com", 1, "plain") !=
+                InflightTable::makeKey("example.com", 1, "do"),
+                "Variante (DNSSEC) faz parte da key");
+}
+
+/**
+ * Testa chamadas concorrentes com a mesma key
+ */
+void test_single_flight() {
+    std::cout << "\n[TEST] InflightTable - Uma resolução para vários chamadores\n";
+
+    InflightTable table;
+    std::atomic<int> executions{0};
+    std::atomic<bool> release{false};
+    const int callers = 8;
+    std::vector<DNSMessage> results(callers);
+    std::vector<int> led(callers, 0);
+
+    auto slow = [&]() {
+        executions++;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return answerWithId(4242);
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() { led[0] = table.run("k", slow, results[0]); });
+    waitForLeader(table, 1);
+    for (int i = 1; i < callers; i++) {
+        threads.emplace_back([&, i]() { led[i] = table.run("k", slow, results[i]); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    bool same = true;
+    int leaders = 0;
+    for (int i = 0; i < callers; i++) {
+        same = same && results[i].header.id == 4242;
+        leaders += led[i];
+    }
+    test_assert(executions == 1, "Resolução executada uma única vez");
+    test_assert(same, "Todos recebem o mesmo resultado");
+    test_assert(leaders == 1 && table.coalesced() == callers - 1,
+                "Um líder, demais contados como coalescidos");
+    test_assert(table.size() == 0, "Key removida ao terminar");
+
+    DNSMessage again;
+    test_assert(table.run("k", []() { return answerWithId(1); }, again) &&
+                again.header.id == 1,
+                "Depois de concluída, a key volta a resolver");
+}
+
+/**
+ * Testa que keys diferentes correm em paralelo
+ */
+void test_independent_keys() {
+    std::cout << "\n[TEST] InflightTable - Keys independentes\n";
+
+    InflightTable table;
+    std::atomic<bool> release{false};
+    DNSMessage first;
+    std::thread leader([&]() {
+        table.run("a", [&]() {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return answerWithId(1);
+        }, first);
+    });
+    waitForLeader(table, 1);
+
+    DNSMessage second;
+    bool ran = table.run("b", []() { return answerWithId(2); }, second);
+    test_assert(ran && second.header.id == 2, "Outra key não espera a primeira");
+
+    release = true;
+    leader.join();
+    test_assert(first.header.id == 1, "Primeira key conclui normalmente");
+}
+
+/**
+ * Testa propagação de falhas e prazos
+ */
+void test_failures() {
+    std::cout << "\n[TEST] InflightTable - Falhas e prazos\n";
+
+    InflightTable table;
+    std::atomic<bool> release{false};
+    auto failing = [&]() -> DNSMessage {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        throw std::runtime_error("No response from server");
+    };
+
+    std::string leader_error;
+    std::thread leader([&]() {
+        DNSMessage out;
+        try {
+            table.run("fail", failing, out);
+        } catch (const std::runtime_error& e) {
+            leader_error = e.what();
+        }
+    });
+    waitForLeader(table, 1);
+
+    std::string follower_error;
+    std::thread follower([&]() {
+        DNSMessage out;
+        try {
+            table.run("fail", []() { return answerWithId(9); }, out);
+        } catch (const std::runtime_error& e) {
+            follower_error = e.what();
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+    leader.join();
+    follower.join();
+    test_assert(leader_error == "No response from server" && follower_error == leader_error,
+                "Exceção do líder chega aos seguidores");
+    test_assert(table.size() == 0, "Key removida após falha");
+
+    // Seguidor com prazo: desiste sem derrubar o líder
+    release = false;
+    DNSMessage led_result;
+    std::thread slow_leader([&]() {
+        table.run("slow", [&]() {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return answerWithId(7);
+        }, led_result);
+    });
+    waitForLeader(table, 1);
+
+    auto deadline = InflightTable::Clock::now() + std::chrono::milliseconds(30);
+    bool budget_exceeded = false;
+    try {
+        DNSMessage out;
+        table.run("slow", []() { return answerWithId(8); }, out, &deadline);
+    } catch (const std::runtime_error& e) {
+        budget_exceeded = std::string(e.what()) == "Latency budget exceeded";
+    }
+    release = true;
+    slow_leader.join();
+    test_assert(budget_exceeded && led_result.header.id == 7,
+                "Prazo do seguidor não afeta o líder");
+
+    // Com prazo e nada em curso: resolve sem registrar a key
+    DNSMessage out;
+    bool ran = table.run("alone", [&]() {
+        return answerWithId(static_cast<uint16_t>(table.size()));
+    }, out, &deadline);
+    test_assert(ran && out.header.id == 0, "Chamada com prazo nunca lidera");
+
+    // Reentrância: a mesma thread pedindo a key que ela lidera
+    DNSMessage outer;
+    table.run("loop", [&]() {
+        DNSMessage inner;
+        table.run("loop", []() { return answerWithId(5); }, inner);
+        return inner;
+    }, outer);
+    test_assert(outer.header.id == 5, "Chamada reentrante não espera por si mesma");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: InflightTable (coalescência)\n";
+    std::cout << "==========================================\n";
+
+    test_keys();
+    test_single_flight();
+    test_independent_keys();
+    test_failures();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
@@ -0,0 +1,228 @@
+/*
+ * Arquivo: test_infra_cache.cpp
+ * Propósito: Testes unitários para a tabela de RTT por servidor (InfraCache)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para InfraCache, cobrindo:
+ * - SRTT: primeira amostra, média móvel e teto MAX_RTT_MS
+ * - Timeouts: backoff da estimativa e recuperação
+ * - RTO (SRTT + 4 × RTTVAR) para o retry em outro servidor
+ * - Seleção pelo menor RTT efetivo, desconhecidos e exploração
+ * - Estatísticas antigas (STATS_TTL) e limite de servidores
+ */
+
+#include "dns_resolver/InfraCache.h"
+#include <iostream>
+#include <set>
+#include <string>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa o cálculo do RTT suavizado
+ */
+void test_smoothed_rtt() {
+    std::cout << "\n[TEST] InfraCache - RTT suavizado\n";
+
+    InfraCache cache;
+    time_t now = 1000;
+    test_assert(cache.effectiveRtt("10.0.0.1", now) == InfraCache::UNKNOWN_RTT_MS,
+                "Desconhecido: UNKNOWN_RTT_MS");
+
+    cache.recordRtt("10.0.0.1", 40, now);
+    test_assert(cache.effectiveRtt("10.0.0.1", now) == 40, "Primeira amostra usada direto");
+
+    cache.recordRtt("10.0.0.1", 120, now);
+    test_assert(cache.effectiveRtt("10.0.0.1", now) == 50, "7/8 SRTT + 1/8 amostra");
+
+    ServerStats stats;
+    test_assert(cache.stats("10.0.0.1", stats) && stats.samples == 2 && stats.timeouts == 0,
+                "Amostras contadas");
+
+    cache.recordRtt("10.0.0.2", 500000, now);
+    test_assert(cache.effectiveRtt("10.0.0.2", now) == InfraCache::MAX_RTT_MS, "Teto MAX_RTT_MS");
+}
+
+/**
+ * Testa backoff por timeout e recuperação
+ */
+void test_timeouts() {
+    std::cout << "\n[TEST] InfraCache - Timeouts\n";
+
+    InfraCache cache;
+    time_t now = 1000;
+    cache.recordTimeout("10.0.0.1", now);
+    test_assert(cache.effectiveRtt("10.0.0.1", now) == InfraCache::TIMEOUT_RTT_MS,
+                "Primeiro timeout: piso TIMEOUT_RTT_MS");
+
+    cache.recordTimeout("10.0.0.1", now);
+    ServerStats stats;
+    test_assert(cache.effectiveRtt("10.0.0.1", now) == 2 * InfraCache::TIMEOUT_RTT_MS &&
+                cache.stats("10.0.0.1", stats) && stats.timeouts == 2,
+                "Timeouts consecutivos dobram a estimativa");
+
+    for (int i = 0; i < 20; i++) {
+        cache.recordTimeout("10.0.0.1", now);
+    }
+    test_assert(cache.effectiveRtt("10.0.0.1", now) == InfraCache::MAX_RTT_MS, "Backoff limitado");
+
+    cache.recordTimeout("10.0.0.2", now);
+    cache.recordRtt("10.0.0.2", 30, now);
+    test_assert(cache.effectiveRtt("10.0.0.2", now) == (InfraCache::TIMEOUT_RTT_MS + 30) / 2 &&
+                cache.stats("10.0.0.2", stats) && stats.timeouts == 0,
+                "Resposta zera timeouts e descarta metade da penalidade");
+}
+
+/**
+ * Testa o RTO usado para tentar outro servidor
+ */
+void test_retry_timeout() {
+    std::cout << "\n[TEST] InfraCache - RTO\n";
+
+    InfraCache cache;
+    time_t now = 1000;
+    test_assert(cache.retryTimeoutMs("10.0.0.1", now) == InfraCache::UNKNOWN_RTO_MS,
+                "Desconhecido: UNKNOWN_RTO_MS");
+
+    cache.recordRtt("10.0.0.1", 40, now);
+    test_assert(cache.retryTimeoutMs("10.0.0.1", now) == 40 + 4 * 20, "SRTT + 4 × RTTVAR");
+
+    for (int i = 0; i < 50; i++) {
+        cache.recordRtt("10.0.0.1", 40, now);
+    }
+    test_assert(cache.retryTimeoutMs("10.0.0.1", now) == InfraCache::MIN_RTO_MS,
+                "RTT estável: piso MIN_RTO_MS");
+
+    cache.recordRtt("10.0.0.1", 400, now);
+    ServerStats stats;
+    test_assert(cache.stats("10.0.0.1", stats) && stats.rttvar_ms >= 90,
+                "Amostra discrepante aumenta RTTVAR");
+
+    for (int i = 0; i < 5; i++) {
+        cache.recordTimeout("10.0.0.2", now);
+    }
+    test_assert(cache.retryTimeoutMs("10.0.0.2", now) == InfraCache::MAX_RTO_MS,
+                "Teto MAX_RTO_MS");
+}
+
+/**
+ * Testa a seleção do servidor
+ */
+void test_selection() {
+    std::cout << "\n[TEST] InfraCache - Seleção\n";
+
+    InfraCache cache;
+    cache.setExplorePercent(0);
+    time_t now = 1000;
+    std::vector<std::string> servers = {"10.0.0.1", "10.0.0.2", "10.0.0.3"};
+    cache.recordRtt("10.0.0.1", 200, now);
+    cache.recordRtt("10.0.0.2", 20, now);
+    cache.recordRtt("10.0.0.3", 80, now);
+
+    bool always_fastest = true;
+    for (int i = 0; i < 50; i++) {
+        always_fastest = always_fastest && cache.select(servers, now) == 1;
+    }
+    test_assert(always_fastest, "Menor SRTT escolhido");
+
+    cache.recordTimeout("10.0.0.2", now);
+    test_assert(cache.select(servers, now) == 2, "Servidor com timeout perde a vez");
+
+    std::vector<std::string> with_unknown = {"10.0.0.1", "10.0.0.9"};
+    test_assert(cache.select(with_unknown, now) == 1, "Desconhecido antes de servidor lento");
+
+    std::set<size_t> tied;
+    std::vector<std::string> unknown = {"192.0.2.1", "192.0.2.2", "192.0.2.3"};
+    for (int i = 0; i < 200; i++) {
+        tied.insert(cache.select(unknown, now));
+    }
+    test_assert(tied.size() == 3, "Empates distribuídos entre os candidatos");
+
+    cache.setExplorePercent(100);
+    std::set<size_t> explored;
+    for (int i = 0; i < 200; i++) {
+        explored.insert(cache.select(servers, now));
+    }
+    test_assert(explored.size() == 3, "Exploração visita todos os servidores");
+
+    bool threw = false;
+    try {
+        cache.select({}, now);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    test_assert(threw, "Lista vazia lança invalid_argument");
+}
+
+/**
+ * Testa estatísticas antigas e limite de servidores
+ */
+void test_staleness_and_limits() {
+    std::cout << "\n[TEST] InfraCache - Estatísticas antigas e limites\n";
+
+    InfraCache cache(2);
+    time_t now = 1000;
+    cache.recordTimeout("10.0.0.1", now);
+    test_assert(cache.effectiveRtt("10.0.0.1", now + InfraCache::STATS_TTL + 1) ==
+                InfraCache::UNKNOWN_RTT_MS,
+                "Após STATS_TTL volta a ser desconhecido");
+
+    cache.recordRtt("10.0.0.1", 300, now + InfraCache::STATS_TTL + 1);
+    test_assert(cache.effectiveRtt("10.0.0.1", now + InfraCache::STATS_TTL + 1) == 300,
+                "Amostra após STATS_TTL recomeça o SRTT");
+
+    cache.recordRtt("10.0.0.2", 10, now + 2000);
+    cache.recordRtt("10.0.0.3", 10, now + 2001);
+    ServerStats stats;
+    test_assert(cache.size() == 2 && !cache.stats("10.0.0.1", stats),
+                "Limite de servidores: descarta o mais antigo");
+
+    cache.clear();
+    test_assert(cache.size() == 0, "clear");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: InfraCache (RTT por Servidor)\n";
+    std::cout << "==========================================\n";
+
+    test_smoothed_rtt();
+    test_timeouts();
+    test_retry_timeout();
+    test_selection();
+    test_staleness_and_limits();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
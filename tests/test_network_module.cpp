@@ -12,6 +12,7 @@
  * - DNS over TLS (DoT) com validação de certificados
  * - Gerenciamento de recursos com RAII (Resource Acquisition Is Initialization)
  * - Timeouts configuráveis e tratamento de erros de rede
+ * - UDP escalonado: próximo servidor após o RTO do anterior, primeira resposta vence
  * 
  * Os testes verificam conformidade com RFC 1035 (DNS), RFC 7766 (TCP fallback)
  * e RFC 7858 (DNS over TLS), garantindo que o módulo de rede consegue
@@ -24,6 +25,11 @@
 #include <cassert>
 #include <stdexcept>
 #include <chrono>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
 
 using namespace dns_resolver;
 
@@ -237,6 +243,110 @@ void test_socket_raii_no_leak() {
     std::cout << "\n";
 }
 
+// ========== Testes de UDP Escalonado ==========
+// Servidores falsos em 127.0.0.x:53 (loopback): um que nunca responde e um
+// que ecoa a query. Sem permissão para a porta 53 os testes são pulados.
+
+/**
+ * Abre um socket UDP em ip:53 (-1 se não for possível)
+ */
+static int bindLoopbackDNS(const char* ip) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(53);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    if (fd >= 0 && bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        return fd;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return -1;
+}
+
+/**
+ * Testa retry escalonado entre servidores
+ * O primeiro servidor não responde: a query vai ao segundo após o RTO do
+ * primeiro (100ms), bem antes do timeout total, e a resposta dele vence.
+ */
+void test_queryUDPStaggered_retry() {
+    std::cout << "  [TEST] queryUDPStaggered - retry no próximo servidor... ";
+    
+    int silent = bindLoopbackDNS("127.0.0.2");
+    int echo = bindLoopbackDNS("127.0.0.3");
+    if (silent < 0 || echo < 0) {
+        if (silent >= 0) close(silent);
+        if (echo >= 0) close(echo);
+        std::cout << " (pulado: porta 53 indisponível)\n";
+        return;
+    }
+    
+    // Eco de uma query, primeiro com ID trocado (deve ser ignorado), depois a original
+    std::thread responder([echo]() {
+        uint8_t buffer[512];
+        struct sockaddr_in from {};
+        socklen_t len = sizeof(from);
+        ssize_t n = recvfrom(echo, buffer, sizeof(buffer), 0,
+                             reinterpret_cast<struct sockaddr*>(&from), &len);
+        if (n > 0) {
+            buffer[0] ^= 0xFF;
+            sendto(echo, buffer, n, 0, reinterpret_cast<struct sockaddr*>(&from), len);
+            buffer[0] ^= 0xFF;
+            sendto(echo, buffer, n, 0, reinterpret_cast<struct sockaddr*>(&from), len);
+        }
+    });
+    
+    std::vector<uint8_t> query = {
+        0xAB, 0xCD, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x07, 'e','x','a','m','p','l','e', 0x03, 'c','o','m', 0x00,
+        0x00, 0x01, 0x00, 0x01
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    auto result = NetworkModule::queryUDPStaggered(
+        {"127.0.0.2", "127.0.0.3"}, query, {100, 100}, 3000);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    responder.join();
+    close(silent);
+    close(echo);
+    
+    assert(result.answered && "Segundo servidor deveria responder");
+    assert(result.server_index == 1 && result.sent == 2);
+    assert(result.response == query && "Resposta com ID original");
+    assert(elapsed >= 100 && elapsed < 1000 && "Retry após o RTO, não após o timeout");
+    std::cout << " (" << elapsed << "ms)\n";
+}
+
+/**
+ * Testa servidores que não respondem
+ * Sem resposta de nenhum servidor o resultado vem com answered = false
+ * no prazo total, sem exceção; lista vazia é rejeitada.
+ */
+void test_queryUDPStaggered_no_answer() {
+    std::cout << "  [TEST] queryUDPStaggered - sem resposta... ";
+    
+    std::vector<uint8_t> query(12, 0);
+    query[0] = 0x42;
+    
+    int silent = bindLoopbackDNS("127.0.0.2");
+    if (silent < 0) {
+        std::cout << " (pulado: porta 53 indisponível)\n";
+        return;
+    }
+    auto result = NetworkModule::queryUDPStaggered({"127.0.0.2", "999.1.1.1"}, query, {50}, 300);
+    close(silent);
+    assert(!result.answered && result.sent == 2);
+    
+    try {
+        NetworkModule::queryUDPStaggered({}, query, {}, 100);
+        assert(false && "Deveria lançar exceção para lista vazia");
+    } catch (const std::invalid_argument&) {
+    }
+    std::cout << "\n";
+}
+
 // ========== Testes de TCP (Story 2.1) ==========
 // Estes testes verificam se o NetworkModule implementa corretamente
 // comunicação TCP para fallback quando respostas UDP são truncadas,
@@ -386,6 +496,11 @@ int main() {
     std::cout << "\n→ Testes de Recursos:\n";
     test_socket_raii_no_leak();
     
+    // Testes de UDP escalonado (retry entre servidores)
+    std::cout << "\n→ Testes de UDP Escalonado:\n";
+    test_queryUDPStaggered_retry();
+    test_queryUDPStaggered_no_answer();
+    
     // Testes de Comunicação TCP (Story 2.1)
     std::cout << "\n→ Testes de TCP (Story 2.1):\n";
     test_queryTCP_basic();
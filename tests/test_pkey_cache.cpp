@@ -0,0 +1,199 @@
+/*
+ * Arquivo: test_pkey_cache.cpp
+ * Propósito: Testes unitários para o cache de chaves DNSKEY convertidas (PKeyCache)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para PKeyCache, cobrindo:
+ * - Busca por (algoritmo, key tag, chave pública) e contadores
+ * - Inserção concorrente da mesma chave mantém a primeira
+ * - Limite LRU e handles válidos após o descarte
+ * - validateRRSIG converte cada DNSKEY uma única vez
+ */
+
+#include "dns_resolver/PKeyCache.h"
+#include "dns_resolver/DNSSECValidator.h"
+#include "dns_resolver/TrustAnchorStore.h"
+#include <openssl/evp.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Helpers ==========
+
+std::vector<uint8_t> keyBytes(uint8_t seed) {
+    return std::vector<uint8_t>(64, seed);
+}
+
+// Ponto gerador da P-256 (chave pública ECDSA válida, RFC 6605: X || Y)
+std::vector<uint8_t> p256Generator() {
+    return {
+        0x6B, 0x17, 0xD1, 0xF2, 0xE1, 0x2C, 0x42, 0x47, 0xF8, 0xBC, 0xE6, 0xE5, 0x63, 0xA4, 0x40, 0xF2,
+        0x77, 0x03, 0x7D, 0x81, 0x2D, 0xEB, 0x33, 0xA0, 0xF4, 0xA1, 0x39, 0x45, 0xD8, 0x98, 0xC2, 0x96,
+        0x4F, 0xE3, 0x42, 0xE2, 0xFE, 0x1A, 0x7F, 0x9B, 0x8E, 0xE7, 0xEB, 0x4A, 0x7C, 0x0F, 0x9E, 0x16,
+        0x2B, 0xCE, 0x33, 0x57, 0x6B, 0x31, 0x5E, 0xCE, 0xCB, 0xB6, 0x40, 0x68, 0x37, 0xBF, 0x51, 0xF5
+    };
+}
+
+// ========== Testes ==========
+
+void test_find_insert() {
+    std::cout << "\n→ Busca e inserção:\n";
+    PKeyCache cache;
+
+    test_assert(!cache.find(13, 100, keyBytes(1)) && cache.misses() == 1,
+                "Chave desconhecida é um miss");
+
+    EVP_PKEY* raw = EVP_PKEY_new();
+    PKeyCache::Handle stored = cache.insert(13, 100, keyBytes(1), raw);
+    test_assert(stored && stored.get() == raw && cache.size() == 1, "insert() devolve o handle guardado");
+
+    PKeyCache::Handle found = cache.find(13, 100, keyBytes(1));
+    test_assert(found.get() == raw && cache.hits() == 1, "Mesma chave é um hit");
+
+    test_assert(!cache.find(8, 100, keyBytes(1)), "Algoritmo diferente não confere");
+    test_assert(!cache.find(13, 101, keyBytes(1)), "Key tag diferente não confere");
+    test_assert(!cache.find(13, 100, keyBytes(2)), "Chave pública diferente (mesma key tag) não confere");
+
+    test_assert(!cache.insert(13, 200, keyBytes(3), nullptr) && cache.size() == 1,
+                "insert() de nullptr é ignorado");
+
+    // Outra thread converteu a mesma chave: fica a primeira, a nova é liberada
+    PKeyCache::Handle again = cache.insert(13, 100, keyBytes(1), EVP_PKEY_new());
+    test_assert(again.get() == raw && cache.size() == 1, "Inserção repetida mantém a primeira chave");
+
+    cache.clear();
+    test_assert(cache.size() == 0 && !cache.find(13, 100, keyBytes(1)), "clear() esvazia o cache");
+    test_assert(found.get() == raw, "Handle continua válido após clear()");
+}
+
+void test_lru_limit() {
+    std::cout << "\n→ Limite LRU:\n";
+    PKeyCache cache(2);
+
+    PKeyCache::Handle first = cache.insert(8, 1, keyBytes(1), EVP_PKEY_new());
+    cache.insert(8, 2, keyBytes(2), EVP_PKEY_new());
+    cache.find(8, 1, keyBytes(1));    // 1 passa a ser a mais recente
+    cache.insert(8, 3, keyBytes(3), EVP_PKEY_new());
+
+    test_assert(cache.size() == 2, "Cache respeita o limite de chaves");
+    test_assert(cache.find(8, 1, keyBytes(1)) && cache.find(8, 3, keyBytes(3)),
+                "Chaves usadas recentemente permanecem");
+    test_assert(!cache.find(8, 2, keyBytes(2)), "Chave menos recente é descartada");
+
+    PKeyCache::Handle held = cache.find(8, 1, keyBytes(1));
+    cache.insert(8, 4, keyBytes(4), EVP_PKEY_new());
+    cache.insert(8, 5, keyBytes(5), EVP_PKEY_new());
+    test_assert(!cache.find(8, 1, keyBytes(1)) && held && held.get() == first.get(),
+                "Handle em uso sobrevive ao descarte");
+}
+
+void test_concurrent() {
+    std::cout << "\n→ Concorrência:\n";
+    PKeyCache cache(16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 200; i++) {
+                uint8_t seed = static_cast<uint8_t>((t + i) % 32);
+                if (!cache.find(13, seed, keyBytes(seed))) {
+                    cache.insert(13, seed, keyBytes(seed), EVP_PKEY_new());
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    test_assert(cache.size() == 16, "Acessos concorrentes mantêm o limite");
+    test_assert(cache.hits() + cache.misses() == 1600, "Toda busca é contada");
+}
+
+void test_validator_reuses_keys() {
+    std::cout << "\n→ Integração com DNSSECValidator:\n";
+    TrustAnchorStore anchors;
+    DNSSECValidator validator(anchors);
+
+    DNSKEYRecord dnskey;
+    dnskey.flags = 256;
+    dnskey.protocol = 3;
+    dnskey.algorithm = 13;
+    dnskey.public_key = p256Generator();
+
+    DNSResourceRecord rr;
+    rr.name = "example.com";
+    rr.type = 1;
+    rr.rr_class = 1;
+    rr.ttl = 300;
+    rr.rdlength = 4;
+    rr.rdata = {192, 0, 2, 1};
+
+    RRSIGRecord rrsig;
+    rrsig.type_covered = 1;
+    rrsig.algorithm = 13;
+    rrsig.labels = 2;
+    rrsig.original_ttl = 300;
+    rrsig.signature_inception = 0;
+    rrsig.signature_expiration = 0xFFFFFFFF;
+    rrsig.key_tag = validator.calculateKeyTag(dnskey);
+    rrsig.signer_name = "example.com";
+    rrsig.signature = std::vector<uint8_t>(64, 0x01);
+
+    PKeyCache& pkeys = PKeyCache::instance();
+    pkeys.clear();
+    uint64_t misses_before = pkeys.misses();
+    uint64_t hits_before = pkeys.hits();
+
+    bool first = validator.validateRRSIG({rr}, rrsig, dnskey, "example.com");
+    bool second = validator.validateRRSIG({rr}, rrsig, dnskey, "example.com");
+
+    test_assert(!first && !second, "Assinatura inválida continua rejeitada");
+    test_assert(pkeys.size() == 1, "DNSKEY convertida fica no cache do processo");
+    test_assert(pkeys.misses() - misses_before == 1 && pkeys.hits() - hits_before == 1,
+                "Segunda verificação reaproveita a chave convertida");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: PKeyCache (chaves convertidas)\n";
+    std::cout << "==========================================\n";
+
+    test_find_insert();
+    test_lru_limit();
+    test_concurrent();
+    test_validator_reuses_keys();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
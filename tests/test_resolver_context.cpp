@@ -0,0 +1,648 @@
+/*
+ * Arquivo: test_resolver_context.cpp
+ * Propósito: Testes unitários para o contexto compartilhado entre resolvers (ResolverContext)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para ResolverContext, cobrindo:
+ * - Trust anchors carregados uma vez (padrão e arquivo)
+ * - Conjuntos DNSKEY/DS por zona com TTL e normalização do nome
+ * - RRSIGs do RRset DNSKEY guardados com o conjunto
+ * - Zona sem DS/DNSKEY (conjunto vazio com TTL negativo)
+ * - Limite de zonas e acesso concorrente
+ * - ResolverEngine com contexto compartilhado
+ * - Consultas DNSKEY/DS em paralelo com a caminhada de referências
+ * - Só conjuntos autenticados pela cadeia são guardados (nunca forjados,
+ *   vazios ou erros)
+ *
+ * O teste de paralelismo usa servidores falsos em 127.0.0.x:53 (loopback)
+ * que atrasam DNSKEY/DS e assinam o DNSKEY root com uma chave P-256 gerada
+ * no teste; sem permissão para a porta 53 ele é pulado.
+ */
+
+#include "dns_resolver/ResolverContext.h"
+#include "dns_resolver/ResolverEngine.h"
+#include "dns_resolver/DNSParser.h"
+#include "dns_resolver/DNSSECValidator.h"
+#include "dns_resolver/TrustAnchorStore.h"
+#include <openssl/core_names.h>
+#include <openssl/ecdsa.h>
+#include <openssl/evp.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+DNSKEYRecord makeKey(uint16_t flags) {
+    DNSKEYRecord key;
+    key.flags = flags;
+    key.protocol = 3;
+    key.algorithm = 8;
+    key.public_key = {0x01, 0x02, 0x03};
+    return key;
+}
+
+DSRecord makeDS(uint16_t key_tag) {
+    DSRecord ds;
+    ds.key_tag = key_tag;
+    ds.algorithm = 8;
+    ds.digest_type = 2;
+    ds.digest = std::vector<uint8_t>(32, 0xAB);
+    return ds;
+}
+
+// ========== Servidores Falsos ==========
+
+const char* ROOT_IP = "127.0.0.2";
+const char* AUTH_IP = "127.0.0.3";
+const int DNSSEC_DELAY_MS = 300;
+
+int bindLoopbackDNS(const char* ip) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(53);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    if (fd >= 0 && bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) {
+        return fd;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    return -1;
+}
+
+void appendU16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(value >> 8);
+    out.push_back(value & 0xFF);
+}
+
+void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+    appendU16(out, value >> 16);
+    appendU16(out, value & 0xFFFF);
+}
+
+// Root delega example.test; o autoritativo responde www.example.test.
+// DNSKEY/DS respondem após DNSSEC_DELAY_MS, sem bloquear as demais respostas:
+// a root tem uma KSK P-256 real (trust anchor em anchorPath()), example.test
+// recebe NODATA (zona não assinada).
+// Mode escolhe a resposta DNSKEY: assinada, com assinatura forjada, ou
+// SERVFAIL (também para DS)
+class SlowDnssecServers {
+public:
+    enum class Mode { Signed, Forged, ServFail };
+
+    SlowDnssecServers() {
+        pkey_ = EVP_PKEY_Q_keygen(nullptr, nullptr, "EC", "P-256");
+        uint8_t point[65];
+        size_t point_len = 0;
+        if (pkey_ != nullptr &&
+            EVP_PKEY_get_octet_string_param(pkey_, OSSL_PKEY_PARAM_PUB_KEY,
+                                            point, sizeof(point), &point_len) == 1 &&
+            point_len == 65) {
+            root_key_.public_key.assign(point + 1, point + 65);   // X || Y (RFC 6605)
+        }
+        root_key_.flags = 257;
+        root_key_.protocol = 3;
+        root_key_.algorithm = 13;
+    }
+
+    void setMode(Mode mode) { mode_ = mode; }
+    int rootDnskeyQueries() const { return root_dnskey_queries_.load(); }
+
+    static const char* anchorPath() { return "/tmp/test_resolver_context_signed_anchor.txt"; }
+
+    bool start() {
+        if (root_key_.public_key.empty() || !writeAnchor()) {
+            return false;
+        }
+        root_ = bindLoopbackDNS(ROOT_IP);
+        auth_ = bindLoopbackDNS(AUTH_IP);
+        if (root_ < 0 || auth_ < 0) {
+            return false;
+        }
+        thread_ = std::thread([this]() { serve(); });
+        return true;
+    }
+
+    ~SlowDnssecServers() {
+        stop_ = true;
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (root_ >= 0) close(root_);
+        if (auth_ >= 0) close(auth_);
+        EVP_PKEY_free(pkey_);
+    }
+
+private:
+    struct Delayed {
+        std::chrono::steady_clock::time_point due;
+        int fd;
+        struct sockaddr_in to;
+        std::vector<uint8_t> bytes;
+    };
+
+    bool writeAnchor() {
+        TrustAnchorStore store;
+        DNSSECValidator validator(store);
+        std::ofstream file(anchorPath());
+        file << ". IN DS " << validator.calculateKeyTag(root_key_) << " 13 2 ";
+        for (uint8_t byte : validator.calculateDigest(root_key_, ".", 2)) {
+            static const char* hex = "0123456789ABCDEF";
+            file << hex[byte >> 4] << hex[byte & 0x0F];
+        }
+        file << "\n";
+        return file.good();
+    }
+
+    // RRSIG do RRset DNSKEY da root (um registro) assinado pela KSK
+    RRSIGRecord signRootKeys() const {
+        RRSIGRecord rrsig;
+        rrsig.type_covered = DNSType::DNSKEY;
+        rrsig.algorithm = 13;
+        rrsig.labels = 0;
+        rrsig.original_ttl = 300;
+        rrsig.signature_inception = static_cast<uint32_t>(time(nullptr) - 3600);
+        rrsig.signature_expiration = static_cast<uint32_t>(time(nullptr) + 3600);
+        TrustAnchorStore store;
+        rrsig.key_tag = DNSSECValidator(store).calculateKeyTag(root_key_);
+        rrsig.signer_name = ".";
+
+        std::vector<uint8_t> data;
+        appendU16(data, rrsig.type_covered);
+        data.push_back(rrsig.algorithm);
+        data.push_back(rrsig.labels);
+        appendU32(data, rrsig.original_ttl);
+        appendU32(data, rrsig.signature_expiration);
+        appendU32(data, rrsig.signature_inception);
+        appendU16(data, rrsig.key_tag);
+        data.push_back(0);                      // Signer "."
+        data.push_back(0);                      // Owner "."
+        appendU16(data, DNSType::DNSKEY);
+        appendU16(data, DNSClass::IN);
+        appendU32(data, rrsig.original_ttl);
+        appendU16(data, static_cast<uint16_t>(4 + root_key_.public_key.size()));
+        appendU16(data, root_key_.flags);
+        data.push_back(root_key_.protocol);
+        data.push_back(root_key_.algorithm);
+        data.insert(data.end(), root_key_.public_key.begin(), root_key_.public_key.end());
+
+        // Assinar (DER) e converter para r || s
+        EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+        size_t der_len = 0;
+        std::vector<uint8_t> der;
+        if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, pkey_) == 1 &&
+            EVP_DigestSign(ctx, nullptr, &der_len, data.data(), data.size()) == 1) {
+            der.resize(der_len);
+            EVP_DigestSign(ctx, der.data(), &der_len, data.data(), data.size());
+        }
+        EVP_MD_CTX_free(ctx);
+        const uint8_t* der_ptr = der.data();
+        ECDSA_SIG* sig = d2i_ECDSA_SIG(nullptr, &der_ptr, static_cast<long>(der_len));
+        rrsig.signature.assign(64, 0);
+        if (sig != nullptr) {
+            BN_bn2binpad(ECDSA_SIG_get0_r(sig), rrsig.signature.data(), 32);
+            BN_bn2binpad(ECDSA_SIG_get0_s(sig), rrsig.signature.data() + 32, 32);
+            ECDSA_SIG_free(sig);
+        }
+        return rrsig;
+    }
+
+    DNSMessage answer(const DNSMessage& query, bool root) {
+        DNSMessage response;
+        response.header = query.header;
+        response.header.qr = true;
+        response.questions = query.questions;
+        response.header.arcount = 0;   // OPT da query (EDNS0) não é devolvido
+        if (response.questions[0].qname.empty()) {
+            response.questions[0].qname = ".";   // Raiz volta do parser como ""
+        }
+        const DNSQuestion& question = response.questions[0];
+        if (question.qtype == DNSType::DNSKEY || question.qtype == DNSType::DS) {
+            Mode mode = mode_;
+            if (mode == Mode::ServFail) {
+                response.header.rcode = 2;
+            } else if (question.qtype == DNSType::DNSKEY && question.qname == ".") {
+                root_dnskey_queries_++;
+                DNSResourceRecord key;
+                key.name = ".";
+                key.type = DNSType::DNSKEY;
+                key.rr_class = DNSClass::IN;
+                key.ttl = 300;
+                key.rdata_dnskey = root_key_;
+                response.answers.push_back(key);
+                DNSResourceRecord rrsig;
+                rrsig.name = ".";
+                rrsig.type = DNSType::RRSIG;
+                rrsig.rr_class = DNSClass::IN;
+                rrsig.ttl = 300;
+                rrsig.rdata_rrsig = signRootKeys();
+                if (mode == Mode::Forged) {
+                    rrsig.rdata_rrsig.signature[10] ^= 0xFF;
+                }
+                response.answers.push_back(rrsig);
+            } else {
+                DNSResourceRecord soa;
+                soa.name = root ? "." : "example.test";
+                soa.type = DNSType::SOA;
+                soa.rr_class = DNSClass::IN;
+                soa.ttl = 300;
+                soa.rdata_soa.mname = "ns.example.test";
+                soa.rdata_soa.rname = "hostmaster.example.test";
+                soa.rdata_soa.minimum = 300;
+                response.authority.push_back(soa);
+            }
+            return response;
+        }
+        if (root) {
+            DNSResourceRecord ns;
+            ns.name = "example.test";
+            ns.type = DNSType::NS;
+            ns.rr_class = DNSClass::IN;
+            ns.ttl = 300;
+            ns.rdata_ns = "ns.example.test";
+            response.authority.push_back(ns);
+            DNSResourceRecord glue;
+            glue.name = "ns.example.test";
+            glue.type = DNSType::A;
+            glue.rr_class = DNSClass::IN;
+            glue.ttl = 300;
+            glue.rdata_a = AUTH_IP;
+            response.additional.push_back(glue);
+        } else {
+            response.header.aa = true;
+            DNSResourceRecord a;
+            a.name = question.qname;
+            a.type = DNSType::A;
+            a.rr_class = DNSClass::IN;
+            a.ttl = 300;
+            a.rdata_a = "192.0.2.1";
+            response.answers.push_back(a);
+        }
+        return response;
+    }
+
+    void serve() {
+        struct pollfd fds[2] = {{root_, POLLIN, 0}, {auth_, POLLIN, 0}};
+        std::vector<Delayed> delayed;
+        uint8_t buffer[4096];
+        while (!stop_) {
+            poll(fds, 2, 5);
+            for (int i = 0; i < 2; i++) {
+                if ((fds[i].revents & POLLIN) == 0) {
+                    continue;
+                }
+                struct sockaddr_in from {};
+                socklen_t len = sizeof(from);
+                ssize_t n = recvfrom(fds[i].fd, buffer, sizeof(buffer), 0,
+                                     reinterpret_cast<struct sockaddr*>(&from), &len);
+                if (n <= 0) {
+                    continue;
+                }
+                try {
+                    DNSMessage query = DNSParser::parse(std::vector<uint8_t>(buffer, buffer + n));
+                    uint16_t qtype = query.questions[0].qtype;
+                    Delayed reply{std::chrono::steady_clock::now(), fds[i].fd, from,
+                                  DNSParser::serialize(answer(query, i == 0))};
+                    if (qtype == DNSType::DNSKEY || qtype == DNSType::DS) {
+                        reply.due += std::chrono::milliseconds(DNSSEC_DELAY_MS);
+                    }
+                    delayed.push_back(std::move(reply));
+                } catch (const std::exception&) {
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            for (auto it = delayed.begin(); it != delayed.end();) {
+                if (it->due <= now) {
+                    sendto(it->fd, it->bytes.data(), it->bytes.size(), 0,
+                           reinterpret_cast<struct sockaddr*>(&it->to), sizeof(it->to));
+                    it = delayed.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    int root_ = -1;
+    int auth_ = -1;
+    EVP_PKEY* pkey_ = nullptr;
+    DNSKEYRecord root_key_;
+    std::atomic<bool> stop_{false};
+    std::atomic<Mode> mode_{Mode::Signed};
+    std::atomic<int> root_dnskey_queries_{0};
+    std::thread thread_;
+};
+
+// ========== Testes ==========
+
+/**
+ * Testa o carregamento dos trust anchors
+ */
+void test_trust_anchors() {
+    std::cout << "\n[TEST] ResolverContext - Trust anchors\n";
+
+    ResolverContext context;
+    test_assert(context.trustAnchors().hasTrustAnchor(".") && context.trustAnchorFile().empty(),
+                "KSK root padrão carregada");
+
+    const std::string path = "/tmp/test_resolver_context_anchor.txt";
+    {
+        std::ofstream file(path);
+        file << ". IN DS 20326 8 2 E06D44B80B8F1D39A95C0B0D7C65D08458E880409BBC683457104237C7F8EC8D\n";
+    }
+    ResolverContext from_file(path);
+    test_assert(from_file.trustAnchors().count() == 1 && from_file.trustAnchorFile() == path,
+                "Trust anchor carregado de arquivo");
+
+    bool threw = false;
+    try {
+        ResolverContext missing("/nonexistent/anchor.txt");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    test_assert(threw, "Arquivo inexistente lança exceção");
+}
+
+/**
+ * Testa os conjuntos DNSKEY/DS por zona
+ */
+void test_key_sets() {
+    std::cout << "\n[TEST] ResolverContext - Conjuntos DNSKEY/DS\n";
+
+    ResolverContext context;
+    time_t now = 1000000;
+
+    RRSIGRecord rrsig;
+    rrsig.type_covered = DNSType::DNSKEY;
+    rrsig.key_tag = 4242;
+    context.storeDNSKEY("COM.", {makeKey(257), makeKey(256)}, {rrsig}, 3600, now);
+    std::vector<DNSKEYRecord> keys;
+    std::vector<RRSIGRecord> rrsigs;
+    test_assert(context.findDNSKEY("com", keys, rrsigs, now + 10) && keys.size() == 2 && keys[0].isKSK(),
+                "DNSKEY encontrado (nome normalizado)");
+    test_assert(rrsigs.size() == 1 && rrsigs[0].key_tag == 4242, "RRSIGs do RRset DNSKEY guardados junto");
+    test_assert(!context.findDNSKEY("com", keys, rrsigs, now + 3600), "DNSKEY expira com o TTL");
+
+    context.storeDS("example.com", {makeDS(12345)}, 600, now);
+    std::vector<DSRecord> ds;
+    test_assert(context.findDS("example.com", ds, now) && ds.size() == 1 && ds[0].key_tag == 12345,
+                "DS encontrado");
+    test_assert(!context.findDNSKEY("example.com", keys, rrsigs, now), "DNSKEY e DS são independentes");
+
+    context.storeDS("unsigned.com", {}, 3600, now);
+    ds.clear();
+    test_assert(context.findDS("unsigned.com", ds, now) && ds.empty(),
+                "Zona sem DS guardada como conjunto vazio");
+    test_assert(!context.findDS("unsigned.com", ds, now + ResolverContext::NEGATIVE_TTL),
+                "Conjunto vazio usa o TTL negativo");
+
+    context.storeDNSKEY("big.com", {makeKey(256)}, {}, 10 * ResolverContext::MAX_TTL, now);
+    test_assert(!context.findDNSKEY("big.com", keys, rrsigs, now + ResolverContext::MAX_TTL),
+                "TTL limitado a MAX_TTL");
+
+    context.storeDNSKEY("zero.com", {makeKey(256)}, {}, 0, now);
+    test_assert(!context.findDNSKEY("zero.com", keys, rrsigs, now), "TTL 0 não é guardado");
+
+    context.clear();
+    test_assert(context.size() == 0, "clear() esvazia o contexto");
+}
+
+/**
+ * Testa limite de zonas e acesso concorrente
+ */
+void test_limits_and_concurrency() {
+    std::cout << "\n[TEST] ResolverContext - Limite e concorrência\n";
+
+    ResolverContext context("", true, 3);
+    time_t now = 1000000;
+    context.storeDNSKEY("a.com", {makeKey(256)}, {}, 100, now);
+    context.storeDNSKEY("b.com", {makeKey(256)}, {}, 200, now);
+    context.storeDNSKEY("c.com", {makeKey(256)}, {}, 300, now);
+    context.storeDNSKEY("d.com", {makeKey(256)}, {}, 400, now);
+    std::vector<DNSKEYRecord> keys;
+    std::vector<RRSIGRecord> rrsigs;
+    test_assert(context.size() == 3 && !context.findDNSKEY("a.com", keys, rrsigs, now) &&
+                context.findDNSKEY("d.com", keys, rrsigs, now),
+                "Cheio: descarta a zona que vence antes");
+
+    ResolverContext shared;
+    std::atomic<int> found{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&shared, &found, t]() {
+            for (int i = 0; i < 500; i++) {
+                std::string zone = "z" + std::to_string(i % 50) + ".com";
+                if (t % 2 == 0) {
+                    shared.storeDS(zone, {makeDS(static_cast<uint16_t>(i))}, 3600);
+                } else {
+                    std::vector<DSRecord> out;
+                    if (shared.findDS(zone, out) && out.size() == 1) {
+                        found++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    test_assert(shared.size() == 50 && found > 0, "Leituras e escritas concorrentes consistentes");
+}
+
+/**
+ * Testa ResolverEngine usando um contexto compartilhado
+ */
+void test_engine_context() {
+    std::cout << "\n[TEST] ResolverContext - ResolverEngine compartilhando contexto\n";
+
+    ResolverConfig config;
+    config.quiet_mode = true;
+    auto context = std::make_shared<ResolverContext>();
+
+    bool built = true;
+    try {
+        for (int i = 0; i < 100; i++) {
+            ResolverEngine engine(config, context);
+        }
+    } catch (const std::exception&) {
+        built = false;
+    }
+    test_assert(built && context.use_count() == 1, "100 engines sobre o mesmo contexto");
+
+    bool null_rejected = false;
+    try {
+        ResolverEngine engine(config, nullptr);
+    } catch (const std::invalid_argument&) {
+        null_rejected = true;
+    }
+    test_assert(null_rejected, "Contexto nulo rejeitado");
+
+    ResolverConfig other = config;
+    other.trust_anchor_file = "/tmp/test_resolver_context_anchor.txt";
+    bool mismatch_rejected = false;
+    try {
+        ResolverEngine engine(other, context);
+    } catch (const std::invalid_argument&) {
+        mismatch_rejected = true;
+    }
+    test_assert(mismatch_rejected, "Contexto de outro trust anchor rejeitado");
+}
+
+ResolverConfig signedConfig() {
+    ResolverConfig config;
+    config.root_servers = {ROOT_IP};
+    config.dnssec_enabled = true;
+    config.trust_anchor_file = SlowDnssecServers::anchorPath();
+    config.use_cache = false;
+    config.use_delegation_cache = false;
+    config.coalesce_inflight = false;
+    config.quiet_mode = true;
+    config.timeout_seconds = 2;
+    return config;
+}
+
+/**
+ * Testa DNSKEY/DS consultados em paralelo com as referências
+ */
+void test_parallel_fetches(SlowDnssecServers& servers) {
+    std::cout << "\n[TEST] ResolverContext - DNSKEY/DS em paralelo\n";
+
+    ResolverConfig config = signedConfig();
+    auto context = std::make_shared<ResolverContext>(config.trust_anchor_file);
+
+    // Em série: DNSKEY root, DS example.test, DNSKEY example.test = 3 atrasos
+    auto start = std::chrono::steady_clock::now();
+    DNSMessage response;
+    bool ok = true;
+    try {
+        ResolverEngine engine(config, context);
+        response = engine.resolve("www.example.test", DNSType::A);
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    test_assert(ok && response.answers.size() == 1, "Resolução com DNSSEC concluída");
+    test_assert(elapsed < 2 * DNSSEC_DELAY_MS, "Consultas DNSSEC sobrepostas (" +
+                std::to_string(elapsed) + " ms, atraso de " + std::to_string(DNSSEC_DELAY_MS) +
+                " ms cada)");
+    test_assert(context->size() == 1, "Só o DNSKEY root (autenticado) guardado no contexto");
+
+    // Segunda resolução: DNSKEY root vem do contexto
+    int queries = servers.rootDnskeyQueries();
+    try {
+        ResolverEngine engine(config, context);
+        response = engine.resolve("mail.example.test", DNSType::A);
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    test_assert(ok && servers.rootDnskeyQueries() == queries, "Segunda resolução reaproveita o DNSKEY root");
+}
+
+/**
+ * Testa que DNSKEY forjado, NODATA e erros não ficam no contexto
+ */
+void test_uncached_failures(SlowDnssecServers& servers) {
+    std::cout << "\n[TEST] ResolverContext - Conjuntos não autenticados não são guardados\n";
+
+    ResolverConfig config = signedConfig();
+    auto context = std::make_shared<ResolverContext>(config.trust_anchor_file);
+
+    // Assinatura forjada: BOGUS, nada guardado (nem o elo no ValidatedKeyCache)
+    servers.setMode(SlowDnssecServers::Mode::Forged);
+    bool bogus = false;
+    try {
+        ResolverEngine engine(config, context);
+        engine.resolve("www.example.test", DNSType::A);
+    } catch (const std::exception&) {
+        bogus = true;
+    }
+    test_assert(bogus && context->size() == 0 && context->validatedKeys().size() == 0,
+                "DNSKEY com RRSIG forjado não é guardado");
+
+    // A resposta legítima seguinte não é bloqueada pela forjada
+    servers.setMode(SlowDnssecServers::Mode::Signed);
+    bool ok = true;
+    try {
+        ResolverEngine engine(config, context);
+        engine.resolve("www.example.test", DNSType::A);
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    test_assert(ok && context->size() == 1, "Resposta assinada seguinte validada e guardada");
+
+    servers.setMode(SlowDnssecServers::Mode::ServFail);
+    auto failing = std::make_shared<ResolverContext>(config.trust_anchor_file);
+    ok = true;
+    try {
+        ResolverEngine engine(config, failing);
+        engine.resolve("www.example.test", DNSType::A);
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    test_assert(ok && failing->size() == 0, "SERVFAIL não é guardado");
+    servers.setMode(SlowDnssecServers::Mode::Signed);
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: ResolverContext (estado compartilhado)\n";
+    std::cout << "==========================================\n";
+
+    test_trust_anchors();
+    test_key_sets();
+    test_limits_and_concurrency();
+    test_engine_context();
+
+    SlowDnssecServers servers;
+    if (servers.start()) {
+        test_parallel_fetches(servers);
+        test_uncached_failures(servers);
+    } else {
+        std::cout << "\n(teste de rede pulado: porta 53 em loopback indisponível)\n";
+    }
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}
@@ -0,0 +1,265 @@
+/*
+ * Arquivo: test_shared_cache.cpp
+ * Propósito: Testes unitários para o espelho do cache em memória compartilhada (SharedCache)
+ * Autor: João Victor Zuanazzi Lourenço, Ian Tutida Leite, Tiago Amarilha Rodrigues
+ * Data: 14/10/2025
+ * Projeto: DNS Resolver com DNSSEC
+ *
+ * Este arquivo contém testes para SharedCache, cobrindo:
+ * - Publicação pelo criador e leitura por um mapeamento somente leitura
+ * - Entradas positivas e negativas, normalização da chave
+ * - Expiração, substituição e respostas maiores que o slot
+ * - Colisões além da janela de sondagem e limpeza por tipo
+ * - Contadores de HITs dos leitores amostrados pelo criador
+ * - Remoção de uma chave por tipo (unpublish)
+ * - Segmento inativo após o fim do criador
+ * - Consistência das leituras com escritas concorrentes (seqlock)
+ */
+
+#include "dns_resolver/SharedCache.h"
+#include "dns_resolver/types.h"
+#include <unistd.h>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dns_resolver;
+
+// ========== Sistema de Contadores de Testes ==========
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void test_assert(bool condition, const std::string& test_name) {
+    if (condition) {
+        std::cout << "✓ " << test_name << "\n";
+        tests_passed++;
+    } else {
+        std::cout << "✗ " << test_name << "\n";
+        tests_failed++;
+    }
+}
+
+// ========== Helpers ==========
+
+std::string segmentName() {
+    return "/test_shared_cache_" + std::to_string(getpid());
+}
+
+void publishPositive(SharedCache& shm, const std::string& name, const std::string& wire,
+                     uint32_t ttl = 300, time_t timestamp = std::time(nullptr)) {
+    shm.publish(name, DNSType::A, DNSClass::IN, false, 0, wire, timestamp, ttl);
+}
+
+bool lookup(const SharedCache& shm, const std::string& name, SharedCacheHit& hit) {
+    return shm.lookup(name, DNSType::A, DNSClass::IN, std::time(nullptr), hit);
+}
+
+// ========== Testes ==========
+
+/**
+ * Testa publicação e leitura entre mapeamentos
+ */
+void test_publish_and_lookup() {
+    std::cout << "\n[TEST] SharedCache - Publicação e leitura\n";
+
+    auto writer = SharedCache::create(segmentName(), 100);
+    auto reader = SharedCache::attach(segmentName());
+    test_assert(writer && writer->slotCount() == 128, "Slots arredondados para 128");
+    test_assert(reader && reader->isActive(), "Leitor mapeia o segmento");
+
+    publishPositive(*writer, "www.example.com", std::string("\x12\x34wire", 6));
+    writer->publish("nx.example", DNSType::A, DNSClass::IN, true, 3, "", std::time(nullptr), 60);
+
+    SharedCacheHit hit;
+    test_assert(lookup(*reader, "www.example.com", hit) && !hit.negative &&
+                hit.wire == std::string("\x12\x34wire", 6), "HIT positivo com wire");
+    test_assert(lookup(*reader, "WWW.Example.COM.", hit), "Chave normalizada");
+    test_assert(lookup(*reader, "nx.example", hit) && hit.negative && hit.rcode == 3,
+                "HIT negativo com RCODE");
+    test_assert(!reader->lookup("www.example.com", DNSType::AAAA, DNSClass::IN,
+                                std::time(nullptr), hit), "Outro qtype: MISS");
+    test_assert(!lookup(*reader, "absent.example", hit), "Ausente: MISS");
+
+    // Leitor não escreve
+    reader->publish("ro.example", DNSType::A, DNSClass::IN, false, 0, "x", std::time(nullptr), 60);
+    test_assert(!lookup(*writer, "ro.example", hit), "Mapeamento somente leitura ignora publish");
+}
+
+/**
+ * Testa expiração, substituição e respostas grandes
+ */
+void test_expiry_and_replace() {
+    std::cout << "\n[TEST] SharedCache - Expiração e substituição\n";
+
+    auto shm = SharedCache::create(segmentName(), 64);
+    SharedCacheHit hit;
+
+    publishPositive(*shm, "old.example", "old", 10, std::time(nullptr) - 60);
+    test_assert(!lookup(*shm, "old.example", hit), "Expirada: MISS");
+
+    publishPositive(*shm, "a.example", "first");
+    publishPositive(*shm, "a.example", "second");
+    test_assert(lookup(*shm, "a.example", hit) && hit.wire == "second", "Substituição in place");
+
+    publishPositive(*shm, "a.example", std::string(SharedCache::WIRE_CAPACITY + 1, 'x'));
+    test_assert(!lookup(*shm, "a.example", hit), "Resposta grande remove a versão anterior");
+}
+
+/**
+ * Testa colisões além da janela de sondagem e limpeza
+ */
+void test_collisions_and_clear() {
+    std::cout << "\n[TEST] SharedCache - Colisões e limpeza\n";
+
+    // 4 slots = uma única janela: a quinta chave substitui a que expira primeiro
+    auto shm = SharedCache::create(segmentName(), 4);
+    time_t now = std::time(nullptr);
+    publishPositive(*shm, "k0.example", "0", 500, now);
+    publishPositive(*shm, "k1.example", "1", 100, now);
+    publishPositive(*shm, "k2.example", "2", 500, now);
+    shm->publish("k3.example", DNSType::A, DNSClass::IN, true, 3, "", now, 500);
+    publishPositive(*shm, "k4.example", "4", 500, now);
+
+    SharedCacheHit hit;
+    test_assert(!lookup(*shm, "k1.example", hit), "Vítima: a que expira primeiro");
+    test_assert(lookup(*shm, "k4.example", hit) && lookup(*shm, "k0.example", hit),
+                "Demais entradas preservadas");
+
+    shm->clear(true, false);
+    test_assert(!lookup(*shm, "k0.example", hit) && lookup(*shm, "k3.example", hit),
+                "clear(positivas) mantém negativas");
+    shm->clear(false, true);
+    test_assert(!lookup(*shm, "k3.example", hit), "clear(negativas)");
+}
+
+/**
+ * Testa contadores de HITs e remoção de uma chave
+ */
+void test_hits_and_unpublish() {
+    std::cout << "\n[TEST] SharedCache - HITs e unpublish\n";
+
+    auto writer = SharedCache::create(segmentName(), 16);
+    auto reader = SharedCache::attach(segmentName());
+    publishPositive(*writer, "hot.example", "hot");
+    publishPositive(*writer, "cold.example", "cold");
+    writer->publish("nx.example", DNSType::A, DNSClass::IN, true, 3, "", std::time(nullptr), 60);
+
+    SharedCacheHit hit;
+    for (int i = 0; i < 3; i++) {
+        lookup(*reader, "hot.example", hit);
+    }
+    lookup(*reader, "nx.example", hit);
+    lookup(*reader, "absent.example", hit);
+
+    std::vector<SharedCacheHits> sampled = writer->drainHits();
+    bool hot = false;
+    bool negative = false;
+    for (const auto& sample : sampled) {
+        hot = hot || (sample.qname == "hot.example" && sample.hits == 3 && !sample.negative);
+        negative = negative || (sample.qname == "nx.example" && sample.hits == 1 && sample.negative);
+    }
+    test_assert(sampled.size() == 2 && hot && negative, "HITs do leitor amostrados por chave");
+    test_assert(writer->drainHits().empty(), "Amostragem zera os contadores");
+    test_assert(reader->drainHits().empty(), "Leitor não amostra");
+
+    // Slot reaproveitado por outra chave não herda HITs
+    lookup(*reader, "cold.example", hit);
+    writer->unpublish("cold.example", DNSType::A, DNSClass::IN, false);
+    publishPositive(*writer, "new.example", "new");
+    test_assert(!lookup(*reader, "cold.example", hit), "unpublish remove a chave");
+    sampled = writer->drainHits();
+    test_assert(sampled.empty(), "HITs da chave removida descartados");
+
+    writer->unpublish("nx.example", DNSType::A, DNSClass::IN, false);
+    test_assert(lookup(*reader, "nx.example", hit), "unpublish de outro tipo mantém a entrada");
+    writer->unpublish("NX.Example.", DNSType::A, DNSClass::IN, true);
+    test_assert(!lookup(*reader, "nx.example", hit), "unpublish negativo (chave normalizada)");
+}
+
+/**
+ * Testa segmento inativo após o criador encerrar
+ */
+void test_inactive_after_owner() {
+    std::cout << "\n[TEST] SharedCache - Fim do criador\n";
+
+    auto writer = SharedCache::create(segmentName(), 16);
+    auto reader = SharedCache::attach(segmentName());
+    writer.reset();
+
+    test_assert(reader && !reader->isActive(), "Segmento marcado inativo");
+    test_assert(!SharedCache::attach(segmentName()), "Segmento removido (shm_unlink)");
+}
+
+/**
+ * Testa consistência das leituras durante escritas concorrentes
+ */
+void test_concurrent_readers() {
+    std::cout << "\n[TEST] SharedCache - Leituras concorrentes (seqlock)\n";
+
+    auto writer = SharedCache::create(segmentName(), 16);
+    auto reader = SharedCache::attach(segmentName());
+    std::string a(1000, 'a');
+    std::string b(600, 'b');
+    publishPositive(*writer, "hot.example", a);
+
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> hits{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 2; t++) {
+        readers.emplace_back([&] {
+            SharedCacheHit hit;
+            while (!done) {
+                if (lookup(*reader, "hot.example", hit)) {
+                    hits++;
+                    if (hit.wire != a && hit.wire != b) {
+                        torn++;
+                    }
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        publishPositive(*writer, "hot.example", (i % 2) ? a : b);
+    }
+    done = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    test_assert(hits > 0, "Leitores obtiveram HITs");
+    test_assert(torn == 0, "Nenhuma leitura inconsistente");
+}
+
+int main() {
+    std::cout << "==========================================\n";
+    std::cout << "  TESTES: SharedCache (Memória Compartilhada)\n";
+    std::cout << "==========================================\n";
+
+    test_publish_and_lookup();
+    test_expiry_and_replace();
+    test_collisions_and_clear();
+    test_hits_and_unpublish();
+    test_inactive_after_owner();
+    test_concurrent_readers();
+
+    std::cout << "\n==========================================\n";
+    std::cout << "  RESULTADOS FINAIS\n";
+    std::cout << "==========================================\n";
+    std::cout << "  ✓ Testes passaram: " << tests_passed << "\n";
+    std::cout << "  ✗ Testes falharam: " << tests_failed << "\n";
+    std::cout << "==========================================\n";
+
+    if (tests_failed == 0) {
+        std::cout << "\n TODOS OS TESTES PASSARAM!\n\n";
+        return 0;
+    } else {
+        std::cout << "\n ALGUNS TESTES FALHARAM\n\n";
+        return 1;
+    }
+}